@@ -0,0 +1,99 @@
+#include "bench.h"
+
+#include <math.h>
+#include <string.h>
+#include <time.h>
+
+#include "modem/modem_rx.h"
+
+#define TRIAL_DST 0x02
+#define TRIAL_SRC 0x01
+
+typedef struct received
+{
+    uint8_t data[MODEM_FRAME_MAX_PAYLOAD];
+    size_t len;
+    int frames;
+} received_t;
+
+static modem_rx_t rx;
+
+uint64_t bench_clock_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+void bench_count_frame(void *ctx, const uint8_t *data, size_t len, uint8_t src_addr)
+{
+    (void)data;
+    (void)len;
+    (void)src_addr;
+    if (ctx)
+        (*(int *)ctx)++;
+}
+
+static void keep_frame(void *ctx, const uint8_t *data, size_t len, uint8_t src_addr)
+{
+    received_t *received = ctx;
+    (void)src_addr;
+    memcpy(received->data, data, len);
+    received->len = len;
+    received->frames++;
+}
+
+bool bench_frame_trial(const modem_profile_t *profile, const bench_trial_t *trial, synth_rng_t *rng,
+                       const uint8_t *payload, size_t len, uint16_t *samples, size_t max_samples,
+                       double *airtime_s)
+{
+    modem_profile_t tx = *profile;
+    tx.carrier_hz += trial->offset_hz;
+    for (int k = 0; k < MODEM_MAX_CARRIERS; k++)
+    {
+        tx.tone_hz[k][0] += trial->offset_hz;
+        tx.tone_hz[k][1] += trial->offset_hz;
+    }
+    for (int i = 0; i < MODEM_MAX_TONES; i++)
+        tx.mfsk_hz[i] += trial->offset_hz;
+
+    size_t lead = profile->sample_rate / 4;
+    synth_idle(rng, samples, lead, 0.0f);
+    size_t frame = synth_frame(&tx, trial->amplitude, TRIAL_DST, TRIAL_SRC, payload, len, samples + lead,
+                               max_samples - 2 * lead);
+    float power = synth_power(samples + lead, frame);
+    synth_idle(rng, samples + lead + frame, lead, 0.0f);
+    size_t n = 2 * lead + frame;
+
+    if (!isinf(trial->snr_db))
+    {
+        float sigma = trial->reference == BENCH_SNR_POWER
+                          ? synth_noise_sigma_for_power(power, trial->snr_db, profile->sample_rate)
+                          : synth_noise_sigma(trial->amplitude, trial->snr_db, profile->sample_rate);
+        synth_add_noise(rng, samples, n, sigma);
+    }
+
+    received_t received = {0};
+    modem_rx_init(&rx, profile, keep_frame, &received);
+    modem_rx_process(&rx, samples, n);
+
+    if (airtime_s)
+        *airtime_s = (double)frame / profile->sample_rate;
+    return received.frames == 1 && received.len == len && !memcmp(received.data, payload, len);
+}
+
+double bench_frame_success(const modem_profile_t *profile, const bench_trial_t *trial, int trials,
+                           synth_rng_t *rng, uint16_t *samples, size_t max_samples, double *airtime_s)
+{
+    uint8_t payload[BENCH_TRIAL_PAYLOAD];
+    int ok = 0;
+
+    for (int t = 0; t < trials; t++)
+    {
+        for (size_t i = 0; i < sizeof(payload); i++)
+            payload[i] = (uint8_t)synth_rng_u32(rng);
+        ok += bench_frame_trial(profile, trial, rng, payload, sizeof(payload), samples, max_samples, airtime_s);
+    }
+
+    return trials > 0 ? (double)ok / trials : 0.0;
+}
@@ -0,0 +1,45 @@
+#ifndef BENCH_H
+#define BENCH_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#include "synth.h"
+
+#define BENCH_TRIAL_PAYLOAD 32 // bytes in each bench_frame_success frame
+
+// Monotonic clock in nanoseconds; also fits modem_rx_set_timer and the loopback config.
+uint64_t bench_clock_ns(void);
+
+// modem_rx callback counting frames into the int at ctx (if any).
+void bench_count_frame(void *ctx, const uint8_t *data, size_t len, uint8_t src_addr);
+
+typedef enum
+{
+    BENCH_SNR_PEAK = 0, // against a sine at the trial amplitude (single-tone profiles)
+    BENCH_SNR_POWER,    // against the frame's measured mean power (multi-carrier)
+} bench_snr_reference_t;
+
+typedef struct bench_trial
+{
+    int16_t amplitude;               // peak, ADC counts
+    float snr_db;                    // in a 3 kHz bandwidth; INFINITY adds no noise
+    bench_snr_reference_t reference;
+    float offset_hz;                 // every transmitted frequency moved by this
+} bench_trial_t;
+
+/*
+ * One frame between quarter-second idles, noised as the trial says and run
+ * through a fresh modem_rx. True if exactly that payload came out.
+ * samples is scratch; airtime_s (if not NULL) gets the frame's length.
+ */
+bool bench_frame_trial(const modem_profile_t *profile, const bench_trial_t *trial, synth_rng_t *rng,
+                       const uint8_t *payload, size_t len, uint16_t *samples, size_t max_samples,
+                       double *airtime_s);
+
+// Share of trials random BENCH_TRIAL_PAYLOAD-byte frames that get through.
+double bench_frame_success(const modem_profile_t *profile, const bench_trial_t *trial, int trials,
+                           synth_rng_t *rng, uint16_t *samples, size_t max_samples, double *airtime_s);
+
+#endif // BENCH_H
@@ -0,0 +1,525 @@
+#include "capture.h"
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "modem/modem_profile.h"
+
+#define WAV_HEADER_SIZE 44
+#define CHUNKED_BLOCK_FRAMES 4096
+
+static uint32_t read_le32(const uint8_t *p)
+{
+    return (uint32_t)p[0] | (uint32_t)p[1] << 8 | (uint32_t)p[2] << 16 | (uint32_t)p[3] << 24;
+}
+
+static uint16_t read_le16(const uint8_t *p)
+{
+    return (uint16_t)(p[0] | p[1] << 8);
+}
+
+static void write_le32(uint8_t *p, uint32_t value)
+{
+    p[0] = (uint8_t)value;
+    p[1] = (uint8_t)(value >> 8);
+    p[2] = (uint8_t)(value >> 16);
+    p[3] = (uint8_t)(value >> 24);
+}
+
+static void write_le16(uint8_t *p, uint16_t value)
+{
+    p[0] = (uint8_t)value;
+    p[1] = (uint8_t)(value >> 8);
+}
+
+int capture_format_parse(const char *name, capture_format_t *format)
+{
+    if (!strcmp(name, "raw"))
+        *format = CAPTURE_RAW;
+    else if (!strcmp(name, "wav"))
+        *format = CAPTURE_WAV;
+    else if (!strcmp(name, "rec"))
+        *format = CAPTURE_RECORD;
+    else if (!strcmp(name, "pcc"))
+        *format = CAPTURE_CHUNKED;
+    else
+        return -1;
+    return 0;
+}
+
+capture_format_t capture_format_guess(const char *path)
+{
+    size_t len = strlen(path);
+    if (len >= 4 && !strcmp(path + len - 4, ".wav"))
+        return CAPTURE_WAV;
+    if (len >= 4 && !strcmp(path + len - 4, ".rec"))
+        return CAPTURE_RECORD;
+    if (len >= 4 && !strcmp(path + len - 4, ".pcc"))
+        return CAPTURE_CHUNKED;
+    return CAPTURE_RAW;
+}
+
+static uint8_t *read_file(const char *path, size_t *size)
+{
+    FILE *file = fopen(path, "rb");
+    if (!file)
+        return NULL;
+
+    fseek(file, 0, SEEK_END);
+    long bytes = ftell(file);
+    fseek(file, 0, SEEK_SET);
+
+    uint8_t *data = bytes > 0 ? malloc((size_t)bytes) : NULL;
+    if (data && fread(data, 1, (size_t)bytes, file) != (size_t)bytes)
+    {
+        free(data);
+        data = NULL;
+    }
+
+    fclose(file);
+    *size = data ? (size_t)bytes : 0;
+    return data;
+}
+
+// Finds the fmt and data chunks of a 16-bit mono PCM WAV.
+static int parse_wav(const uint8_t *data, size_t size, uint32_t *rate, const uint8_t **pcm, size_t *count)
+{
+    if (size < 12 || memcmp(data, "RIFF", 4) || memcmp(data + 8, "WAVE", 4))
+        return -1;
+
+    bool have_fmt = false;
+    size_t pos = 12;
+    while (pos + 8 <= size)
+    {
+        const uint8_t *chunk = data + pos;
+        uint32_t len = read_le32(chunk + 4);
+        if (len > size - pos - 8)
+            len = (uint32_t)(size - pos - 8); // tolerate a truncated last chunk
+
+        if (!memcmp(chunk, "fmt ", 4) && len >= 16)
+        {
+            if (read_le16(chunk + 8) != 1 || read_le16(chunk + 10) != 1 || read_le16(chunk + 22) != 16)
+                return -1; // PCM, mono, 16 bit only
+            *rate = read_le32(chunk + 12);
+            have_fmt = true;
+        }
+        else if (!memcmp(chunk, "data", 4) && have_fmt)
+        {
+            *pcm = chunk + 8;
+            *count = len / 2;
+            return 0;
+        }
+
+        pos += 8 + len + (len & 1);
+    }
+
+    return -1;
+}
+
+static uint16_t clamp_adc(int32_t value)
+{
+    if (value < 0)
+        return 0;
+    if (value > 4095)
+        return 4095;
+    return (uint16_t)value;
+}
+
+size_t capture_resample(const uint16_t *in, size_t count, uint32_t in_rate, uint32_t out_rate,
+                        uint16_t *out, size_t max_out)
+{
+    if (!count || !in_rate || !out_rate)
+        return 0;
+
+    size_t n = (size_t)((uint64_t)count * out_rate / in_rate);
+    if (n > max_out)
+        n = max_out;
+
+    for (size_t i = 0; i < n; i++)
+    {
+        double t = (double)i * in_rate / out_rate;
+        size_t k = (size_t)t;
+        double frac = t - k;
+        double a = in[k];
+        double b = k + 1 < count ? in[k + 1] : a;
+        out[i] = (uint16_t)(a + (b - a) * frac + 0.5);
+    }
+
+    return n;
+}
+
+static int load_chunked(const char *path, uint32_t file_rate, uint32_t *rate, uint16_t **samples, size_t *count)
+{
+    capture_map_t map;
+    if (capture_map(path, CAPTURE_CHUNKED, &map))
+        return -1;
+
+    uint16_t *raw = malloc((map.count ? map.count : 1) * sizeof(uint16_t));
+    if (!raw)
+    {
+        capture_unmap(&map);
+        return -1;
+    }
+
+    for (size_t i = 0; i < map.count; i++)
+        raw[i] = capture_map_sample(&map, i);
+
+    *rate = file_rate ? file_rate : map.rate;
+    *samples = raw;
+    *count = map.count;
+    capture_unmap(&map);
+    return 0;
+}
+
+// Hands raw over at out_rate, resampling (and freeing raw) if the rates differ.
+static int resample_owned(uint16_t *raw, size_t n, uint32_t rate, uint32_t out_rate, uint16_t **samples,
+                          size_t *count)
+{
+    if (!rate)
+    {
+        free(raw);
+        return -1;
+    }
+
+    if (rate == out_rate)
+    {
+        *samples = raw;
+        *count = n;
+        return 0;
+    }
+
+    size_t max_out = (size_t)((uint64_t)n * out_rate / rate) + 1;
+    uint16_t *resampled = malloc(max_out * sizeof(uint16_t));
+    if (!resampled)
+    {
+        free(raw);
+        return -1;
+    }
+
+    *count = capture_resample(raw, n, rate, out_rate, resampled, max_out);
+    *samples = resampled;
+    free(raw);
+    return 0;
+}
+
+int capture_load(const char *path, capture_format_t format, uint32_t file_rate, uint32_t out_rate,
+                 uint16_t **samples, size_t *count)
+{
+    if (format == CAPTURE_CHUNKED)
+    {
+        uint16_t *raw;
+        size_t n;
+        uint32_t rate;
+        if (load_chunked(path, file_rate, &rate, &raw, &n))
+            return -1;
+        return resample_owned(raw, n, rate, out_rate, samples, count);
+    }
+
+    size_t size;
+    uint8_t *data = read_file(path, &size);
+    if (!data)
+        return -1;
+
+    const uint8_t *pcm = data;
+    size_t stride = format == CAPTURE_RECORD ? CAPTURE_RECORD_SIZE : 2;
+    size_t n = size / stride;
+    uint32_t header_rate = 0;
+    if (format == CAPTURE_WAV && parse_wav(data, size, &header_rate, &pcm, &n))
+    {
+        free(data);
+        return -1;
+    }
+
+    uint32_t rate = file_rate ? file_rate : header_rate;
+    uint16_t *raw = malloc((n ? n : 1) * sizeof(uint16_t));
+    if (!rate || !raw)
+    {
+        free(raw);
+        free(data);
+        return -1;
+    }
+
+    for (size_t i = 0; i < n; i++)
+    {
+        uint16_t value = read_le16(pcm + stride * i);
+        raw[i] = format == CAPTURE_WAV ? clamp_adc((int16_t)value + MODEM_ADC_MIDPOINT) : value;
+    }
+    free(data);
+
+    return resample_owned(raw, n, rate, out_rate, samples, count);
+}
+
+int capture_save_chunked(const char *path, const capture_info_t *info, const uint16_t *frames, size_t count,
+                         size_t block)
+{
+    if (!info->channels || info->channels > CAPTURE_MAX_CHANNELS || !info->sample_rate || !block)
+        return -1;
+
+    FILE *file = fopen(path, "wb");
+    if (!file)
+        return -1;
+
+    uint8_t header[CAPTURE_CHUNK_HEADER_SIZE + CAPTURE_INFO_SIZE];
+    bool ok = fwrite(header, 1, capture_file_info(header, info, 0, 0), file) > 0;
+
+    size_t frame_size = capture_file_frame_size(info);
+    for (size_t first = 0; first < count && ok; first += block)
+    {
+        size_t n = count - first < block ? count - first : block;
+        // Block time is when its last frame was taken, as the recorder stamps it.
+        uint64_t time_us = (uint64_t)(first + n) * 1000000 / info->sample_rate;
+
+        capture_file_chunk_header(header, CAPTURE_TAG_DATA, (uint32_t)(n * frame_size), time_us, first);
+        ok = fwrite(header, 1, CAPTURE_CHUNK_HEADER_SIZE, file) == CAPTURE_CHUNK_HEADER_SIZE;
+
+        const uint16_t *src = frames + first * info->channels;
+        for (size_t v = 0; v < n * info->channels && ok; v++)
+        {
+            // Channel 0 is always a u16; traces may be a byte.
+            uint8_t bytes[2];
+            size_t width = (v % info->channels && info->trace_bits == 8) ? 1 : 2;
+            if (width == 1)
+                bytes[0] = (uint8_t)src[v];
+            else
+                write_le16(bytes, src[v]);
+            ok = fwrite(bytes, 1, width, file) == width;
+        }
+    }
+
+    return fclose(file) || !ok ? -1 : 0;
+}
+
+int capture_save(const char *path, capture_format_t format, uint32_t rate, const uint16_t *samples, size_t count)
+{
+    if (format == CAPTURE_CHUNKED)
+    {
+        capture_info_t info = {
+            .channels = 1,
+            .sample_rate = rate,
+            .bits = 12,
+            .profile = CAPTURE_PROFILE_NONE,
+            .dc_offset = MODEM_ADC_MIDPOINT,
+        };
+        return capture_save_chunked(path, &info, samples, count, CHUNKED_BLOCK_FRAMES);
+    }
+
+    FILE *file = fopen(path, "wb");
+    if (!file)
+        return -1;
+
+    bool ok = true;
+    if (format == CAPTURE_WAV)
+    {
+        uint8_t header[WAV_HEADER_SIZE];
+        uint32_t bytes = (uint32_t)(count * 2);
+        memcpy(header, "RIFF", 4);
+        write_le32(header + 4, 36 + bytes);
+        memcpy(header + 8, "WAVEfmt ", 8);
+        write_le32(header + 16, 16);
+        write_le16(header + 20, 1); // PCM
+        write_le16(header + 22, 1); // mono
+        write_le32(header + 24, rate);
+        write_le32(header + 28, rate * 2);
+        write_le16(header + 32, 2);
+        write_le16(header + 34, 16);
+        memcpy(header + 36, "data", 4);
+        write_le32(header + 40, bytes);
+        ok = fwrite(header, 1, sizeof(header), file) == sizeof(header);
+    }
+
+    size_t stride = format == CAPTURE_RECORD ? CAPTURE_RECORD_SIZE : 2;
+    for (size_t i = 0; i < count && ok; i++)
+    {
+        uint8_t bytes[CAPTURE_RECORD_SIZE] = {0};
+        uint16_t value = format == CAPTURE_WAV ? (uint16_t)(int16_t)(samples[i] - MODEM_ADC_MIDPOINT) : samples[i];
+        write_le16(bytes, value);
+        ok = fwrite(bytes, 1, stride, file) == stride;
+    }
+
+    return fclose(file) || !ok ? -1 : 0;
+}
+
+/*
+ * Lists the DATA chunks of a mapped capture stream. Anything before the
+ * first INFO (a stream joined late) and bytes that are not a chunk are
+ * skipped; a DATA chunk cut short at the end keeps its whole frames.
+ */
+static int index_chunked(capture_map_t *map)
+{
+    bool have_info = false;
+    size_t capacity = 0;
+    size_t pos = 0;
+
+    while (pos < map->size)
+    {
+        capture_chunk_t chunk;
+        size_t left = map->size - pos;
+        int bad = capture_file_parse_chunk(map->base + pos, left, &chunk);
+        bool cut = bad && left >= CAPTURE_CHUNK_HEADER_SIZE && chunk.tag == CAPTURE_TAG_DATA;
+
+        if (bad && !cut)
+        {
+            pos = capture_file_resync(map->base, map->size, pos + 1);
+            continue;
+        }
+        if (cut)
+            chunk.length = (uint32_t)(left - CAPTURE_CHUNK_HEADER_SIZE);
+
+        if (chunk.tag == CAPTURE_TAG_INFO)
+        {
+            capture_info_t info;
+            if (!have_info && !capture_file_parse_info(&chunk, &info))
+            {
+                have_info = true;
+                map->rate = info.sample_rate;
+                map->channels = info.channels;
+                map->bits = info.bits;
+                map->profile = info.profile;
+                map->dc_offset = info.dc_offset;
+                map->trace_bits = info.trace_bits;
+                map->stride = capture_file_frame_size(&info);
+            }
+        }
+        else if (chunk.tag == CAPTURE_TAG_GAP && have_info && chunk.length >= CAPTURE_GAP_SIZE)
+        {
+            map->dropped += read_le32(chunk.payload);
+        }
+        else if (chunk.tag == CAPTURE_TAG_DATA && have_info && chunk.length >= map->stride)
+        {
+            if (map->block_count == capacity)
+            {
+                capacity = capacity ? capacity * 2 : 256;
+                capture_block_t *blocks = realloc(map->blocks, capacity * sizeof(capture_block_t));
+                if (!blocks)
+                    return -1;
+                map->blocks = blocks;
+            }
+
+            capture_block_t *block = &map->blocks[map->block_count++];
+            block->data = chunk.payload;
+            block->frames = chunk.length / map->stride;
+            block->first = map->count;
+            block->index = chunk.index;
+            block->time_us = chunk.time_us;
+            map->count += block->frames;
+        }
+
+        pos += CAPTURE_CHUNK_HEADER_SIZE + chunk.length;
+    }
+
+    if (!have_info || !map->block_count)
+        return -1;
+
+    map->data = map->blocks[0].data;
+    return 0;
+}
+
+const uint8_t *capture_map_frame(const capture_map_t *map, size_t i)
+{
+    // Blocks are nearly all the same length, so guess first and search if wrong.
+    size_t lo = 0, hi = map->block_count;
+    size_t guess = i / map->blocks[0].frames;
+    if (guess < hi && map->blocks[guess].first <= i && i - map->blocks[guess].first < map->blocks[guess].frames)
+        lo = guess;
+    else
+    {
+        while (hi - lo > 1)
+        {
+            size_t mid = (lo + hi) / 2;
+            if (map->blocks[mid].first <= i)
+                lo = mid;
+            else
+                hi = mid;
+        }
+    }
+
+    const capture_block_t *block = &map->blocks[lo];
+    return block->data + map->stride * (i - block->first);
+}
+
+float capture_map_trace(const capture_map_t *map, size_t i, unsigned channel)
+{
+    if (channel < 1 || channel > 3)
+        return 0.0f;
+
+    if (map->format == CAPTURE_RECORD)
+        return map->data[map->stride * i + 1 + channel] / 255.0f;
+
+    if (map->format == CAPTURE_CHUNKED && map->channels > channel)
+    {
+        const uint8_t *frame = capture_map_frame(map, i);
+        if (map->trace_bits == 8)
+            return frame[1 + channel] / 255.0f;
+        return read_le16(frame + 2 * channel) / 65535.0f;
+    }
+
+    return 0.0f;
+}
+
+int capture_map(const char *path, capture_format_t format, capture_map_t *map)
+{
+    memset(map, 0, sizeof(*map));
+
+    int fd = open(path, O_RDONLY);
+    if (fd < 0)
+        return -1;
+
+    struct stat st;
+    if (fstat(fd, &st) || st.st_size <= 0)
+    {
+        close(fd);
+        return -1;
+    }
+
+    void *base = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED)
+        return -1;
+
+    // Read front to back, once.
+    madvise(base, (size_t)st.st_size, MADV_SEQUENTIAL);
+
+    map->base = base;
+    map->size = (size_t)st.st_size;
+    map->format = format;
+    map->data = map->base;
+    map->channels = 1;
+    map->bits = 12;
+    map->profile = CAPTURE_PROFILE_NONE;
+    map->dc_offset = MODEM_ADC_MIDPOINT;
+
+    if (format == CAPTURE_CHUNKED)
+    {
+        if (index_chunked(map))
+        {
+            capture_unmap(map);
+            return -1;
+        }
+        return 0;
+    }
+
+    map->stride = format == CAPTURE_RECORD ? CAPTURE_RECORD_SIZE : 2;
+    map->count = map->size / map->stride;
+
+    if (format == CAPTURE_WAV && parse_wav(map->base, map->size, &map->rate, &map->data, &map->count))
+    {
+        capture_unmap(map);
+        return -1;
+    }
+
+    return 0;
+}
+
+void capture_unmap(capture_map_t *map)
+{
+    if (map->base)
+        munmap((void *)map->base, map->size);
+    free(map->blocks);
+    memset(map, 0, sizeof(*map));
+}
@@ -0,0 +1,115 @@
+#ifndef CAPTURE_H
+#define CAPTURE_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "utils/capture_file.h"
+
+/*
+ * Capture files as the tools read and write them:
+ *
+ *   raw   little-endian uint16 ADC counts, no header (scripts/record.py)
+ *   wav   16-bit PCM mono, signed around the ADC midpoint (center-shift.py)
+ *   rec   recorder.c debug records before the capture stream: uint16
+ *         sample then the 1200 Hz, 2200 Hz and metric bytes (written as 0,
+ *         ignored on load)
+ *   pcc   the chunked capture stream (utils/capture_file.h); channel 0 is
+ *         loaded, gaps are skipped (capture_map_t.blocks has them)
+ *
+ * Loaded samples are ADC counts at the requested rate; other rates are
+ * resampled linearly.
+ */
+typedef enum
+{
+    CAPTURE_RAW = 0,
+    CAPTURE_WAV,
+    CAPTURE_RECORD,
+    CAPTURE_CHUNKED,
+} capture_format_t;
+
+#define CAPTURE_RECORD_SIZE 5
+
+// "raw", "wav", "rec" or "pcc"; -1 for anything else.
+int capture_format_parse(const char *name, capture_format_t *format);
+
+// From the file name extension: .wav, .rec, .pcc, raw otherwise.
+capture_format_t capture_format_guess(const char *path);
+
+/*
+ * Loads a capture into malloc'd memory. file_rate is the rate the samples
+ * were really taken at: 0 trusts the WAV header (raw files need it).
+ * Returns 0 and the samples at out_rate, or -1.
+ */
+int capture_load(const char *path, capture_format_t format, uint32_t file_rate, uint32_t out_rate,
+                 uint16_t **samples, size_t *count);
+
+int capture_save(const char *path, capture_format_t format, uint32_t rate, const uint16_t *samples, size_t count);
+
+// Writes a capture stream of count frames (info->channels values each) in DATA chunks of block frames.
+// With info->trace_bits 8 the trace values (channels 1 and up) are 0..255.
+int capture_save_chunked(const char *path, const capture_info_t *info, const uint16_t *frames, size_t count,
+                         size_t block);
+
+// One DATA chunk of a mapped capture stream.
+typedef struct capture_block
+{
+    const uint8_t *data;
+    size_t frames;
+    size_t first;   // sample number within the map, gaps left out
+    uint64_t index; // frame number in the stream, gaps counted
+    uint64_t time_us;
+} capture_block_t;
+
+/**
+ * @brief A capture mapped read-only, for files too large to load.
+ *
+ * Samples stay in the file; capture_map_sample converts one to ADC counts.
+ * Capture streams also list their DATA chunks, so readers can see where
+ * frames were lost and when each block was taken.
+ */
+typedef struct capture_map
+{
+    const uint8_t *base; // whole file
+    size_t size;
+    const uint8_t *data; // first sample
+    size_t stride;       // bytes per sample
+    size_t count;
+    uint32_t rate;       // from the WAV or INFO header, 0 for raw and rec
+    capture_format_t format;
+    uint16_t channels;   // u16 values per frame in a capture stream, else 1
+    uint16_t dc_offset;
+    uint8_t bits;
+    uint8_t profile;     // CAPTURE_PROFILE_NONE unless the stream says
+    uint8_t trace_bits;  // capture streams: 8 or 16
+    capture_block_t *blocks; // capture streams only
+    size_t block_count;
+    uint64_t dropped;    // frames the GAP chunks report lost
+} capture_map_t;
+
+int capture_map(const char *path, capture_format_t format, capture_map_t *map);
+void capture_unmap(capture_map_t *map);
+
+// Frame i of a capture stream.
+const uint8_t *capture_map_frame(const capture_map_t *map, size_t i);
+
+static inline uint16_t capture_map_sample(const capture_map_t *map, size_t i)
+{
+    const uint8_t *p = map->blocks ? capture_map_frame(map, i) : map->data + map->stride * i;
+    uint16_t value = (uint16_t)(p[0] | p[1] << 8);
+
+    if (map->format != CAPTURE_WAV)
+        return value;
+
+    int32_t counts = (int16_t)value + 2048;
+    return (uint16_t)(counts < 0 ? 0 : counts > 4095 ? 4095 : counts);
+}
+
+// Firmware trace 1..3 (1200 Hz, 2200 Hz, metric) as 0..1 from rec or a 4-channel stream; 0 otherwise.
+float capture_map_trace(const capture_map_t *map, size_t i, unsigned channel);
+
+// Linear resampling; returns the number of samples written (at most max_out).
+size_t capture_resample(const uint16_t *in, size_t count, uint32_t in_rate, uint32_t out_rate,
+                        uint16_t *out, size_t max_out);
+
+#endif // CAPTURE_H
@@ -0,0 +1,258 @@
+#include "channel.h"
+
+#include <math.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "modem/modem_profile.h"
+
+#define NBFM_EMPHASIS_US 750.0f
+#define EMPHASIS_REFERENCE_HZ 1000.0f // audio levels are set with a 1 kHz tone
+
+typedef struct biquad
+{
+    float b0, b1, b2, a1, a2;
+    float z1, z2;
+} biquad_t;
+
+void channel_default_config(channel_config_t *config)
+{
+    memset(config, 0, sizeof(*config));
+    config->sample_rate = 79200;
+    config->lead_ms = 100.0f;
+    config->trail_ms = 100.0f;
+    config->snr_db = INFINITY;
+}
+
+int channel_preset(channel_config_t *config, const char *name)
+{
+    channel_default_config(config);
+
+    if (!strcmp(name, "clean"))
+        return 0;
+
+    config->bandpass_low_hz = 300.0f;
+    config->bandpass_high_hz = 3000.0f;
+    config->pre_emphasis_us = NBFM_EMPHASIS_US;
+    config->clip_counts = 1500.0f;
+
+    if (!strcmp(name, "fm"))
+    {
+        config->de_emphasis_us = NBFM_EMPHASIS_US;
+        return 0;
+    }
+
+    if (!strcmp(name, "fm-flat"))
+        return 0;
+
+    if (!strcmp(name, "fm-tail"))
+    {
+        config->de_emphasis_us = NBFM_EMPHASIS_US;
+        config->ptt_delay_ms = 120.0f;
+        config->squelch_tail_ms = 150.0f;
+        config->squelch_tail_counts = 400.0f;
+        return 0;
+    }
+
+    return -1;
+}
+
+static size_t ms_to_samples(const channel_config_t *config, float ms)
+{
+    return ms > 0.0f ? (size_t)(ms * config->sample_rate / 1000.0f) : 0;
+}
+
+size_t channel_output_size(const channel_config_t *config, size_t count)
+{
+    size_t total = ms_to_samples(config, config->lead_ms) + count + ms_to_samples(config, config->trail_ms) +
+                   ms_to_samples(config, config->squelch_tail_ms);
+    return (size_t)(total * (1.0 + fabs(config->clock_ppm) * 1e-6)) + 2;
+}
+
+// RBJ cookbook second-order sections, Q = 1/sqrt(2) (Butterworth).
+static void biquad_init(biquad_t *bq, bool highpass, float hz, uint32_t sample_rate)
+{
+    double w = 2.0 * M_PI * hz / sample_rate;
+    double alpha = sin(w) / (2.0 * M_SQRT1_2);
+    double c = cos(w);
+    double a0 = 1.0 + alpha;
+
+    if (highpass)
+    {
+        bq->b0 = (float)((1.0 + c) / 2.0 / a0);
+        bq->b1 = (float)(-(1.0 + c) / a0);
+    }
+    else
+    {
+        bq->b0 = (float)((1.0 - c) / 2.0 / a0);
+        bq->b1 = (float)((1.0 - c) / a0);
+    }
+    bq->b2 = bq->b0;
+    bq->a1 = (float)(-2.0 * c / a0);
+    bq->a2 = (float)((1.0 - alpha) / a0);
+    bq->z1 = bq->z2 = 0.0f;
+}
+
+static void biquad_run(biquad_t *bq, float *x, size_t count)
+{
+    for (size_t i = 0; i < count; i++)
+    {
+        float y = bq->b0 * x[i] + bq->z1;
+        bq->z1 = bq->b1 * x[i] - bq->a1 * y + bq->z2;
+        bq->z2 = bq->b2 * x[i] - bq->a2 * y;
+        x[i] = y;
+    }
+}
+
+// |1 - a e^-jw| / (1 - a) at the reference frequency: the pre-emphasis gain there.
+static float emphasis_gain(float a, uint32_t sample_rate)
+{
+    double w = 2.0 * M_PI * EMPHASIS_REFERENCE_HZ / sample_rate;
+    double re = 1.0 - a * cos(w);
+    double im = a * sin(w);
+    return (float)(sqrt(re * re + im * im) / (1.0 - a));
+}
+
+// First order, unity gain at the reference; de-emphasis undoes pre-emphasis of the same constant.
+static void pre_emphasis(float *x, size_t count, float tau_us, uint32_t sample_rate)
+{
+    float a = expf(-1e6f / (tau_us * sample_rate));
+    float scale = 1.0f / ((1.0f - a) * emphasis_gain(a, sample_rate));
+    float previous = 0.0f;
+
+    for (size_t i = 0; i < count; i++)
+    {
+        float in = x[i];
+        x[i] = (in - a * previous) * scale;
+        previous = in;
+    }
+}
+
+static void de_emphasis(float *x, size_t count, float tau_us, uint32_t sample_rate)
+{
+    float a = expf(-1e6f / (tau_us * sample_rate));
+    float scale = (1.0f - a) * emphasis_gain(a, sample_rate);
+    float y = 0.0f;
+
+    for (size_t i = 0; i < count; i++)
+    {
+        y = scale * x[i] + a * y;
+        x[i] = y;
+    }
+}
+
+size_t channel_apply(const channel_config_t *config, synth_rng_t *rng, const uint16_t *in, size_t count,
+                     uint16_t *out, size_t max_out, channel_report_t *report)
+{
+    channel_report_t local;
+    if (!report)
+        report = &local;
+    memset(report, 0, sizeof(*report));
+
+    size_t lead = ms_to_samples(config, config->lead_ms);
+    size_t tail = ms_to_samples(config, config->squelch_tail_ms);
+    size_t total = lead + count + tail + ms_to_samples(config, config->trail_ms);
+    size_t muted = ms_to_samples(config, config->ptt_delay_ms);
+    if (muted > count)
+        muted = count;
+
+    float *x = calloc(total, sizeof(float));
+    if (!x)
+        return 0;
+
+    // TX audio, with the key-up time lost.
+    double mean = 0.0;
+    for (size_t i = 0; i < count; i++)
+        mean += in[i];
+    mean = count ? mean / count : 0.0;
+    for (size_t i = muted; i < count; i++)
+        x[lead + i] = (float)(in[i] - mean);
+
+    if (config->pre_emphasis_us > 0.0f)
+        pre_emphasis(x + lead, count, config->pre_emphasis_us, config->sample_rate);
+
+    size_t clipped = 0;
+    if (config->clip_counts > 0.0f)
+    {
+        for (size_t i = lead; i < lead + count; i++)
+        {
+            if (fabsf(x[i]) > config->clip_counts)
+            {
+                x[i] = copysignf(config->clip_counts, x[i]);
+                clipped++;
+            }
+        }
+    }
+
+    double power = 0.0;
+    for (size_t i = lead + muted; i < lead + count; i++)
+        power += (double)x[i] * x[i];
+    report->signal_power = count > muted ? (float)(power / (count - muted)) : 0.0f;
+
+    if (config->offset_hz != 0.0f)
+        synth_shift_float(x + lead, count, config->offset_hz, config->sample_rate);
+
+    if (isfinite(config->snr_db))
+    {
+        report->noise_sigma = synth_noise_sigma_for_power(report->signal_power, config->snr_db, config->sample_rate);
+        for (size_t i = 0; i < total; i++)
+            x[i] += report->noise_sigma * synth_rng_gaussian(rng);
+    }
+
+    // The receiver stays open a moment after the carrier drops, on full-scale noise.
+    for (size_t i = lead + count; i < lead + count + tail; i++)
+        x[i] += config->squelch_tail_counts * synth_rng_gaussian(rng);
+
+    if (config->de_emphasis_us > 0.0f)
+        de_emphasis(x, total, config->de_emphasis_us, config->sample_rate);
+
+    if (config->bandpass_low_hz > 0.0f || config->bandpass_high_hz > 0.0f)
+    {
+        // Fourth order either side: two Butterworth sections each.
+        for (int stage = 0; stage < 2; stage++)
+        {
+            biquad_t bq;
+            if (config->bandpass_low_hz > 0.0f)
+            {
+                biquad_init(&bq, true, config->bandpass_low_hz, config->sample_rate);
+                biquad_run(&bq, x, total);
+            }
+            if (config->bandpass_high_hz > 0.0f)
+            {
+                biquad_init(&bq, false, config->bandpass_high_hz, config->sample_rate);
+                biquad_run(&bq, x, total);
+            }
+        }
+    }
+
+    // A fast RX clock takes more samples of the same audio.
+    double step = 1.0 / (1.0 + config->clock_ppm * 1e-6);
+    size_t n = 0;
+    size_t adc_clipped = 0;
+    for (double t = 0.0; n < max_out; t += step)
+    {
+        size_t k = (size_t)t;
+        if (k >= total)
+            break;
+        double frac = t - k;
+        double value = x[k] + (k + 1 < total ? (x[k + 1] - x[k]) * frac : 0.0);
+        long adc = lrint(value + MODEM_ADC_MIDPOINT);
+        if (adc < 0 || adc > 4095)
+        {
+            adc = adc < 0 ? 0 : 4095;
+            adc_clipped++;
+        }
+        out[n++] = (uint16_t)adc;
+    }
+
+    free(x);
+
+    report->samples_in = count;
+    report->samples_out = n;
+    report->signal_first = (size_t)((lead + muted) / step);
+    report->signal_last = (size_t)((lead + count) / step);
+    report->clipped_pct = count ? 100.0f * clipped / count : 0.0f;
+    report->adc_clipped_pct = n ? 100.0f * adc_clipped / n : 0.0f;
+    return n;
+}
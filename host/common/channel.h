@@ -0,0 +1,67 @@
+#ifndef CHANNEL_H
+#define CHANNEL_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "synth.h"
+
+/**
+ * @brief Analog radio path between the TX audio and the RX ADC.
+ *
+ * Applied in the order the signal meets them:
+ *
+ *   TX   PTT delay (the start of the transmission is lost), pre-emphasis,
+ *        deviation limiter (clips at clip_counts)
+ *   air  frequency offset, white noise, squelch tail (a noise burst when
+ *        the carrier drops)
+ *   RX   de-emphasis, 300-3000 Hz bandpass, sample clock skew, ADC
+ *
+ * Levels are in ADC counts about mid-scale. Zero turns a stage off, and
+ * so does an infinite snr_db.
+ */
+typedef struct channel_config
+{
+    uint32_t sample_rate;
+    float lead_ms;           // idle before the transmission
+    float trail_ms;          // idle after it
+    float ptt_delay_ms;      // TX audio lost while the transmitter keys up
+    float pre_emphasis_us;   // TX time constant (750 for NBFM)
+    float clip_counts;       // TX limiter, peak
+    float offset_hz;
+    float snr_db;            // in 3 kHz, against the transmitted signal power
+    float squelch_tail_ms;
+    float squelch_tail_counts; // RMS of the tail burst
+    float de_emphasis_us;    // RX time constant; differs from TX when mismatched
+    float bandpass_low_hz;
+    float bandpass_high_hz;
+    float clock_ppm;         // RX sample clock fast by this much
+} channel_config_t;
+
+typedef struct channel_report
+{
+    size_t samples_in;
+    size_t samples_out;
+    size_t signal_first;  // output sample where the transmission starts
+    size_t signal_last;
+    float signal_power;   // transmitted, ADC counts^2
+    float noise_sigma;
+    float clipped_pct;    // of TX samples hitting the limiter
+    float adc_clipped_pct;
+} channel_report_t;
+
+// No impairments, 79.2 kHz, 100 ms of idle either side.
+void channel_default_config(channel_config_t *config);
+
+// "clean", "fm" (matched NBFM emphasis), "fm-flat" (TX emphasis, flat RX
+// data port), "fm-tail" (fm plus PTT delay and squelch tail). 0 or -1.
+int channel_preset(channel_config_t *config, const char *name);
+
+// Output length for count input samples, to size the output buffer.
+size_t channel_output_size(const channel_config_t *config, size_t count);
+
+// Runs in through the channel; returns the number of samples written, 0 on error.
+size_t channel_apply(const channel_config_t *config, synth_rng_t *rng, const uint16_t *in, size_t count,
+                     uint16_t *out, size_t max_out, channel_report_t *report);
+
+#endif // CHANNEL_H
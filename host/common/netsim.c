@@ -0,0 +1,633 @@
+#include "netsim.h"
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "synth.h"
+#include "modem/modem_frame.h"
+#include "modem/modem_rx.h"
+
+#define AMPLITUDE 600
+#define BLOCK (3 * SQUELCH_BLOCK_SIZE)
+#define HANGOVER_US 500000   // keep a receiver running this long after the last audible frame
+#define WARMUP_US 2000000    // noise before the start, so every squelch knows its floor
+#define NOISE_TABLE (1u << 20)
+#define SEQ_BYTES 4
+
+typedef struct sim_frame
+{
+    uint8_t src;
+    uint8_t dst;
+    bool sent;
+    bool delivered;
+    uint64_t queued_us;
+    uint64_t keyup_us;
+    uint64_t air_us;       // first audio sample
+    uint64_t end_us;
+    uint64_t delivered_us;
+} sim_frame_t;
+
+struct netsim;
+
+typedef struct sim_node
+{
+    struct netsim *sim;
+    uint8_t addr;
+    double x, y;
+    modem_rx_t rx;
+    squelch_t carrier;     // carrier detect for CSMA; the demodulator itself is not gated
+    csma_t csma;
+    uint32_t *queue;
+    unsigned head;
+    unsigned queued;
+    float *tx;             // current frame, zero-mean; NULL while not sending
+    size_t tx_len;
+    size_t tx_pos;
+    uint32_t tx_seq;
+    synth_rng_t traffic;   // arrivals, destinations, payloads: the same whatever the MAC does
+    uint64_t next_arrival_us;
+    uint64_t hear_until_us;
+    uint8_t *neighbours;
+    unsigned neighbour_count;
+} sim_node_t;
+
+typedef struct netsim
+{
+    const netsim_config_t *config;
+    const modem_profile_t *profile;
+    netsim_report_t *report;
+    unsigned n;
+    sim_node_t *nodes;
+    float *gain;           // [tx * n + rx], amplitude
+    float *snr_db;
+    float sigma;
+    float *noise;
+    sim_frame_t *frames;
+    size_t frame_count;
+    size_t frame_cap;
+    synth_rng_t rng;       // placement, noise, CSMA draws
+    uint64_t now_us;       // end of the block being received, for delivery times
+    size_t max_samples;
+    uint16_t *scratch;
+    float *tx_buffers;
+    float mix[BLOCK];
+    uint16_t block[BLOCK];
+} netsim_t;
+
+void netsim_default_config(netsim_config_t *config)
+{
+    memset(config, 0, sizeof(*config));
+    config->profile = MODEM_PROFILE_FSK_32;
+    config->nodes = 10;
+    config->seconds = 600.0;
+    config->frames_per_hour = 12.0;
+    config->payload = 16;
+    config->queue = 8;
+    config->area_km = 5.0;
+    config->ref_snr_db = 30.0;
+    config->path_loss_exponent = 3.0;
+    config->audible_snr_db = -6.0;
+    config->neighbour_snr_db = 10.0;
+    csma_default_config(&config->csma);
+    config->carrier_sense = true;
+    config->seed = 1;
+}
+
+static double wall_seconds(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static uint64_t sample_us(const netsim_t *sim, uint64_t sample)
+{
+    return sample * 1000000 / sim->profile->sample_rate;
+}
+
+// First block boundary at or after time_us.
+static uint64_t block_at(const netsim_t *sim, uint64_t time_us)
+{
+    uint64_t sample = (time_us * sim->profile->sample_rate + 999999) / 1000000;
+    return (sample + BLOCK - 1) / BLOCK * BLOCK;
+}
+
+static uint64_t next_arrival(netsim_t *sim, sim_node_t *node, uint64_t now_us)
+{
+    double rate = sim->config->frames_per_hour / 3600.0;
+    double wait = -log(1.0 - synth_rng_uniform(&node->traffic)) / rate;
+    return now_us + (uint64_t)(wait * 1e6);
+}
+
+static void on_frame(void *ctx, const uint8_t *data, size_t len, uint8_t src_addr)
+{
+    sim_node_t *node = ctx;
+    netsim_t *sim = node->sim;
+
+    if (len < SEQ_BYTES)
+        return;
+
+    uint32_t seq = (uint32_t)data[0] | (uint32_t)data[1] << 8 | (uint32_t)data[2] << 16 | (uint32_t)data[3] << 24;
+    if (seq >= sim->frame_count || sim->frames[seq].src != src_addr)
+        return;
+
+    sim_frame_t *frame = &sim->frames[seq];
+    if (frame->dst != node->addr)
+    {
+        sim->report->overheard++;
+        return;
+    }
+
+    if (!frame->delivered)
+    {
+        frame->delivered = true;
+        frame->delivered_us = sim->now_us;
+    }
+}
+
+static int place_nodes(netsim_t *sim)
+{
+    const netsim_config_t *config = sim->config;
+    unsigned n = sim->n;
+
+    for (unsigned i = 0; i < n; i++)
+    {
+        sim->nodes[i].x = synth_rng_uniform(&sim->rng) * config->area_km;
+        sim->nodes[i].y = synth_rng_uniform(&sim->rng) * config->area_km;
+    }
+
+    for (unsigned t = 0; t < n; t++)
+    {
+        sim_node_t *node = &sim->nodes[t];
+        node->neighbours = malloc(n);
+        if (!node->neighbours)
+            return -1;
+
+        for (unsigned r = 0; r < n; r++)
+        {
+            double dx = sim->nodes[r].x - node->x;
+            double dy = sim->nodes[r].y - node->y;
+            double km = sqrt(dx * dx + dy * dy);
+            double loss_db = km > 1.0 ? 10.0 * config->path_loss_exponent * log10(km) : 0.0;
+
+            sim->snr_db[t * n + r] = (float)(config->ref_snr_db - loss_db);
+            sim->gain[t * n + r] = (float)pow(10.0, -loss_db / 20.0);
+            if (r != t && sim->snr_db[t * n + r] >= config->neighbour_snr_db)
+                node->neighbours[node->neighbour_count++] = (uint8_t)r;
+        }
+
+        if (!node->neighbour_count)
+            sim->report->isolated++;
+    }
+
+    return 0;
+}
+
+static int netsim_setup(netsim_t *sim, const netsim_config_t *config, netsim_report_t *report)
+{
+    memset(sim, 0, sizeof(*sim));
+    memset(report, 0, sizeof(*report));
+    sim->config = config;
+    sim->report = report;
+    sim->profile = modem_profile_get(config->profile);
+    sim->n = config->nodes;
+
+    if (!sim->profile || sim->n < 2 || sim->n > NETSIM_MAX_NODES || config->payload < SEQ_BYTES ||
+        config->payload > MODEM_FRAME_MAX_PAYLOAD || !config->queue || config->frames_per_hour <= 0.0)
+        return -1;
+
+    size_t n = sim->n;
+    size_t symbol_samples = (sim->profile->sample_rate + sim->profile->baud - 1) / sim->profile->baud;
+    size_t bits = MODEM_FRAME_PREAMBLE_BITS + MODEM_FRAME_SYNC_BITS + modem_frame_body_size((uint8_t)config->payload) * 8;
+    sim->max_samples = (bits + 2) * symbol_samples;
+
+    sim->nodes = calloc(n, sizeof(sim_node_t));
+    sim->gain = calloc(n * n, sizeof(float));
+    sim->snr_db = calloc(n * n, sizeof(float));
+    sim->noise = malloc(NOISE_TABLE * sizeof(float));
+    sim->scratch = malloc(sim->max_samples * sizeof(uint16_t));
+    sim->tx_buffers = malloc(n * sim->max_samples * sizeof(float));
+    if (!sim->nodes || !sim->gain || !sim->snr_db || !sim->noise || !sim->scratch || !sim->tx_buffers)
+        return -1;
+
+    synth_rng_seed(&sim->rng, config->seed);
+    for (size_t i = 0; i < NOISE_TABLE; i++)
+        sim->noise[i] = synth_rng_gaussian(&sim->rng);
+
+    // A transmitter at unit gain is heard at ref_snr_db.
+    sim->sigma = synth_noise_sigma(AMPLITUDE, (float)config->ref_snr_db, sim->profile->sample_rate);
+
+    squelch_config_t squelch;
+    squelch_default_config(&squelch);
+
+    for (unsigned i = 0; i < sim->n; i++)
+    {
+        sim_node_t *node = &sim->nodes[i];
+        node->sim = sim;
+        node->addr = (uint8_t)(i + 1);
+        node->queue = calloc(config->queue, sizeof(uint32_t));
+        if (!node->queue || modem_rx_init(&node->rx, sim->profile, on_frame, node) ||
+            squelch_init(&node->carrier, &squelch) || csma_init(&node->csma, &config->csma))
+            return -1;
+    }
+
+    if (place_nodes(sim))
+        return -1;
+
+    for (unsigned i = 0; i < sim->n; i++)
+    {
+        synth_rng_seed(&sim->nodes[i].traffic, config->seed * NETSIM_MAX_NODES + i + 1);
+        sim->nodes[i].next_arrival_us = next_arrival(sim, &sim->nodes[i], 0);
+    }
+
+    return 0;
+}
+
+static void netsim_free(netsim_t *sim)
+{
+    if (sim->nodes)
+    {
+        for (unsigned i = 0; i < sim->n; i++)
+        {
+            free(sim->nodes[i].queue);
+            free(sim->nodes[i].neighbours);
+        }
+    }
+    free(sim->nodes);
+    free(sim->gain);
+    free(sim->snr_db);
+    free(sim->noise);
+    free(sim->scratch);
+    free(sim->tx_buffers);
+    free(sim->frames);
+}
+
+static void enqueue(netsim_t *sim, sim_node_t *node, uint64_t now_us)
+{
+    if (!node->neighbour_count)
+        return;
+
+    sim->report->offered++;
+    if (node->queued == sim->config->queue)
+    {
+        sim->report->queue_drops++;
+        return;
+    }
+
+    if (sim->frame_count == sim->frame_cap)
+    {
+        size_t cap = sim->frame_cap ? sim->frame_cap * 2 : 1024;
+        sim_frame_t *frames = realloc(sim->frames, cap * sizeof(sim_frame_t));
+        if (!frames)
+            return;
+        sim->frames = frames;
+        sim->frame_cap = cap;
+    }
+
+    uint32_t seq = (uint32_t)sim->frame_count++;
+    sim_frame_t *frame = &sim->frames[seq];
+    memset(frame, 0, sizeof(*frame));
+    frame->src = node->addr;
+    frame->dst = sim->nodes[node->neighbours[synth_rng_u32(&node->traffic) % node->neighbour_count]].addr;
+    frame->queued_us = now_us;
+
+    node->queue[(node->head + node->queued) % sim->config->queue] = seq;
+    node->queued++;
+    csma_request(&node->csma, now_us);
+}
+
+static void start_frame(netsim_t *sim, sim_node_t *node, uint64_t now_us)
+{
+    uint32_t seq = node->queue[node->head];
+    sim_frame_t *frame = &sim->frames[seq];
+    uint8_t payload[MODEM_FRAME_MAX_PAYLOAD];
+
+    payload[0] = (uint8_t)seq;
+    payload[1] = (uint8_t)(seq >> 8);
+    payload[2] = (uint8_t)(seq >> 16);
+    payload[3] = (uint8_t)(seq >> 24);
+    for (size_t i = SEQ_BYTES; i < sim->config->payload; i++)
+        payload[i] = (uint8_t)synth_rng_u32(&node->traffic);
+
+    size_t count = synth_frame(sim->profile, AMPLITUDE, frame->dst, frame->src, payload, sim->config->payload,
+                               sim->scratch, sim->max_samples);
+
+    node->tx = sim->tx_buffers + (size_t)(node - sim->nodes) * sim->max_samples;
+    for (size_t i = 0; i < count; i++)
+        node->tx[i] = (float)sim->scratch[i] - MODEM_ADC_MIDPOINT;
+    node->tx_len = count;
+    node->tx_pos = 0;
+    node->tx_seq = seq;
+    frame->air_us = now_us;
+}
+
+static void finish_frame(netsim_t *sim, sim_node_t *node, uint64_t end_us)
+{
+    sim_frame_t *frame = &sim->frames[node->tx_seq];
+    frame->sent = true;
+    frame->end_us = end_us;
+    sim->report->sent++;
+    sim->report->airtime_s += (end_us - frame->keyup_us) / 1e6;
+
+    node->tx = NULL;
+    node->head = (node->head + 1) % sim->config->queue;
+    node->queued--;
+    csma_done(&node->csma, end_us, node->queued > 0);
+}
+
+static bool node_busy(const sim_node_t *node)
+{
+    return squelch_is_open(&node->carrier);
+}
+
+static void receive_block(netsim_t *sim, sim_node_t *node, sim_node_t **active, unsigned active_count)
+{
+    unsigned r = (unsigned)(node - sim->nodes);
+    const float *noise = sim->noise + synth_rng_u32(&sim->rng) % (NOISE_TABLE - BLOCK);
+
+    for (size_t i = 0; i < BLOCK; i++)
+        sim->mix[i] = sim->sigma * noise[i];
+
+    for (unsigned a = 0; a < active_count; a++)
+    {
+        const sim_node_t *tx = active[a];
+        float g = sim->gain[(size_t)(tx - sim->nodes) * sim->n + r];
+        size_t n = tx->tx_len - tx->tx_pos < BLOCK ? tx->tx_len - tx->tx_pos : BLOCK;
+        const float *src = tx->tx + tx->tx_pos;
+        for (size_t i = 0; i < n; i++)
+            sim->mix[i] += g * src[i];
+    }
+
+    for (size_t i = 0; i < BLOCK; i++)
+    {
+        float v = sim->mix[i] + MODEM_ADC_MIDPOINT + 0.5f;
+        sim->block[i] = v < 0.0f ? 0 : v > 4095.0f ? 4095 : (uint16_t)v;
+    }
+
+    for (size_t i = 0; i < BLOCK; i += SQUELCH_BLOCK_SIZE)
+        squelch_update(&node->carrier, sim->block + i, SQUELCH_BLOCK_SIZE);
+    modem_rx_process(&node->rx, sim->block, BLOCK);
+}
+
+static bool receivers_idle(const netsim_t *sim, uint64_t now_us)
+{
+    for (unsigned i = 0; i < sim->n; i++)
+    {
+        const sim_node_t *node = &sim->nodes[i];
+        if (csma_ptt(&node->csma) || now_us < node->hear_until_us || node_busy(node))
+            return false;
+    }
+    return true;
+}
+
+static uint64_t next_event_us(const netsim_t *sim)
+{
+    uint64_t next = UINT64_MAX;
+    for (unsigned i = 0; i < sim->n; i++)
+    {
+        const sim_node_t *node = &sim->nodes[i];
+        if (node->neighbour_count && node->next_arrival_us < next)
+            next = node->next_arrival_us;
+        if (node->csma.state != CSMA_IDLE && node->csma.next_us < next)
+            next = node->csma.next_us;
+    }
+    return next;
+}
+
+static void warm_up(netsim_t *sim)
+{
+    size_t blocks = (size_t)((uint64_t)WARMUP_US * sim->profile->sample_rate / 1000000 / BLOCK);
+    for (unsigned i = 0; i < sim->n; i++)
+    {
+        for (size_t b = 0; b < blocks; b++)
+        {
+            receive_block(sim, &sim->nodes[i], NULL, 0);
+            // The floor starts at min_floor; take it from the noise instead.
+            if (b == 0)
+                squelch_relearn(&sim->nodes[i].carrier);
+        }
+        memset(&sim->nodes[i].rx.stats, 0, sizeof(sim->nodes[i].rx.stats));
+    }
+}
+
+static void step_block(netsim_t *sim, uint64_t t, uint64_t *busy_samples)
+{
+    const netsim_config_t *config = sim->config;
+    uint64_t now_us = sample_us(sim, t);
+    sim_node_t *active[NETSIM_MAX_NODES];
+    unsigned active_count = 0;
+    bool keyed = false;
+
+    sim->now_us = sample_us(sim, t + BLOCK);
+
+    for (unsigned i = 0; i < sim->n; i++)
+    {
+        sim_node_t *node = &sim->nodes[i];
+        while (node->neighbour_count && node->next_arrival_us <= now_us)
+        {
+            enqueue(sim, node, node->next_arrival_us);
+            node->next_arrival_us = next_arrival(sim, node, node->next_arrival_us);
+        }
+    }
+
+    // Every node decides on what it heard up to the last block, so two
+    // nodes can key up in the same block and collide.
+    for (unsigned i = 0; i < sim->n; i++)
+    {
+        sim_node_t *node = &sim->nodes[i];
+        csma_state_t before = node->csma.state;
+        if (before == CSMA_IDLE || before == CSMA_TRANSMIT)
+            continue;
+
+        bool busy = config->carrier_sense && node_busy(node);
+        csma_state_t state = csma_update(&node->csma, now_us, busy, (uint8_t)synth_rng_u32(&sim->rng));
+        if (before == CSMA_DEFER && state == CSMA_KEYUP)
+        {
+            sim->frames[node->queue[node->head]].keyup_us = now_us;
+            modem_rx_resync(&node->rx); // half duplex: whatever it was receiving is lost
+        }
+        else if (state == CSMA_TRANSMIT)
+        {
+            start_frame(sim, node, now_us);
+        }
+    }
+
+    for (unsigned i = 0; i < sim->n; i++)
+    {
+        if (sim->nodes[i].tx)
+            active[active_count++] = &sim->nodes[i];
+        keyed |= csma_ptt(&sim->nodes[i].csma);
+    }
+
+    for (unsigned i = 0; i < sim->n; i++)
+    {
+        sim_node_t *node = &sim->nodes[i];
+        if (csma_ptt(&node->csma))
+            continue;
+
+        bool audible = false;
+        for (unsigned a = 0; a < active_count && !audible; a++)
+            audible = sim->snr_db[(size_t)(active[a] - sim->nodes) * sim->n + i] >= config->audible_snr_db;
+
+        if (audible)
+        {
+            node->hear_until_us = now_us + HANGOVER_US;
+        }
+        else if (now_us >= node->hear_until_us && !node_busy(node))
+        {
+            // Only noise from here on: a frame it is still slicing is garbage.
+            if (modem_rx_dcd(&node->rx))
+                modem_rx_resync(&node->rx);
+            continue;
+        }
+
+        receive_block(sim, node, active, active_count);
+    }
+
+    for (unsigned a = 0; a < active_count; a++)
+    {
+        sim_node_t *node = active[a];
+        size_t left = node->tx_len - node->tx_pos;
+        if (left > BLOCK)
+        {
+            node->tx_pos += BLOCK;
+            continue;
+        }
+        finish_frame(sim, node, now_us + left * 1000000 / sim->profile->sample_rate);
+    }
+
+    if (keyed)
+        *busy_samples += BLOCK;
+}
+
+// A frame collides if another frame is audible at its destination while it
+// is on the air, or the destination itself is keyed up.
+static void count_collisions(netsim_t *sim)
+{
+    for (size_t f = 0; f < sim->frame_count; f++)
+    {
+        const sim_frame_t *frame = &sim->frames[f];
+        if (!frame->sent)
+            continue;
+
+        unsigned dst = frame->dst - 1u;
+        for (size_t g = 0; g < sim->frame_count; g++)
+        {
+            const sim_frame_t *other = &sim->frames[g];
+            if (g == f || !other->sent)
+                continue;
+
+            bool own = other->src == frame->dst;
+            uint64_t start = own ? other->keyup_us : other->air_us;
+            if (start >= frame->end_us || other->end_us <= frame->air_us)
+                continue;
+
+            if (own || sim->snr_db[(size_t)(other->src - 1u) * sim->n + dst] >= sim->config->audible_snr_db)
+            {
+                sim->report->collided++;
+                break;
+            }
+        }
+    }
+}
+
+static int compare_double(const void *a, const void *b)
+{
+    double x = *(const double *)a, y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+static void summarize(netsim_t *sim, double seconds, uint64_t busy_samples)
+{
+    netsim_report_t *report = sim->report;
+    double *latency = malloc((sim->frame_count ? sim->frame_count : 1) * sizeof(double));
+    size_t delivered = 0;
+    double sum = 0.0;
+
+    for (size_t f = 0; f < sim->frame_count; f++)
+    {
+        const sim_frame_t *frame = &sim->frames[f];
+        if (frame->sent && frame->delivered && latency)
+        {
+            latency[delivered] = (frame->delivered_us - frame->queued_us) / 1e6;
+            sum += latency[delivered++];
+        }
+    }
+
+    report->delivered = (uint32_t)delivered;
+    if (delivered)
+    {
+        qsort(latency, delivered, sizeof(double), compare_double);
+        report->latency_mean_s = sum / delivered;
+        report->latency_p50_s = latency[delivered / 2];
+        report->latency_p95_s = latency[delivered * 95 / 100];
+    }
+    free(latency);
+
+    count_collisions(sim);
+
+    // Offered load in erlangs: every frame the same length, plus txdelay.
+    double frame_s = (double)synth_frame(sim->profile, AMPLITUDE, 1, 2, (const uint8_t[MODEM_FRAME_MAX_PAYLOAD]){0},
+                                         sim->config->payload, sim->scratch, sim->max_samples) /
+                         sim->profile->sample_rate +
+                     sim->config->csma.txdelay_us / 1e6;
+
+    report->nodes = sim->n;
+    report->seconds = seconds;
+    report->busy_fraction = (double)busy_samples / sim->profile->sample_rate / seconds;
+    report->offered_erlangs = (sim->n - report->isolated) * sim->config->frames_per_hour / 3600.0 * frame_s;
+    report->throughput_bps = delivered * (double)sim->config->payload * 8.0 / seconds;
+
+    for (unsigned i = 0; i < sim->n; i++)
+    {
+        report->busy_slots += sim->nodes[i].csma.stats.busy_slots;
+        report->bad_crc += sim->nodes[i].rx.stats.frames_bad_crc;
+        report->samples_demodulated += sim->nodes[i].rx.stats.samples_demodulated;
+    }
+}
+
+int netsim_run(const netsim_config_t *config, netsim_report_t *report)
+{
+    netsim_t *sim = malloc(sizeof(netsim_t));
+    if (!sim)
+        return -1;
+
+    double start = wall_seconds();
+    if (netsim_setup(sim, config, report))
+    {
+        netsim_free(sim);
+        free(sim);
+        return -1;
+    }
+
+    warm_up(sim);
+
+    uint64_t end = (uint64_t)(config->seconds * sim->profile->sample_rate) / BLOCK * BLOCK;
+    uint64_t busy_samples = 0;
+    uint64_t t = 0;
+
+    while (t < end)
+    {
+        step_block(sim, t, &busy_samples);
+        t += BLOCK;
+
+        // Nothing on the air and nobody listening: skip to the next thing that happens.
+        uint64_t now_us = sample_us(sim, t);
+        if (receivers_idle(sim, now_us))
+        {
+            uint64_t next = next_event_us(sim);
+            uint64_t jump = next == UINT64_MAX ? end : block_at(sim, next);
+            if (jump > t)
+                t = jump < end ? jump : end;
+        }
+    }
+
+    summarize(sim, (double)end / sim->profile->sample_rate, busy_samples);
+    report->wall_s = wall_seconds() - start;
+
+    netsim_free(sim);
+    free(sim);
+    return 0;
+}
@@ -0,0 +1,81 @@
+#ifndef NETSIM_H
+#define NETSIM_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#include "modem/csma.h"
+#include "modem/modem_profile.h"
+
+#define NETSIM_MAX_NODES 250 // one-byte addresses, 1..nodes
+
+/**
+ * @brief Many nodes on one shared audio channel, in one process.
+ *
+ * Every node runs the real modulator, modem_rx and the CSMA scheduler,
+ * with a squelch as the radio's carrier detect. Nodes are placed at random
+ * in a square. What each receiver hears is the sum of every
+ * transmitter on the air, scaled by the path loss between them, plus its
+ * own noise:
+ *
+ *   snr_db = ref_snr_db - 10 * path_loss_exponent * log10(distance / 1 km)
+ *
+ * (nodes closer than 1 km hear each other at ref_snr_db). Each node gets
+ * Poisson traffic to a random neighbour. A transmitting node hears
+ * nothing (half duplex).
+ *
+ * The simulation steps in blocks of a few milliseconds. A receiver is only
+ * run while something is audible to it, for a short hangover after, or
+ * while its carrier detect is up; then it is resynced, as it would only
+ * be slicing noise. When nothing is on the air and no receiver is busy, time jumps to
+ * the next arrival or CSMA slot. That makes it much faster than real
+ * time.
+ */
+typedef struct netsim_config
+{
+    modem_profile_id_t profile;
+    unsigned nodes;
+    double seconds;
+    double frames_per_hour;    // offered per node
+    size_t payload;            // bytes per frame, the first 4 carry a sequence number
+    unsigned queue;            // frames a node holds before dropping new ones
+    double area_km;
+    double ref_snr_db;
+    double path_loss_exponent; // 0: everyone hears everyone at ref_snr_db
+    double audible_snr_db;     // weaker links are mixed in but never wake a receiver
+    double neighbour_snr_db;   // destinations are picked from links at least this good
+    csma_config_t csma;
+    bool carrier_sense;        // false: ALOHA, every slot is clear
+    uint64_t seed;
+} netsim_config_t;
+
+typedef struct netsim_report
+{
+    unsigned nodes;
+    unsigned isolated;         // nodes with no neighbour, which send nothing
+    uint32_t offered;
+    uint32_t queue_drops;
+    uint32_t sent;
+    uint32_t delivered;        // decoded by their destination
+    uint32_t collided;         // overlapped at the destination by another audible frame, or by its own TX
+    uint32_t overheard;        // decoded by other nodes
+    uint32_t bad_crc;
+    double seconds;
+    double airtime_s;          // summed over all transmissions, txdelay included
+    double busy_fraction;      // of the time at least one node was keyed up
+    double offered_erlangs;    // offered airtime per second
+    double throughput_bps;     // delivered payload bits per second
+    double latency_mean_s;     // queued to decoded at the destination
+    double latency_p50_s;
+    double latency_p95_s;
+    uint32_t busy_slots;       // CSMA slots deferred on carrier detect
+    uint64_t samples_demodulated;
+    double wall_s;
+} netsim_report_t;
+
+void netsim_default_config(netsim_config_t *config);
+
+int netsim_run(const netsim_config_t *config, netsim_report_t *report);
+
+#endif // NETSIM_H
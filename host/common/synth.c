@@ -0,0 +1,179 @@
+#include "synth.h"
+
+#include <math.h>
+#include <stdbool.h>
+#include <stdlib.h>
+
+#include "modem/fsk_mod.h"
+#include "modem/modem_frame.h"
+
+void synth_rng_seed(synth_rng_t *rng, uint64_t seed)
+{
+    rng->state = seed ? seed : 0x9E3779B97F4A7C15ull;
+}
+
+uint32_t synth_rng_u32(synth_rng_t *rng)
+{
+    // xorshift64*
+    rng->state ^= rng->state >> 12;
+    rng->state ^= rng->state << 25;
+    rng->state ^= rng->state >> 27;
+    return (uint32_t)((rng->state * 0x2545F4914F6CDD1Dull) >> 32);
+}
+
+float synth_rng_uniform(synth_rng_t *rng)
+{
+    return (synth_rng_u32(rng) >> 8) * (1.0f / 16777216.0f);
+}
+
+float synth_rng_gaussian(synth_rng_t *rng)
+{
+    float u1 = synth_rng_uniform(rng);
+    float u2 = synth_rng_uniform(rng);
+    if (u1 < 1e-12f)
+        u1 = 1e-12f;
+    return sqrtf(-2.0f * logf(u1)) * cosf(2.0f * (float)M_PI * u2);
+}
+
+float synth_noise_sigma(float amplitude, float snr_db, uint32_t sample_rate)
+{
+    return synth_noise_sigma_for_power(amplitude * amplitude / 2.0f, snr_db, sample_rate);
+}
+
+float synth_noise_sigma_for_power(float signal_power, float snr_db, uint32_t sample_rate)
+{
+    // Signal power against the white noise power that falls in the reference bandwidth.
+    float band_fraction = SYNTH_REFERENCE_BANDWIDTH_HZ / (sample_rate / 2.0f);
+    float noise_power = signal_power / powf(10.0f, snr_db / 10.0f) / band_fraction;
+    return sqrtf(noise_power);
+}
+
+float synth_power(const uint16_t *samples, size_t count)
+{
+    double sum = 0.0;
+
+    for (size_t i = 0; i < count; i++)
+    {
+        double x = (double)samples[i] - MODEM_ADC_MIDPOINT;
+        sum += x * x;
+    }
+
+    return count ? (float)(sum / count) : 0.0f;
+}
+
+static uint16_t clamp_adc(float value)
+{
+    if (value < 0.0f)
+        return 0;
+    if (value > 4095.0f)
+        return 4095;
+    return (uint16_t)lrintf(value);
+}
+
+void synth_add_noise(synth_rng_t *rng, uint16_t *samples, size_t count, float sigma)
+{
+    for (size_t i = 0; i < count; i++)
+    {
+        samples[i] = clamp_adc(samples[i] + sigma * synth_rng_gaussian(rng));
+    }
+}
+
+void synth_scale(uint16_t *samples, size_t count, float gain)
+{
+    for (size_t i = 0; i < count; i++)
+    {
+        samples[i] = clamp_adc(MODEM_ADC_MIDPOINT + ((float)samples[i] - MODEM_ADC_MIDPOINT) * gain);
+    }
+}
+
+#define HILBERT_HALF 64 // taps either side of the centre
+
+void synth_shift_float(float *x, size_t count, float shift_hz, uint32_t sample_rate)
+{
+    static float taps[HILBERT_HALF + 1];
+    static bool taps_ready = false;
+
+    if (!taps_ready)
+    {
+        // 2 / (pi n) on odd n, Blackman window
+        for (int n = 1; n <= HILBERT_HALF; n++)
+        {
+            double w = 0.42 + 0.5 * cos(M_PI * n / (HILBERT_HALF + 1)) + 0.08 * cos(2.0 * M_PI * n / (HILBERT_HALF + 1));
+            taps[n] = (n & 1) ? (float)(2.0 / (M_PI * n) * w) : 0.0f;
+        }
+        taps_ready = true;
+    }
+
+    float *q = malloc(count * sizeof(float));
+    if (!q)
+        return;
+
+    for (size_t i = 0; i < count; i++)
+    {
+        float sum = 0.0f;
+        for (int n = 1; n <= HILBERT_HALF; n += 2)
+        {
+            float before = i >= (size_t)n ? x[i - n] : 0.0f;
+            float after = i + n < count ? x[i + n] : 0.0f;
+            sum += taps[n] * (before - after);
+        }
+        q[i] = sum;
+    }
+
+    double step = 2.0 * M_PI * shift_hz / sample_rate;
+    for (size_t i = 0; i < count; i++)
+    {
+        double phase = step * (double)i;
+        x[i] = (float)(x[i] * cos(phase) - q[i] * sin(phase));
+    }
+
+    free(q);
+}
+
+void synth_frequency_shift(uint16_t *samples, size_t count, float shift_hz, uint32_t sample_rate)
+{
+    double mean = 0.0;
+    for (size_t i = 0; i < count; i++)
+        mean += samples[i];
+    mean = count ? mean / count : 0.0;
+
+    float *x = malloc(count * sizeof(float));
+    if (!x)
+        return;
+    for (size_t i = 0; i < count; i++)
+        x[i] = (float)(samples[i] - mean);
+
+    synth_shift_float(x, count, shift_hz, sample_rate);
+    for (size_t i = 0; i < count; i++)
+        samples[i] = clamp_adc((float)(mean + x[i]));
+
+    free(x);
+}
+
+void synth_idle(synth_rng_t *rng, uint16_t *samples, size_t count, float sigma)
+{
+    for (size_t i = 0; i < count; i++)
+    {
+        samples[i] = MODEM_ADC_MIDPOINT;
+    }
+
+    if (sigma > 0.0f)
+        synth_add_noise(rng, samples, count, sigma);
+}
+
+size_t synth_frame(const modem_profile_t *profile, int16_t amplitude,
+                   uint8_t dst, uint8_t src, const uint8_t *payload, size_t len,
+                   uint16_t *out, size_t max_samples)
+{
+    uint8_t bits[(MODEM_FRAME_MAX_BITS + 7) / 8];
+    size_t num_bits = 0;
+    fsk_mod_t mod;
+
+    if (modem_frame_build(dst, src, payload, len, bits, sizeof(bits), &num_bits))
+        return 0;
+
+    if (fsk_mod_init(&mod, profile, amplitude))
+        return 0;
+
+    return fsk_mod_frame(&mod, bits, num_bits, MODEM_FRAME_PREAMBLE_BITS + MODEM_FRAME_SYNC_BITS, out, max_samples);
+}
@@ -0,0 +1,51 @@
+#ifndef SYNTH_H
+#define SYNTH_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "modem/modem_profile.h"
+
+#define SYNTH_REFERENCE_BANDWIDTH_HZ 3000.0f // SNR is quoted in a voice-channel bandwidth
+
+typedef struct synth_rng
+{
+    uint64_t state;
+} synth_rng_t;
+
+void synth_rng_seed(synth_rng_t *rng, uint64_t seed);
+uint32_t synth_rng_u32(synth_rng_t *rng);
+float synth_rng_uniform(synth_rng_t *rng);  // [0, 1)
+float synth_rng_gaussian(synth_rng_t *rng); // zero mean, unit variance
+
+// Noise standard deviation (ADC counts) giving snr_db for a sine of the given amplitude.
+float synth_noise_sigma(float amplitude, float snr_db, uint32_t sample_rate);
+
+// As synth_noise_sigma, for a signal of known mean power (ADC counts^2).
+float synth_noise_sigma_for_power(float signal_power, float snr_db, uint32_t sample_rate);
+
+// Mean AC power of a sample block around mid-scale.
+float synth_power(const uint16_t *samples, size_t count);
+
+// Adds white Gaussian noise and re-clamps to the 12-bit ADC range.
+void synth_add_noise(synth_rng_t *rng, uint16_t *samples, size_t count, float sigma);
+
+// Scales around mid-scale by gain and re-clamps, so large gains clip like the ADC.
+void synth_scale(uint16_t *samples, size_t count, float gain);
+
+// Moves every frequency up by shift_hz (down when negative), as a mistuned
+// SSB receiver does; a Hilbert filter gives the quadrature part.
+void synth_frequency_shift(uint16_t *samples, size_t count, float shift_hz, uint32_t sample_rate);
+
+// As synth_frequency_shift, in place on a zero-mean float signal.
+void synth_shift_float(float *x, size_t count, float shift_hz, uint32_t sample_rate);
+
+// Fills with mid-scale (silence) or mid-scale plus noise when sigma > 0.
+void synth_idle(synth_rng_t *rng, uint16_t *samples, size_t count, float sigma);
+
+// Modulates one frame; returns the number of samples written.
+size_t synth_frame(const modem_profile_t *profile, int16_t amplitude,
+                   uint8_t dst, uint8_t src, const uint8_t *payload, size_t len,
+                   uint16_t *out, size_t max_samples);
+
+#endif // SYNTH_H
@@ -0,0 +1,14 @@
+#ifndef ADC_BSP_H
+#define ADC_BSP_H
+
+#include <stdbool.h>
+#include "circular_buffer.h"
+
+/* Host build: the ADC interface the firmware bsp implements. */
+
+int adc_bsp_init(int sample_rate);
+int adc_bsp_task(void);
+bool adc_bsp_data_available(void);
+int adc_bsp_get_data(circular_buffer_t *buffer);
+
+#endif // ADC_BSP_H
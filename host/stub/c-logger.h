@@ -0,0 +1,32 @@
+#ifndef C_LOGGER_STUB_H
+#define C_LOGGER_STUB_H
+
+#include <stdio.h>
+
+/* Host build: the firmware logs go to stderr. */
+
+#define LOG_LEVEL_DEBUG 0
+#define LOG_LEVEL_INFO 1
+#define LOG_LEVEL_WARN 2
+#define LOG_LEVEL_ERROR 3
+
+extern int c_logger_stub_level;
+
+#define log_init(level) ((void)(c_logger_stub_level = (level)))
+
+#define C_LOGGER_STUB(level, tag, ...)                    \
+    do                                                    \
+    {                                                     \
+        if ((level) >= c_logger_stub_level)               \
+        {                                                 \
+            fprintf(stderr, tag " " __VA_ARGS__);         \
+            fputc('\n', stderr);                          \
+        }                                                 \
+    } while (0)
+
+#define LOG_DEBUG(...) C_LOGGER_STUB(LOG_LEVEL_DEBUG, "[DEBUG]", __VA_ARGS__)
+#define LOG_INFO(...) C_LOGGER_STUB(LOG_LEVEL_INFO, "[INFO]", __VA_ARGS__)
+#define LOG_WARN(...) C_LOGGER_STUB(LOG_LEVEL_WARN, "[WARN]", __VA_ARGS__)
+#define LOG_ERROR(...) C_LOGGER_STUB(LOG_LEVEL_ERROR, "[ERROR]", __VA_ARGS__)
+
+#endif // C_LOGGER_STUB_H
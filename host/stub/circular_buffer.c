@@ -0,0 +1,44 @@
+#include "circular_buffer.h"
+
+#include <string.h>
+
+int circular_buffer_init(circular_buffer_t *buffer, void *storage, size_t element_size, size_t capacity)
+{
+    if (!buffer || !storage || !element_size || !capacity)
+        return -1;
+
+    buffer->data = storage;
+    buffer->element_size = element_size;
+    buffer->capacity = capacity;
+    circular_buffer_clear(buffer);
+    return 0;
+}
+
+int circular_buffer_push(circular_buffer_t *buffer, const void *element)
+{
+    if (buffer->count == buffer->capacity)
+        return -1;
+
+    memcpy(buffer->data + buffer->head * buffer->element_size, element, buffer->element_size);
+    buffer->head = (buffer->head + 1) % buffer->capacity;
+    buffer->count++;
+    return 0;
+}
+
+int circular_buffer_pop(circular_buffer_t *buffer, void *element)
+{
+    if (buffer->count == 0)
+        return -1;
+
+    memcpy(element, buffer->data + buffer->tail * buffer->element_size, buffer->element_size);
+    buffer->tail = (buffer->tail + 1) % buffer->capacity;
+    buffer->count--;
+    return 0;
+}
+
+void circular_buffer_clear(circular_buffer_t *buffer)
+{
+    buffer->head = 0;
+    buffer->tail = 0;
+    buffer->count = 0;
+}
@@ -0,0 +1,32 @@
+#ifndef CIRCULAR_BUFFER_STUB_H
+#define CIRCULAR_BUFFER_STUB_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+/*
+ * Host build: the fixed-element ring adc_bsp_get_data pushes samples into.
+ * Elements are copied by size, one call per element, as on the target.
+ */
+
+typedef struct circular_buffer
+{
+    uint8_t *data;
+    size_t element_size;
+    size_t capacity;
+    size_t head;
+    size_t tail;
+    size_t count;
+} circular_buffer_t;
+
+int circular_buffer_init(circular_buffer_t *buffer, void *storage, size_t element_size, size_t capacity);
+
+// 0, or -1 when full.
+int circular_buffer_push(circular_buffer_t *buffer, const void *element);
+
+// 0, or -1 when empty.
+int circular_buffer_pop(circular_buffer_t *buffer, void *element);
+
+void circular_buffer_clear(circular_buffer_t *buffer);
+
+#endif // CIRCULAR_BUFFER_STUB_H
@@ -0,0 +1,10 @@
+#ifndef DAC_BSP_H
+#define DAC_BSP_H
+
+/* Host build: the DAC interface the firmware bsp implements. */
+
+int dac_bsp_init(void);
+int dac_bsp_task(void);
+int dac_bsp_set_tone(float frequency);
+
+#endif // DAC_BSP_H
@@ -0,0 +1,142 @@
+#include "hal_stub.h"
+
+#include "HAL_time.h"
+#include "adc_hal.h"
+#include "dac_bsp.h"
+#include "ptt_bsp.h"
+#include "c-logger.h"
+#include "pico_sdk_stub.h"
+
+int c_logger_stub_level = LOG_LEVEL_WARN;
+
+static uint64_t now_us = 0;
+
+static uint64_t dropped_at_reset = 0; // adc_hal.c never clears its count
+
+static bool ptt = false;
+static uint32_t ptt_keyups = 0;
+static float dac_tone = 0.0f;
+static uint32_t dac_writes = 0;
+
+void hal_stub_reset(void)
+{
+    now_us = 0;
+    dropped_at_reset = 0;
+    adc_hal_get_dropped(&dropped_at_reset);
+    ptt = false;
+    ptt_keyups = 0;
+    dac_tone = 0.0f;
+    dac_writes = 0;
+}
+
+// ---- Time ----
+
+void hal_stub_set_time_us(uint64_t time_us)
+{
+    now_us = time_us;
+}
+
+void hal_stub_advance_us(uint64_t us)
+{
+    now_us += us;
+}
+
+uint64_t HAL_get_current_time_us(void)
+{
+    return now_us;
+}
+
+uint32_t HAL_get_current_time_ms(void)
+{
+    return (uint32_t)(now_us / 1000);
+}
+
+void HAL_timer_start(HAL_timer_t *timer, uint64_t wait)
+{
+    timer->start_time = HAL_get_current_time_us();
+    timer->wait = wait;
+}
+
+bool HAL_timer_done(HAL_timer_t *timer)
+{
+    return (HAL_get_current_time_us() - timer->start_time) >= timer->wait;
+}
+
+void HAL_timer_reset(HAL_timer_t *timer)
+{
+    timer->start_time = HAL_get_current_time_us();
+}
+
+// ---- ADC ----
+
+// The ring itself is the firmware's adc_hal.c, on the pico_sdk_stub DMA channel.
+size_t hal_stub_adc_push(const uint16_t *samples, size_t count)
+{
+    return pico_sdk_stub_dma_transfer(samples, count);
+}
+
+uint64_t hal_stub_adc_overwritten(void)
+{
+    uint64_t dropped = 0;
+    adc_hal_get_dropped(&dropped);
+    return dropped - dropped_at_reset;
+}
+
+// ---- PTT and DAC ----
+
+int ptt_bsp_init(void)
+{
+    ptt = false;
+    return 0;
+}
+
+int ptt_bsp_task(void)
+{
+    return 0;
+}
+
+int ptt_bsp_set_ptt(bool active)
+{
+    if (active && !ptt)
+        ptt_keyups++;
+    ptt = active;
+    return 0;
+}
+
+bool hal_stub_ptt(void)
+{
+    return ptt;
+}
+
+uint32_t hal_stub_ptt_keyups(void)
+{
+    return ptt_keyups;
+}
+
+int dac_bsp_init(void)
+{
+    dac_tone = 0.0f;
+    return 0;
+}
+
+int dac_bsp_task(void)
+{
+    return 0;
+}
+
+int dac_bsp_set_tone(float frequency)
+{
+    dac_writes++;
+    dac_tone = frequency;
+    return 0;
+}
+
+float hal_stub_dac_tone(void)
+{
+    return dac_tone;
+}
+
+uint32_t hal_stub_dac_writes(void)
+{
+    return dac_writes;
+}
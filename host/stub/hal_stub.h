@@ -0,0 +1,38 @@
+#ifndef HAL_STUB_H
+#define HAL_STUB_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+/*
+ * Host stand-ins for the firmware HAL, so code written against HAL_time.h,
+ * adc_hal.h, dac_bsp.h and ptt_bsp.h builds and runs off-target:
+ *
+ *   time   a virtual clock that only moves when told to
+ *   ADC    the firmware's own adc_hal.c on stub pico-sdk calls
+ *          (pico_sdk_stub.h); hal_stub_adc_push plays samples into its DMA
+ *          channel and the real interrupt handler runs
+ *   PTT    remembers the line and counts key-ups
+ *   DAC    remembers the tone and counts writes
+ */
+
+void hal_stub_reset(void);
+
+void hal_stub_set_time_us(uint64_t now_us);
+void hal_stub_advance_us(uint64_t us);
+
+// Captures samples; every whole chunk lands in the ring and fires the callback.
+// Returns the number of chunks completed.
+size_t hal_stub_adc_push(const uint16_t *samples, size_t count);
+
+// Samples dropped because the ring was full when a chunk landed.
+uint64_t hal_stub_adc_overwritten(void);
+
+bool hal_stub_ptt(void);
+uint32_t hal_stub_ptt_keyups(void);
+
+float hal_stub_dac_tone(void);
+uint32_t hal_stub_dac_writes(void);
+
+#endif // HAL_STUB_H
@@ -0,0 +1,23 @@
+#ifndef HARDWARE_ADC_STUB_H
+#define HARDWARE_ADC_STUB_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/* Host build: the pico-sdk ADC calls adc_hal.c makes. Only the FIFO address is real. */
+
+typedef struct
+{
+    volatile uint32_t fifo;
+} adc_hw_t;
+
+extern adc_hw_t *const adc_hw;
+
+void adc_init(void);
+void adc_gpio_init(unsigned gpio);
+void adc_select_input(unsigned input);
+void adc_set_clkdiv(float clkdiv);
+void adc_fifo_setup(bool en, bool dreq_en, uint16_t dreq_thresh, bool err_in_fifo, bool byte_shift);
+void adc_run(bool run);
+
+#endif // HARDWARE_ADC_STUB_H
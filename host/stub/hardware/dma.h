@@ -0,0 +1,55 @@
+#ifndef HARDWARE_DMA_STUB_H
+#define HARDWARE_DMA_STUB_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/*
+ * Host build: the pico-sdk DMA calls adc_hal.c makes. A channel paced by
+ * the ADC does not move data by itself; pico_sdk_stub_dma_transfer plays
+ * the FIFO into it. An unpaced (DREQ_FORCE) memory read runs as soon as it
+ * is started. Either raises DMA_IRQ_0 when a transfer completes.
+ */
+
+enum dma_channel_transfer_size
+{
+    DMA_SIZE_8 = 0,
+    DMA_SIZE_16 = 1,
+    DMA_SIZE_32 = 2,
+};
+
+#define DREQ_ADC 36
+#define DREQ_FORCE 63
+
+typedef struct
+{
+    bool read_increment;
+    unsigned dreq;
+} dma_channel_config;
+
+typedef struct
+{
+    volatile uint32_t ints0;
+} dma_hw_t;
+
+extern dma_hw_t *const dma_hw;
+
+int dma_claim_unused_channel(bool required);
+void dma_channel_unclaim(unsigned channel);
+
+dma_channel_config dma_channel_get_default_config(unsigned channel);
+void channel_config_set_transfer_data_size(dma_channel_config *c, enum dma_channel_transfer_size size);
+void channel_config_set_read_increment(dma_channel_config *c, bool incr);
+void channel_config_set_write_increment(dma_channel_config *c, bool incr);
+void channel_config_set_dreq(dma_channel_config *c, unsigned dreq);
+
+void dma_channel_configure(unsigned channel, const dma_channel_config *config, volatile void *write_addr,
+                           const volatile void *read_addr, unsigned transfer_count, bool trigger);
+void dma_channel_set_read_addr(unsigned channel, const volatile void *read_addr, bool trigger);
+void dma_channel_set_write_addr(unsigned channel, volatile void *write_addr, bool trigger);
+void dma_channel_set_trans_count(unsigned channel, uint32_t trans_count, bool trigger);
+void dma_channel_set_irq0_enabled(unsigned channel, bool enabled);
+void dma_channel_start(unsigned channel);
+void dma_channel_abort(unsigned channel);
+
+#endif // HARDWARE_DMA_STUB_H
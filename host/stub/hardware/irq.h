@@ -0,0 +1,17 @@
+#ifndef HARDWARE_IRQ_STUB_H
+#define HARDWARE_IRQ_STUB_H
+
+#include <stdbool.h>
+
+/* Host build: interrupt handlers are plain functions the stubs call. */
+
+#define __isr
+
+#define DMA_IRQ_0 11
+
+typedef void (*irq_handler_t)(void);
+
+void irq_set_exclusive_handler(unsigned num, irq_handler_t handler);
+void irq_set_enabled(unsigned num, bool enabled);
+
+#endif // HARDWARE_IRQ_STUB_H
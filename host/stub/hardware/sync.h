@@ -0,0 +1,18 @@
+#ifndef HARDWARE_SYNC_STUB_H
+#define HARDWARE_SYNC_STUB_H
+
+#include <stdint.h>
+
+/* Host build: nothing runs concurrently with the stub interrupts. */
+
+static inline uint32_t save_and_disable_interrupts(void)
+{
+    return 0;
+}
+
+static inline void restore_interrupts(uint32_t status)
+{
+    (void)status;
+}
+
+#endif // HARDWARE_SYNC_STUB_H
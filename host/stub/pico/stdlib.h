@@ -0,0 +1,10 @@
+#ifndef PICO_STDLIB_STUB_H
+#define PICO_STDLIB_STUB_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/* Host build: stands in for the pico-sdk umbrella header. */
+
+#endif // PICO_STDLIB_STUB_H
@@ -0,0 +1,218 @@
+#include "pico_sdk_stub.h"
+
+#include <string.h>
+#include "hardware/adc.h"
+#include "hardware/dma.h"
+#include "hardware/irq.h"
+
+static adc_hw_t adc_regs;
+static dma_hw_t dma_regs;
+adc_hw_t *const adc_hw = &adc_regs;
+dma_hw_t *const dma_hw = &dma_regs;
+
+static bool adc_running = false;
+
+static bool channel_claimed = false;
+static bool channel_busy = false;
+static bool channel_irq0 = false;
+static bool channel_unpaced = false;
+static bool channel_in_transfer = false;
+static const uint16_t *channel_read = NULL;
+static uint16_t *channel_write = NULL;
+static uint32_t channel_count = 0;
+
+static irq_handler_t dma_irq_handler = NULL;
+static bool dma_irq_enabled = false;
+
+// ---- ADC ----
+
+void adc_init(void)
+{
+    adc_running = false;
+}
+
+void adc_gpio_init(unsigned gpio)
+{
+    (void)gpio;
+}
+
+void adc_select_input(unsigned input)
+{
+    (void)input;
+}
+
+void adc_set_clkdiv(float clkdiv)
+{
+    (void)clkdiv;
+}
+
+void adc_fifo_setup(bool en, bool dreq_en, uint16_t dreq_thresh, bool err_in_fifo, bool byte_shift)
+{
+    (void)en;
+    (void)dreq_en;
+    (void)dreq_thresh;
+    (void)err_in_fifo;
+    (void)byte_shift;
+}
+
+void adc_run(bool run)
+{
+    adc_running = run;
+}
+
+// ---- DMA ----
+
+int dma_claim_unused_channel(bool required)
+{
+    (void)required;
+    if (channel_claimed)
+        return -1;
+    channel_claimed = true;
+    return 0;
+}
+
+void dma_channel_unclaim(unsigned channel)
+{
+    (void)channel;
+    channel_claimed = false;
+    channel_busy = false;
+}
+
+dma_channel_config dma_channel_get_default_config(unsigned channel)
+{
+    (void)channel;
+    return (dma_channel_config){.read_increment = true, .dreq = DREQ_FORCE};
+}
+
+void channel_config_set_transfer_data_size(dma_channel_config *c, enum dma_channel_transfer_size size)
+{
+    (void)c;
+    (void)size; // always 16 bits here
+}
+
+void channel_config_set_read_increment(dma_channel_config *c, bool incr)
+{
+    c->read_increment = incr;
+}
+
+void channel_config_set_write_increment(dma_channel_config *c, bool incr)
+{
+    (void)c;
+    (void)incr;
+}
+
+void channel_config_set_dreq(dma_channel_config *c, unsigned dreq)
+{
+    c->dreq = dreq;
+}
+
+void dma_channel_configure(unsigned channel, const dma_channel_config *config, volatile void *write_addr,
+                           const volatile void *read_addr, unsigned transfer_count, bool trigger)
+{
+    channel_unpaced = config->dreq == DREQ_FORCE && config->read_increment;
+    dma_channel_set_read_addr(channel, read_addr, false);
+    dma_channel_set_write_addr(channel, write_addr, false);
+    dma_channel_set_trans_count(channel, transfer_count, trigger);
+}
+
+void dma_channel_set_read_addr(unsigned channel, const volatile void *read_addr, bool trigger)
+{
+    channel_read = (const uint16_t *)read_addr; // only used when unpaced
+    if (trigger)
+        dma_channel_start(channel);
+}
+
+void dma_channel_set_write_addr(unsigned channel, volatile void *write_addr, bool trigger)
+{
+    channel_write = (uint16_t *)write_addr;
+    if (trigger)
+        dma_channel_start(channel);
+}
+
+void dma_channel_set_trans_count(unsigned channel, uint32_t trans_count, bool trigger)
+{
+    channel_count = trans_count;
+    if (trigger)
+        dma_channel_start(channel);
+}
+
+void dma_channel_set_irq0_enabled(unsigned channel, bool enabled)
+{
+    (void)channel;
+    channel_irq0 = enabled;
+}
+
+static void transfer_done(void)
+{
+    channel_busy = false;
+    dma_regs.ints0 |= 1u; // channel 0, the only one
+    if (channel_irq0 && dma_irq_enabled && dma_irq_handler)
+        dma_irq_handler(); // may start the next transfer
+}
+
+void dma_channel_start(unsigned channel)
+{
+    (void)channel;
+    channel_busy = channel_count > 0;
+
+    // A memory source is copied at once; a handler restarting the channel loops here rather than nesting.
+    if (!channel_unpaced || channel_in_transfer)
+        return;
+
+    channel_in_transfer = true;
+    while (channel_busy)
+    {
+        memcpy(channel_write, channel_read, channel_count * sizeof(uint16_t));
+        channel_write += channel_count;
+        channel_read += channel_count;
+        channel_count = 0;
+        transfer_done();
+    }
+    channel_in_transfer = false;
+}
+
+void dma_channel_abort(unsigned channel)
+{
+    (void)channel;
+    channel_busy = false;
+}
+
+// ---- IRQ ----
+
+void irq_set_exclusive_handler(unsigned num, irq_handler_t handler)
+{
+    if (num == DMA_IRQ_0)
+        dma_irq_handler = handler;
+}
+
+void irq_set_enabled(unsigned num, bool enabled)
+{
+    if (num == DMA_IRQ_0)
+        dma_irq_enabled = enabled;
+}
+
+// ---- FIFO ----
+
+size_t pico_sdk_stub_dma_transfer(const uint16_t *samples, size_t count)
+{
+    size_t transfers = 0;
+
+    while (count && adc_running && channel_busy && !channel_unpaced)
+    {
+        size_t n = channel_count < count ? channel_count : count;
+
+        memcpy(channel_write, samples, n * sizeof(uint16_t));
+        channel_write += n;
+        channel_count -= (uint32_t)n;
+        samples += n;
+        count -= n;
+
+        if (channel_count == 0)
+        {
+            transfers++;
+            transfer_done();
+        }
+    }
+
+    return transfers;
+}
@@ -0,0 +1,19 @@
+#ifndef PICO_SDK_STUB_H
+#define PICO_SDK_STUB_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+/*
+ * Host stand-ins for the pico-sdk ADC, DMA and IRQ calls (the hardware/
+ * headers in this directory), so the real adc_hal.c runs off-target: one
+ * DMA channel, with the ADC FIFO played into it from here. An adc_hal
+ * replay source is copied in as soon as the ring has room.
+ */
+
+// Writes samples through the running DMA channel, raising DMA_IRQ_0 at the
+// end of every transfer. Samples arriving while no transfer is armed, or the
+// ADC is stopped, are lost. Returns the number of transfers completed.
+size_t pico_sdk_stub_dma_transfer(const uint16_t *samples, size_t count);
+
+#endif // PICO_SDK_STUB_H
@@ -0,0 +1,12 @@
+#ifndef PTT_BSP_H
+#define PTT_BSP_H
+
+#include <stdbool.h>
+
+/* Host build: the PTT interface the firmware bsp implements. */
+
+int ptt_bsp_init(void);
+int ptt_bsp_task(void);
+int ptt_bsp_set_ptt(bool active);
+
+#endif // PTT_BSP_H
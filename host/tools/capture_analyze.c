@@ -0,0 +1,463 @@
+/**
+ * @file capture_analyze.c
+ *
+ * @brief Native replacement for scripts/dsp.py: traces and bit decisions for captures of any length.
+ *
+ * The capture (raw, WAV, recorder.c records or a capture stream) is memory-mapped and cut
+ * into segments. Worker threads run the dsp.py chain on each segment:
+ * - two Butterworth bandpasses (order 4, +/-200 Hz about each tone)
+ * - envelope followers
+ * - metric = env(mark) - env(space)
+ * - the edge-timed slicer deciding half a bit after each edge
+ * Each segment starts `overlap` samples early so filters, envelopes and
+ * slicer timing have settled by its first sample. The warm-up output is
+ * dropped. Segments are written in order, so the output matches a single
+ * pass once the slicer has seen an edge in the overlap.
+ *
+ * Traces, one row every `decimate` samples:
+ *   index, raw, y1200, y2200, env1200, env2200, metric, bit
+ *   (+ dev1200, dev2200, devmetric when the capture has the recorder traces)
+ * raw and the filtered signals are scaled as in dsp.py ((x - 2048) / 1024,
+ * with a stream's own DC offset).
+ * bit is 0 or 1 on the sample where a decision was made, -1 elsewhere.
+ *
+ * Output formats:
+ *   csv  text with a header row (scripts/graph_csv.py reads it)
+ *   bin  "PCTRACE1", u32 sample rate, u32 columns, u32 decimate, then
+ *        float32 rows without the index column
+ * Decisions also go to -b as "index,bit" lines.
+ *
+ * usage: capture_analyze -i capture [-o traces] [-F csv|bin] [-b bits.csv] [-D decimate]
+ *                        [-r rate] [-l space_hz] [-m mark_hz] [-B baud] [-j threads]
+ *                        [-S segment] [-O overlap]
+ */
+
+#include <complex.h>
+#include <math.h>
+#include <pthread.h>
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "bench.h"
+#include "capture.h"
+
+#define FILTER_ORDER 4
+#define FILTER_HALF_WIDTH_HZ 200.0
+#define ENVELOPE_ALPHA 0.01f
+#define THRESHOLD 0.1f
+#define MAX_THREADS 64
+#define TRACE_COLUMNS 7 // raw .. bit
+#define DEVICE_COLUMNS 3
+
+typedef struct biquad
+{
+    float b0, b1, b2, a1, a2;
+} biquad_t;
+
+typedef struct bandpass
+{
+    biquad_t stage[FILTER_ORDER];
+    float gain;
+} bandpass_t;
+
+typedef struct analyzer
+{
+    const capture_map_t *map;
+    uint32_t rate;
+    bandpass_t filter[2]; // space, mark
+    float half_bit;       // slicer delay in samples
+    size_t decimate;
+    bool binary;
+    bool device;          // recorder.c records carry the firmware's own trace
+} analyzer_t;
+
+typedef struct segment
+{
+    size_t first;    // first sample written
+    size_t last;     // one past the last
+    char *text;      // csv rows
+    size_t text_len;
+    size_t text_cap;
+    float *rows;     // bin rows
+    size_t row_count;
+    size_t *bit_index;
+    uint8_t *bit_value;
+    size_t bits;
+    size_t bit_cap;
+} segment_t;
+
+typedef struct job
+{
+    const analyzer_t *analyzer;
+    segment_t *segment;
+    size_t overlap;
+} job_t;
+
+/*
+ * Butterworth bandpass as scipy's butter(order, [low, high], 'band'):
+ * analog prototype poles, lowpass to bandpass, bilinear transform, one
+ * biquad per conjugate pole pair with a zero at DC and one at Nyquist.
+ */
+static void bandpass_design(bandpass_t *bp, double low_hz, double high_hz, double rate)
+{
+    double fs2 = 2.0 * rate;
+    double w1 = fs2 * tan(M_PI * low_hz / rate);
+    double w2 = fs2 * tan(M_PI * high_hz / rate);
+    double w0 = sqrt(w1 * w2);
+    double bw = w2 - w1;
+    int n = 0;
+
+    for (int k = 0; k < FILTER_ORDER / 2; k++)
+    {
+        double complex p = cexp(I * M_PI * (2.0 * k + FILTER_ORDER + 1) / (2.0 * FILTER_ORDER));
+        double complex half = p * bw / 2.0;
+        double complex root = csqrt(half * half - w0 * w0);
+        double complex poles[2] = {half + root, half - root};
+
+        for (int j = 0; j < 2; j++)
+        {
+            // Each analog pole and its conjugate make one section.
+            double complex z = (fs2 + poles[j]) / (fs2 - poles[j]);
+            biquad_t *s = &bp->stage[n++];
+            s->b0 = 1.0f;
+            s->b1 = 0.0f;
+            s->b2 = -1.0f;
+            s->a1 = (float)(-2.0 * creal(z));
+            s->a2 = (float)(cabs(z) * cabs(z));
+        }
+    }
+
+    // Unity gain at the centre frequency.
+    double complex e = cexp(-I * 2.0 * M_PI * sqrt(low_hz * high_hz) / rate);
+    double complex h = 1.0;
+    for (int s = 0; s < FILTER_ORDER; s++)
+    {
+        const biquad_t *b = &bp->stage[s];
+        h *= (b->b0 + b->b1 * e + b->b2 * e * e) / (1.0 + b->a1 * e + b->a2 * e * e);
+    }
+    bp->gain = (float)(1.0 / cabs(h));
+}
+
+static void segment_text(segment_t *seg, const char *fmt, ...)
+{
+    if (seg->text_cap - seg->text_len < 256)
+    {
+        seg->text_cap = seg->text_cap ? seg->text_cap * 2 : 1 << 16;
+        seg->text = realloc(seg->text, seg->text_cap);
+    }
+
+    va_list args;
+    va_start(args, fmt);
+    seg->text_len += (size_t)vsnprintf(seg->text + seg->text_len, seg->text_cap - seg->text_len, fmt, args);
+    va_end(args);
+}
+
+static void segment_bit(segment_t *seg, size_t index, unsigned bit)
+{
+    if (seg->bits == seg->bit_cap)
+    {
+        seg->bit_cap = seg->bit_cap ? seg->bit_cap * 2 : 1024;
+        seg->bit_index = realloc(seg->bit_index, seg->bit_cap * sizeof(size_t));
+        seg->bit_value = realloc(seg->bit_value, seg->bit_cap);
+    }
+    seg->bit_index[seg->bits] = index;
+    seg->bit_value[seg->bits] = (uint8_t)bit;
+    seg->bits++;
+}
+
+static void analyze_segment(const analyzer_t *an, segment_t *seg, size_t overlap)
+{
+    const capture_map_t *map = an->map;
+    size_t start = seg->first > overlap ? seg->first - overlap : 0;
+    size_t columns = TRACE_COLUMNS + (an->device ? DEVICE_COLUMNS : 0);
+    float state[2][FILTER_ORDER][2] = {{{0}}};
+    float env[2] = {0.0f, 0.0f};
+    float prev = 0.0f;
+    float timer = 0.0f;
+
+    if (an->binary)
+    {
+        size_t rows = (seg->last - seg->first + an->decimate - 1) / an->decimate + 1;
+        seg->rows = malloc(rows * columns * sizeof(float));
+    }
+
+    for (size_t i = start; i < seg->last; i++)
+    {
+        float x = ((float)capture_map_sample(map, i) - map->dc_offset) / 1024.0f;
+        float y[2];
+
+        for (int f = 0; f < 2; f++)
+        {
+            // Direct form II transposed, one section after the other.
+            float v = x * an->filter[f].gain;
+            for (int s = 0; s < FILTER_ORDER; s++)
+            {
+                const biquad_t *b = &an->filter[f].stage[s];
+                float out = b->b0 * v + state[f][s][0];
+                state[f][s][0] = b->b1 * v - b->a1 * out + state[f][s][1];
+                state[f][s][1] = b->b2 * v - b->a2 * out;
+                v = out;
+            }
+            y[f] = v;
+            env[f] = (1.0f - ENVELOPE_ALPHA) * env[f] + ENVELOPE_ALPHA * fabsf(v);
+        }
+
+        // dsp.py: restart the half-bit timer on every threshold crossing.
+        float metric = env[1] - env[0];
+        int bit = -1;
+        if ((metric > THRESHOLD && prev <= THRESHOLD) || (metric <= -THRESHOLD && prev > -THRESHOLD))
+            timer = 0.0f;
+        if (timer >= an->half_bit)
+        {
+            if (metric > THRESHOLD)
+                bit = 1;
+            else if (metric < -THRESHOLD)
+                bit = 0;
+            timer = -an->half_bit;
+        }
+        timer += 1.0f;
+        prev = metric;
+
+        if (i < seg->first)
+            continue;
+
+        if (bit >= 0)
+            segment_bit(seg, i, (unsigned)bit);
+
+        if ((i - seg->first) % an->decimate)
+            continue;
+
+        float row[TRACE_COLUMNS + DEVICE_COLUMNS] = {x, y[0], y[1], env[0], env[1], metric, (float)bit};
+        if (an->device)
+        {
+            for (unsigned c = 0; c < DEVICE_COLUMNS; c++)
+                row[TRACE_COLUMNS + c] = capture_map_trace(map, i, c + 1);
+        }
+
+        if (an->binary)
+        {
+            memcpy(seg->rows + seg->row_count * columns, row, columns * sizeof(float));
+            seg->row_count++;
+        }
+        else if (an->device)
+        {
+            segment_text(seg, "%zu,%.4f,%.4f,%.4f,%.4f,%.4f,%.4f,%d,%.3f,%.3f,%.3f\n", i, row[0], row[1], row[2],
+                         row[3], row[4], row[5], bit, row[7], row[8], row[9]);
+        }
+        else
+        {
+            segment_text(seg, "%zu,%.4f,%.4f,%.4f,%.4f,%.4f,%.4f,%d\n", i, row[0], row[1], row[2], row[3], row[4],
+                         row[5], bit);
+        }
+    }
+}
+
+static void *worker(void *arg)
+{
+    job_t *job = arg;
+    analyze_segment(job->analyzer, job->segment, job->overlap);
+    return NULL;
+}
+
+static void segment_free(segment_t *seg)
+{
+    free(seg->text);
+    free(seg->rows);
+    free(seg->bit_index);
+    free(seg->bit_value);
+    memset(seg, 0, sizeof(*seg));
+}
+
+static void usage(const char *name)
+{
+    fprintf(stderr,
+            "usage: %s -i capture [-o traces] [-F csv|bin] [-b bits.csv] [-D decimate]\n"
+            "          [-r rate] [-l space_hz] [-m mark_hz] [-B baud] [-j threads] [-S segment] [-O overlap]\n",
+            name);
+}
+
+int main(int argc, char **argv)
+{
+    const char *input = NULL;
+    const char *output = NULL;
+    const char *bits_path = NULL;
+    bool binary = false;
+    long decimate = 1;
+    uint32_t rate = 0;
+    double space_hz = 1200.0, mark_hz = 2200.0;
+    double baud = 32.0;
+    long threads = sysconf(_SC_NPROCESSORS_ONLN);
+    long segment_len = 1 << 20;
+    long overlap = 1 << 15;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "i:o:F:b:D:r:l:m:B:j:S:O:")) != -1)
+    {
+        switch (opt)
+        {
+        case 'i':
+            input = optarg;
+            break;
+        case 'o':
+            output = optarg;
+            break;
+        case 'F':
+            if (strcmp(optarg, "csv") && strcmp(optarg, "bin"))
+            {
+                usage(argv[0]);
+                return 1;
+            }
+            binary = !strcmp(optarg, "bin");
+            break;
+        case 'b':
+            bits_path = optarg;
+            break;
+        case 'D':
+            decimate = atol(optarg);
+            break;
+        case 'r':
+            rate = (uint32_t)strtoul(optarg, NULL, 0);
+            break;
+        case 'l':
+            space_hz = atof(optarg);
+            break;
+        case 'm':
+            mark_hz = atof(optarg);
+            break;
+        case 'B':
+            baud = atof(optarg);
+            break;
+        case 'j':
+            threads = atol(optarg);
+            break;
+        case 'S':
+            segment_len = atol(optarg);
+            break;
+        case 'O':
+            overlap = atol(optarg);
+            break;
+        default:
+            usage(argv[0]);
+            return 1;
+        }
+    }
+
+    if (!input || decimate <= 0 || baud <= 0.0 || segment_len <= 0 || overlap < 0)
+    {
+        usage(argv[0]);
+        return 1;
+    }
+    if (threads < 1)
+        threads = 1;
+    if (threads > MAX_THREADS)
+        threads = MAX_THREADS;
+
+    capture_map_t map;
+    if (capture_map(input, capture_format_guess(input), &map))
+    {
+        fprintf(stderr, "cannot map %s\n", input);
+        return 1;
+    }
+
+    analyzer_t an = {
+        .map = &map,
+        .rate = rate ? rate : map.rate ? map.rate : 79200,
+        .decimate = (size_t)decimate,
+        .binary = binary,
+        .device = map.format == CAPTURE_RECORD || map.channels > DEVICE_COLUMNS,
+    };
+    an.half_bit = (float)(an.rate / baud / 2.0);
+    bandpass_design(&an.filter[0], space_hz - FILTER_HALF_WIDTH_HZ, space_hz + FILTER_HALF_WIDTH_HZ, an.rate);
+    bandpass_design(&an.filter[1], mark_hz - FILTER_HALF_WIDTH_HZ, mark_hz + FILTER_HALF_WIDTH_HZ, an.rate);
+
+    FILE *out = output ? fopen(output, "wb") : NULL;
+    FILE *bits_out = bits_path ? fopen(bits_path, "w") : NULL;
+    if ((output && !out) || (bits_path && !bits_out))
+    {
+        fprintf(stderr, "cannot write output\n");
+        return 1;
+    }
+
+    uint32_t columns = TRACE_COLUMNS + (an.device ? DEVICE_COLUMNS : 0);
+    if (out && binary)
+    {
+        uint32_t header[3] = {an.rate, columns, (uint32_t)decimate};
+        fwrite("PCTRACE1", 1, 8, out);
+        fwrite(header, sizeof(header), 1, out);
+    }
+    else if (out)
+    {
+        fprintf(out, "index,raw,y1200,y2200,env1200,env2200,metric,bit%s\n",
+                an.device ? ",dev1200,dev2200,devmetric" : "");
+    }
+    if (bits_out)
+        fprintf(bits_out, "index,bit\n");
+
+    // Segments go out in waves of one per thread, written in order.
+    size_t segments = (map.count + (size_t)segment_len - 1) / (size_t)segment_len;
+    segment_t *wave = calloc((size_t)threads, sizeof(segment_t));
+    job_t *jobs = calloc((size_t)threads, sizeof(job_t));
+    pthread_t *ids = calloc((size_t)threads, sizeof(pthread_t));
+    uint64_t total_bits = 0;
+    uint64_t ones = 0;
+
+    if (!out)
+        an.decimate = SIZE_MAX; // bit decisions only
+
+    double start = bench_clock_ns();
+    for (size_t s = 0; s < segments; s += (size_t)threads)
+    {
+        size_t n = segments - s < (size_t)threads ? segments - s : (size_t)threads;
+
+        for (size_t t = 0; t < n; t++)
+        {
+            wave[t].first = (s + t) * (size_t)segment_len;
+            wave[t].last = wave[t].first + (size_t)segment_len < map.count ? wave[t].first + (size_t)segment_len
+                                                                           : map.count;
+            jobs[t] = (job_t){.analyzer = &an, .segment = &wave[t], .overlap = (size_t)overlap};
+            pthread_create(&ids[t], NULL, worker, &jobs[t]);
+        }
+
+        for (size_t t = 0; t < n; t++)
+        {
+            pthread_join(ids[t], NULL);
+            segment_t *seg = &wave[t];
+
+            if (out && binary)
+                fwrite(seg->rows, sizeof(float) * columns, seg->row_count, out);
+            else if (out && seg->text_len)
+                fwrite(seg->text, 1, seg->text_len, out);
+
+            for (size_t b = 0; b < seg->bits; b++)
+            {
+                if (bits_out)
+                    fprintf(bits_out, "%zu,%u\n", seg->bit_index[b], seg->bit_value[b]);
+                ones += seg->bit_value[b];
+            }
+            total_bits += seg->bits;
+            segment_free(seg);
+        }
+    }
+    double elapsed = bench_clock_ns() - start;
+
+    if (out)
+        fclose(out);
+    if (bits_out)
+        fclose(bits_out);
+
+    double seconds = (double)map.count / an.rate;
+    printf("capture,samples,seconds,rate,bits,ones,threads,segments,elapsed_s,msamples_per_s,x_realtime\n");
+    printf("%s,%zu,%.1f,%u,%llu,%llu,%ld,%zu,%.3f,%.1f,%.0f\n", input, map.count, seconds, an.rate,
+           (unsigned long long)total_bits, (unsigned long long)ones, threads, segments, elapsed / 1e9,
+           map.count / (elapsed / 1e3), seconds / (elapsed / 1e9));
+
+    free(wave);
+    free(jobs);
+    free(ids);
+    capture_unmap(&map);
+    return 0;
+}
@@ -0,0 +1,182 @@
+/**
+ * @file capture_convert.c
+ *
+ * @brief Converts legacy captures to the self-describing capture stream and describes captures.
+ *
+ * Raw dumps carry no sample rate, so give it with -r (default 79200, the
+ * rate dsp.py assumes; the older scripts say 70400). WAV files carry
+ * their own. recorder.c records keep their three trace bytes as 8-bit
+ * channels 1-3 of a four-channel stream, as the recorder now sends them.
+ *
+ * Without -o the input is only described: format, rate, channels, blocks,
+ * frames lost and duration. With -o the output format comes from the
+ * extension or -F; converting a stream back to raw or WAV keeps channel 0.
+ *
+ * usage: capture_convert -i in [-f raw|wav|rec|pcc] [-r rate] [-p profile]
+ *                        [-B block] [-o out] [-F raw|wav|rec|pcc]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "capture.h"
+#include "modem/modem_profile.h"
+
+#define DEFAULT_RATE 79200
+#define DEFAULT_BLOCK 4096
+#define RECORD_CHANNELS 4
+
+static const char *format_names[] = {"raw", "wav", "rec", "pcc"};
+
+static void usage(const char *name)
+{
+    fprintf(stderr,
+            "usage: %s -i in [-f raw|wav|rec|pcc] [-r rate] [-p profile]\n"
+            "          [-B block] [-o out] [-F raw|wav|rec|pcc]\n",
+            name);
+}
+
+static void describe(const char *path, const capture_map_t *map, uint32_t rate)
+{
+    const modem_profile_t *profile = modem_profile_get((modem_profile_id_t)map->profile);
+    uint64_t first_us = map->blocks ? map->blocks[0].time_us : 0;
+    uint64_t last_us = map->blocks ? map->blocks[map->block_count - 1].time_us : 0;
+
+    printf("capture,format,rate,channels,bits,dc_offset,profile,blocks,frames,dropped,seconds,device_seconds\n");
+    printf("%s,%s,%u,%u,%u,%u,%s,%zu,%zu,%llu,%.3f,%.3f\n", path, format_names[map->format], rate,
+           map->channels, map->bits, map->dc_offset, profile ? profile->name : "-", map->block_count, map->count,
+           (unsigned long long)map->dropped, rate ? (double)(map->count + map->dropped) / rate : 0.0,
+           (last_us - first_us) / 1e6);
+}
+
+int main(int argc, char **argv)
+{
+    const char *input = NULL;
+    const char *output = NULL;
+    const char *in_name = NULL;
+    const char *out_name = NULL;
+    uint32_t rate = 0;
+    int profile = CAPTURE_PROFILE_NONE;
+    long block = DEFAULT_BLOCK;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "i:f:r:p:B:o:F:")) != -1)
+    {
+        switch (opt)
+        {
+        case 'i':
+            input = optarg;
+            break;
+        case 'f':
+            in_name = optarg;
+            break;
+        case 'r':
+            rate = (uint32_t)strtoul(optarg, NULL, 0);
+            break;
+        case 'p':
+            profile = atoi(optarg);
+            break;
+        case 'B':
+            block = atol(optarg);
+            break;
+        case 'o':
+            output = optarg;
+            break;
+        case 'F':
+            out_name = optarg;
+            break;
+        default:
+            usage(argv[0]);
+            return 1;
+        }
+    }
+
+    capture_format_t in_format = input ? capture_format_guess(input) : CAPTURE_RAW;
+    capture_format_t out_format = output ? capture_format_guess(output) : CAPTURE_CHUNKED;
+    if (!input || block <= 0 || (in_name && capture_format_parse(in_name, &in_format)) ||
+        (out_name && capture_format_parse(out_name, &out_format)) ||
+        (profile != CAPTURE_PROFILE_NONE && !modem_profile_get((modem_profile_id_t)profile)))
+    {
+        usage(argv[0]);
+        return 1;
+    }
+
+    capture_map_t map;
+    if (capture_map(input, in_format, &map))
+    {
+        fprintf(stderr, "cannot read %s as %s\n", input, format_names[in_format]);
+        return 1;
+    }
+
+    // A rate given on the command line wins; raw and rec files have none of their own.
+    if (!rate)
+        rate = map.rate ? map.rate : DEFAULT_RATE;
+
+    if (!output)
+    {
+        describe(input, &map, rate);
+        capture_unmap(&map);
+        return 0;
+    }
+
+    int ret;
+    if (out_format == CAPTURE_CHUNKED)
+    {
+        unsigned channels = in_format == CAPTURE_RECORD ? RECORD_CHANNELS : map.channels;
+        capture_info_t info = {
+            .channels = (uint16_t)channels,
+            .sample_rate = rate,
+            .bits = map.bits,
+            .profile = (uint8_t)(profile != CAPTURE_PROFILE_NONE ? profile : map.profile),
+            .dc_offset = map.dc_offset,
+            .trace_bits = in_format == CAPTURE_RECORD ? 8 : map.trace_bits,
+        };
+        float trace_scale = info.trace_bits == 8 ? 255.0f : 65535.0f;
+
+        uint16_t *frames = malloc((map.count ? map.count : 1) * channels * sizeof(uint16_t));
+        if (!frames)
+        {
+            capture_unmap(&map);
+            return 1;
+        }
+
+        for (size_t i = 0; i < map.count; i++)
+        {
+            uint16_t *frame = frames + i * channels;
+            frame[0] = capture_map_sample(&map, i);
+            for (unsigned c = 1; c < channels; c++)
+                frame[c] = (uint16_t)(capture_map_trace(&map, i, c) * trace_scale + 0.5f);
+        }
+
+        ret = capture_save_chunked(output, &info, frames, map.count, (size_t)block);
+        free(frames);
+    }
+    else
+    {
+        uint16_t *samples = malloc((map.count ? map.count : 1) * sizeof(uint16_t));
+        if (!samples)
+        {
+            capture_unmap(&map);
+            return 1;
+        }
+
+        for (size_t i = 0; i < map.count; i++)
+            samples[i] = capture_map_sample(&map, i);
+
+        ret = capture_save(output, out_format, rate, samples, map.count);
+        free(samples);
+    }
+
+    if (ret)
+    {
+        fprintf(stderr, "cannot write %s\n", output);
+        capture_unmap(&map);
+        return 1;
+    }
+
+    printf("%s -> %s: %zu frames at %u Hz as %s\n", input, output, map.count, rate, format_names[out_format]);
+    capture_unmap(&map);
+    return 0;
+}
@@ -0,0 +1,452 @@
+/**
+ * @file capture_regress.c
+ *
+ * @brief Golden-capture regression: decode every stored capture, then sweep impairments.
+ *
+ * Each capture listed in host/vectors/captures.txt is loaded at 79.2 kHz
+ * and decoded with the firmware front end: fsk_demod on the capture's
+ * tones and baud, the preamble correlator on the sync word, and slicing
+ * after the sync word. The text must come out exactly, or the run exits 1.
+ *
+ * The clean decode fixes the golden timing. Each impaired copy is then
+ * decoded twice:
+ * - BER: bits sliced at the golden timing against the text.
+ * - Frame loss: a copy counts as lost if the real sync search plus
+ *   slicing does not produce the text exactly.
+ *
+ * The sweeps are:
+ * 1. White noise, with SNR in 3 kHz measured against the frame's own power.
+ * 2. Frequency offset, a whole-band shift as from a mistuned receiver.
+ * 3. Amplitude, scaled about mid-scale and clipped to 12 bits.
+ *
+ * Each row also has the decode time per sample.
+ *
+ * usage: capture_regress [-f vectors] [-d capture_dir] [-t trials] [-o csv_prefix] [-s seed]
+ */
+
+#include <math.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "bench.h"
+#include "capture.h"
+#include "synth.h"
+#include "modem/fsk_demod.h"
+#include "modem/preamble_correlator.h"
+#include "modem/modem_rx.h"
+
+#ifndef CAPTURE_VECTORS
+#define CAPTURE_VECTORS "vectors/captures.txt"
+#endif
+
+#ifndef CAPTURE_DIR
+#define CAPTURE_DIR "../scripts/recorded_data"
+#endif
+
+#define SAMPLE_RATE 79200
+#define OVERSAMPLE 8
+#define SYNC_BITS 16
+#define MAX_TEXT 32
+#define MAX_CAPTURES 16
+#define BLOCK 1024
+
+typedef struct golden
+{
+    char file[128];
+    capture_format_t format;
+    uint32_t rate;
+    fsk_demod_config_t demod;
+    uint32_t sync;
+    char text[MAX_TEXT + 1];
+    size_t text_bits;
+
+    uint16_t *samples;
+    size_t count;
+    uint32_t start_chip; // golden timing from the clean decode
+    size_t frame_first;  // samples covered by sync word and text
+    size_t frame_last;
+    float frame_power;
+} golden_t;
+
+typedef struct decode
+{
+    bool found;        // sync found and text sliced exactly
+    uint32_t errors;   // bit errors at the golden timing
+    float score;
+    uint32_t start_chip;
+    char text[MAX_TEXT + 1];
+    double ns;
+} decode_t;
+
+static int split(char *line, char **fields, int max)
+{
+    int n = 0;
+    fields[n++] = line;
+
+    for (char *p = line; *p && n < max; p++)
+    {
+        if (*p == '\t')
+        {
+            *p = '\0';
+            fields[n++] = p + 1;
+        }
+    }
+
+    return n;
+}
+
+static int load_vectors(const char *path, golden_t *captures, int max)
+{
+    FILE *file = fopen(path, "r");
+    if (!file)
+    {
+        fprintf(stderr, "cannot open %s\n", path);
+        return -1;
+    }
+
+    char line[512];
+    int n = 0;
+    while (fgets(line, sizeof(line), file) && n < max)
+    {
+        line[strcspn(line, "\r\n")] = '\0';
+        if (line[0] == '#' || line[0] == '\0')
+            continue;
+
+        char *fields[8];
+        golden_t *g = &captures[n];
+        memset(g, 0, sizeof(*g));
+        if (split(line, fields, 8) != 8 || capture_format_parse(fields[1], &g->format) ||
+            strlen(fields[7]) > MAX_TEXT)
+        {
+            fprintf(stderr, "bad vector line: %s\n", line);
+            continue;
+        }
+
+        snprintf(g->file, sizeof(g->file), "%s", fields[0]);
+        g->rate = (uint32_t)strtoul(fields[2], NULL, 0);
+        g->demod.sample_rate = SAMPLE_RATE;
+        g->demod.baud = (uint16_t)atoi(fields[3]);
+        g->demod.oversample = OVERSAMPLE;
+        g->demod.tone_hz[0] = strtof(fields[4], NULL);
+        g->demod.tone_hz[1] = strtof(fields[5], NULL);
+        g->sync = (uint32_t)strtoul(fields[6], NULL, 0);
+        snprintf(g->text, sizeof(g->text), "%s", fields[7]);
+        g->text_bits = strlen(g->text) * 8;
+        n++;
+    }
+
+    fclose(file);
+    return n;
+}
+
+static unsigned text_bit(const char *text, size_t k)
+{
+    return ((uint8_t)text[k / 8] >> (7 - k % 8)) & 1;
+}
+
+// Slices the text after a sync word whose first body bit is decided on start_chip.
+static void slice(const golden_t *g, const float *metric, size_t chips, uint32_t start_chip, char *text,
+                  uint32_t *errors)
+{
+    memset(text, 0, MAX_TEXT + 1);
+    *errors = 0;
+
+    for (size_t k = 0; k < g->text_bits; k++)
+    {
+        size_t chip = start_chip + k * OVERSAMPLE;
+        unsigned bit = chip < chips ? metric[chip] > 0.0f : 0;
+        text[k / 8] |= (char)(bit << (7 - k % 8));
+        *errors += bit != text_bit(g->text, k);
+    }
+}
+
+static float *demodulate(const golden_t *g, const uint16_t *samples, size_t count, size_t *chips)
+{
+    fsk_demod_t demod;
+    fsk_chip_t batch[64];
+    size_t max_chips = (size_t)((double)count * g->demod.baud * OVERSAMPLE / SAMPLE_RATE) + 64;
+    float *metric = malloc(max_chips * sizeof(float));
+    size_t n = 0;
+
+    fsk_demod_init(&demod, &g->demod);
+    for (size_t pos = 0; pos < count;)
+    {
+        size_t num = 0;
+        size_t block = count - pos < BLOCK ? count - pos : BLOCK;
+        pos += fsk_demod_process(&demod, samples + pos, block, batch, 64, &num);
+        for (size_t i = 0; i < num && n < max_chips; i++)
+            metric[n++] = batch[i].metric;
+    }
+
+    *chips = n;
+    return metric;
+}
+
+static void decode(const golden_t *g, const uint16_t *samples, size_t count, uint32_t golden_chip, decode_t *out)
+{
+    preamble_correlator_t corr;
+    preamble_correlator_config_t config = {
+        .pattern = g->sync,
+        .bits = SYNC_BITS,
+        .oversample = OVERSAMPLE,
+        .threshold = MODEM_RX_SYNC_THRESHOLD,
+    };
+    size_t chips;
+
+    memset(out, 0, sizeof(*out));
+    double start = bench_clock_ns();
+    float *metric = demodulate(g, samples, count, &chips);
+
+    preamble_correlator_init(&corr, &config);
+    for (size_t i = 0; i < chips && !out->found; i++)
+    {
+        preamble_detection_t detection;
+        if (!preamble_correlator_push(&corr, metric[i], &detection))
+            continue;
+
+        char text[MAX_TEXT + 1];
+        uint32_t errors;
+        slice(g, metric, chips, detection.start_chip, text, &errors);
+        if (!out->score || !errors)
+        {
+            out->score = detection.score;
+            out->start_chip = detection.start_chip;
+            memcpy(out->text, text, sizeof(text));
+        }
+        out->found = errors == 0;
+    }
+    out->ns = bench_clock_ns() - start;
+
+    char text[MAX_TEXT + 1];
+    slice(g, metric, chips, golden_chip, text, &out->errors);
+    free(metric);
+}
+
+static float frame_power(const uint16_t *samples, size_t first, size_t last)
+{
+    double mean = 0.0;
+    double sum = 0.0;
+
+    for (size_t i = first; i < last; i++)
+        mean += samples[i];
+    mean /= (double)(last - first);
+
+    for (size_t i = first; i < last; i++)
+        sum += (samples[i] - mean) * (samples[i] - mean);
+
+    return (float)(sum / (last - first));
+}
+
+static int check_golden(golden_t *g, const char *dir, FILE *out)
+{
+    char path[512];
+    snprintf(path, sizeof(path), "%s/%s", dir, g->file);
+
+    if (capture_load(path, g->format, g->rate, SAMPLE_RATE, &g->samples, &g->count))
+    {
+        fprintf(out, "%s,,,,,,,,cannot load\n", g->file);
+        return 1;
+    }
+
+    decode_t result;
+    decode(g, g->samples, g->count, 0, &result);
+    bool ok = result.found;
+
+    if (ok)
+    {
+        double samples_per_chip = (double)SAMPLE_RATE / (g->demod.baud * OVERSAMPLE);
+        g->start_chip = result.start_chip;
+        g->frame_first = (size_t)((result.start_chip - (SYNC_BITS + 0.5) * OVERSAMPLE) * samples_per_chip);
+        g->frame_last = (size_t)((result.start_chip + (g->text_bits - 0.5) * OVERSAMPLE) * samples_per_chip);
+        if (g->frame_last > g->count)
+            g->frame_last = g->count;
+        g->frame_power = frame_power(g->samples, g->frame_first, g->frame_last);
+    }
+
+    fprintf(out, "%s,%zu,%.2f,%.2f,%.0f,%s,%s,%.2f,%s\n", g->file, g->count, (double)g->count / SAMPLE_RATE,
+            result.score, sqrt(2.0 * g->frame_power), g->text, result.text, result.ns / g->count,
+            ok ? "ok" : "FAIL");
+    return ok ? 0 : 1;
+}
+
+static void sweep_noise(const golden_t *g, int trials, synth_rng_t *rng, uint16_t *work, FILE *out)
+{
+    for (float snr_db = 21.0f; snr_db >= -6.0f; snr_db -= 3.0f)
+    {
+        float sigma = synth_noise_sigma_for_power(g->frame_power, snr_db, SAMPLE_RATE);
+        uint64_t bits = 0, errors = 0;
+        int lost = 0;
+        double ns = 0.0;
+
+        for (int t = 0; t < trials; t++)
+        {
+            decode_t result;
+            memcpy(work, g->samples, g->count * sizeof(uint16_t));
+            synth_add_noise(rng, work, g->count, sigma);
+            decode(g, work, g->count, g->start_chip, &result);
+
+            bits += g->text_bits;
+            errors += result.errors;
+            lost += !result.found;
+            ns += result.ns;
+        }
+
+        fprintf(out, "%s,%.1f,%d,%llu,%llu,%.2e,%d,%.3f,%.2f\n", g->file, snr_db, trials,
+                (unsigned long long)bits, (unsigned long long)errors, (double)errors / bits, lost,
+                (double)lost / trials, ns / trials / g->count);
+    }
+}
+
+static void sweep_offset(const golden_t *g, uint16_t *work, FILE *out)
+{
+    // Out to two thirds of the tone spacing of a 32 baud integrator bin either way.
+    for (float offset = -24.0f; offset <= 24.0f; offset += 4.0f)
+    {
+        decode_t result;
+        memcpy(work, g->samples, g->count * sizeof(uint16_t));
+        if (offset != 0.0f)
+            synth_frequency_shift(work, g->count, offset, SAMPLE_RATE);
+        decode(g, work, g->count, g->start_chip, &result);
+
+        fprintf(out, "%s,%.0f,%zu,%u,%.2e,%d,%.2f\n", g->file, offset, g->text_bits, result.errors,
+                (double)result.errors / g->text_bits, result.found, result.ns / g->count);
+    }
+}
+
+static void sweep_amplitude(const golden_t *g, uint16_t *work, FILE *out)
+{
+    const float gains[] = {1.0f / 64, 1.0f / 32, 1.0f / 16, 1.0f / 8, 1.0f / 4, 1.0f / 2, 1.0f, 2.0f, 4.0f, 8.0f, 16.0f};
+
+    for (size_t i = 0; i < sizeof(gains) / sizeof(gains[0]); i++)
+    {
+        decode_t result;
+        size_t clipped = 0;
+
+        memcpy(work, g->samples, g->count * sizeof(uint16_t));
+        synth_scale(work, g->count, gains[i]);
+        for (size_t k = g->frame_first; k < g->frame_last; k++)
+            clipped += work[k] == 0 || work[k] == 4095;
+        decode(g, work, g->count, g->start_chip, &result);
+
+        fprintf(out, "%s,%.4f,%.0f,%.1f,%u,%.2e,%d,%.2f\n", g->file, gains[i],
+                sqrt(2.0 * g->frame_power) * gains[i], 100.0 * clipped / (g->frame_last - g->frame_first),
+                result.errors, (double)result.errors / g->text_bits, result.found, result.ns / g->count);
+    }
+}
+
+static FILE *open_section(const char *prefix, const char *name, const char *comment, const char *header)
+{
+    FILE *out = stdout;
+
+    if (prefix)
+    {
+        char path[512];
+        snprintf(path, sizeof(path), "%s%s.csv", prefix, name);
+        out = fopen(path, "w");
+        if (!out)
+        {
+            fprintf(stderr, "cannot write %s\n", path);
+            out = stdout;
+        }
+    }
+
+    if (out == stdout)
+        fprintf(out, "%s# %s\n", name[0] == 'g' ? "" : "\n", comment);
+    fprintf(out, "%s\n", header);
+    return out;
+}
+
+static void close_section(FILE *out)
+{
+    if (out != stdout)
+        fclose(out);
+}
+
+int main(int argc, char **argv)
+{
+    const char *vectors = CAPTURE_VECTORS;
+    const char *dir = CAPTURE_DIR;
+    const char *prefix = NULL;
+    int trials = 10;
+    unsigned long seed = 1;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "f:d:t:o:s:")) != -1)
+    {
+        switch (opt)
+        {
+        case 'f':
+            vectors = optarg;
+            break;
+        case 'd':
+            dir = optarg;
+            break;
+        case 't':
+            trials = atoi(optarg);
+            break;
+        case 'o':
+            prefix = optarg;
+            break;
+        case 's':
+            seed = strtoul(optarg, NULL, 0);
+            break;
+        default:
+            fprintf(stderr, "usage: %s [-f vectors] [-d capture_dir] [-t trials] [-o csv_prefix] [-s seed]\n",
+                    argv[0]);
+            return 1;
+        }
+    }
+
+    static golden_t captures[MAX_CAPTURES];
+    int n = load_vectors(vectors, captures, MAX_CAPTURES);
+    if (n <= 0 || trials <= 0)
+        return 1;
+
+    synth_rng_t rng;
+    synth_rng_seed(&rng, seed);
+
+    FILE *out = open_section(prefix, "golden", "golden captures, clean decode",
+                             "capture,samples,seconds,sync_score,peak_counts,expected,decoded,ns_per_sample,result");
+    int failures = 0;
+    for (int i = 0; i < n; i++)
+        failures += check_golden(&captures[i], dir, out);
+    close_section(out);
+
+    size_t max_count = 0;
+    for (int i = 0; i < n; i++)
+        if (captures[i].count > max_count)
+            max_count = captures[i].count;
+    uint16_t *work = malloc((max_count ? max_count : 1) * sizeof(uint16_t));
+
+    out = open_section(prefix, "noise", "white noise, SNR in 3 kHz against the frame power",
+                       "capture,snr_db,trials,bits,bit_errors,ber,frames_lost,frame_loss,ns_per_sample");
+    for (int i = 0; i < n; i++)
+        if (captures[i].frame_last)
+            sweep_noise(&captures[i], trials, &rng, work, out);
+    close_section(out);
+
+    out = open_section(prefix, "offset", "frequency offset, no added noise",
+                       "capture,offset_hz,bits,bit_errors,ber,frame_ok,ns_per_sample");
+    for (int i = 0; i < n; i++)
+        if (captures[i].frame_last)
+            sweep_offset(&captures[i], work, out);
+    close_section(out);
+
+    out = open_section(prefix, "amplitude", "amplitude about mid-scale, clipped to 12 bits",
+                       "capture,gain,peak_counts,clipped_pct,bit_errors,ber,frame_ok,ns_per_sample");
+    for (int i = 0; i < n; i++)
+        if (captures[i].frame_last)
+            sweep_amplitude(&captures[i], work, out);
+    close_section(out);
+
+    for (int i = 0; i < n; i++)
+        free(captures[i].samples);
+    free(work);
+
+    if (failures)
+        printf("\n%d golden captures failed\n", failures);
+    return failures ? 1 : 0;
+}
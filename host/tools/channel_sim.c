@@ -0,0 +1,260 @@
+/**
+ * @file channel_sim.c
+ *
+ * @brief Runs TX audio through a simulated analog radio path and writes what the RX ADC sees.
+ *
+ * The input is either a capture file (-i) sent as one transmission, or
+ * frames from the TX generator (-p profile, -n frames), each sent as its
+ * own transmission with its own key-up and squelch tail. Impairments
+ * start from a preset (-m) and individual options override it. The
+ * result is written as raw samples, WAV or recorder.c records (-o, with
+ * the format from the extension or -F).
+ *
+ * Generated frames are decoded again with modem_rx, and the frames
+ * received are reported next to the channel figures.
+ *
+ * usage: channel_sim [-i in | -p profile -n frames] [-m preset] [-S snr_db] [-O offset_hz]
+ *                    [-k clock_ppm] [-e pre_us] [-d de_us] [-b low:high] [-c clip] [-D ptt_ms]
+ *                    [-t tail_ms] [-T tail_counts] [-a amplitude] [-o out] [-F raw|wav|rec] [-s seed]
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "capture.h"
+#include "channel.h"
+#include "synth.h"
+#include "modem/modem_rx.h"
+
+#define PAYLOAD_SIZE 16
+#define BLOCK 1024
+
+typedef struct received
+{
+    int frames;
+    int matched;
+    uint8_t expected[64][PAYLOAD_SIZE];
+    int sent;
+} received_t;
+
+static void frame_callback(void *ctx, const uint8_t *data, size_t len, uint8_t src_addr)
+{
+    received_t *received = ctx;
+    (void)src_addr;
+
+    received->frames++;
+    for (int f = 0; f < received->sent && len == PAYLOAD_SIZE; f++)
+    {
+        if (!memcmp(received->expected[f], data, len))
+        {
+            received->matched++;
+            break;
+        }
+    }
+}
+
+static void usage(const char *name)
+{
+    fprintf(stderr,
+            "usage: %s [-i in | -p profile -n frames] [-m clean|fm|fm-flat|fm-tail] [-S snr_db] [-O offset_hz]\n"
+            "          [-k clock_ppm] [-e pre_us] [-d de_us] [-b low:high] [-c clip] [-D ptt_ms]\n"
+            "          [-t tail_ms] [-T tail_counts] [-a amplitude] [-o out] [-F raw|wav|rec] [-s seed]\n",
+            name);
+}
+
+static uint16_t *grow(uint16_t *out, size_t *capacity, size_t needed)
+{
+    if (needed <= *capacity)
+        return out;
+
+    *capacity = needed * 2;
+    return realloc(out, *capacity * sizeof(uint16_t));
+}
+
+int main(int argc, char **argv)
+{
+    const char *input = NULL;
+    const char *output = NULL;
+    const char *format_name = NULL;
+    int profile_id = -1;
+    int frames = 4;
+    int amplitude = 600;
+    unsigned long seed = 1;
+    channel_config_t config;
+    int opt;
+
+    channel_default_config(&config);
+
+    // The preset goes first so the other options can override it.
+    for (int i = 1; i + 1 < argc; i++)
+    {
+        if (!strcmp(argv[i], "-m") && channel_preset(&config, argv[i + 1]))
+        {
+            fprintf(stderr, "unknown preset %s\n", argv[i + 1]);
+            return 1;
+        }
+    }
+
+    while ((opt = getopt(argc, argv, "i:p:n:m:S:O:k:e:d:b:c:D:t:T:a:o:F:s:")) != -1)
+    {
+        switch (opt)
+        {
+        case 'i':
+            input = optarg;
+            break;
+        case 'p':
+            profile_id = atoi(optarg);
+            break;
+        case 'n':
+            frames = atoi(optarg);
+            break;
+        case 'm':
+            break;
+        case 'S':
+            config.snr_db = strtof(optarg, NULL);
+            break;
+        case 'O':
+            config.offset_hz = strtof(optarg, NULL);
+            break;
+        case 'k':
+            config.clock_ppm = strtof(optarg, NULL);
+            break;
+        case 'e':
+            config.pre_emphasis_us = strtof(optarg, NULL);
+            break;
+        case 'd':
+            config.de_emphasis_us = strtof(optarg, NULL);
+            break;
+        case 'b':
+            if (sscanf(optarg, "%f:%f", &config.bandpass_low_hz, &config.bandpass_high_hz) != 2)
+            {
+                usage(argv[0]);
+                return 1;
+            }
+            break;
+        case 'c':
+            config.clip_counts = strtof(optarg, NULL);
+            break;
+        case 'D':
+            config.ptt_delay_ms = strtof(optarg, NULL);
+            break;
+        case 't':
+            config.squelch_tail_ms = strtof(optarg, NULL);
+            break;
+        case 'T':
+            config.squelch_tail_counts = strtof(optarg, NULL);
+            break;
+        case 'a':
+            amplitude = atoi(optarg);
+            break;
+        case 'o':
+            output = optarg;
+            break;
+        case 'F':
+            format_name = optarg;
+            break;
+        case 's':
+            seed = strtoul(optarg, NULL, 0);
+            break;
+        default:
+            usage(argv[0]);
+            return 1;
+        }
+    }
+
+    const modem_profile_t *profile = profile_id >= 0 ? modem_profile_get((modem_profile_id_t)profile_id) : NULL;
+    if ((!input && !profile) || (profile && profile_id == MODEM_PROFILE_AFSK_1200) || frames <= 0 || frames > 64)
+    {
+        usage(argv[0]);
+        return 1;
+    }
+
+    capture_format_t format = output ? capture_format_guess(output) : CAPTURE_RAW;
+    if (format_name && capture_format_parse(format_name, &format))
+    {
+        usage(argv[0]);
+        return 1;
+    }
+
+    synth_rng_t rng;
+    synth_rng_seed(&rng, seed);
+
+    static received_t received;
+    uint16_t *out = NULL;
+    size_t capacity = 0;
+    size_t total = 0;
+    channel_report_t sum = {0};
+    int transmissions = input ? 1 : frames;
+
+    for (int t = 0; t < transmissions; t++)
+    {
+        uint16_t *tx = NULL;
+        size_t count = 0;
+
+        if (input)
+        {
+            if (capture_load(input, capture_format_guess(input), config.sample_rate, config.sample_rate, &tx, &count))
+            {
+                fprintf(stderr, "cannot load %s\n", input);
+                return 1;
+            }
+        }
+        else
+        {
+            size_t max_samples = (size_t)MODEM_FRAME_MAX_BITS * profile->sample_rate / profile->baud;
+            tx = malloc(max_samples * sizeof(uint16_t));
+            for (size_t i = 0; i < PAYLOAD_SIZE; i++)
+                received.expected[t][i] = (uint8_t)synth_rng_u32(&rng);
+            count = synth_frame(profile, (int16_t)amplitude, 0x02, 0x01, received.expected[t], PAYLOAD_SIZE, tx,
+                                max_samples);
+            received.sent++;
+        }
+
+        channel_report_t report;
+        out = grow(out, &capacity, total + channel_output_size(&config, count));
+        size_t n = channel_apply(&config, &rng, tx, count, out + total, capacity - total, &report);
+        free(tx);
+        if (!out || !n)
+        {
+            fprintf(stderr, "channel failed\n");
+            return 1;
+        }
+
+        total += n;
+        sum.samples_in += report.samples_in;
+        sum.signal_power += report.signal_power / transmissions;
+        sum.noise_sigma = report.noise_sigma;
+        sum.clipped_pct += report.clipped_pct / transmissions;
+        sum.adc_clipped_pct += report.adc_clipped_pct * n;
+    }
+    sum.adc_clipped_pct /= total;
+
+    if (output && capture_save(output, format, config.sample_rate, out, total))
+    {
+        fprintf(stderr, "cannot write %s\n", output);
+        return 1;
+    }
+
+    printf("samples_in,samples_out,seconds,signal_rms,noise_sigma,tx_clipped_pct,adc_clipped_pct");
+    if (profile)
+        printf(",profile,frames_sent,frames_ok,frames_matched");
+    printf("\n%zu,%zu,%.2f,%.1f,%.1f,%.2f,%.2f", sum.samples_in, total, (double)total / config.sample_rate,
+           sqrt(sum.signal_power), sum.noise_sigma, sum.clipped_pct, sum.adc_clipped_pct);
+
+    if (profile)
+    {
+        static modem_rx_t rx;
+        modem_rx_init(&rx, profile, frame_callback, &received);
+        modem_rx_set_squelch(&rx, true, NULL);
+        for (size_t pos = 0; pos < total; pos += BLOCK)
+            modem_rx_process(&rx, out + pos, total - pos < BLOCK ? total - pos : BLOCK);
+        printf(",%s,%d,%d,%d", profile->name, received.sent, received.frames, received.matched);
+    }
+    printf("\n");
+
+    free(out);
+    return 0;
+}
@@ -0,0 +1,183 @@
+/**
+ * @file chase_gain.c
+ *
+ * @brief Gain of chase combining on repeated transmissions.
+ *
+ * Each trial sends the same frame up to -c times, each copy with its own
+ * noise, into one receiver. The tool records after how many copies the
+ * frame first came out, with and without a combiner attached (same
+ * frames, same noise), so the columns are the delivery probability after
+ * 1, 2, ... copies. bad_crc counts copies that synced but failed the CRC;
+ * the rest of the misses are lost sync words, which combining cannot help. A frame
+ * delivered with the wrong payload counts as a failure and is reported.
+ *
+ * usage: chase_gain [-t trials] [-c copies] [-s seed]
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "synth.h"
+#include "modem/modem_rx.h"
+#include "modem/chase.h"
+
+#define AMPLITUDE 600
+#define PAYLOAD_SIZE 32
+#define MAX_COPIES 8
+
+typedef struct result
+{
+    const uint8_t *expected;
+    int delivered;
+    int wrong;
+} result_t;
+
+static void frame_callback(void *ctx, const uint8_t *data, size_t len, uint8_t src_addr)
+{
+    result_t *result = ctx;
+    if (len == PAYLOAD_SIZE && !memcmp(data, result->expected, len))
+        result->delivered++;
+    else
+        result->wrong++;
+}
+
+// Returns after how many copies the frame was delivered, 0 if never.
+static int run_trial(const modem_profile_t *profile, float snr_db, int copies, chase_t *chase,
+                     synth_rng_t *rng, uint16_t *samples, size_t max_samples, int *wrong, int *bad_crc)
+{
+    static modem_rx_t rx;
+    uint8_t payload[PAYLOAD_SIZE];
+    for (size_t i = 0; i < sizeof(payload); i++)
+        payload[i] = (uint8_t)synth_rng_u32(rng);
+
+    result_t result = {.expected = payload};
+    modem_rx_init(&rx, profile, frame_callback, &result);
+    modem_rx_set_chase(&rx, chase);
+    if (chase)
+        chase_reset(chase);
+
+    float sigma = synth_noise_sigma(AMPLITUDE, snr_db, profile->sample_rate);
+    size_t gap = profile->sample_rate / 4;
+    int first = 0;
+
+    for (int c = 1; c <= copies; c++)
+    {
+        synth_idle(rng, samples, gap, 0.0f);
+        size_t n = synth_frame(profile, AMPLITUDE, 0x02, 0x01, payload, sizeof(payload), samples + gap, max_samples - 2 * gap);
+        synth_idle(rng, samples + gap + n, gap, 0.0f);
+        n += 2 * gap;
+        synth_add_noise(rng, samples, n, sigma);
+        modem_rx_process(&rx, samples, n);
+
+        if (result.delivered && !first)
+            first = c;
+    }
+
+    *wrong += result.wrong;
+    *bad_crc += rx.stats.frames_bad_crc;
+    return first;
+}
+
+static void run_point(const modem_profile_t *profile, float snr_db, int copies, int trials,
+                      chase_t *chase, synth_rng_t *rng, uint16_t *samples, size_t max_samples)
+{
+    // Both modes see the same frames and noise, so they only differ once combining helps.
+    synth_rng_t start = *rng;
+
+    for (int combine = 0; combine < 2; combine++)
+    {
+        *rng = start;
+        int by_copy[MAX_COPIES + 1] = {0};
+        int wrong = 0;
+        int bad_crc = 0;
+
+        for (int t = 0; t < trials; t++)
+        {
+            by_copy[run_trial(profile, snr_db, copies, combine ? chase : NULL, rng, samples, max_samples, &wrong, &bad_crc)]++;
+        }
+
+        printf("%s,%.1f,%s", profile->name, snr_db, combine ? "chase" : "plain");
+        int total = 0;
+        for (int c = 1; c <= copies; c++)
+        {
+            total += by_copy[c];
+            printf(",%.3f", (double)total / trials);
+        }
+        printf(",%d,%d\n", bad_crc, wrong);
+    }
+}
+
+int main(int argc, char **argv)
+{
+    int trials = 100;
+    int copies = 3;
+    unsigned long seed = 1;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "t:c:s:")) != -1)
+    {
+        switch (opt)
+        {
+        case 't':
+            trials = atoi(optarg);
+            break;
+        case 'c':
+            copies = atoi(optarg);
+            break;
+        case 's':
+            seed = strtoul(optarg, NULL, 0);
+            break;
+        default:
+            fprintf(stderr, "usage: %s [-t trials] [-c copies] [-s seed]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    if (trials <= 0 || copies < 1 || copies > MAX_COPIES)
+        return 1;
+
+    size_t max_samples = 79200 * 20;
+    uint16_t *samples = malloc(max_samples * sizeof(uint16_t));
+    static chase_t chase;
+    chase_config_t config;
+    chase_default_config(&config);
+    config.max_copies = copies < 2 ? 2 : (uint8_t)copies;
+    if (!samples || chase_init(&chase, &config))
+        return 1;
+
+    synth_rng_t rng;
+    synth_rng_seed(&rng, seed);
+
+    struct
+    {
+        modem_profile_id_t id;
+        float snr_db[4];
+    } points[] = {
+        {MODEM_PROFILE_FSK_32, {-10.5f, -9.0f, -7.5f, -6.0f}},
+        {MODEM_PROFILE_BPSK_32, {-13.5f, -12.0f, -10.5f, -9.0f}},
+        {MODEM_PROFILE_QPSK_250, {-1.5f, 0.0f, 1.5f, 3.0f}},
+    };
+
+    printf("# %d-byte frames, amplitude %d, %d trials per point, combiner %zu bytes (%d slots)\n",
+           PAYLOAD_SIZE, AMPLITUDE, trials, sizeof(chase), CHASE_MAX_SLOTS);
+    printf("profile,snr_db,mode");
+    for (int c = 1; c <= copies; c++)
+        printf(",after_%d", c);
+    printf(",bad_crc,wrong\n");
+
+    for (size_t p = 0; p < sizeof(points) / sizeof(points[0]); p++)
+    {
+        const modem_profile_t *profile = modem_profile_get(points[p].id);
+        for (int s = 0; s < 4; s++)
+            run_point(profile, points[p].snr_db[s], copies, trials, &chase, &rng, samples, max_samples);
+    }
+
+    printf("# chase stats: stored %u, combined %u, recovered %u, evicted %u, expired %u\n",
+           chase.stats.stored, chase.stats.combined, chase.stats.recovered, chase.stats.evicted, chase.stats.expired);
+
+    free(samples);
+    return 0;
+}
@@ -0,0 +1,219 @@
+/**
+ * @file correlator_sweep.c
+ *
+ * @brief Detection probability and false-alarm rate of the sync correlator versus SNR.
+ *
+ * Each trial is idle noise, a short preamble, the sync word and random data,
+ * then more noise. A detection within one chip of the true sync peak counts
+ * toward Pd; a detection before it (noise or preamble) is a false alarm. A full frame is also run
+ * through modem_rx at the same SNR to report frame success.
+ *
+ * usage: correlator_sweep [-n trials] [-p preamble_bits] [-t threshold] [-s seed]
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "bench.h"
+#include "synth.h"
+#include "modem/fsk_demod.h"
+#include "modem/fsk_mod.h"
+#include "modem/preamble_correlator.h"
+#include "modem/modem_frame.h"
+#include "modem/modem_rx.h"
+
+#define AMPLITUDE 600
+#define DATA_BITS 32
+#define MAX_TRIAL_SECONDS 10
+
+typedef struct
+{
+    int detected;
+    int false_alarms;
+    double timing_error_sq;
+} trial_result_t;
+
+static void put_bit(uint8_t *bits, size_t pos, unsigned bit)
+{
+    if (bit)
+        bits[pos >> 3] |= (uint8_t)(0x80 >> (pos & 7));
+}
+
+static trial_result_t run_trial(const modem_profile_t *profile, synth_rng_t *rng, float sigma,
+                                int preamble_bits, float threshold, uint16_t *samples, size_t max_samples,
+                                size_t *noise_chips)
+{
+    trial_result_t result = {0};
+    uint8_t bits[16] = {0};
+    size_t num_bits = 0;
+
+    for (int i = 0; i < preamble_bits; i++)
+        put_bit(bits, num_bits++, !(i & 1));
+    for (int i = MODEM_FRAME_SYNC_BITS - 1; i >= 0; i--)
+        put_bit(bits, num_bits++, (MODEM_FRAME_SYNC_WORD >> i) & 1);
+    for (int i = 0; i < DATA_BITS; i++)
+        put_bit(bits, num_bits++, synth_rng_u32(rng) & 1);
+
+    size_t lead = (size_t)(profile->sample_rate * (0.25f + 0.5f * synth_rng_uniform(rng)));
+    size_t tail = profile->sample_rate / 4;
+
+    fsk_mod_t mod;
+    fsk_mod_init(&mod, profile, AMPLITUDE);
+
+    synth_idle(rng, samples, lead, 0.0f);
+    size_t n = lead + fsk_mod_bits(&mod, bits, num_bits, samples + lead, max_samples - lead);
+    synth_idle(rng, samples + n, tail, 0.0f);
+    n += tail;
+    synth_add_noise(rng, samples, n, sigma);
+
+    fsk_demod_config_t demod_config;
+    fsk_demod_t demod;
+    fsk_demod_config_from_profile(&demod_config, profile, 0);
+    fsk_demod_init(&demod, &demod_config);
+
+    preamble_correlator_config_t corr_config = {
+        .pattern = MODEM_FRAME_SYNC_WORD,
+        .bits = MODEM_FRAME_SYNC_BITS,
+        .oversample = profile->oversample,
+        .threshold = threshold,
+    };
+    preamble_correlator_t corr;
+    preamble_correlator_init(&corr, &corr_config);
+
+    double chip_samples = (double)profile->sample_rate / profile->baud / profile->oversample;
+    size_t sync_end = lead + (size_t)lrint((preamble_bits + MODEM_FRAME_SYNC_BITS) * (double)profile->sample_rate / profile->baud);
+    double expected_chip = sync_end / chip_samples - 1.0;
+
+    fsk_chip_t chips[64];
+    size_t pos = 0;
+    while (pos < n)
+    {
+        size_t num_chips;
+        pos += fsk_demod_process(&demod, samples + pos, n - pos, chips, 64, &num_chips);
+        for (size_t i = 0; i < num_chips; i++)
+        {
+            preamble_detection_t det;
+            if (!preamble_correlator_push(&corr, chips[i].metric, &det))
+                continue;
+
+            double error = det.peak_chip - expected_chip;
+            if (!result.detected && fabs(error) <= 1.5)
+            {
+                result.detected = 1;
+                result.timing_error_sq = error * error;
+            }
+            else if (error < 0.0)
+            {
+                // Later detections land in the frame body, where a receiver is no longer hunting.
+                result.false_alarms++;
+            }
+        }
+    }
+
+    *noise_chips = (size_t)expected_chip;
+    return result;
+}
+
+static int run_frame(const modem_profile_t *profile, synth_rng_t *rng, float sigma, uint16_t *samples, size_t max_samples)
+{
+    uint8_t payload[8];
+    for (size_t i = 0; i < sizeof(payload); i++)
+        payload[i] = (uint8_t)synth_rng_u32(rng);
+
+    size_t lead = profile->sample_rate / 4;
+    synth_idle(rng, samples, lead, 0.0f);
+    size_t n = lead + synth_frame(profile, AMPLITUDE, 0x02, 0x01, payload, sizeof(payload), samples + lead, max_samples - lead);
+    synth_idle(rng, samples + n, lead, 0.0f);
+    n += lead;
+    synth_add_noise(rng, samples, n, sigma);
+
+    int frames = 0;
+    modem_rx_t *rx = malloc(sizeof(modem_rx_t));
+    modem_rx_init(rx, profile, bench_count_frame, &frames);
+    modem_rx_process(rx, samples, n);
+    free(rx);
+    return frames;
+}
+
+int main(int argc, char **argv)
+{
+    int trials = 200;
+    int preamble_bits = MODEM_FRAME_PREAMBLE_BITS;
+    float threshold = MODEM_RX_SYNC_THRESHOLD;
+    unsigned long seed = 1;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "n:p:t:s:")) != -1)
+    {
+        switch (opt)
+        {
+        case 'n':
+            trials = atoi(optarg);
+            break;
+        case 'p':
+            preamble_bits = atoi(optarg);
+            break;
+        case 't':
+            threshold = strtof(optarg, NULL);
+            break;
+        case 's':
+            seed = strtoul(optarg, NULL, 0);
+            break;
+        default:
+            fprintf(stderr, "usage: %s [-n trials] [-p preamble_bits] [-t threshold] [-s seed]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    const modem_profile_t *profile = modem_profile_get(MODEM_PROFILE_FSK_32);
+    size_t max_samples = (size_t)profile->sample_rate * MAX_TRIAL_SECONDS;
+    uint16_t *samples = malloc(max_samples * sizeof(uint16_t));
+    if (!samples || preamble_bits < 0 || preamble_bits + MODEM_FRAME_SYNC_BITS + DATA_BITS > 128)
+        return 1;
+
+    synth_rng_t rng;
+    synth_rng_seed(&rng, seed);
+
+    printf("# profile=%s preamble_bits=%d sync_bits=%d threshold=%.2f trials=%d\n",
+           profile->name, preamble_bits, MODEM_FRAME_SYNC_BITS, threshold, trials);
+    printf("snr_db,pd,false_alarms,pfa_per_chip,false_alarms_per_hour,timing_rms_chips,frame_success\n");
+
+    for (int snr = -15; snr <= 12; snr += 3)
+    {
+        float sigma = synth_noise_sigma(AMPLITUDE, (float)snr, profile->sample_rate);
+        int detected = 0;
+        int false_alarms = 0;
+        int frames_ok = 0;
+        double timing_sq = 0.0;
+        double chips_total = 0.0;
+
+        for (int t = 0; t < trials; t++)
+        {
+            size_t chips = 0;
+            trial_result_t r = run_trial(profile, &rng, sigma, preamble_bits, threshold, samples, max_samples, &chips);
+            detected += r.detected;
+            false_alarms += r.false_alarms;
+            timing_sq += r.timing_error_sq;
+            chips_total += chips;
+
+            if (t < trials / 4)
+                frames_ok += run_frame(profile, &rng, sigma, samples, max_samples) > 0;
+        }
+
+        double chip_rate = (double)profile->baud * profile->oversample;
+        printf("%d,%.3f,%d,%.2e,%.1f,%.2f,%.3f\n",
+               snr,
+               (double)detected / trials,
+               false_alarms,
+               false_alarms / chips_total,
+               false_alarms / (chips_total / chip_rate) * 3600.0,
+               detected ? sqrt(timing_sq / detected) : 0.0,
+               (double)frames_ok / (trials / 4 ? trials / 4 : 1));
+    }
+
+    free(samples);
+    return 0;
+}
@@ -0,0 +1,217 @@
+/**
+ * @file crc_bench.c
+ *
+ * @brief Frame CRC vectors and cost, software table against bitwise reference and a sniffer model.
+ *
+ * 1. Check values: "123456789" gives 0x29B1 (CCITT-FALSE) and 0x906E (X.25).
+ * 2. Random buffers of every length up to 512 bytes at odd offsets give the
+ *    same CRC from the bitwise reference, the byte table and a model of
+ *    the RP2350 DMA sniffer (MSB-first CRC-16 on bit-reversed bytes for
+ *    X.25, converted with crc_from_sniffer). The model is registered as
+ *    the crc_compute() engine, so the dispatch and its length threshold
+ *    are exercised as well.
+ * 3. Cost per buffer of the bitwise loop (the old modem_frame_crc16) and
+ *    the table at frame sizes. The DMA path itself only runs on the
+ *    device; crc_dma_benchmark() logs the same numbers there.
+ *
+ * Any mismatch exits 1.
+ *
+ * usage: crc_bench [-r rounds] [-s seed]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "bench.h"
+#include "synth.h"
+#include "modem/crc.h"
+
+#define MAX_LEN 512
+#define MODEL_MIN_BYTES 16
+
+static const char *type_names[CRC_TYPE_COUNT] = {"ccitt-false", "x25"};
+static const uint16_t check_values[CRC_TYPE_COUNT] = {0x29B1, 0x906E};
+
+static unsigned long model_calls;
+
+static uint16_t bitwise_crc(crc_type_t type, const uint8_t *data, size_t len)
+{
+    uint16_t crc = 0xFFFF;
+
+    for (size_t i = 0; i < len; i++)
+    {
+        if (type == CRC_16_X25)
+        {
+            crc ^= data[i];
+            for (int b = 0; b < 8; b++)
+                crc = (crc & 1) ? (uint16_t)((crc >> 1) ^ 0x8408) : (uint16_t)(crc >> 1);
+        }
+        else
+        {
+            crc ^= (uint16_t)data[i] << 8;
+            for (int b = 0; b < 8; b++)
+                crc = (crc & 0x8000) ? (uint16_t)((crc << 1) ^ 0x1021) : (uint16_t)(crc << 1);
+        }
+    }
+
+    return type == CRC_16_X25 ? (uint16_t)~crc : crc;
+}
+
+static uint8_t reflect8(uint8_t value)
+{
+    uint8_t out = 0;
+    for (int b = 0; b < 8; b++)
+        out |= (uint8_t)(((value >> b) & 1) << (7 - b));
+    return out;
+}
+
+// What the sniffer does in CRC16 / CRC16R mode, bit by bit.
+static int sniffer_model(crc_type_t type, const uint8_t *data, size_t len, uint16_t *crc)
+{
+    uint32_t acc = crc_sniffer_seed(type);
+
+    model_calls++;
+    for (size_t i = 0; i < len; i++)
+    {
+        uint8_t byte = crc_sniffer_reflected(type) ? reflect8(data[i]) : data[i];
+        acc ^= (uint32_t)byte << 8;
+        for (int b = 0; b < 8; b++)
+            acc = (acc & 0x8000) ? ((acc << 1) ^ 0x1021) & 0xFFFF : (acc << 1) & 0xFFFF;
+    }
+
+    *crc = crc_from_sniffer(type, acc);
+    return 0;
+}
+
+static int run_vectors(synth_rng_t *rng)
+{
+    static uint8_t buffer[MAX_LEN + 1];
+    const uint8_t check[] = "123456789";
+    int failures = 0;
+
+    printf("type,check,expected,bitwise,table,model,result\n");
+    for (int type = 0; type < CRC_TYPE_COUNT; type++)
+    {
+        uint16_t model;
+        uint16_t bitwise = bitwise_crc(type, check, 9);
+        uint16_t table = crc_software(type, check, 9);
+        sniffer_model(type, check, 9, &model);
+        int ok = bitwise == check_values[type] && table == check_values[type] && model == check_values[type];
+        failures += !ok;
+        printf("%s,123456789,0x%04X,0x%04X,0x%04X,0x%04X,%s\n", type_names[type], check_values[type], bitwise,
+               table, model, ok ? "ok" : "FAIL");
+    }
+
+    for (size_t i = 0; i < sizeof(buffer); i++)
+        buffer[i] = (uint8_t)synth_rng_u32(rng);
+
+    crc_set_engine(sniffer_model, MODEL_MIN_BYTES);
+    model_calls = 0;
+
+    int random_failures = 0;
+    unsigned long buffers = 0;
+    for (int type = 0; type < CRC_TYPE_COUNT; type++)
+    {
+        for (size_t len = 0; len <= MAX_LEN; len++)
+        {
+            const uint8_t *data = buffer + (len & 1);
+            uint16_t expected = bitwise_crc(type, data, len);
+            uint16_t model;
+            sniffer_model(type, data, len, &model);
+            buffers++;
+
+            if (crc_software(type, data, len) != expected || model != expected ||
+                crc_compute(type, data, len) != expected)
+            {
+                if (!random_failures)
+                    printf("mismatch: %s, %zu bytes\n", type_names[type], len);
+                random_failures++;
+            }
+        }
+    }
+
+    crc_set_engine(NULL, 0);
+
+    // One direct call per buffer, plus one through crc_compute() above the threshold.
+    unsigned long expected_calls = buffers + CRC_TYPE_COUNT * (MAX_LEN + 1 - MODEL_MIN_BYTES);
+    int dispatch_ok = model_calls == expected_calls;
+
+    printf("\nbuffers,mismatches,engine_calls,expected_engine_calls,result\n");
+    printf("%lu,%d,%lu,%lu,%s\n", buffers, random_failures, model_calls, expected_calls,
+           !random_failures && dispatch_ok ? "ok" : "FAIL");
+
+    return failures + random_failures + !dispatch_ok;
+}
+
+static void run_cost(int rounds, synth_rng_t *rng)
+{
+    static uint8_t buffer[MAX_LEN];
+    size_t lengths[] = {16, 64, 133, 330, 512};
+    volatile uint16_t sink = 0;
+
+    for (size_t i = 0; i < sizeof(buffer); i++)
+        buffer[i] = (uint8_t)synth_rng_u32(rng);
+
+    printf("\n# cost, %d rounds\n", rounds);
+    printf("type,bytes,bitwise_ns,table_ns,speedup,table_ns_per_byte\n");
+    for (int type = 0; type < CRC_TYPE_COUNT; type++)
+    {
+        for (size_t l = 0; l < sizeof(lengths) / sizeof(lengths[0]); l++)
+        {
+            size_t len = lengths[l];
+
+            double start = bench_clock_ns();
+            for (int r = 0; r < rounds; r++)
+                sink = bitwise_crc(type, buffer, len);
+            double bitwise = (bench_clock_ns() - start) / rounds;
+
+            start = bench_clock_ns();
+            for (int r = 0; r < rounds; r++)
+                sink = crc_software(type, buffer, len);
+            double table = (bench_clock_ns() - start) / rounds;
+
+            printf("%s,%zu,%.1f,%.1f,%.1f,%.2f\n", type_names[type], len, bitwise, table, bitwise / table,
+                   table / len);
+        }
+    }
+
+    (void)sink;
+}
+
+int main(int argc, char **argv)
+{
+    int rounds = 20000;
+    unsigned long seed = 1;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "r:s:")) != -1)
+    {
+        switch (opt)
+        {
+        case 'r':
+            rounds = atoi(optarg);
+            break;
+        case 's':
+            seed = strtoul(optarg, NULL, 0);
+            break;
+        default:
+            fprintf(stderr, "usage: %s [-r rounds] [-s seed]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    if (rounds <= 0)
+        return 1;
+
+    synth_rng_t rng;
+    synth_rng_seed(&rng, seed);
+
+    int failures = run_vectors(&rng);
+    run_cost(rounds, &rng);
+
+    if (failures)
+        printf("\n%d CRC checks failed\n", failures);
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,631 @@
+/**
+ * @file infra_bench.c
+ *
+ * @brief Cost of the non-DSP paths that run on every loop or request: ADC ring, HTTP parsing, UI JSON.
+ *
+ * Each microbenchmark runs the firmware's own code on fixed inputs:
+ *
+ *   adc_hal_isr                         a 1024-sample DMA transfer landing and the
+ *                                       real adc_hal.c interrupt handler (stub DMA)
+ *   adc_hal_get_samples                 copying 1024 samples out of the ring
+ *   adc_bsp_get_data                    fetching 3072 samples, feeding the waterfall
+ *                                       and link test and pushing them one by one
+ *   circular_buffer_push                the push loop of adc_bsp_get_data alone
+ *   http_request_complete/get, /post    a browser GET and a form POST
+ *   parse_http_request/get, /post       the same two requests
+ *   url_decode                          a 100-character form body
+ *   messages_to_json/typical, /full     the 32-message history
+ *
+ * Work that only sets an input up again (refilling the ring, copying a
+ * request that the parser splits in place) is done outside the timed
+ * region. Each benchmark runs -r times for about -t seconds in all; the
+ * median and the fastest ns/op are reported.
+ *
+ * Allocations are counted by wrapping malloc, calloc and realloc at link
+ * time (GNU ld), so only calls from the firmware and tool code count, not
+ * libc's own. Where the linker cannot wrap they are reported as -1.
+ *
+ * One CSV row per benchmark on stdout. -o writes the same results as JSON,
+ * one benchmark per line; -c reads such a file from an earlier run (say,
+ * another commit) and adds the change in ns/op. -l labels the run, e.g.
+ * with `git rev-parse --short HEAD`.
+ *
+ * usage: infra_bench [-t seconds] [-r repeats] [-f filter] [-o out.json] [-c baseline.json] [-l label]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "bench.h"
+#include "hal_stub.h"
+#include "adc_hal.h"
+#include "adc_bsp.h"
+#include "adc_bsp_tap.h"
+#include "network/http.h"
+#include "ui/messages.h"
+#include "ui/waterfall.h"
+#include "ui/link_test.h"
+
+#define CHUNK 1024          // adc_bsp's DMA transfer
+#define RING_CHUNKS 7       // adc_hal keeps 8 chunks and one slot free
+#define BSP_SAMPLES 3072    // adc_bsp's read size
+#define REQUEST_COPIES 64
+#define REQUEST_SIZE 2048   // TCP_CONNECT_STATE_T.request
+#define MAX_BENCHES 32
+#define MAX_REPEATS 64
+#define NAME_LEN 64
+
+// ---- Allocation counting ----
+
+static int counting = 0;
+static unsigned long alloc_calls = 0;
+static unsigned long alloc_bytes = 0;
+
+#ifdef INFRA_BENCH_WRAP_MALLOC
+void *__real_malloc(size_t size);
+void *__real_calloc(size_t count, size_t size);
+void *__real_realloc(void *ptr, size_t size);
+
+void *__wrap_malloc(size_t size)
+{
+    if (counting)
+    {
+        alloc_calls++;
+        alloc_bytes += size;
+    }
+    return __real_malloc(size);
+}
+
+void *__wrap_calloc(size_t count, size_t size)
+{
+    if (counting)
+    {
+        alloc_calls++;
+        alloc_bytes += count * size;
+    }
+    return __real_calloc(count, size);
+}
+
+void *__wrap_realloc(void *ptr, size_t size)
+{
+    if (counting)
+    {
+        alloc_calls++;
+        alloc_bytes += size;
+    }
+    return __real_realloc(ptr, size);
+}
+#endif
+
+// ---- Inputs ----
+
+static const char get_request[] =
+    "GET /spectrum?since=1234 HTTP/1.1\r\n"
+    "Host: 192.168.4.1\r\n"
+    "User-Agent: Mozilla/5.0 (X11; Linux x86_64; rv:128.0) Gecko/20100101 Firefox/128.0\r\n"
+    "Accept: */*\r\n"
+    "Accept-Language: en-US,en;q=0.5\r\n"
+    "Accept-Encoding: gzip, deflate\r\n"
+    "Referer: http://192.168.4.1/\r\n"
+    "Connection: keep-alive\r\n"
+    "\r\n";
+
+static const char post_request[] =
+    "POST /send HTTP/1.1\r\n"
+    "Host: 192.168.4.1\r\n"
+    "User-Agent: Mozilla/5.0 (X11; Linux x86_64; rv:128.0) Gecko/20100101 Firefox/128.0\r\n"
+    "Accept: */*\r\n"
+    "Accept-Language: en-US,en;q=0.5\r\n"
+    "Accept-Encoding: gzip, deflate\r\n"
+    "Content-Type: application/x-www-form-urlencoded\r\n"
+    "Content-Length: 100\r\n"
+    "Origin: http://192.168.4.1\r\n"
+    "Connection: keep-alive\r\n"
+    "Referer: http://192.168.4.1/\r\n"
+    "\r\n"
+    "QTH+grid+FN42%2C+running+5+W+into+a+dipole.+Copy+%3F+73%21+%28de+N0CALL%29+-+see+you+on+the+net+okay";
+
+static const char *form_body;
+
+static uint16_t adc_samples[BSP_SAMPLES];
+static uint16_t adc_scratch[BSP_SAMPLES];
+static uint16_t bsp_storage[BSP_SAMPLES + CHUNK];
+static circular_buffer_t bsp_buffer;
+
+static char requests[REQUEST_COPIES][REQUEST_SIZE];
+static const char *request_source;
+static int request_next;
+static http_request_t parsed;
+
+static message_t messages[MESSAGES_MAX];
+static char json[HTML_MAX_CONTENTS];
+static char decoded[HTML_MAX_QUERY_LEN];
+
+static volatile size_t sink;
+
+static void make_samples(void)
+{
+    // A fixed tone-ish pattern; the ring and parser costs do not depend on it.
+    for (int i = 0; i < BSP_SAMPLES; i++)
+        adc_samples[i] = (uint16_t)(2048 + ((i * 37) % 1024) - 512);
+}
+
+static void make_messages(size_t text_len)
+{
+    for (int i = 0; i < MESSAGES_MAX; i++)
+    {
+        snprintf(messages[i].name, sizeof(messages[i].name), "N%dCALL", i % 10);
+        snprintf(messages[i].time, sizeof(messages[i].time), "12:%02d:%02d", i, (i * 7) % 60);
+        for (size_t c = 0; c < text_len; c++)
+            messages[i].message[c] = (char)('a' + (c + i) % 26);
+        messages[i].message[text_len] = '\0';
+    }
+}
+
+// ---- Benchmarks ----
+
+typedef struct bench
+{
+    const char *name;
+    size_t items;              // samples or bytes handled per op
+    size_t bytes;              // bytes moved per op, for MB/s
+    void (*setup)(void);
+    int (*refill)(void);       // untimed; ops the next batch may run, 0 for no limit
+    void (*op)(void);
+    void (*teardown)(void);
+} bench_t;
+
+static void adc_setup(void)
+{
+    hal_stub_reset();
+    adc_hal_init();
+    adc_hal_set_sample_rate(79200);
+    adc_hal_set_sample_size(CHUNK);
+    adc_hal_start();
+}
+
+static void adc_teardown(void)
+{
+    adc_hal_deinit();
+}
+
+static void adc_drain(void)
+{
+    int fetched;
+    do
+    {
+        adc_hal_get_samples(adc_scratch, BSP_SAMPLES, &fetched);
+    } while (fetched > 0);
+}
+
+static int isr_refill(void)
+{
+    adc_drain();
+    return RING_CHUNKS;
+}
+
+static void isr_op(void)
+{
+    sink = hal_stub_adc_push(adc_samples, CHUNK);
+}
+
+static int get_samples_refill(void)
+{
+    adc_drain();
+    for (int i = 0; i < RING_CHUNKS; i++)
+        hal_stub_adc_push(adc_samples, CHUNK);
+    return RING_CHUNKS;
+}
+
+static void get_samples_op(void)
+{
+    int fetched;
+    adc_hal_get_samples(adc_scratch, CHUNK, &fetched);
+    sink = (size_t)fetched;
+}
+
+// As the firmware's main registers it.
+static void bsp_tap(const uint16_t *samples, size_t count)
+{
+    waterfall_feed(samples, count);
+    link_test_feed(samples, count);
+}
+
+static void bsp_setup(void)
+{
+    hal_stub_reset();
+    adc_bsp_init(79200);
+    waterfall_init(79200);
+    adc_bsp_set_tap(bsp_tap);
+    circular_buffer_init(&bsp_buffer, bsp_storage, sizeof(uint16_t), BSP_SAMPLES + CHUNK);
+}
+
+static int bsp_refill(void)
+{
+    circular_buffer_clear(&bsp_buffer);
+    adc_drain();
+    for (int i = 0; i < BSP_SAMPLES / CHUNK; i++)
+        hal_stub_adc_push(adc_samples, CHUNK);
+    return 1; // one read empties the ring
+}
+
+static void bsp_op(void)
+{
+    sink = (size_t)adc_bsp_get_data(&bsp_buffer);
+}
+
+static void push_setup(void)
+{
+    circular_buffer_init(&bsp_buffer, bsp_storage, sizeof(uint16_t), BSP_SAMPLES + CHUNK);
+}
+
+static int push_refill(void)
+{
+    circular_buffer_clear(&bsp_buffer);
+    return 1;
+}
+
+static void push_op(void)
+{
+    // As adc_bsp_get_data does after the fetch.
+    for (int i = 0; i < BSP_SAMPLES; i++)
+    {
+        if (circular_buffer_push(&bsp_buffer, &adc_samples[i]))
+            break;
+    }
+    sink = bsp_buffer.count;
+}
+
+static void complete_get_op(void)
+{
+    sink = http_request_complete(get_request, sizeof(get_request) - 1);
+}
+
+static void complete_post_op(void)
+{
+    sink = http_request_complete(post_request, sizeof(post_request) - 1);
+}
+
+static int parse_refill(void)
+{
+    for (int i = 0; i < REQUEST_COPIES; i++)
+        strcpy(requests[i], request_source);
+    request_next = 0;
+    return REQUEST_COPIES;
+}
+
+static void parse_get_setup(void)
+{
+    request_source = get_request;
+}
+
+static void parse_post_setup(void)
+{
+    request_source = post_request;
+}
+
+static void parse_op(void)
+{
+    sink = (size_t)parse_http_request(requests[request_next++], &parsed);
+}
+
+static void url_decode_op(void)
+{
+    url_decode(decoded, form_body);
+    sink = (size_t)decoded[0];
+}
+
+static void messages_typical_setup(void)
+{
+    make_messages(60);
+}
+
+static void messages_full_setup(void)
+{
+    make_messages(sizeof(messages[0].message) - 1);
+}
+
+static void messages_op(void)
+{
+    sink = messages_to_json(messages, MESSAGES_MAX, json, sizeof(json));
+}
+
+static const bench_t benches[] = {
+    {"adc_hal_isr", CHUNK, CHUNK * sizeof(uint16_t), adc_setup, isr_refill, isr_op, adc_teardown},
+    {"adc_hal_get_samples", CHUNK, CHUNK * sizeof(uint16_t), adc_setup, get_samples_refill, get_samples_op,
+     adc_teardown},
+    {"adc_bsp_get_data", BSP_SAMPLES, BSP_SAMPLES * sizeof(uint16_t), bsp_setup, bsp_refill, bsp_op, adc_teardown},
+    {"circular_buffer_push", BSP_SAMPLES, BSP_SAMPLES * sizeof(uint16_t), push_setup, push_refill, push_op, NULL},
+    {"http_request_complete/get", sizeof(get_request) - 1, sizeof(get_request) - 1, NULL, NULL, complete_get_op,
+     NULL},
+    {"http_request_complete/post", sizeof(post_request) - 1, sizeof(post_request) - 1, NULL, NULL,
+     complete_post_op, NULL},
+    {"parse_http_request/get", sizeof(get_request) - 1, sizeof(get_request) - 1, parse_get_setup, parse_refill,
+     parse_op, NULL},
+    {"parse_http_request/post", sizeof(post_request) - 1, sizeof(post_request) - 1, parse_post_setup,
+     parse_refill, parse_op, NULL},
+    {"url_decode", 100, 100, NULL, NULL, url_decode_op, NULL},
+    {"messages_to_json/typical", MESSAGES_MAX, 0, messages_typical_setup, NULL, messages_op, NULL},
+    {"messages_to_json/full", MESSAGES_MAX, 0, messages_full_setup, NULL, messages_op, NULL},
+};
+
+#define BENCH_COUNT (sizeof(benches) / sizeof(benches[0]))
+#define BATCH 256 // ops between clock reads when nothing needs refilling
+
+typedef struct result
+{
+    unsigned long ops;
+    double ns_per_op;          // median of the repeats
+    double ns_min;             // fastest repeat
+    double allocs_per_op;
+    double alloc_bytes_per_op;
+    size_t json_bytes;         // output size, for the JSON benchmarks
+} result_t;
+
+static int compare_double(const void *a, const void *b)
+{
+    double x = *(const double *)a;
+    double y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+// Runs batches until budget_ns of timed work is done; returns ns/op.
+static double run_repeat(const bench_t *bench, double budget_ns, unsigned long *ops)
+{
+    double timed = 0.0;
+    unsigned long count = 0;
+
+    while (timed < budget_ns)
+    {
+        int batch = bench->refill ? bench->refill() : 0;
+        if (batch <= 0)
+            batch = BATCH;
+
+        counting = 1;
+        double start = bench_clock_ns();
+        for (int i = 0; i < batch; i++)
+            bench->op();
+        timed += bench_clock_ns() - start;
+        counting = 0;
+
+        count += (unsigned long)batch;
+    }
+
+    *ops += count;
+    return timed / count;
+}
+
+static void run_bench(const bench_t *bench, double seconds, int repeats, result_t *result)
+{
+    double per_repeat[MAX_REPEATS];
+    unsigned long ops = 0;
+
+    if (bench->setup)
+        bench->setup();
+
+    // Warm the caches and branch predictors; the counters start after.
+    run_repeat(bench, seconds * 1e9 / repeats / 10, &ops);
+    ops = 0;
+    alloc_calls = 0;
+    alloc_bytes = 0;
+
+    for (int r = 0; r < repeats; r++)
+        per_repeat[r] = run_repeat(bench, seconds * 1e9 / repeats, &ops);
+
+    result->json_bytes = bench->op == messages_op ? strlen(json) : 0;
+
+    if (bench->teardown)
+        bench->teardown();
+
+    qsort(per_repeat, (size_t)repeats, sizeof(double), compare_double);
+    result->ops = ops;
+    result->ns_per_op = repeats % 2 ? per_repeat[repeats / 2]
+                                    : 0.5 * (per_repeat[repeats / 2 - 1] + per_repeat[repeats / 2]);
+    result->ns_min = per_repeat[0];
+#ifdef INFRA_BENCH_WRAP_MALLOC
+    result->allocs_per_op = (double)alloc_calls / ops;
+    result->alloc_bytes_per_op = (double)alloc_bytes / ops;
+#else
+    result->allocs_per_op = -1.0;
+    result->alloc_bytes_per_op = -1.0;
+#endif
+}
+
+// ---- Baseline ----
+
+typedef struct baseline
+{
+    char name[NAME_LEN];
+    double ns_per_op;
+} baseline_t;
+
+// Reads the "name" and "ns_per_op" of each result line of a file written by -o.
+static int load_baseline(const char *path, baseline_t *baseline, int max)
+{
+    FILE *file = fopen(path, "r");
+    char line[512];
+    int n = 0;
+
+    if (!file)
+        return -1;
+
+    while (n < max && fgets(line, sizeof(line), file))
+    {
+        const char *name = strstr(line, "\"name\": \"");
+        const char *ns = strstr(line, "\"ns_per_op\": ");
+        if (!name || !ns)
+            continue;
+
+        name += strlen("\"name\": \"");
+        const char *end = strchr(name, '"');
+        if (!end || end - name >= NAME_LEN)
+            continue;
+
+        memcpy(baseline[n].name, name, (size_t)(end - name));
+        baseline[n].name[end - name] = '\0';
+        baseline[n].ns_per_op = atof(ns + strlen("\"ns_per_op\": "));
+        n++;
+    }
+
+    fclose(file);
+    return n;
+}
+
+static const baseline_t *find_baseline(const baseline_t *baseline, int count, const char *name)
+{
+    for (int i = 0; i < count; i++)
+    {
+        if (strcmp(baseline[i].name, name) == 0)
+            return &baseline[i];
+    }
+    return NULL;
+}
+
+// ---- Output ----
+
+static int write_json(const char *path, const char *label, double seconds, int repeats, const result_t *results,
+                      const int *selected)
+{
+    FILE *file = fopen(path, "w");
+    int first = 1;
+
+    if (!file)
+        return -1;
+
+    fprintf(file, "{\n  \"tool\": \"infra_bench\",\n  \"label\": \"%s\",\n  \"seconds\": %g,\n  \"repeats\": %d,\n",
+            label, seconds, repeats);
+#ifdef INFRA_BENCH_WRAP_MALLOC
+    fprintf(file, "  \"allocations_counted\": true,\n");
+#else
+    fprintf(file, "  \"allocations_counted\": false,\n");
+#endif
+    fprintf(file, "  \"results\": [\n");
+
+    for (size_t b = 0; b < BENCH_COUNT; b++)
+    {
+        if (!selected[b])
+            continue;
+
+        const result_t *r = &results[b];
+        fprintf(file,
+                "%s    {\"name\": \"%s\", \"ns_per_op\": %.2f, \"ns_min\": %.2f, \"ops\": %lu, \"items_per_op\": %zu, "
+                "\"bytes_per_op\": %zu, \"allocs_per_op\": %.3f, \"alloc_bytes_per_op\": %.1f}",
+                first ? "" : ",\n", benches[b].name, r->ns_per_op, r->ns_min, r->ops, benches[b].items,
+                benches[b].bytes ? benches[b].bytes : r->json_bytes, r->allocs_per_op, r->alloc_bytes_per_op);
+        first = 0;
+    }
+
+    fprintf(file, "\n  ]\n}\n");
+    return fclose(file) ? -1 : 0;
+}
+
+static void usage(const char *name)
+{
+    fprintf(stderr, "usage: %s [-t seconds] [-r repeats] [-f filter] [-o out.json] [-c baseline.json] [-l label]\n",
+            name);
+}
+
+int main(int argc, char **argv)
+{
+    double seconds = 0.5;
+    int repeats = 5;
+    const char *filter = NULL;
+    const char *output = NULL;
+    const char *compare = NULL;
+    const char *label = "";
+    baseline_t baseline[MAX_BENCHES];
+    int baseline_count = 0;
+    result_t results[BENCH_COUNT];
+    int selected[BENCH_COUNT];
+    int opt;
+
+    while ((opt = getopt(argc, argv, "t:r:f:o:c:l:")) != -1)
+    {
+        switch (opt)
+        {
+        case 't':
+            seconds = atof(optarg);
+            break;
+        case 'r':
+            repeats = atoi(optarg);
+            break;
+        case 'f':
+            filter = optarg;
+            break;
+        case 'o':
+            output = optarg;
+            break;
+        case 'c':
+            compare = optarg;
+            break;
+        case 'l':
+            label = optarg;
+            break;
+        default:
+            usage(argv[0]);
+            return 1;
+        }
+    }
+
+    if (seconds <= 0.0 || repeats < 1 || repeats > MAX_REPEATS || strchr(label, '"') || strchr(label, '\\'))
+    {
+        usage(argv[0]);
+        return 1;
+    }
+
+    if (compare)
+    {
+        baseline_count = load_baseline(compare, baseline, MAX_BENCHES);
+        if (baseline_count < 0)
+        {
+            fprintf(stderr, "cannot read %s\n", compare);
+            return 1;
+        }
+    }
+
+    make_samples();
+    form_body = strstr(post_request, "\r\n\r\n") + 4;
+
+    printf("# %.2f s per benchmark in %d repeats%s%s\n", seconds, repeats, *label ? ", " : "", label);
+    printf("name,ops,ns_per_op,ns_min,items_per_op,ns_per_item,mb_per_s,allocs_per_op,alloc_bytes_per_op%s\n",
+           compare ? ",baseline_ns,change_pct" : "");
+
+    for (size_t b = 0; b < BENCH_COUNT; b++)
+    {
+        const bench_t *bench = &benches[b];
+        result_t *r = &results[b];
+
+        selected[b] = !filter || strstr(bench->name, filter);
+        if (!selected[b])
+            continue;
+
+        run_bench(bench, seconds, repeats, r);
+
+        size_t bytes = bench->bytes ? bench->bytes : r->json_bytes;
+        printf("%s,%lu,%.1f,%.1f,%zu,%.3f,%.1f,%.3f,%.1f", bench->name, r->ops, r->ns_per_op, r->ns_min,
+               bench->items, r->ns_per_op / bench->items, bytes * 1e3 / r->ns_per_op, r->allocs_per_op,
+               r->alloc_bytes_per_op);
+
+        if (compare)
+        {
+            const baseline_t *base = find_baseline(baseline, baseline_count, bench->name);
+            if (base && base->ns_per_op > 0.0)
+                printf(",%.1f,%+.1f", base->ns_per_op, 100.0 * (r->ns_per_op / base->ns_per_op - 1.0));
+            else
+                printf(",,");
+        }
+
+        printf("\n");
+        fflush(stdout);
+    }
+
+    if (output && write_json(output, label, seconds, repeats, results, selected))
+    {
+        fprintf(stderr, "cannot write %s\n", output);
+        return 1;
+    }
+
+    return 0;
+}
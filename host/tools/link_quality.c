@@ -0,0 +1,185 @@
+/**
+ * @file link_quality.c
+ *
+ * @brief Calibration of the per-frame link quality reported by modem_rx.
+ *
+ * Frames are sent at a range of channel SNRs (3 kHz bandwidth) and the
+ * values from modem_rx_frame_info are compared with what was transmitted:
+ * decision SNR against channel SNR, tone envelopes against the amplitude,
+ * the PSK loop's offset against the injected one, and the sync word
+ * timestamp against its true position. Samples are handed over in
+ * 1024-sample blocks on a simulated clock, as the firmware does, so the
+ * latency column is the buffering delay.
+ *
+ * usage: link_quality [-t trials] [-s seed]
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "synth.h"
+#include "modem/modem_rx.h"
+#include "modem/link_stats.h"
+
+#define AMPLITUDE 600
+#define BLOCK 1024
+
+typedef struct result
+{
+    int frames;
+    modem_rx_frame_info_t info;
+} result_t;
+
+static uint64_t sim_time_us;
+
+static uint64_t sim_clock_us(void)
+{
+    return sim_time_us;
+}
+
+static modem_rx_t rx;
+
+static void frame_callback(void *ctx, const uint8_t *data, size_t len, uint8_t src_addr)
+{
+    result_t *result = ctx;
+    result->frames++;
+    result->info = *modem_rx_frame_info(&rx);
+}
+
+typedef struct totals
+{
+    int frames;
+    double snr_db;
+    double mark;
+    double space;
+    double offset_hz;
+    double start_error;
+    double latency_us;
+} totals_t;
+
+static void run_point(const modem_profile_t *profile, float snr_db, float offset_hz, int trials,
+                      synth_rng_t *rng, uint16_t *samples, size_t max_samples, link_stats_t *peers)
+{
+    modem_profile_t tx = *profile;
+    tx.carrier_hz += offset_hz;
+    totals_t totals = {0};
+    uint8_t payload[32];
+
+    for (int t = 0; t < trials; t++)
+    {
+        for (size_t i = 0; i < sizeof(payload); i++)
+            payload[i] = (uint8_t)synth_rng_u32(rng);
+
+        size_t lead = profile->sample_rate / 4 + synth_rng_u32(rng) % BLOCK;
+        synth_idle(rng, samples, lead, 0.0f);
+        size_t n = synth_frame(&tx, AMPLITUDE, 0x02, 0x01, payload, sizeof(payload), samples + lead, max_samples - 2 * lead);
+        synth_idle(rng, samples + lead + n, lead, 0.0f);
+        n += 2 * lead;
+        synth_add_noise(rng, samples, n, synth_noise_sigma(AMPLITUDE, snr_db, profile->sample_rate));
+
+        result_t result = {0};
+        modem_rx_init(&rx, profile, frame_callback, &result);
+        modem_rx_set_clock(&rx, sim_clock_us);
+
+        for (size_t pos = 0; pos < n; pos += BLOCK)
+        {
+            size_t count = n - pos < BLOCK ? n - pos : BLOCK;
+            sim_time_us = (uint64_t)(pos + count) * 1000000 / profile->sample_rate;
+            modem_rx_process(&rx, samples + pos, count);
+        }
+
+        if (result.frames != 1)
+            continue;
+
+        double sync_start = lead + (double)MODEM_FRAME_PREAMBLE_BITS * profile->sample_rate / profile->baud;
+        totals.frames++;
+        totals.snr_db += result.info.snr_db;
+        totals.mark += result.info.mark_level;
+        totals.space += result.info.space_level;
+        totals.offset_hz += result.info.offset_hz;
+        totals.start_error += fabs((double)result.info.first_sample - sync_start);
+        totals.latency_us += result.info.latency_us;
+        link_stats_update(peers, 0x01, &result.info, result.info.timestamp_us);
+    }
+
+    if (!totals.frames)
+    {
+        printf("%s,%.0f,%.1f,0,,,,,,\n", profile->name, snr_db, offset_hz);
+        return;
+    }
+
+    double k = totals.frames;
+    double symbol = (double)profile->sample_rate / profile->baud;
+    printf("%s,%.0f,%.1f,%d,%.1f,%.0f,%.0f,%.1f,%.2f,%.1f\n", profile->name, snr_db, offset_hz, totals.frames,
+           totals.snr_db / k, totals.mark / k, totals.space / k, totals.offset_hz / k,
+           totals.start_error / k / symbol, totals.latency_us / k / 1000.0);
+}
+
+int main(int argc, char **argv)
+{
+    int trials = 10;
+    unsigned long seed = 1;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "t:s:")) != -1)
+    {
+        switch (opt)
+        {
+        case 't':
+            trials = atoi(optarg);
+            break;
+        case 's':
+            seed = strtoul(optarg, NULL, 0);
+            break;
+        default:
+            fprintf(stderr, "usage: %s [-t trials] [-s seed]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    size_t max_samples = 79200 * 40;
+    uint16_t *samples = malloc(max_samples * sizeof(uint16_t));
+    if (!samples || trials <= 0)
+        return 1;
+
+    synth_rng_t rng;
+    synth_rng_seed(&rng, seed);
+
+    modem_profile_id_t ids[] = {
+        MODEM_PROFILE_FSK_32,
+        MODEM_PROFILE_MFSK4_32,
+        MODEM_PROFILE_BPSK_32,
+        MODEM_PROFILE_QPSK_250,
+    };
+
+    printf("# 32-byte frames, amplitude %d, %d trials per point\n", AMPLITUDE, trials);
+    printf("profile,channel_snr_db,offset_hz,frames,decision_snr_db,mark,space,offset_est_hz,start_error_symbols,latency_ms\n");
+
+    for (size_t p = 0; p < sizeof(ids) / sizeof(ids[0]); p++)
+    {
+        const modem_profile_t *profile = modem_profile_get(ids[p]);
+        link_stats_t peers;
+        link_stats_init(&peers);
+
+        for (int snr = 0; snr <= 30; snr += 6)
+            run_point(profile, (float)snr, 0.0f, trials, &rng, samples, max_samples, &peers);
+
+        if (profile->modulation == MODEM_MOD_BPSK || profile->modulation == MODEM_MOD_QPSK)
+        {
+            float offset = profile->baud / (10.0f * modem_profile_bits_per_symbol(profile));
+            run_point(profile, 18.0f, offset, trials, &rng, samples, max_samples, &peers);
+            run_point(profile, 18.0f, -offset, trials, &rng, samples, max_samples, &peers);
+        }
+
+        const link_peer_t *peer = link_stats_find(&peers, 0x01);
+        if (peer)
+            printf("# %s peer table: frames %u, snr %.1f dB (min %.1f), mark %.0f, space %.0f\n", profile->name,
+                   peer->frames, peer->snr_db, peer->snr_min_db, peer->mark_level, peer->space_level);
+    }
+
+    free(samples);
+    return 0;
+}
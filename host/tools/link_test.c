@@ -0,0 +1,177 @@
+/**
+ * @file link_test.c
+ *
+ * @brief PRBS link test on a simulated channel.
+ *
+ * 1. Checker: PRBS-9 and PRBS-15 bits with errors injected at a known rate
+ *    go straight into the checker. It must lock and measure the injected
+ *    BER to within 20%, and must not lock on random bits. Failures exit 1.
+ * 2. Link: the prbs_link transmitter is modulated, noise is added and the
+ *    receiver runs on 1024-sample blocks, closing a second every second of
+ *    samples as the firmware does. The receiver starts partway into the
+ *    first burst, so it has to pick the stream up at the next sync word.
+ *
+ * usage: link_test [-d seconds] [-s seed]
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "synth.h"
+#include "modem/fsk_mod.h"
+#include "modem/prbs_link.h"
+
+#define AMPLITUDE 600
+#define BLOCK 1024
+#define CHECKER_BITS 200000
+
+static int run_checker(prbs_type_t type, synth_rng_t *rng)
+{
+    double rates[] = {0.0, 1e-4, 1e-3, 1e-2, 5e-2};
+    int failures = 0;
+
+    for (size_t r = 0; r < sizeof(rates) / sizeof(rates[0]); r++)
+    {
+        prbs_t tx;
+        prbs_checker_t checker;
+        prbs_init(&tx, type);
+        prbs_checker_init(&checker, type);
+
+        // Start at an arbitrary point of the sequence.
+        for (uint32_t skip = synth_rng_u32(rng) % 40000; skip; skip--)
+            prbs_next(&tx);
+
+        uint64_t injected = 0;
+        uint64_t injected_locked = 0;
+        int lock_bit = -1;
+        for (int i = 0; i < CHECKER_BITS; i++)
+        {
+            unsigned bit = prbs_next(&tx);
+            bool flip = synth_rng_uniform(rng) < rates[r];
+            injected += flip;
+            if (checker.locked)
+                injected_locked += flip;
+            if (prbs_checker_push(&checker, bit ^ flip) && lock_bit < 0)
+                lock_bit = i;
+        }
+
+        double expected = (double)injected_locked / (double)checker.stats.bits;
+        double measured = prbs_checker_ber(&checker);
+        bool ok = lock_bit >= 0 && fabs(measured - expected) <= 0.2 * expected + 1e-9;
+        failures += !ok;
+
+        printf("%s,%.0e,%d,%llu,%llu,%.3e,%.3e,%u,%s\n", prbs_name(type), rates[r], lock_bit,
+               (unsigned long long)checker.stats.bits, (unsigned long long)injected, expected, measured,
+               checker.stats.sync_losses, ok ? "ok" : "FAIL");
+    }
+
+    prbs_checker_t checker;
+    prbs_checker_init(&checker, type);
+    for (int i = 0; i < CHECKER_BITS; i++)
+        prbs_checker_push(&checker, synth_rng_u32(rng) & 1);
+
+    // Random bits may chance a short lock, but must not stay locked.
+    bool ok = checker.stats.bits < CHECKER_BITS / 100;
+    failures += !ok;
+    printf("%s,random,,%llu,,,,%u,%s\n", prbs_name(type), (unsigned long long)checker.stats.bits,
+           checker.stats.sync_losses, ok ? "ok" : "FAIL");
+
+    return failures;
+}
+
+static void run_link(const modem_profile_t *profile, prbs_type_t type, float snr_db, int seconds, synth_rng_t *rng)
+{
+    static prbs_link_tx_t tx;
+    static prbs_link_rx_t link;
+    fsk_mod_t mod;
+    uint32_t burst_bits = prbs_link_burst_bits(profile);
+
+    prbs_link_tx_init(&tx, profile, type, burst_bits);
+    prbs_link_rx_init(&link, profile, type, burst_bits);
+    fsk_mod_init(&mod, profile, AMPLITUDE);
+
+    size_t max_samples = (size_t)profile->sample_rate * (seconds + 1);
+    uint16_t *samples = malloc(max_samples * sizeof(uint16_t));
+    size_t n = 0;
+    while (n + fsk_mod_symbol_samples(&mod) <= max_samples)
+        n += fsk_mod_symbol(&mod, prbs_link_tx_symbol(&tx), samples + n, max_samples - n);
+    synth_add_noise(rng, samples, n, synth_noise_sigma(AMPLITUDE, snr_db, profile->sample_rate));
+
+    // Join a third of the way into the first burst.
+    size_t start = (size_t)((double)burst_bits / modem_profile_bit_rate(profile) / 3.0 * profile->sample_rate);
+    size_t next_second = start + profile->sample_rate;
+    int first_lock = -1;
+
+    for (size_t pos = start; pos + BLOCK <= n; pos += BLOCK)
+    {
+        prbs_link_rx_process(&link, samples + pos, BLOCK);
+        if (pos + BLOCK >= next_second)
+        {
+            prbs_link_rx_second(&link);
+            next_second += profile->sample_rate;
+            if (first_lock < 0 && link.checker.locked)
+                first_lock = (int)link.checker.stats.seconds;
+        }
+    }
+
+    const prbs_stats_t *stats = &link.checker.stats;
+    printf("%s,%s,%.1f,%u,%d,%llu,%llu,%.2e,%u,%u,%u,%u,%u,%u,%.1f,%u\n", profile->name, prbs_name(type), snr_db,
+           stats->seconds, first_lock, (unsigned long long)stats->bits, (unsigned long long)stats->errors,
+           prbs_checker_ber(&link.checker), stats->error_free_seconds, stats->errored_seconds,
+           stats->unsynced_seconds, stats->sync_losses, link.bursts, link.false_syncs,
+           prbs_link_rx_throughput(&link), modem_profile_bit_rate(profile));
+
+    free(samples);
+}
+
+int main(int argc, char **argv)
+{
+    int seconds = 60;
+    unsigned long seed = 1;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "d:s:")) != -1)
+    {
+        switch (opt)
+        {
+        case 'd':
+            seconds = atoi(optarg);
+            break;
+        case 's':
+            seed = strtoul(optarg, NULL, 0);
+            break;
+        default:
+            fprintf(stderr, "usage: %s [-d seconds] [-s seed]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    if (seconds < 2 * PRBS_LINK_BURST_SECONDS)
+        return 1;
+
+    synth_rng_t rng;
+    synth_rng_seed(&rng, seed);
+
+    printf("# checker, %d bits per run\n", CHECKER_BITS);
+    printf("prbs,injected_ber,lock_bit,bits,injected,expected_ber,measured_ber,sync_losses,result\n");
+    int failures = run_checker(PRBS_9, &rng) + run_checker(PRBS_15, &rng);
+
+    printf("\n# link, %d s, amplitude %d, receiver joins mid-burst\n", seconds, AMPLITUDE);
+    printf("profile,prbs,snr_db,seconds,first_lock_s,bits,errors,ber,efs,es,unsynced_s,sync_losses,bursts,false_syncs,throughput_bps,bit_rate\n");
+
+    modem_profile_id_t ids[] = {MODEM_PROFILE_FSK_32, MODEM_PROFILE_MFSK4_32, MODEM_PROFILE_QPSK_250};
+    float snr_db[] = {-3.0f, -3.0f, 6.0f}; // highest of four points, 3 dB apart
+    for (size_t p = 0; p < sizeof(ids) / sizeof(ids[0]); p++)
+    {
+        const modem_profile_t *profile = modem_profile_get(ids[p]);
+        for (int s = 0; s < 4; s++)
+            run_link(profile, p % 2 ? PRBS_9 : PRBS_15, snr_db[p] - 3.0f * s, seconds, &rng);
+    }
+
+    if (failures)
+        printf("\n%d checker runs failed\n", failures);
+    return failures ? 1 : 0;
+}
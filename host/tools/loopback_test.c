@@ -0,0 +1,117 @@
+/**
+ * @file loopback_test.c
+ *
+ * @brief The firmware's TX to RX loopback self-test, run on the host.
+ *
+ * ui/loopback.c as built into the firmware, on the stub HAL and the real
+ * adc_hal ring: each frame is modulated a buffer at a time, injected into
+ * the ring and read back into modem_rx with the squelch on. One CSV row per
+ * profile with frames decoded, latency from the first sample entering the
+ * ring, wall time on each side, and the highest baud the profile's tones
+ * still decode at (-m percent of the frames, in real time on this host).
+ *
+ * Without noise every frame must decode, with nothing overwritten in the
+ * ring, or it exits 1; with -S the rows are for reading only.
+ *
+ * usage: loopback_test [-p profile] [-n frames] [-b payload] [-S snr_db] [-g gap_s] [-s seed] [-m percent]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "bench.h"
+#include "ui/loopback.h"
+
+int main(int argc, char **argv)
+{
+    int profile_id = -1;
+    unsigned frames = 10;
+    size_t payload = 16;
+    float snr_db = LOOPBACK_NO_NOISE;
+    float gap_s = 0.5f;
+    unsigned long seed = 1;
+    unsigned min_success = LOOPBACK_MIN_SUCCESS;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "p:n:b:S:g:s:m:")) != -1)
+    {
+        switch (opt)
+        {
+        case 'p':
+            profile_id = atoi(optarg);
+            break;
+        case 'n':
+            frames = (unsigned)atoi(optarg);
+            break;
+        case 'b':
+            payload = (size_t)atoi(optarg);
+            break;
+        case 'S':
+            snr_db = strtof(optarg, NULL);
+            break;
+        case 'g':
+            gap_s = strtof(optarg, NULL);
+            break;
+        case 's':
+            seed = strtoul(optarg, NULL, 0);
+            break;
+        case 'm':
+            min_success = (unsigned)atoi(optarg);
+            break;
+        default:
+            fprintf(stderr, "usage: %s [-p profile] [-n frames] [-b payload] [-S snr_db] [-g gap_s] [-s seed] [-m percent]\n",
+                    argv[0]);
+            return 1;
+        }
+    }
+
+    if (profile_id >= MODEM_PROFILE_COUNT || profile_id == MODEM_PROFILE_AFSK_1200)
+    {
+        fprintf(stderr, "profile %d has no modem_frame framing\n", profile_id);
+        return 1;
+    }
+
+    if (snr_db < LOOPBACK_NO_NOISE)
+        printf("# %u frames of %zu bytes, %.1f dB SNR, %.2f s gaps\n", frames, payload, snr_db, gap_s);
+    else
+        printf("# %u frames of %zu bytes, no noise, %.2f s gaps\n", frames, payload, gap_s);
+    printf("profile,sent,ok,bad_crc,wrong,dropped,air_s,latency_mean_ms,latency_max_ms,delay_mean_ms,tx_s,rx_s,"
+           "x_realtime,baud,max_baud\n");
+
+    int failures = 0;
+    for (int id = 0; id < MODEM_PROFILE_COUNT; id++)
+    {
+        if ((profile_id >= 0 && id != profile_id) || id == MODEM_PROFILE_AFSK_1200)
+            continue;
+
+        const modem_profile_t *profile = modem_profile_get((modem_profile_id_t)id);
+        loopback_config_t config;
+        loopback_report_t report;
+
+        loopback_default_config(&config, (modem_profile_id_t)id, bench_clock_ns);
+        config.frames = frames;
+        config.payload = payload;
+        config.snr_db = snr_db;
+        config.gap_s = gap_s;
+        config.seed = (uint32_t)seed;
+
+        if (loopback_run(&config, &report))
+        {
+            fprintf(stderr, "%s: loopback failed\n", profile->name);
+            return 1;
+        }
+
+        printf("%s,%u,%u,%u,%u,%llu,%.2f,%.1f,%.1f,%.1f,%.4f,%.4f,%.1f,%u,%u\n", profile->name, report.sent,
+               report.ok, report.bad_crc, report.wrong, (unsigned long long)report.dropped, report.air_s,
+               report.latency_mean_ms, report.latency_max_ms, report.delay_mean_ms, report.tx_s, report.rx_s,
+               report.x_realtime, profile->baud, (unsigned)loopback_max_baud(&config, min_success));
+
+        if (snr_db >= LOOPBACK_NO_NOISE && (report.ok != report.sent || report.wrong || report.dropped))
+            failures++;
+    }
+
+    if (failures)
+        printf("\n%d profiles lost frames\n", failures);
+    return failures ? 1 : 0;
+}
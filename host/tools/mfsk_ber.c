@@ -0,0 +1,178 @@
+/**
+ * @file mfsk_ber.c
+ *
+ * @brief Bit rate, BER and demodulator cost of 4-FSK / 8-FSK against binary FSK.
+ *
+ * All profiles transmit a single tone at the same amplitude, so equal SNR
+ * (signal power in a 3 kHz bandwidth) means equal transmit power. BER uses
+ * decisions at the known symbol centres; frame success runs full frames
+ * through modem_rx.
+ *
+ * usage: mfsk_ber [-n symbols] [-s seed]
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "bench.h"
+#include "synth.h"
+#include "modem/fsk_demod.h"
+#include "modem/fsk_mod.h"
+#include "modem/mfsk.h"
+#include "modem/modem_rx.h"
+#include "modem/tone_bank.h"
+
+#define AMPLITUDE 600
+#define LEAD_SYMBOLS 2
+#define FRAME_TRIALS 10
+
+static double demod_ns;
+static double demod_samples;
+
+// Hard decisions (bits_per_symbol each) at every chip.
+static size_t demodulate(const modem_profile_t *profile, const uint16_t *samples, size_t n,
+                         uint8_t *decisions, size_t max_chips)
+{
+    size_t num_chips = 0;
+    double start = bench_clock_ns();
+
+    if (profile->modulation == MODEM_MOD_MFSK)
+    {
+        tone_bank_config_t config = {
+            .sample_rate = profile->sample_rate,
+            .baud = profile->baud,
+            .oversample = profile->oversample,
+            .tones = profile->tones,
+            .tone_hz = profile->mfsk_hz,
+        };
+        tone_bank_t bank;
+        tone_bank_chip_t *chips = malloc(max_chips * sizeof(tone_bank_chip_t));
+        float soft[MODEM_MAX_SYMBOL_BITS];
+
+        tone_bank_init(&bank, &config);
+        tone_bank_process(&bank, samples, n, chips, max_chips, &num_chips);
+        for (size_t i = 0; i < num_chips; i++)
+            decisions[i] = (uint8_t)mfsk_soft_bits(chips[i].energy, profile->tones, chips[i].total, soft);
+        free(chips);
+    }
+    else
+    {
+        fsk_demod_config_t config;
+        fsk_demod_t demod;
+        fsk_chip_t *chips = malloc(max_chips * sizeof(fsk_chip_t));
+
+        fsk_demod_config_from_profile(&config, profile, 0);
+        fsk_demod_init(&demod, &config);
+        fsk_demod_process(&demod, samples, n, chips, max_chips, &num_chips);
+        for (size_t i = 0; i < num_chips; i++)
+            decisions[i] = chips[i].metric > 0.0f;
+        free(chips);
+    }
+
+    demod_ns += bench_clock_ns() - start;
+    demod_samples += n;
+    return num_chips;
+}
+
+static double run_ber(const modem_profile_t *profile, synth_rng_t *rng, float snr_db, int symbols,
+                      uint16_t *samples, size_t max_samples)
+{
+    uint8_t bits = modem_profile_bits_per_symbol(profile);
+    uint8_t *sent = malloc(symbols);
+    fsk_mod_t mod;
+    fsk_mod_init(&mod, profile, AMPLITUDE);
+
+    size_t n = 0;
+    for (int s = 0; s < LEAD_SYMBOLS + symbols; s++)
+    {
+        unsigned symbol = synth_rng_u32(rng) & ((1u << bits) - 1);
+        if (s >= LEAD_SYMBOLS)
+            sent[s - LEAD_SYMBOLS] = (uint8_t)symbol;
+        n += fsk_mod_symbol(&mod, symbol, samples + n, max_samples - n);
+    }
+    synth_add_noise(rng, samples, n, synth_noise_sigma(AMPLITUDE, snr_db, profile->sample_rate));
+
+    double sps = (double)profile->sample_rate / profile->baud;
+    double chip_samples = sps / profile->oversample;
+    size_t max_chips = (size_t)(n / chip_samples) + 2;
+    uint8_t *decisions = malloc(max_chips);
+    size_t num_chips = demodulate(profile, samples, n, decisions, max_chips);
+
+    long errors = 0;
+    for (int s = 0; s < symbols; s++)
+    {
+        size_t chip = (size_t)lround((LEAD_SYMBOLS + s + 1) * sps / chip_samples) - 1;
+        if (chip >= num_chips)
+            break;
+        errors += __builtin_popcount(decisions[chip] ^ sent[s]);
+    }
+
+    free(decisions);
+    free(sent);
+    return (double)errors / ((double)symbols * bits);
+}
+
+int main(int argc, char **argv)
+{
+    int symbols = 1000;
+    unsigned long seed = 1;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "n:s:")) != -1)
+    {
+        switch (opt)
+        {
+        case 'n':
+            symbols = atoi(optarg);
+            break;
+        case 's':
+            seed = strtoul(optarg, NULL, 0);
+            break;
+        default:
+            fprintf(stderr, "usage: %s [-n symbols] [-s seed]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    size_t max_samples = 79200 * (size_t)(symbols / 32 + 60);
+    uint16_t *samples = malloc(max_samples * sizeof(uint16_t));
+    if (!samples || symbols <= 0)
+        return 1;
+
+    synth_rng_t rng;
+    synth_rng_seed(&rng, seed);
+
+    printf("# %d symbols per point, amplitude %d\n", symbols, AMPLITUDE);
+    printf("profile,bit_rate,snr_db,ber,frame_success,frame_airtime_s\n");
+
+    modem_profile_id_t ids[] = {MODEM_PROFILE_FSK_32, MODEM_PROFILE_MFSK4_32, MODEM_PROFILE_MFSK8_32};
+    double cost[3];
+
+    for (size_t p = 0; p < 3; p++)
+    {
+        const modem_profile_t *profile = modem_profile_get(ids[p]);
+        demod_ns = 0.0;
+        demod_samples = 0.0;
+
+        for (int snr = -15; snr <= 6; snr += 3)
+        {
+            double airtime = 0.0;
+            double ber = run_ber(profile, &rng, (float)snr, symbols, samples, max_samples);
+            bench_trial_t trial = {.amplitude = AMPLITUDE, .snr_db = (float)snr, .reference = BENCH_SNR_PEAK};
+            double success = bench_frame_success(profile, &trial, FRAME_TRIALS, &rng, samples, max_samples, &airtime);
+            printf("%s,%u,%d,%.5f,%.2f,%.2f\n", profile->name, (unsigned)modem_profile_bit_rate(profile),
+                   snr, ber, success, airtime);
+        }
+
+        cost[p] = demod_ns / demod_samples;
+    }
+
+    printf("\nprofile,demod_ns_per_sample\n");
+    for (size_t p = 0; p < 3; p++)
+        printf("%s,%.2f\n", modem_profile_get(ids[p])->name, cost[p]);
+
+    free(samples);
+    return 0;
+}
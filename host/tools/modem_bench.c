@@ -0,0 +1,297 @@
+/**
+ * @file modem_bench.c
+ *
+ * @brief Receive throughput on a recorded capture, through the stub HAL.
+ *
+ * The capture (raw little-endian uint16 ADC samples at 79.2 kHz, as
+ * scripts/record.py writes) is followed by synthetic frames of the chosen
+ * profile with noise, so the frame path is timed too. Samples are fed to
+ * the stub ADC ring in DMA-sized chunks and read back the way adc_bsp
+ * does, while the virtual clock advances by the capture time of each
+ * chunk. Everything read goes to modem_rx with the squelch on, timing
+ * each stage with modem_rx_set_timer.
+ *
+ * Reports samples per second, frames decoded and time per sample for
+ * each stage. Then the link test transmitter runs for ten virtual seconds
+ * against the stub DAC and PTT, and must write one tone per symbol. Exits
+ * 1 if fewer frames than were synthesized decode or the transmitter is
+ * off.
+ *
+ * usage: modem_bench [-f capture.raw] [-p profile] [-n frames] [-l loops] [-q] [-s seed]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "bench.h"
+#include "hal_stub.h"
+#include "synth.h"
+#include "adc_hal.h"
+#include "HAL_time.h"
+#include "modem/modem_rx.h"
+#include "ui/link_test.h"
+
+#ifndef MODEM_BENCH_CAPTURE
+#define MODEM_BENCH_CAPTURE "scripts/recorded_data/capture.raw"
+#endif
+
+#define CHUNK 1024           // adc_bsp sample size
+#define READ_MAX (CHUNK * 3) // adc_bsp read buffer
+#define AMPLITUDE 600
+#define FRAME_SNR_DB 15.0f
+#define PAYLOAD_SIZE 16
+#define TX_SECONDS 10
+
+typedef struct bench
+{
+    uint64_t samples;
+    double acquire_ns;
+    double total_ns;
+    modem_rx_timing_t timing;
+    modem_rx_stats_t stats;
+    uint64_t overwritten;
+} bench_t;
+
+static int data_ready;
+
+static void sample_callback(size_t size)
+{
+    (void)size;
+    data_ready = 1;
+}
+
+static uint16_t *load_capture(const char *path, size_t extra, size_t *count)
+{
+    FILE *file = fopen(path, "rb");
+    if (!file)
+    {
+        fprintf(stderr, "cannot open %s\n", path);
+        return NULL;
+    }
+
+    fseek(file, 0, SEEK_END);
+    long bytes = ftell(file);
+    fseek(file, 0, SEEK_SET);
+
+    size_t n = bytes > 0 ? (size_t)bytes / sizeof(uint16_t) : 0;
+    uint16_t *samples = malloc((n + extra) * sizeof(uint16_t));
+    if (!samples || fread(samples, sizeof(uint16_t), n, file) != n)
+    {
+        fprintf(stderr, "cannot read %s\n", path);
+        free(samples);
+        fclose(file);
+        return NULL;
+    }
+
+    fclose(file);
+    *count = n;
+    return samples;
+}
+
+static size_t append_frames(const modem_profile_t *profile, int frames, synth_rng_t *rng, uint16_t *out,
+                            size_t max_samples)
+{
+    size_t gap = profile->sample_rate / 2;
+    size_t n = 0;
+
+    for (int f = 0; f < frames; f++)
+    {
+        uint8_t payload[PAYLOAD_SIZE];
+        for (size_t i = 0; i < sizeof(payload); i++)
+            payload[i] = (uint8_t)synth_rng_u32(rng);
+
+        synth_idle(rng, out + n, gap, 0.0f);
+        n += gap;
+        n += synth_frame(profile, AMPLITUDE, 0x02, 0x01, payload, sizeof(payload), out + n, max_samples - n - gap);
+    }
+
+    synth_idle(rng, out + n, gap, 0.0f);
+    n += gap;
+    synth_add_noise(rng, out, n, synth_noise_sigma(AMPLITUDE, FRAME_SNR_DB, profile->sample_rate));
+    return n;
+}
+
+static void run_receive(const modem_profile_t *profile, const uint16_t *samples, size_t count, bool squelch,
+                        bench_t *bench)
+{
+    static modem_rx_t rx;
+    static uint16_t block[READ_MAX];
+    uint64_t chunk_us = (uint64_t)CHUNK * 1000000 / profile->sample_rate;
+
+    hal_stub_reset();
+    adc_hal_init();
+    adc_hal_set_sample_rate((int)profile->sample_rate);
+    adc_hal_set_sample_size(CHUNK);
+    adc_hal_set_callback(sample_callback);
+    adc_hal_start();
+
+    modem_rx_init(&rx, profile, bench_count_frame, NULL);
+    modem_rx_set_squelch(&rx, squelch, NULL);
+    modem_rx_set_clock(&rx, HAL_get_current_time_us);
+    modem_rx_set_timer(&rx, bench_clock_ns);
+
+    for (size_t pos = 0; pos < count; pos += CHUNK)
+    {
+        size_t n = count - pos < CHUNK ? count - pos : CHUNK;
+
+        double start = bench_clock_ns();
+        hal_stub_adc_push(samples + pos, n);
+        hal_stub_advance_us(chunk_us);
+
+        int fetched = 0;
+        if (data_ready)
+        {
+            data_ready = 0;
+            adc_hal_get_samples(block, READ_MAX, &fetched);
+        }
+        double acquired = bench_clock_ns();
+
+        if (fetched > 0)
+            modem_rx_process(&rx, block, (size_t)fetched);
+
+        bench->acquire_ns += acquired - start;
+        bench->total_ns += bench_clock_ns() - start;
+        bench->samples += (uint64_t)fetched;
+    }
+
+    bench->timing.squelch_ns += rx.timing.squelch_ns;
+    bench->timing.front_ns += rx.timing.front_ns;
+    bench->timing.chips_ns += rx.timing.chips_ns;
+    bench->timing.blocks += rx.timing.blocks;
+    bench->stats = rx.stats;
+    bench->overwritten += hal_stub_adc_overwritten();
+    adc_hal_deinit();
+}
+
+static int run_transmit(void)
+{
+    const modem_profile_t *profile = modem_profile_get(MODEM_PROFILE_FSK_32);
+
+    hal_stub_reset();
+    if (link_test_init(LINK_TEST_TRANSMIT, MODEM_PROFILE_FSK_32, PRBS_15))
+        return 1;
+
+    uint32_t calls = 0;
+    double start = bench_clock_ns();
+    for (uint64_t t = 0; t < (uint64_t)TX_SECONDS * 1000000; t += 1000)
+    {
+        hal_stub_set_time_us(t);
+        link_test_task();
+        calls++;
+    }
+    double elapsed = bench_clock_ns() - start;
+    link_test_init(LINK_TEST_OFF, MODEM_PROFILE_FSK_32, PRBS_15);
+
+    // Symbol n is due at n / baud, so ten seconds hold baud * 10 of them after symbol 0.
+    uint32_t expected = (uint32_t)profile->baud * TX_SECONDS;
+    bool ok = hal_stub_dac_writes() == expected && hal_stub_ptt() && hal_stub_ptt_keyups() == 1;
+
+    printf("\n# transmit, link test on the stub DAC and PTT, %d virtual seconds\n", TX_SECONDS);
+    printf("profile,task_calls,ns_per_task,dac_writes,expected,ptt,result\n");
+    printf("%s,%u,%.1f,%u,%u,%d,%s\n", profile->name, calls, elapsed / calls, hal_stub_dac_writes(), expected,
+           hal_stub_ptt(), ok ? "ok" : "FAIL");
+    return ok ? 0 : 1;
+}
+
+int main(int argc, char **argv)
+{
+    const char *path = MODEM_BENCH_CAPTURE;
+    int profile_id = MODEM_PROFILE_FSK_32;
+    int frames = 8;
+    int loops = 5;
+    bool squelch = true;
+    unsigned long seed = 1;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "f:p:n:l:qs:")) != -1)
+    {
+        switch (opt)
+        {
+        case 'f':
+            path = optarg;
+            break;
+        case 'p':
+            profile_id = atoi(optarg);
+            break;
+        case 'n':
+            frames = atoi(optarg);
+            break;
+        case 'l':
+            loops = atoi(optarg);
+            break;
+        case 'q':
+            squelch = false;
+            break;
+        case 's':
+            seed = strtoul(optarg, NULL, 0);
+            break;
+        default:
+            fprintf(stderr, "usage: %s [-f capture.raw] [-p profile] [-n frames] [-l loops] [-q] [-s seed]\n",
+                    argv[0]);
+            return 1;
+        }
+    }
+
+    const modem_profile_t *profile = modem_profile_get((modem_profile_id_t)profile_id);
+    if (!profile || profile_id == MODEM_PROFILE_AFSK_1200 || frames < 0 || loops <= 0)
+        return 1;
+
+    synth_rng_t rng;
+    synth_rng_seed(&rng, seed);
+
+    // Room for the frames and their half-second gaps, at no more than one bit per symbol.
+    size_t frame_bits = MODEM_FRAME_PREAMBLE_BITS + MODEM_FRAME_SYNC_BITS + modem_frame_body_size(PAYLOAD_SIZE) * 8;
+    size_t frame_samples = (frame_bits + 1) * profile->sample_rate / profile->baud;
+    size_t extra = (size_t)frames * frame_samples + (size_t)(frames + 1) * (profile->sample_rate / 2);
+    size_t captured = 0;
+    uint16_t *samples = load_capture(path, extra, &captured);
+    if (!samples)
+        return 1;
+    size_t count = captured + append_frames(profile, frames, &rng, samples + captured, extra);
+
+    bench_t bench = {0};
+    for (int l = 0; l < loops; l++)
+        run_receive(profile, samples, count, squelch, &bench);
+
+    double seconds = (double)count / profile->sample_rate;
+    double per_sample = bench.total_ns / bench.samples;
+    bool frames_ok = bench.stats.frames_ok >= (uint32_t)frames;
+
+    printf("# %s: %zu samples (%.2f s) + %d %s frames at %.0f dB, %d loops, squelch %s\n", path, captured,
+           (double)captured / profile->sample_rate, frames, profile->name, FRAME_SNR_DB, loops,
+           squelch ? "on" : "off");
+    printf("profile,samples,seconds,frames_ok,frames_sent,bad_crc,sync_detects,gated_pct,overwritten,"
+           "ns_per_sample,samples_per_s,x_realtime\n");
+    printf("%s,%zu,%.2f,%u,%d,%u,%u,%.1f,%llu,%.2f,%.0f,%.0f\n", profile->name, count, seconds,
+           bench.stats.frames_ok, frames, bench.stats.frames_bad_crc, bench.stats.sync_detects,
+           100.0 * bench.stats.samples_gated / count, (unsigned long long)bench.overwritten, per_sample,
+           1e9 / per_sample, 1e9 / per_sample / profile->sample_rate);
+
+    double stages[] = {
+        bench.acquire_ns,
+        (double)bench.timing.squelch_ns,
+        (double)bench.timing.front_ns,
+        (double)bench.timing.chips_ns,
+    };
+    const char *names[] = {"acquire", "squelch", "front_end", "sync_slice_frame"};
+    double accounted = 0.0;
+
+    printf("\n# per stage\n");
+    printf("stage,ns_per_sample,share_pct\n");
+    for (size_t s = 0; s < sizeof(stages) / sizeof(stages[0]); s++)
+    {
+        printf("%s,%.2f,%.1f\n", names[s], stages[s] / bench.samples, 100.0 * stages[s] / bench.total_ns);
+        accounted += stages[s];
+    }
+    printf("other,%.2f,%.1f\n", (bench.total_ns - accounted) / bench.samples,
+           100.0 * (bench.total_ns - accounted) / bench.total_ns);
+
+    int failures = run_transmit() + !frames_ok;
+    free(samples);
+
+    if (!frames_ok)
+        printf("\nonly %u of %d frames decoded\n", bench.stats.frames_ok, frames);
+    return failures ? 1 : 0;
+}
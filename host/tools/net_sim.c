@@ -0,0 +1,157 @@
+/**
+ * @file net_sim.c
+ *
+ * @brief Throughput, collisions and latency of a shared channel as the number of nodes grows.
+ *
+ * Runs the network simulator (host/common/netsim.h) once per node count.
+ * Every run uses the same seed, so a change to CSMA or the modem can be
+ * compared run for run. One CSV row per node count.
+ *
+ * usage: net_sim [-N 2,5,10,...] [-p profile] [-t seconds] [-L frames_per_hour] [-b payload]
+ *                [-a area_km] [-S ref_snr_db] [-e exponent] [-d txdelay_ms] [-l slot_ms]
+ *                [-P persist] [-q queue] [-A] [-s seed]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "netsim.h"
+
+#define MAX_RUNS 32
+
+static void usage(const char *name)
+{
+    fprintf(stderr,
+            "usage: %s [-N 2,5,10,...] [-p profile] [-t seconds] [-L frames_per_hour] [-b payload]\n"
+            "          [-a area_km] [-S ref_snr_db] [-e exponent] [-d txdelay_ms] [-l slot_ms]\n"
+            "          [-P persist] [-q queue] [-A] [-s seed]\n",
+            name);
+}
+
+static int parse_counts(const char *text, unsigned *counts, int max)
+{
+    int n = 0;
+    char *end;
+
+    while (*text && n < max)
+    {
+        long value = strtol(text, &end, 10);
+        if (end == text || value < 2 || value > NETSIM_MAX_NODES)
+            return -1;
+        counts[n++] = (unsigned)value;
+        text = *end == ',' ? end + 1 : end;
+        if (*end && *end != ',')
+            return -1;
+    }
+
+    return n;
+}
+
+int main(int argc, char **argv)
+{
+    netsim_config_t config;
+    unsigned counts[MAX_RUNS] = {2, 5, 10, 20, 50, 100};
+    int runs = 6;
+    int opt;
+
+    netsim_default_config(&config);
+
+    while ((opt = getopt(argc, argv, "N:p:t:L:b:a:S:e:d:l:P:q:As:")) != -1)
+    {
+        switch (opt)
+        {
+        case 'N':
+            runs = parse_counts(optarg, counts, MAX_RUNS);
+            if (runs <= 0)
+            {
+                usage(argv[0]);
+                return 1;
+            }
+            break;
+        case 'p':
+            config.profile = (modem_profile_id_t)atoi(optarg);
+            break;
+        case 't':
+            config.seconds = atof(optarg);
+            break;
+        case 'L':
+            config.frames_per_hour = atof(optarg);
+            break;
+        case 'b':
+            config.payload = (size_t)atoi(optarg);
+            break;
+        case 'a':
+            config.area_km = atof(optarg);
+            break;
+        case 'S':
+            config.ref_snr_db = atof(optarg);
+            break;
+        case 'e':
+            config.path_loss_exponent = atof(optarg);
+            break;
+        case 'd':
+            config.csma.txdelay_us = (uint32_t)(atof(optarg) * 1000.0);
+            break;
+        case 'l':
+            config.csma.slot_us = (uint32_t)(atof(optarg) * 1000.0);
+            break;
+        case 'P':
+            config.csma.persist = (uint8_t)atoi(optarg);
+            break;
+        case 'q':
+            config.queue = (unsigned)atoi(optarg);
+            break;
+        case 'A':
+            config.carrier_sense = false;
+            config.csma.persist = 255;
+            break;
+        case 's':
+            config.seed = strtoull(optarg, NULL, 0);
+            break;
+        default:
+            usage(argv[0]);
+            return 1;
+        }
+    }
+
+    const modem_profile_t *profile = modem_profile_get(config.profile);
+    // afsk-1200 is HDLC framed; every other profile sends modem_frame frames.
+    if (!profile || config.profile == MODEM_PROFILE_AFSK_1200)
+    {
+        usage(argv[0]);
+        return 1;
+    }
+
+    printf("# %s, %.0f s, %.1f frames/h/node, %zu byte payload, %.1f km square, %.0f dB at 1 km, exponent %.1f, "
+           "%s txdelay %u ms slot %u ms persist %u\n",
+           profile->name, config.seconds, config.frames_per_hour, config.payload, config.area_km, config.ref_snr_db,
+           config.path_loss_exponent, config.carrier_sense ? "csma" : "aloha", config.csma.txdelay_us / 1000,
+           config.csma.slot_us / 1000, config.csma.persist);
+    printf("nodes,isolated,offered,queue_drops,sent,delivered,delivery_pct,collided,collision_pct,overheard,bad_crc,"
+           "offered_erlangs,busy_pct,throughput_bps,latency_mean_s,latency_p50_s,latency_p95_s,busy_slots,"
+           "wall_s,x_realtime\n");
+
+    for (int r = 0; r < runs; r++)
+    {
+        netsim_report_t report;
+        config.nodes = counts[r];
+        if (netsim_run(&config, &report))
+        {
+            fprintf(stderr, "simulation of %u nodes failed\n", counts[r]);
+            return 1;
+        }
+
+        printf("%u,%u,%u,%u,%u,%u,%.1f,%u,%.1f,%u,%u,%.3f,%.1f,%.2f,%.2f,%.2f,%.2f,%u,%.2f,%.1f\n", report.nodes,
+               report.isolated, report.offered, report.queue_drops, report.sent, report.delivered,
+               report.sent ? 100.0 * report.delivered / report.sent : 0.0, report.collided,
+               report.sent ? 100.0 * report.collided / report.sent : 0.0, report.overheard, report.bad_crc,
+               report.offered_erlangs, 100.0 * report.busy_fraction, report.throughput_bps, report.latency_mean_s,
+               report.latency_p50_s, report.latency_p95_s, report.busy_slots, report.wall_s,
+               report.seconds / report.wall_s);
+        fflush(stdout);
+    }
+
+    return 0;
+}
@@ -0,0 +1,164 @@
+/**
+ * @file psk_bench.c
+ *
+ * @brief Loopback checks, frame success and demodulator cost of the PSK profiles.
+ *
+ * 1. Bit-exact loopback: frames of every payload length are modulated,
+ *    optionally shifted in carrier frequency and noised at a high SNR, and
+ *    must come out of modem_rx byte for byte. Any mismatch fails the run.
+ * 2. Frame success against SNR (3 kHz bandwidth), with fsk-32 as reference.
+ * 3. Demodulator cost per symbol: wall time and, on x86, TSC cycles.
+ *
+ * usage: psk_bench [-t trials] [-s seed]
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+#include "bench.h"
+#include "synth.h"
+#include "modem/modem_rx.h"
+#include "modem/psk_demod.h"
+
+#define AMPLITUDE 600
+#define LOOPBACK_SNR_DB 15.0f
+#define BENCH_SECONDS 20
+
+static uint64_t cycles(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return 0;
+#endif
+}
+
+static int run_loopback(const modem_profile_t *profile, synth_rng_t *rng, uint16_t *samples, size_t max_samples)
+{
+    // Offsets up to a tenth of the baud rate (a twentieth for QPSK).
+    float max_offset = profile->baud / (10.0f * modem_profile_bits_per_symbol(profile));
+    float offsets[] = {0.0f, max_offset, -max_offset};
+    float snrs[] = {INFINITY, LOOPBACK_SNR_DB};
+    uint8_t payload[MODEM_FRAME_MAX_PAYLOAD];
+    int failures = 0;
+    int runs = 0;
+
+    for (size_t o = 0; o < sizeof(offsets) / sizeof(offsets[0]); o++)
+    {
+        for (size_t s = 0; s < sizeof(snrs) / sizeof(snrs[0]); s++)
+        {
+            for (size_t len = 1; len <= MODEM_FRAME_MAX_PAYLOAD; len += 9)
+            {
+                for (size_t i = 0; i < len; i++)
+                    payload[i] = (uint8_t)synth_rng_u32(rng);
+
+                bench_trial_t trial = {.amplitude = AMPLITUDE, .snr_db = snrs[s], .offset_hz = offsets[o]};
+                runs++;
+                if (!bench_frame_trial(profile, &trial, rng, payload, len, samples, max_samples, NULL))
+                {
+                    failures++;
+                    printf("FAIL %s offset %+.1f Hz snr %.0f dB len %zu\n", profile->name, offsets[o], snrs[s], len);
+                }
+            }
+        }
+    }
+
+    printf("%s,%d,%d\n", profile->name, runs, failures);
+    return failures;
+}
+
+static void run_cost(const modem_profile_t *profile, synth_rng_t *rng, uint16_t *samples, size_t max_samples)
+{
+    size_t n = (size_t)profile->sample_rate * BENCH_SECONDS;
+    if (n > max_samples)
+        n = max_samples;
+    synth_idle(rng, samples, n, 200.0f);
+
+    psk_demod_config_t config;
+    psk_demod_t demod;
+    psk_chip_t chips[64];
+    psk_demod_config_from_profile(&config, profile);
+    psk_demod_init(&demod, &config);
+
+    double start = bench_clock_ns();
+    uint64_t start_cycles = cycles();
+    for (size_t pos = 0; pos < n;)
+    {
+        size_t num_chips;
+        pos += psk_demod_process(&demod, samples + pos, n - pos, chips, 64, &num_chips);
+    }
+    uint64_t used_cycles = cycles() - start_cycles;
+    double elapsed = bench_clock_ns() - start;
+
+    double symbols = (double)n * profile->baud / profile->sample_rate;
+    printf("%s,%.0f,%.1f,%.0f,%.2f\n", profile->name, symbols, elapsed / symbols,
+           used_cycles / symbols, elapsed / n);
+}
+
+int main(int argc, char **argv)
+{
+    int trials = 10;
+    unsigned long seed = 1;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "t:s:")) != -1)
+    {
+        switch (opt)
+        {
+        case 't':
+            trials = atoi(optarg);
+            break;
+        case 's':
+            seed = strtoul(optarg, NULL, 0);
+            break;
+        default:
+            fprintf(stderr, "usage: %s [-t trials] [-s seed]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    size_t max_samples = 79200 * (size_t)(BENCH_SECONDS + 60);
+    uint16_t *samples = malloc(max_samples * sizeof(uint16_t));
+    if (!samples || trials <= 0)
+        return 1;
+
+    synth_rng_t rng;
+    synth_rng_seed(&rng, seed);
+
+    const modem_profile_t *psk[] = {
+        modem_profile_get(MODEM_PROFILE_BPSK_32),
+        modem_profile_get(MODEM_PROFILE_QPSK_250),
+    };
+    const modem_profile_t *reference = modem_profile_get(MODEM_PROFILE_FSK_32);
+    int failures = 0;
+
+    printf("# loopback: clean and %.0f dB SNR, carrier offsets 0 and +-baud/10 (baud/20 QPSK)\n", LOOPBACK_SNR_DB);
+    printf("profile,frames,failures\n");
+    for (size_t p = 0; p < 2; p++)
+        failures += run_loopback(psk[p], &rng, samples, max_samples);
+
+    printf("\n# frame success, 32-byte payload, %d trials, amplitude %d\n", trials, AMPLITUDE);
+    printf("snr_db,%s,%s,%s\n", reference->name, psk[0]->name, psk[1]->name);
+    for (int snr = -15; snr <= 9; snr += 3)
+    {
+        bench_trial_t trial = {.amplitude = AMPLITUDE, .snr_db = (float)snr};
+        printf("%d,%.2f,%.2f,%.2f\n", snr,
+               bench_frame_success(reference, &trial, trials, &rng, samples, max_samples, NULL),
+               bench_frame_success(psk[0], &trial, trials, &rng, samples, max_samples, NULL),
+               bench_frame_success(psk[1], &trial, trials, &rng, samples, max_samples, NULL));
+    }
+
+    printf("\n# demodulator cost\n");
+    printf("profile,symbols,ns_per_symbol,cycles_per_symbol,ns_per_sample\n");
+    for (size_t p = 0; p < 2; p++)
+        run_cost(psk[p], &rng, samples, max_samples);
+
+    free(samples);
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,176 @@
+/**
+ * @file spectrum_bench.c
+ *
+ * @brief Accuracy and cost of the fixed-point spectrum / waterfall engine.
+ *
+ * 1. Tone check: single tones across the span at several amplitudes must
+ *    peak in the right bin, and the peak must track the amplitude
+ *    (about 6 dB per halving). Any wrong bin fails the run.
+ * 2. Streaming: a minute of ADC samples is fed in 1024-sample blocks on a
+ *    simulated clock, as the firmware does, and the line rate, the cost of
+ *    one line and the resulting CPU share are reported. In idle-only mode
+ *    every other block is reported busy.
+ *
+ * usage: spectrum_bench [-s seed]
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "bench.h"
+#include "synth.h"
+#include "dsp/spectrum.h"
+
+#define SAMPLE_RATE 79200
+#define BLOCK 1024
+#define STREAM_SECONDS 60
+
+static uint64_t sim_time_us;
+
+static uint64_t sim_clock_us(void)
+{
+    return sim_time_us;
+}
+
+static void make_tone(synth_rng_t *rng, uint16_t *samples, size_t count, float hz, float amplitude, float sigma)
+{
+    for (size_t i = 0; i < count; i++)
+    {
+        float x = MODEM_ADC_MIDPOINT + amplitude * sinf(2.0f * (float)M_PI * hz * i / SAMPLE_RATE);
+        samples[i] = (uint16_t)lrintf(x);
+    }
+    if (sigma > 0.0f)
+        synth_add_noise(rng, samples, count, sigma);
+}
+
+// Feeds until one line comes out; returns it.
+static const uint8_t *one_line(spectrum_t *spec, const uint16_t *samples, size_t count)
+{
+    sim_time_us = spec->next_capture_us;
+    spectrum_feed(spec, samples, count);
+    if (!spectrum_task(spec, true))
+        return NULL;
+    return spectrum_line(spec, spec->seq);
+}
+
+static int run_tones(synth_rng_t *rng)
+{
+    static spectrum_t spec;
+    spectrum_config_t config;
+    spectrum_default_config(&config, SAMPLE_RATE, sim_clock_us);
+    spectrum_init(&spec, &config);
+
+    size_t count = (size_t)config.fft_size * config.decimation;
+    uint16_t *samples = malloc(count * sizeof(uint16_t));
+    float bin_hz = spectrum_bin_hz(&spec);
+    float amplitudes[] = {2000.0f, 1000.0f, 500.0f, 100.0f, 10.0f};
+    int failures = 0;
+
+    printf("# tone check, %u-point FFT, %.1f Hz bins, %.1f dB per step\n",
+           config.fft_size, bin_hz, SPECTRUM_DB_PER_STEP);
+    printf("tone_hz,amplitude,expected_bin,peak_bin,peak,floor\n");
+
+    for (float hz = 300.0f; hz <= 4500.0f; hz += 700.0f)
+    {
+        for (size_t a = 0; a < sizeof(amplitudes) / sizeof(amplitudes[0]); a++)
+        {
+            make_tone(rng, samples, count, hz, amplitudes[a], 1.0f);
+            const uint8_t *line = one_line(&spec, samples, count);
+            if (!line)
+            {
+                failures++;
+                continue;
+            }
+
+            int peak_bin = 0;
+            unsigned floor_sum = 0;
+            for (int b = 0; b < config.bins; b++)
+            {
+                if (line[b] > line[peak_bin])
+                    peak_bin = b;
+                floor_sum += line[b];
+            }
+            int expected = (int)lrintf(hz / bin_hz);
+            if (abs(peak_bin - expected) > 1)
+                failures++;
+
+            printf("%.0f,%.0f,%d,%d,%u,%u\n", hz, amplitudes[a], expected, peak_bin, line[peak_bin],
+                   (floor_sum - line[peak_bin]) / (config.bins - 1));
+        }
+    }
+
+    free(samples);
+    return failures;
+}
+
+static void run_stream(synth_rng_t *rng, spectrum_schedule_t schedule)
+{
+    static spectrum_t spec;
+    spectrum_config_t config;
+    spectrum_default_config(&config, SAMPLE_RATE, sim_clock_us);
+    config.schedule = schedule;
+    sim_time_us = 0;
+    spectrum_init(&spec, &config);
+
+    uint16_t block[BLOCK];
+    make_tone(rng, block, BLOCK, 1200.0f, 500.0f, 20.0f);
+
+    size_t blocks = (size_t)SAMPLE_RATE * STREAM_SECONDS / BLOCK;
+    double compute_ns = 0.0;
+    double feed_ns = 0.0;
+
+    for (size_t b = 0; b < blocks; b++)
+    {
+        sim_time_us = (uint64_t)b * BLOCK * 1000000 / SAMPLE_RATE;
+
+        double start = bench_clock_ns();
+        spectrum_feed(&spec, block, BLOCK);
+        double fed = bench_clock_ns();
+        spectrum_task(&spec, (b & 1) == 0);
+        compute_ns += bench_clock_ns() - fed;
+        feed_ns += fed - start;
+    }
+
+    double seconds = (double)blocks * BLOCK / SAMPLE_RATE;
+    double per_line_us = spec.stats.lines ? compute_ns / spec.stats.lines / 1e3 : 0.0;
+    printf("%s,%u,%.2f,%u,%.1f,%.3f,%.4f\n",
+           schedule == SPECTRUM_SCHEDULE_IDLE ? "idle" : "always",
+           spec.stats.lines, spec.stats.lines / seconds, spec.stats.deferred, per_line_us,
+           feed_ns / ((double)blocks * BLOCK), 100.0 * (compute_ns + feed_ns) / (seconds * 1e9));
+}
+
+int main(int argc, char **argv)
+{
+    unsigned long seed = 1;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "s:")) != -1)
+    {
+        switch (opt)
+        {
+        case 's':
+            seed = strtoul(optarg, NULL, 0);
+            break;
+        default:
+            fprintf(stderr, "usage: %s [-s seed]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    synth_rng_t rng;
+    synth_rng_seed(&rng, seed);
+
+    int failures = run_tones(&rng);
+
+    printf("\n# streaming %d s at %d Hz in %d-sample blocks (host CPU)\n", STREAM_SECONDS, SAMPLE_RATE, BLOCK);
+    printf("schedule,lines,lines_per_s,deferred,us_per_line,ns_per_sample_fed,cpu_percent\n");
+    run_stream(&rng, SPECTRUM_SCHEDULE_ALWAYS);
+    run_stream(&rng, SPECTRUM_SCHEDULE_IDLE);
+
+    if (failures)
+        printf("\n%d tone checks failed\n", failures);
+    return failures ? 1 : 0;
+}
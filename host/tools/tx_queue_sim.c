@@ -0,0 +1,387 @@
+/**
+ * @file tx_queue_sim.c
+ *
+ * @brief The transmit queue under mixed-priority load, checked on the air.
+ *
+ * Frames of random priority (20 % high, 50 % normal, 30 % low) arrive as a
+ * Poisson stream at a chosen multiple of what the channel can carry, and go
+ * into tx_queue as the firmware queues them. One transmitter takes them in
+ * turn: a key-up delay when PTT was down, then the frame's symbols at the
+ * profile's baud rate. Every pick is checked against everything still
+ * waiting, so a frame of better priority, or an older one of the same,
+ * never waits behind it.
+ *
+ * What goes on air is modulated from the queued symbols with fsk_mod and
+ * decoded by modem_rx (ax25_rx for AFSK 1200); every frame sent has to come
+ * back, in the order sent. Waits also go into utils/histogram, whose
+ * percentiles must bracket the exact ones from the sorted waits. One CSV
+ * row per priority; exits 1 on any failure.
+ *
+ * usage: tx_queue_sim [-p profile] [-n frames] [-b payload] [-l load] [-k keyup_ms] [-s seed]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <unistd.h>
+
+#include "synth.h"
+#include "modem/ax25_rx.h"
+#include "modem/ax25_tx.h"
+#include "modem/fsk_mod.h"
+#include "modem/modem_rx.h"
+#include "modem/tx_queue.h"
+#include "utils/histogram.h"
+
+#define MAX_FRAMES 1000
+#define CHUNK 4096
+#define GAP_SYMBOLS 16 // silence between frames on air
+
+static const char *priority_names[TX_PRIORITY_COUNT] = {"high", "normal", "low"};
+
+static tx_queue_t queue;
+static uint32_t arrival_of[MAX_FRAMES]; // by queue frame id: the arrival its payload came from
+static uint32_t air_order[MAX_FRAMES];  // arrivals as sent
+static size_t air_count = 0;
+static size_t decoded = 0;
+static size_t out_of_order = 0;
+static size_t payload_len = 16;
+
+static histogram_t wait_hist[TX_PRIORITY_COUNT];
+static int32_t waits[TX_PRIORITY_COUNT][MAX_FRAMES]; // us, as sent
+static size_t wait_count[TX_PRIORITY_COUNT];
+
+static void make_payload(uint32_t id, uint8_t *payload)
+{
+    for (size_t i = 0; i < payload_len; i++)
+        payload[i] = (uint8_t)(i < 4 ? id >> (8 * i) : id * 31 + i);
+}
+
+static void check_payload(const uint8_t *data, size_t len)
+{
+    uint8_t expected[MODEM_FRAME_MAX_PAYLOAD];
+
+    if (decoded < air_count && len == payload_len)
+    {
+        make_payload(air_order[decoded], expected);
+        if (memcmp(data, expected, len) != 0)
+            out_of_order++;
+    }
+    else
+    {
+        out_of_order++;
+    }
+    decoded++;
+}
+
+static void frame_callback(void *ctx, const uint8_t *data, size_t len, uint8_t src_addr)
+{
+    (void)ctx;
+    (void)src_addr;
+    check_payload(data, len);
+}
+
+static void ax25_callback(void *ctx, const uint8_t *frame, size_t len)
+{
+    (void)ctx;
+    check_payload(frame, len);
+}
+
+// A frame better placed than the one just picked, still waiting; -1 if none.
+static int better_waiting(const tx_frame_t *picked)
+{
+    for (int i = 0; i < TX_QUEUE_SLOTS; i++)
+    {
+        const tx_frame_t *frame = &queue.frames[i];
+        if (!frame->used || frame == picked)
+            continue;
+        if (frame->priority < picked->priority || (frame->priority == picked->priority && frame->seq < picked->seq))
+            return i;
+    }
+    return -1;
+}
+
+typedef struct receiver
+{
+    const modem_profile_t *profile;
+    bool is_ax25;
+    modem_rx_t rx;
+    ax25_rx_t ax25;
+    fsk_mod_t mod;
+    uint16_t samples[CHUNK];
+    size_t count;
+} receiver_t;
+
+static void flush(receiver_t *r)
+{
+    if (r->is_ax25)
+        ax25_rx_process(&r->ax25, r->samples, r->count);
+    else
+        modem_rx_process(&r->rx, r->samples, r->count);
+    r->count = 0;
+}
+
+static void put_symbol(receiver_t *r, unsigned symbol)
+{
+    if (r->count + fsk_mod_symbol_samples(&r->mod) > CHUNK)
+        flush(r);
+    r->count += fsk_mod_symbol(&r->mod, symbol, r->samples + r->count, CHUNK - r->count);
+}
+
+static void put_silence(receiver_t *r, size_t count)
+{
+    while (count)
+    {
+        if (r->count == CHUNK)
+            flush(r);
+        size_t n = CHUNK - r->count < count ? CHUNK - r->count : count;
+        for (size_t i = 0; i < n; i++)
+            r->samples[r->count + i] = MODEM_ADC_MIDPOINT;
+        r->count += n;
+        count -= n;
+    }
+}
+
+static void transmit(receiver_t *r, const tx_frame_t *frame)
+{
+    uint8_t symbols[256];
+
+    for (size_t first = 0; first < frame->count;)
+    {
+        size_t n = tx_queue_symbols(&queue, frame, first, symbols, sizeof(symbols));
+        for (size_t i = 0; i < n; i++)
+            put_symbol(r, symbols[i]);
+        first += n;
+    }
+    put_silence(r, GAP_SYMBOLS * (size_t)(r->profile->sample_rate / r->profile->baud));
+}
+
+static int compare_wait(const void *a, const void *b)
+{
+    int32_t x = *(const int32_t *)a;
+    int32_t y = *(const int32_t *)b;
+    return (x > y) - (x < y);
+}
+
+// The histogram's percentile is at least the exact one and within its log2 bin, or the max past the last bin.
+static int check_percentiles(const histogram_t *hist, int32_t *values, size_t count)
+{
+    static const unsigned percents[] = {50, 90, 99, 100};
+
+    if (hist->count != count)
+        return -1;
+    if (count == 0)
+        return 0;
+
+    qsort(values, count, sizeof(*values), compare_wait);
+    for (size_t i = 0; i < sizeof(percents) / sizeof(percents[0]); i++)
+    {
+        int32_t exact = values[(count * percents[i] + 99) / 100 - 1];
+        int32_t binned = histogram_percentile(hist, percents[i]);
+        if (binned < exact || binned > hist->max)
+            return -1;
+        if (binned != hist->max && (int64_t)binned > 2 * (int64_t)exact + (int64_t)hist->unit)
+            return -1;
+    }
+    return 0;
+}
+
+static int32_t push(tx_priority_t priority, uint32_t id, uint64_t now_us)
+{
+    uint8_t payload[MODEM_FRAME_MAX_PAYLOAD];
+
+    make_payload(id, payload);
+    if (queue.profile == modem_profile_get(MODEM_PROFILE_AFSK_1200))
+        return tx_queue_push_ax25(&queue, priority, payload, payload_len, AX25_TX_LEAD_FLAGS, AX25_TX_TAIL_FLAGS,
+                                  now_us);
+    return tx_queue_push_frame(&queue, priority, 0xFF, 1, payload, payload_len, now_us);
+}
+
+int main(int argc, char **argv)
+{
+    int profile_id = MODEM_PROFILE_FSK_32;
+    unsigned frames = 40;
+    float load = 1.5f;
+    float keyup_ms = 50.0f;
+    unsigned long seed = 1;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "p:n:b:l:k:s:")) != -1)
+    {
+        switch (opt)
+        {
+        case 'p':
+            profile_id = atoi(optarg);
+            break;
+        case 'n':
+            frames = (unsigned)atoi(optarg);
+            break;
+        case 'b':
+            payload_len = (size_t)atoi(optarg);
+            break;
+        case 'l':
+            load = strtof(optarg, NULL);
+            break;
+        case 'k':
+            keyup_ms = strtof(optarg, NULL);
+            break;
+        case 's':
+            seed = strtoul(optarg, NULL, 0);
+            break;
+        default:
+            fprintf(stderr, "usage: %s [-p profile] [-n frames] [-b payload] [-l load] [-k keyup_ms] [-s seed]\n",
+                    argv[0]);
+            return 1;
+        }
+    }
+
+    if (profile_id < 0 || profile_id >= MODEM_PROFILE_COUNT || frames == 0 || frames > MAX_FRAMES ||
+        payload_len < 4 || payload_len > MODEM_FRAME_MAX_PAYLOAD || load <= 0.0f)
+    {
+        fprintf(stderr, "bad arguments\n");
+        return 1;
+    }
+
+    const modem_profile_t *profile = modem_profile_get((modem_profile_id_t)profile_id);
+    static receiver_t r;
+    synth_rng_t rng;
+
+    synth_rng_seed(&rng, seed);
+    for (int p = 0; p < TX_PRIORITY_COUNT; p++)
+        histogram_init_log2(&wait_hist[p], 1000);
+    r.profile = profile;
+    r.is_ax25 = profile_id == MODEM_PROFILE_AFSK_1200;
+    if (tx_queue_init(&queue, profile) || fsk_mod_init(&r.mod, profile, 1500) ||
+        (r.is_ax25 ? ax25_rx_init(&r.ax25, profile, ax25_callback, NULL)
+                   : modem_rx_init(&r.rx, profile, frame_callback, NULL)))
+    {
+        fprintf(stderr, "%s: init failed\n", profile->name);
+        return 1;
+    }
+
+    // The first frame sets the air time the load is measured against.
+    if (push(TX_PRIORITY_NORMAL, 0, 0) < 0)
+    {
+        fprintf(stderr, "%s: a %zu byte frame does not fit the queue\n", profile->name, payload_len);
+        return 1;
+    }
+    unsigned frame_symbols = tx_queue_next(&queue, 0)->count;
+    uint64_t frame_us = (uint64_t)frame_symbols * 1000000u / profile->baud;
+    tx_queue_done(&queue);
+    tx_queue_init(&queue, profile);
+
+    double mean_gap_us = frame_us / load;
+    uint64_t now = 0;
+    uint64_t next_arrival = 0;
+    uint64_t air_end = 0;
+    bool keyed = false;
+    unsigned arrived = 0;
+    unsigned offered[TX_PRIORITY_COUNT] = {0};
+    unsigned turned_away[TX_PRIORITY_COUNT] = {0};
+    unsigned order_errors = 0;
+    const tx_frame_t *on_air = NULL;
+
+    while (arrived < frames || on_air || tx_queue_depth(&queue))
+    {
+        // The next event: an arrival, or the end of the frame on air.
+        if (arrived < frames && (!on_air || next_arrival <= air_end))
+        {
+            now = next_arrival;
+            float u = synth_rng_uniform(&rng);
+            tx_priority_t priority = u < 0.2f ? TX_PRIORITY_HIGH : u < 0.7f ? TX_PRIORITY_NORMAL : TX_PRIORITY_LOW;
+            offered[priority]++;
+            int32_t id = push(priority, arrived, now);
+            if (id < 0)
+                turned_away[priority]++;
+            else
+                arrival_of[id] = arrived;
+            arrived++;
+            next_arrival = now + (uint64_t)(-log(1.0 - synth_rng_uniform(&rng)) * mean_gap_us);
+        }
+        else if (on_air)
+        {
+            now = air_end;
+            tx_queue_done(&queue);
+            on_air = NULL;
+        }
+
+        if (on_air)
+            continue;
+
+        const tx_frame_t *frame = tx_queue_next(&queue, now);
+        if (!frame)
+        {
+            keyed = false; // nothing behind it: PTT drops
+            continue;
+        }
+
+        int better = better_waiting(frame);
+        if (better >= 0)
+        {
+            fprintf(stderr, "frame %u (%s) sent ahead of frame %u (%s)\n", (unsigned)frame->id,
+                    priority_names[frame->priority], (unsigned)queue.frames[better].id,
+                    priority_names[queue.frames[better].priority]);
+            order_errors++;
+        }
+
+        int32_t wait = (int32_t)(now - frame->queued_us);
+        histogram_add(&wait_hist[frame->priority], wait);
+        waits[frame->priority][wait_count[frame->priority]++] = wait;
+
+        air_order[air_count++] = arrival_of[frame->id];
+        transmit(&r, frame);
+
+        air_end = now + (keyed ? 0 : (uint64_t)(keyup_ms * 1000.0f)) + frame_us;
+        keyed = true;
+        on_air = frame;
+    }
+    flush(&r);
+
+    const tx_queue_stats_t *stats = &queue.stats;
+    unsigned accounting_errors = 0;
+    unsigned histogram_errors = 0;
+    histogram_t all;
+
+    printf("# %s, %u frames of %zu bytes (%u symbols, %.2f s on air), offered load %.2f, %.0f ms key-up\n",
+           profile->name, frames, payload_len, frame_symbols, frame_us / 1e6, load, keyup_ms);
+    printf("priority,offered,queued,sent,turned_away,evicted,wait_mean_s,wait_p50_s,wait_p90_s,wait_max_s\n");
+    histogram_init_log2(&all, 1000);
+    for (int p = 0; p < TX_PRIORITY_COUNT; p++)
+    {
+        uint32_t evicted = stats->dropped[p] - turned_away[p];
+        if (stats->queued[p] != stats->sent[p] + evicted || offered[p] != stats->queued[p] + turned_away[p])
+            accounting_errors++;
+
+        if (check_percentiles(&wait_hist[p], waits[p], wait_count[p]))
+            histogram_errors++;
+        if (histogram_merge(&all, &wait_hist[p]) ||
+            histogram_mean(&wait_hist[p]) != (int32_t)(stats->sent[p] ? stats->wait_total_us[p] / stats->sent[p] : 0))
+            histogram_errors++;
+
+        printf("%s,%u,%u,%u,%u,%u,%.2f,%.2f,%.2f,%.2f\n", priority_names[p], offered[p], stats->queued[p],
+               stats->sent[p], turned_away[p], evicted,
+               stats->sent[p] ? stats->wait_total_us[p] / 1e6 / stats->sent[p] : 0.0,
+               histogram_percentile(&wait_hist[p], 50) / 1e6, histogram_percentile(&wait_hist[p], 90) / 1e6,
+               stats->wait_max_us[p] / 1e6);
+    }
+    if (all.count != air_count)
+        histogram_errors++;
+    printf("# max depth %u of %d, decoded %zu of %zu sent, %zu wrong or out of order\n", stats->max_depth,
+           TX_QUEUE_SLOTS, decoded, air_count, out_of_order);
+
+    char json[512];
+    histogram_to_json(&all, json, sizeof(json));
+    printf("# all waits: %s\n", json);
+
+    int failed = order_errors || accounting_errors || histogram_errors || decoded != air_count || out_of_order;
+    if (order_errors)
+        printf("\n%u frames sent out of priority order\n", order_errors);
+    if (accounting_errors)
+        printf("\nqueued, sent and dropped counts do not add up\n");
+    if (histogram_errors)
+        printf("\nwait histograms disagree with the exact waits\n");
+    if (decoded != air_count || out_of_order)
+        printf("\nframes lost or reordered on air\n");
+    return failed ? 1 : 0;
+}
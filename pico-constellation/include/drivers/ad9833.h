@@ -1,6 +1,23 @@
 #ifndef AD9833_H
 #define AD9833_H
 
+#include <stdint.h>
+
+// The SPI and pins the fhdm driver is wired to; override to match the board.
+// ad9833_init fails if the SPI is not running on SCLK and SDATA after fhdm starts.
+#ifndef AD9833_SPI
+#define AD9833_SPI spi0
+#endif
+#ifndef AD9833_SCLK_PIN
+#define AD9833_SCLK_PIN PICO_DEFAULT_SPI_SCK_PIN
+#endif
+#ifndef AD9833_SDATA_PIN
+#define AD9833_SDATA_PIN PICO_DEFAULT_SPI_TX_PIN
+#endif
+#ifndef AD9833_FSYNC_PIN
+#define AD9833_FSYNC_PIN PICO_DEFAULT_SPI_CSN_PIN
+#endif
+
 typedef enum
 {
     AD9833_MODE_SINE,
@@ -13,6 +30,24 @@ int ad9833_init(void);
 int ad9833_deinit(void);
 
 int ad9833_set_mode(ad9833_mode_t mode);
+
+/*
+ * Both frequency registers are kept loaded: a tone already in one of them
+ * is selected with a single control word (FSELECT), anything else is
+ * written to the register not in use and then selected. The phase
+ * accumulator runs on through either, so FSK symbols switch without a
+ * phase step, and two-tone FSK costs one 16-bit SPI write per symbol
+ * once both tones have been sent.
+ */
 int ad9833_set_frequency_hz(float frequency);
 
+// Loads tone0 into FREQ0 and tone1 into FREQ1 ahead of a transmission and selects FREQ0.
+int ad9833_load_tones(float tone0, float tone1);
+int ad9833_select(unsigned reg); // 0 or 1, one control word
+
+// For other writers of the part (ad9833_fsk): the control word selecting reg in
+// the current mode, and a rewrite of the last one this driver sent.
+uint16_t ad9833_select_word(unsigned reg);
+int ad9833_resync(void);
+
 #endif // AD9833_H
\ No newline at end of file
@@ -0,0 +1,62 @@
+#ifndef AD9833_FSK_H
+#define AD9833_FSK_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#include "utils/histogram.h"
+
+#define AD9833_FSK_MAX_SYMBOLS 512 // per ad9833_fsk_send
+#define AD9833_FSK_SM_HZ 25000000  // state machine clock; SCLK is half of it
+#define AD9833_FSK_ERROR_BIN_US 2  // period error histogram bin, half the bins either side of 0
+
+/**
+ * @brief Two-tone FSK on the AD9833 with symbol edges timed by PIO.
+ *
+ * The tones go into FREQ0 and FREQ1 once (ad9833_load_tones). After that
+ * a PIO state machine takes the SPI pins and writes one FSELECT control
+ * word per symbol, then counts out the rest of the symbol period itself:
+ * edges are a whole number of state machine clocks apart and do not move
+ * with interrupts, USB or network load. A DMA channel keeps the state
+ * machine's FIFO fed from the prepared buffer.
+ *
+ * Each edge also raises a PIO interrupt that timestamps it, so the spacing
+ * the CPU observes can be checked against the nominal period; that
+ * includes the interrupt's own latency, so it is an upper bound on the
+ * jitter. A starved FIFO stretches a symbol and is counted as an underrun.
+ *
+ * Needs FSYNC and SCLK on consecutive GPIOs (side-set), as the Pico's
+ * default SPI0 pins are.
+ */
+typedef struct ad9833_fsk_stats
+{
+    uint32_t edges;
+    uint32_t period_us;     // nominal
+    uint32_t min_us;        // between consecutive edges of one burst, as seen
+    uint32_t max_us;
+    uint32_t max_error_us;  // largest difference from the nominal period
+    uint32_t underruns;     // the FIFO ran dry inside a burst
+    uint32_t first_us;      // first edge since ad9833_fsk_start, time_us_32
+    uint32_t last_us;       // latest edge
+    histogram_t error;      // edge spacing minus the nominal period, signed
+} ad9833_fsk_stats_t;
+
+int ad9833_fsk_init(void);
+int ad9833_fsk_deinit(void);
+
+// Loads the tones and hands the pins to the state machine; symbols 0 and 1 select them.
+int ad9833_fsk_start(float tone0, float tone1, float baud);
+int ad9833_fsk_stop(void); // gives the pins back to the SPI
+
+/*
+ * Queues a burst: copied, so the buffer is free on return. One burst can
+ * wait behind the one on air and follows it without a gap; -1 if both
+ * slots are taken.
+ */
+int ad9833_fsk_send(const uint8_t *symbols, size_t count);
+bool ad9833_fsk_busy(void);
+
+void ad9833_fsk_get_stats(ad9833_fsk_stats_t *stats);
+
+#endif // AD9833_FSK_H
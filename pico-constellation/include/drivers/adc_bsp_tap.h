@@ -0,0 +1,17 @@
+#ifndef ADC_BSP_TAP_H
+#define ADC_BSP_TAP_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+typedef void (*adc_bsp_tap_t)(const uint16_t *samples, size_t count);
+
+// Sees every block adc_bsp_get_data reads, before it is pushed to the library's
+// buffer, in the caller's context. For the app's own consumers; NULL removes it.
+int adc_bsp_set_tap(adc_bsp_tap_t tap);
+
+// adc_bsp_get_data without the push: the block the ADC has ready (tapped),
+// or 0 samples. *samples stays valid until the next call.
+size_t adc_bsp_read(const uint16_t **samples);
+
+#endif // ADC_BSP_TAP_H
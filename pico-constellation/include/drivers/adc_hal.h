@@ -13,10 +13,19 @@ int adc_hal_set_sample_rate(int sample_rate);             // in Hz
 int adc_hal_set_sample_size(int sample_size);             // minimumnumber of samples per callback
 int adc_hal_set_callback(adc_buffer_ready_callback_t cb); // assign sample callback
 
+// Replay: the DMA reads samples from memory (looped, in whole chunks) instead
+// of the ADC, unpaced but never overwriting unread data. NULL goes back to the ADC.
+int adc_hal_set_replay(const uint16_t *samples, size_t count);
+
 int adc_hal_start(void);
 int adc_hal_stop(void);
 
 int adc_samples_available(int *num_samples); // Check how many samples are available in the buffer
 int adc_hal_get_samples(uint16_t *buffer, size_t max_size, int *num_samples);
+int adc_hal_get_dropped(uint64_t *dropped);   // Samples overwritten unread since init
+
+// Loopback: writes samples into the ring as the DMA would, a whole chunk at a
+// time, with sampling stopped. For self-tests that feed the TX path back to RX.
+int adc_hal_inject(const uint16_t *samples, size_t count);
 
 #endif // ADC_HAL_H
\ No newline at end of file
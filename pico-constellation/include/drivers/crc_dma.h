@@ -0,0 +1,32 @@
+#ifndef CRC_DMA_H
+#define CRC_DMA_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "modem/crc.h"
+
+#define CRC_DMA_MIN_BYTES 16 // shorter buffers are cheaper in software than a DMA setup
+
+/**
+ * @brief Frame CRCs on the DMA sniffer.
+ *
+ * Claims a DMA channel and registers it as the crc_compute() engine. Each
+ * buffer is read by an 8-bit transfer into a dummy byte with sniffing on,
+ * so the CPU only sets up the channel and waits. The engine is checked
+ * against the software CRC on test vectors first and is not registered
+ * if any result differs.
+ */
+int crc_dma_init(void);
+int crc_dma_deinit(void);
+
+// CRC of a buffer on the sniffer regardless of length; 0 or -1.
+int crc_dma_compute(crc_type_t type, const uint8_t *data, size_t len, uint16_t *crc);
+
+// Compares the DMA and software paths on vectors; 0 when all agree.
+int crc_dma_self_test(void);
+
+// Logs the time per buffer of both paths for len-byte buffers.
+void crc_dma_benchmark(size_t len, int rounds);
+
+#endif // CRC_DMA_H
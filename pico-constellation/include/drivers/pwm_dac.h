@@ -0,0 +1,47 @@
+#ifndef PWM_DAC_H
+#define PWM_DAC_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#include "modem/modem_profile.h"
+
+#define PWM_DAC_QUEUE 512 // symbols waiting to start
+
+/**
+ * @brief Audio out of a PWM pin, fed by DMA, for boards without an AD9833.
+ *
+ * One PWM period is one sample: the wrap DREQ paces a pair of chained DMA
+ * channels that write the compare register from two blocks in turn. Each
+ * finished block is refilled in the DMA interrupt with fsk_mod (32-bit
+ * phase accumulators over the Q15 sine table), so symbols are phase
+ * continuous and their boundaries fall on exact samples, whatever the CPU
+ * is doing. The compare value is the 12-bit sample scaled to the wrap.
+ *
+ * Queued symbols are sent in order, in the profile's modulation; between
+ * them the output holds the tone from pwm_dac_set_tone, or the midpoint.
+ * An RC low-pass on the pin well below the sample rate makes it audio.
+ */
+int pwm_dac_init(void);
+int pwm_dac_deinit(void);
+
+// The sample rate is the profile's, rounded to a whole number of system clocks.
+int pwm_dac_start(const modem_profile_t *profile, int16_t amplitude);
+int pwm_dac_stop(void);
+
+int pwm_dac_set_amplitude(int16_t amplitude); // peak, ADC counts; from the next block
+int pwm_dac_set_tone(float frequency);        // between symbols; 0 is silence
+
+// Symbol values as fsk_mod_symbol takes them; returns how many fit.
+size_t pwm_dac_queue_symbols(const uint8_t *symbols, size_t count);
+size_t pwm_dac_queued(void);       // not yet started
+bool pwm_dac_busy(void);           // symbols queued, or not yet out of the pin
+
+// When the latest run of symbols starts and ends at the pin, time_us_32, from
+// the block schedule; false if none since pwm_dac_start.
+bool pwm_dac_last_burst(uint32_t *first_us, uint32_t *end_us);
+uint64_t pwm_dac_symbols_sent(void); // started since pwm_dac_start
+uint32_t pwm_dac_sample_rate(void);
+
+#endif // PWM_DAC_H
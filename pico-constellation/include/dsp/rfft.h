@@ -0,0 +1,29 @@
+#ifndef RFFT_H
+#define RFFT_H
+
+#include <stdint.h>
+
+#define RFFT_MAX_SIZE 512
+
+/**
+ * @brief Fixed-point (Q15) real FFT.
+ *
+ * An N-point real transform done as an N/2-point complex FFT on the samples
+ * packed as (even, odd) pairs, followed by the usual split step. Every
+ * butterfly stage scales by 1/2, so the output is X[k] / (N/2) and cannot
+ * overflow for any Q15 input.
+ */
+typedef struct rfft
+{
+    uint16_t size;                  // N, a power of two
+    uint8_t stages;                 // log2(N/2)
+    int16_t sine[RFFT_MAX_SIZE];    // sin(2 pi i / N), Q15
+} rfft_t;
+
+int rfft_init(rfft_t *fft, uint16_t size);
+
+// Transforms data[size] in place (it is left holding the packed half-size
+// spectrum) and writes |X[k]|^2 / 2 for k = 0 .. size/2 - 1.
+void rfft_power(const rfft_t *fft, int16_t *data, uint32_t *power);
+
+#endif // RFFT_H
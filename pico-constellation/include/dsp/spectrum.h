@@ -0,0 +1,92 @@
+#ifndef SPECTRUM_H
+#define SPECTRUM_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#include "dsp/rfft.h"
+
+#define SPECTRUM_MAX_FFT RFFT_MAX_SIZE
+#define SPECTRUM_MAX_BINS 256
+#define SPECTRUM_MAX_LINES 16      // waterfall history kept for readers
+#define SPECTRUM_DB_PER_STEP 0.295f // line value 255 = full-swing sine, 0 = below one LSB
+
+typedef enum
+{
+    SPECTRUM_SCHEDULE_ALWAYS = 0, // compute as soon as a frame is captured
+    SPECTRUM_SCHEDULE_IDLE,       // only when the caller reports the CPU idle
+} spectrum_schedule_t;
+
+typedef struct spectrum_config
+{
+    uint32_t sample_rate;         // input rate in Hz
+    uint16_t fft_size;            // power of two, <= SPECTRUM_MAX_FFT
+    uint8_t decimation;           // input samples averaged into one FFT sample
+    uint16_t bins;                // line width, divides fft_size / 2 (peak of each group)
+    uint32_t interval_us;         // minimum time between lines
+    uint8_t budget_percent;       // ceiling on the average CPU share of the FFT
+    spectrum_schedule_t schedule;
+    uint64_t (*clock_us)(void);   // monotonic microseconds
+} spectrum_config_t;
+
+typedef struct spectrum_stats
+{
+    uint32_t lines;
+    uint32_t deferred;    // frames held back because the CPU was busy
+    uint32_t last_us;     // cost of the last line
+    uint32_t max_us;
+} spectrum_stats_t;
+
+/**
+ * @brief Low duty cycle spectrum / waterfall engine.
+ *
+ * Feeding is cheap: outside a capture window samples are ignored, inside it
+ * they are averaged down by the decimation factor into a frame. Once a frame
+ * is full the task windows it (Hann), runs the real FFT and compresses the
+ * result to one line of 8-bit log magnitudes. The next capture is not
+ * started before interval_us, or before the measured FFT time fits inside
+ * budget_percent of the elapsed time, whichever is later.
+ *
+ * Lines are numbered from 1; the last SPECTRUM_MAX_LINES stay readable.
+ */
+typedef struct spectrum
+{
+    spectrum_config_t config;
+    rfft_t fft;
+    int16_t window[SPECTRUM_MAX_FFT];     // Hann, Q15
+    uint16_t frame[SPECTRUM_MAX_FFT];     // decimated input, ADC counts
+    int16_t work[SPECTRUM_MAX_FFT];
+    uint32_t power[SPECTRUM_MAX_FFT / 2];
+
+    bool capturing;
+    bool ready;
+    bool deferred;
+    uint16_t fill;
+    uint32_t decimate_sum;
+    uint8_t decimate_count;
+    uint64_t next_capture_us;
+
+    uint8_t lines[SPECTRUM_MAX_LINES][SPECTRUM_MAX_BINS];
+    uint32_t seq;                         // number of the newest line, 0 = none yet
+    spectrum_stats_t stats;
+} spectrum_t;
+
+void spectrum_default_config(spectrum_config_t *config, uint32_t sample_rate, uint64_t (*clock_us)(void));
+
+int spectrum_init(spectrum_t *spectrum, const spectrum_config_t *config);
+
+// Offers ADC samples; only copies while a capture is in progress.
+void spectrum_feed(spectrum_t *spectrum, const uint16_t *samples, size_t count);
+
+// Computes a line if a frame is waiting (and idle, in idle-only mode).
+// Returns 1 if a line was produced, 0 otherwise.
+int spectrum_task(spectrum_t *spectrum, bool idle);
+
+// Line number seq, or NULL if it does not exist yet or was overwritten.
+const uint8_t *spectrum_line(const spectrum_t *spectrum, uint32_t seq);
+
+// Width of one output bin in Hz.
+float spectrum_bin_hz(const spectrum_t *spectrum);
+
+#endif // SPECTRUM_H
@@ -0,0 +1,59 @@
+#ifndef AX25_H
+#define AX25_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#define AX25_CALLSIGN_LEN 6
+#define AX25_ADDRESS_SIZE 7
+#define AX25_MAX_DIGIS 8
+#define AX25_MAX_INFO 256
+#define AX25_MAX_FRAME (AX25_ADDRESS_SIZE * (2 + AX25_MAX_DIGIS) + 2 + AX25_MAX_INFO)
+#define AX25_MIN_FRAME (AX25_ADDRESS_SIZE * 2 + 1)
+#define AX25_CONTROL_UI 0x03
+#define AX25_PID_NO_LAYER3 0xF0
+
+typedef struct ax25_address
+{
+    char callsign[AX25_CALLSIGN_LEN + 1]; // upper case, NUL terminated
+    uint8_t ssid;                         // 0..15
+    bool flag;                            // C bit on dst/src, H (has been repeated) on digipeaters
+} ax25_address_t;
+
+/**
+ * @brief An AX.25 frame between flags, without the FCS.
+ *
+ * Only the control byte is interpreted: I and UI frames carry a PID and an
+ * information field, everything else is kept as raw control plus info.
+ * The info pointer refers into the buffer the frame was decoded from.
+ */
+typedef struct ax25_frame
+{
+    ax25_address_t dst;
+    ax25_address_t src;
+    ax25_address_t digis[AX25_MAX_DIGIS];
+    uint8_t num_digis;
+    uint8_t control;
+    bool has_pid;
+    uint8_t pid;
+    const uint8_t *info;
+    size_t info_len;
+} ax25_frame_t;
+
+// "CALL" or "CALL-SSID", with a trailing '*' setting the flag.
+int ax25_address_parse(const char *text, size_t len, ax25_address_t *addr);
+
+// Fills a UI frame from a monitor line "SRC>DST,DIGI1,DIGI2:info" (TNC2 format).
+int ax25_frame_from_text(const char *text, ax25_frame_t *frame);
+
+// Formats a frame as a monitor line; returns the length or -1 if it does not fit.
+int ax25_frame_to_text(const ax25_frame_t *frame, char *out, size_t max_len);
+
+// Builds the on-air bytes (addresses, control, PID, info); returns 0 on success.
+int ax25_encode(const ax25_frame_t *frame, uint8_t *out, size_t max_len, size_t *len);
+
+// Parses received bytes (FCS already removed); returns 0 on success.
+int ax25_decode(const uint8_t *data, size_t len, ax25_frame_t *frame);
+
+#endif // AX25_H
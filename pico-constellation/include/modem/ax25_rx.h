@@ -0,0 +1,40 @@
+#ifndef AX25_RX_H
+#define AX25_RX_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "modem/fsk_demod.h"
+#include "modem/hdlc.h"
+#include "modem/modem_profile.h"
+
+#define AX25_RX_CHIP_BATCH 16
+#define AX25_RX_PLL_GAIN 0.375f // share of a transition's timing error corrected at once
+
+/**
+ * @brief AFSK 1200 packet receiver: tone detector -> bit clock -> HDLC.
+ *
+ * The binary FSK detector gives a mark/space metric several times a bit.
+ * Every sign change of the metric pulls a digital PLL towards a decision
+ * half a bit later, with the crossing interpolated between chips. Decided
+ * line levels go to the HDLC decoder, which hands complete frames (without
+ * FCS) to the callback.
+ */
+typedef struct ax25_rx
+{
+    fsk_demod_t demod;
+    fsk_chip_t chips[AX25_RX_CHIP_BATCH];
+    int32_t bit_len;    // chips per bit, Q8
+    int32_t clock;      // chips since the last decision, Q8
+    float last_metric;
+    uint32_t transitions;
+    uint32_t bits;
+    hdlc_decoder_t hdlc;
+} ax25_rx_t;
+
+int ax25_rx_init(ax25_rx_t *rx, const modem_profile_t *profile, hdlc_frame_callback_t callback, void *ctx);
+void ax25_rx_reset(ax25_rx_t *rx);
+
+int ax25_rx_process(ax25_rx_t *rx, const uint16_t *samples, size_t count);
+
+#endif // AX25_RX_H
@@ -0,0 +1,25 @@
+#ifndef AX25_TX_H
+#define AX25_TX_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "modem/modem_profile.h"
+
+#define AX25_TX_LEAD_FLAGS 32 // about 210 ms at 1200 baud for the far transmitter to key up
+#define AX25_TX_TAIL_FLAGS 2
+
+// Samples needed for a frame of len bytes (worst-case stuffing).
+size_t ax25_tx_max_samples(const modem_profile_t *profile, size_t len, uint16_t lead_flags, uint16_t tail_flags);
+
+// Modulates frame (FCS added here) as HDLC/NRZI AFSK; returns the samples
+// written, or 0 if out is too small.
+size_t ax25_tx_modulate(const modem_profile_t *profile, int16_t amplitude, const uint8_t *frame, size_t len,
+                        uint16_t lead_flags, uint16_t tail_flags, uint16_t *out, size_t max_samples);
+
+// The same frame as line levels, one per symbol, packed LSB first as
+// hdlc.h describes; returns the count, or 0 if bits is too small.
+size_t ax25_tx_line_bits(const uint8_t *frame, size_t len, uint16_t lead_flags, uint16_t tail_flags, uint8_t *bits,
+                         size_t max_bits);
+
+#endif // AX25_TX_H
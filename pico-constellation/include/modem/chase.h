@@ -0,0 +1,88 @@
+#ifndef CHASE_H
+#define CHASE_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#include "modem/modem_frame.h"
+
+// Memory is CHASE_MAX_SLOTS * CHASE_MAX_BITS * 2 bytes; override either at build time.
+#ifndef CHASE_MAX_SLOTS
+#define CHASE_MAX_SLOTS 4
+#endif
+#ifndef CHASE_MAX_BITS
+#define CHASE_MAX_BITS (MODEM_FRAME_MAX_BODY * 8) // longer bodies are not kept
+#endif
+
+#define CHASE_SOFT_SCALE 64.0f // soft value 1.0 as a stored int8
+#define CHASE_MAX_COPIES 8     // keeps the int16 sums well clear of overflow
+#define CHASE_KEY_BITS (MODEM_FRAME_HEADER_SIZE * 8)
+
+typedef struct chase_config
+{
+    uint8_t slots;         // frames kept at once, up to CHASE_MAX_SLOTS
+    uint8_t max_copies;    // copies summed before a slot starts over, up to CHASE_MAX_COPIES
+    uint8_t key_tolerance; // header bits a copy may differ by and still match
+    uint32_t max_age_us;   // a repeat later than this is not combined
+} chase_config_t;
+
+typedef struct chase_slot
+{
+    bool used;
+    uint8_t copies;
+    uint16_t bits;
+    uint8_t key[MODEM_FRAME_HEADER_SIZE]; // header sliced from the sum
+    uint64_t last_us;
+    int16_t sum[CHASE_MAX_BITS];
+} chase_slot_t;
+
+typedef struct chase_stats
+{
+    uint32_t stored;    // failed copies that opened a slot
+    uint32_t combined;  // failed copies added to an existing slot
+    uint32_t recovered; // combinations that passed the CRC
+    uint32_t evicted;   // slots dropped for space before they recovered
+    uint32_t expired;   // slots dropped for age
+    uint32_t too_long;  // copies longer than CHASE_MAX_BITS
+} chase_stats_t;
+
+/**
+ * @brief Chase combining of repeated copies of a frame that failed its CRC.
+ *
+ * The receiver hands over the soft value of every body bit of a failed
+ * copy. Copies of the same length whose headers agree to within a few
+ * bits are taken as repeats of one frame: they are summed bit by bit and
+ * the sum is sliced and checked again, so two weak copies can give one
+ * good frame. Soft values are stored as int8 and summed in
+ * int16; the oldest slot is replaced when all are taken.
+ */
+typedef struct chase
+{
+    chase_config_t config;
+    chase_slot_t slots[CHASE_MAX_SLOTS];
+    chase_stats_t stats;
+} chase_t;
+
+void chase_default_config(chase_config_t *config);
+
+int chase_init(chase_t *chase, const chase_config_t *config);
+void chase_reset(chase_t *chase);
+
+// Soft value (positive = 1, about -1..+1) as stored by the combiner.
+int8_t chase_quantize(float soft);
+
+/**
+ * @brief Adds one failed copy and retries the CRC on the sum.
+ *
+ * @param soft  one value per body bit, from chase_quantize
+ * @param bits  body length in bits (header + payload + crc)
+ * @param body  receives the sliced body when the sum passes
+ * @return body length in bytes when recovered, 0 otherwise
+ */
+size_t chase_combine(chase_t *chase, const int8_t *soft, size_t bits, uint64_t now_us, uint8_t *body);
+
+// A good copy arrived; drops the slot it would have been combined into.
+void chase_forget(chase_t *chase, const uint8_t *body);
+
+#endif // CHASE_H
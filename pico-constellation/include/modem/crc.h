@@ -0,0 +1,49 @@
+#ifndef CRC_H
+#define CRC_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+/*
+ * Frame check sequences used by the modem:
+ *
+ *   CRC_16_CCITT_FALSE   poly 0x1021, init 0xFFFF, MSB first, no final XOR
+ *                        (modem_frame); check("123456789") = 0x29B1
+ *   CRC_16_X25           poly 0x1021 reflected, init 0xFFFF, LSB first,
+ *                        final XOR 0xFFFF (HDLC / AX.25); check = 0x906E
+ *
+ * crc_compute() hands whole buffers to an engine when one is registered
+ * (the DMA sniffer on the Pico, see drivers/crc_dma.h) and falls back to
+ * byte-table software otherwise. Both give the same result.
+ */
+typedef enum
+{
+    CRC_16_CCITT_FALSE = 0,
+    CRC_16_X25,
+    CRC_TYPE_COUNT
+} crc_type_t;
+
+// Computes a whole-buffer CRC; returns 0, or -1 to let software do it.
+typedef int (*crc_engine_t)(crc_type_t type, const uint8_t *data, size_t len, uint16_t *crc);
+
+// Buffers shorter than min_len stay in software, where setup costs less.
+void crc_set_engine(crc_engine_t engine, size_t min_len);
+
+uint16_t crc_compute(crc_type_t type, const uint8_t *data, size_t len);
+
+uint16_t crc_software(crc_type_t type, const uint8_t *data, size_t len);
+
+// Running register updates for callers that feed bytes in pieces (no final XOR).
+uint16_t crc16_ccitt_update(uint16_t crc, const uint8_t *data, size_t len);
+uint16_t crc16_x25_update(uint16_t crc, const uint8_t *data, size_t len);
+
+/*
+ * A CRC-16 sniffer (MSB-first CCITT, optionally on bit-reversed bytes)
+ * computes both types: the seed to load and how to turn its accumulator
+ * into the CRC.
+ */
+uint32_t crc_sniffer_seed(crc_type_t type);
+int crc_sniffer_reflected(crc_type_t type);
+uint16_t crc_from_sniffer(crc_type_t type, uint32_t accumulator);
+
+#endif // CRC_H
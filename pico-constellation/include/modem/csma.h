@@ -0,0 +1,71 @@
+#ifndef CSMA_H
+#define CSMA_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/*
+ * p-persistent CSMA, with the KISS TNC parameters:
+ *
+ *   txdelay   PTT key-up to the first bit, while the radio turns around
+ *   slot      time between persistence draws
+ *   persist   chance of keying up on a clear slot, (persist + 1) / 256
+ *
+ * With a frame queued, every slot the channel is clear a random byte is
+ * drawn and the transmitter keys up if it is <= persist; a busy channel
+ * (carrier detect) waits another slot. The caller owns the frame queue,
+ * the PTT line and the clock.
+ */
+#define CSMA_DEFAULT_TXDELAY_US 300000
+#define CSMA_DEFAULT_SLOT_US 100000
+#define CSMA_DEFAULT_PERSIST 63
+
+typedef struct csma_config
+{
+    uint32_t txdelay_us;
+    uint32_t slot_us;
+    uint8_t persist;
+} csma_config_t;
+
+typedef enum
+{
+    CSMA_IDLE = 0, // nothing queued
+    CSMA_DEFER,    // waiting for a clear slot that wins the draw
+    CSMA_KEYUP,    // PTT on, waiting out txdelay
+    CSMA_TRANSMIT, // sending; csma_done when the frame is out
+} csma_state_t;
+
+typedef struct csma_stats
+{
+    uint32_t keyups;
+    uint32_t busy_slots;    // slots lost to carrier detect
+    uint32_t lost_draws;    // clear slots that lost the persistence draw
+} csma_stats_t;
+
+typedef struct csma
+{
+    csma_config_t config;
+    csma_state_t state;
+    uint64_t next_us;       // next slot, or end of txdelay
+    csma_stats_t stats;
+} csma_t;
+
+void csma_default_config(csma_config_t *config);
+
+int csma_init(csma_t *csma, const csma_config_t *config);
+
+// A frame is waiting; the first slot is now.
+void csma_request(csma_t *csma, uint64_t now_us);
+
+// Steps the state machine; random is a fresh uniform byte. Returns the new state.
+csma_state_t csma_update(csma_t *csma, uint64_t now_us, bool busy, uint8_t random);
+
+// The frame is out: back to idle, or deferring again if more are queued.
+void csma_done(csma_t *csma, uint64_t now_us, bool more);
+
+static inline bool csma_ptt(const csma_t *csma)
+{
+    return csma->state == CSMA_KEYUP || csma->state == CSMA_TRANSMIT;
+}
+
+#endif // CSMA_H
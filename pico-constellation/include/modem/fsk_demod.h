@@ -0,0 +1,61 @@
+#ifndef FSK_DEMOD_H
+#define FSK_DEMOD_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#include "modem/nco.h"
+#include "modem/modem_profile.h"
+
+/**
+ * @brief Non-coherent binary FSK demodulator.
+ *
+ * Each tone is mixed to baseband and integrated over a sliding one-symbol
+ * window. The window advances in "chips" of 1/oversample symbol, and one
+ * output is produced per chip.
+ */
+typedef struct fsk_demod_config
+{
+    uint32_t sample_rate; // Hz
+    uint16_t baud;        // symbols per second
+    uint8_t oversample;   // chips per symbol, <= MODEM_MAX_OVERSAMPLE
+    float tone_hz[2];     // tone for bit 0, tone for bit 1
+} fsk_demod_config_t;
+
+typedef struct fsk_chip
+{
+    float metric;   // (E1 - E0) / (E1 + E0), -1 (bit 0) .. +1 (bit 1)
+    float level[2]; // tone amplitude estimates in ADC counts
+} fsk_chip_t;
+
+typedef struct fsk_demod
+{
+    nco_t nco[2];
+    int32_t dc;                   // DC estimate, Q10
+    int32_t acc_i[2], acc_q[2];   // partial sums of the current chip
+    int32_t ring_i[2][MODEM_MAX_OVERSAMPLE];
+    int32_t ring_q[2][MODEM_MAX_OVERSAMPLE];
+    int32_t sum_i[2], sum_q[2];   // one-symbol window sums
+    uint8_t ring_pos;
+    uint8_t oversample;
+    uint32_t chip_len;            // samples per chip, Q16
+    uint32_t chip_pos;            // samples into the current chip, Q16
+    float level_scale;
+    uint32_t chip_count;
+} fsk_demod_t;
+
+int fsk_demod_config_from_profile(fsk_demod_config_t *config, const modem_profile_t *profile, uint8_t carrier);
+
+int fsk_demod_init(fsk_demod_t *demod, const fsk_demod_config_t *config);
+void fsk_demod_reset(fsk_demod_t *demod);
+
+// Skips count samples without mixing (e.g. while squelched): keeps NCO phase
+// and DC estimate so the detector resumes cleanly, and empties the window.
+void fsk_demod_skip(fsk_demod_t *demod, size_t count, float dc);
+
+// Returns the number of samples consumed; stops early when chips[] is full.
+size_t fsk_demod_process(fsk_demod_t *demod, const uint16_t *samples, size_t count,
+                         fsk_chip_t *chips, size_t max_chips, size_t *num_chips);
+
+#endif // FSK_DEMOD_H
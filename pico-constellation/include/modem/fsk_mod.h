@@ -0,0 +1,76 @@
+#ifndef FSK_MOD_H
+#define FSK_MOD_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "modem/nco.h"
+#include "modem/modem_profile.h"
+
+/**
+ * @brief Sample-based FSK and PSK modulator.
+ *
+ * Produces phase-continuous 12-bit samples centred on MODEM_ADC_MIDPOINT,
+ * i.e. the same format the ADC path delivers. Symbol boundaries are kept on
+ * a Q16 sample clock so non-integer samples-per-symbol do not drift.
+ *
+ * Multi-carrier profiles sum one oscillator per carrier; each carrier gets
+ * amplitude / carriers so the sum never exceeds the requested peak. M-ary
+ * profiles use one oscillator and pick its tone from the symbol value.
+ * PSK profiles keep one oscillator on the carrier and step its phase at
+ * each symbol boundary.
+ */
+typedef struct fsk_mod
+{
+    nco_t nco[MODEM_MAX_CARRIERS];
+    uint32_t tone_step[MODEM_MAX_CARRIERS][2];
+    uint32_t mfsk_step[MODEM_MAX_TONES];
+    modem_modulation_t modulation;
+    uint8_t carriers;
+    uint8_t tones;
+    uint8_t bits_per_symbol;
+    uint32_t symbol_len; // samples per symbol, Q16
+    uint32_t symbol_pos; // Q16 carry between symbols
+    int16_t amplitude;   // per-carrier peak, ADC counts
+    unsigned shared_one; // symbol for a preamble / sync word 1
+} fsk_mod_t;
+
+int fsk_mod_init(fsk_mod_t *mod, const modem_profile_t *profile, int16_t amplitude);
+
+// Number of samples the next symbol will occupy.
+size_t fsk_mod_symbol_samples(const fsk_mod_t *mod);
+
+// Writes one symbol and returns the count written, or 0 if out is too small.
+// FSK: bit k selects the tone of carrier k. MFSK: the Gray-coded symbol value.
+// PSK: the bits selecting the phase change.
+size_t fsk_mod_symbol(fsk_mod_t *mod, unsigned symbol, uint16_t *out, size_t max_samples);
+
+// fsk_mod_symbol in two steps, for output that does not hold a whole symbol:
+// begin sets the symbol's tones or phase and returns its length in samples,
+// render writes the next count samples of whatever is set.
+size_t fsk_mod_begin_symbol(fsk_mod_t *mod, unsigned symbol);
+void fsk_mod_render(fsk_mod_t *mod, uint16_t *out, size_t count);
+
+// Modulates packed MSB-first bits, bits_per_symbol per symbol; returns the number of samples written.
+size_t fsk_mod_bits(fsk_mod_t *mod, const uint8_t *bits, size_t num_bits, uint16_t *out, size_t max_samples);
+
+// As fsk_mod_bits, but the first shared_bits (preamble and sync word) are
+// sent one per symbol: on every carrier, on the outer MFSK tones, or as
+// BPSK phase changes.
+size_t fsk_mod_frame(fsk_mod_t *mod, const uint8_t *bits, size_t num_bits, size_t shared_bits,
+                     uint16_t *out, size_t max_samples);
+
+// As fsk_mod_frame, from bit *pos up to the first symbol that does not fit;
+// *pos is left there, so a frame can be sent a buffer at a time.
+size_t fsk_mod_frame_part(fsk_mod_t *mod, const uint8_t *bits, size_t num_bits, size_t shared_bits, size_t *pos,
+                          uint16_t *out, size_t max_samples);
+
+// The symbol fsk_mod_frame would send for the bits at *pos, which it moves past
+// them; for sending a frame as symbols rather than samples.
+unsigned fsk_mod_next_symbol(const fsk_mod_t *mod, const uint8_t *bits, size_t num_bits, size_t shared_bits,
+                             size_t *pos);
+
+// Bits a symbol value needs: carriers for FSK, bits_per_symbol otherwise.
+unsigned fsk_mod_symbol_width(const fsk_mod_t *mod);
+
+#endif // FSK_MOD_H
@@ -0,0 +1,93 @@
+#ifndef HDLC_H
+#define HDLC_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+/*
+ * HDLC as used by AX.25 packet radio, bits sent LSB first:
+ *
+ *   flags      0x7E, never bit stuffed
+ *   frame      any number of bytes, a 0 inserted after every five 1s
+ *   fcs        CRC-16/X.25 over the frame, low byte first
+ *   flags      0x7E; seven or more 1s in a row abort the frame
+ *
+ * On the line every 0 is sent as a tone change and every 1 as no change
+ * (NRZI). Line bits are packed LSB first: bit 0 of byte 0 goes out first.
+ */
+#define HDLC_FLAG 0x7E
+#define HDLC_FCS_SIZE 2
+#define HDLC_FCS_GOOD 0xF0B8       // CRC register after a frame and its own FCS
+#define HDLC_MAX_FRAME 330         // largest AX.25 frame (8 digipeaters, 256 info bytes) plus FCS
+#define HDLC_MIN_FRAME 3           // at least one byte before the FCS
+
+uint16_t hdlc_fcs(const uint8_t *data, size_t len);
+
+// Continues an FCS over more bytes; start from 0xFFFF and invert at the end.
+uint16_t hdlc_fcs_update(uint16_t crc, const uint8_t *data, size_t len);
+
+/**
+ * @brief Bit stuffing and NRZI encoder, one byte at a time.
+ *
+ * Each call returns the line bits for one flag or data byte (LSB first,
+ * 8 to 10 of them) from two 256-entry tables, so the cost per byte does not
+ * depend on its bit pattern.
+ */
+typedef struct hdlc_encoder
+{
+    uint8_t ones;   // trailing 1s since the last 0, for stuffing
+    uint8_t level;  // current line level
+} hdlc_encoder_t;
+
+void hdlc_encoder_init(hdlc_encoder_t *enc);
+uint16_t hdlc_encoder_flag(hdlc_encoder_t *enc, uint8_t *num_bits);
+uint16_t hdlc_encoder_byte(hdlc_encoder_t *enc, uint8_t byte, uint8_t *num_bits);
+
+// Encodes a whole frame with its FCS between lead_flags and tail_flags flags.
+// Returns the number of line bits written to line, or 0 if max_bytes is too small.
+size_t hdlc_encode(const uint8_t *frame, size_t len, uint16_t lead_flags, uint16_t tail_flags,
+                   uint8_t *line, size_t max_bytes);
+
+typedef void (*hdlc_frame_callback_t)(void *ctx, const uint8_t *frame, size_t len);
+
+typedef struct hdlc_decoder_stats
+{
+    uint32_t frames_ok;
+    uint32_t frames_bad_fcs;
+    uint32_t frames_bad_length; // not a whole number of bytes, too short or too long
+    uint32_t aborts;
+} hdlc_decoder_stats_t;
+
+/**
+ * @brief NRZI decoder, de-stuffer and deframer.
+ *
+ * A constant transition table indexed by the run of 1s and the next bit
+ * decides whether the bit is data, a stuffed 0, a flag or an abort. The
+ * five 1s that start a flag are taken as data until the flag completes and
+ * are then dropped again, so no look-ahead is needed. Frames with a good
+ * FCS are passed to the callback without it.
+ */
+typedef struct hdlc_decoder
+{
+    uint8_t state;      // run of 1s, see hdlc.c
+    uint8_t level;      // previous line level
+    bool in_frame;      // a flag has been seen and no abort since
+    uint16_t bits;      // data bits since the flag
+    uint8_t frame[HDLC_MAX_FRAME + 1];
+
+    hdlc_frame_callback_t callback;
+    void *callback_ctx;
+    hdlc_decoder_stats_t stats;
+} hdlc_decoder_t;
+
+void hdlc_decoder_init(hdlc_decoder_t *dec, hdlc_frame_callback_t callback, void *ctx);
+void hdlc_decoder_reset(hdlc_decoder_t *dec);
+
+// Feeds one line level (0 or 1).
+void hdlc_decoder_push(hdlc_decoder_t *dec, unsigned level);
+
+// Feeds num_bits line levels packed LSB first.
+void hdlc_decoder_push_bits(hdlc_decoder_t *dec, const uint8_t *line, size_t num_bits);
+
+#endif // HDLC_H
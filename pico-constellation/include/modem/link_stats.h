@@ -0,0 +1,47 @@
+#ifndef LINK_STATS_H
+#define LINK_STATS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "modem/modem_rx.h"
+
+#define LINK_STATS_MAX_PEERS 16
+#define LINK_STATS_AVERAGE_FRAMES 8 // time constant of the rolling averages, in frames
+
+typedef struct link_peer
+{
+    bool used;
+    uint8_t addr;
+    uint32_t frames;
+    uint32_t frames_with_info;  // frames that came with link quality
+    uint32_t corrected_bits;
+    float snr_db;               // rolling averages over frames with info
+    float snr_min_db;
+    float mark_level;
+    float space_level;
+    float offset_hz;
+    float latency_us;
+    uint64_t first_seen_us;
+    uint64_t last_seen_us;
+} link_peer_t;
+
+/**
+ * @brief Rolling per-peer link quality, built from received frames.
+ *
+ * Peers are keyed by source address. When the table is full the peer heard
+ * from least recently is replaced.
+ */
+typedef struct link_stats
+{
+    link_peer_t peers[LINK_STATS_MAX_PEERS];
+} link_stats_t;
+
+void link_stats_init(link_stats_t *stats);
+
+// Records one frame from addr; info may be NULL when the receiver gives none.
+link_peer_t *link_stats_update(link_stats_t *stats, uint8_t addr, const modem_rx_frame_info_t *info, uint64_t now_us);
+
+const link_peer_t *link_stats_find(const link_stats_t *stats, uint8_t addr);
+
+#endif // LINK_STATS_H
@@ -0,0 +1,30 @@
+#ifndef MFSK_H
+#define MFSK_H
+
+#include <stdint.h>
+
+/*
+ * M-ary FSK symbol mapping. Tone i carries the Gray code of i, so the most
+ * likely error (a neighbouring tone) costs a single bit.
+ */
+
+static inline unsigned mfsk_gray(unsigned tone)
+{
+    return tone ^ (tone >> 1);
+}
+
+static inline unsigned mfsk_tone_for_bits(unsigned bits)
+{
+    unsigned tone = bits;
+    for (unsigned shift = 1; shift < 8; shift <<= 1)
+    {
+        tone ^= tone >> shift;
+    }
+    return tone;
+}
+
+// Soft bits (MSB first, positive = 1, -1..+1) from per-tone energies using the
+// max-log rule; returns the hard decision.
+unsigned mfsk_soft_bits(const float *energy, uint8_t tones, float total, float *soft);
+
+#endif // MFSK_H
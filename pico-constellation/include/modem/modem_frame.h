@@ -0,0 +1,45 @@
+#ifndef MODEM_FRAME_H
+#define MODEM_FRAME_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+/*
+ * On-air frame, bits sent MSB first:
+ *
+ *   preamble   MODEM_FRAME_PREAMBLE_BITS alternating 1010...
+ *   sync word  MODEM_FRAME_SYNC_BITS
+ *   header     length, destination, source (1 byte each)
+ *   payload    length bytes
+ *   crc        CRC-16/CCITT-FALSE over header and payload, big endian
+ */
+#define MODEM_FRAME_PREAMBLE_BITS 4
+#define MODEM_FRAME_SYNC_WORD 0x6877 // sidelobes <= 2/16 against itself and the preamble
+#define MODEM_FRAME_SYNC_BITS 16
+#define MODEM_FRAME_HEADER_SIZE 3
+#define MODEM_FRAME_CRC_SIZE 2
+#define MODEM_FRAME_MAX_PAYLOAD 128
+#define MODEM_FRAME_MAX_BODY (MODEM_FRAME_HEADER_SIZE + MODEM_FRAME_MAX_PAYLOAD + MODEM_FRAME_CRC_SIZE)
+#define MODEM_FRAME_MAX_BITS (MODEM_FRAME_PREAMBLE_BITS + MODEM_FRAME_SYNC_BITS + MODEM_FRAME_MAX_BODY * 8)
+
+typedef struct modem_frame
+{
+    uint8_t dst;
+    uint8_t src;
+    uint8_t length;
+    uint8_t payload[MODEM_FRAME_MAX_PAYLOAD];
+} modem_frame_t;
+
+uint16_t modem_frame_crc16(const uint8_t *data, size_t len);
+
+// Body size (header + payload + crc) for a given header length byte.
+size_t modem_frame_body_size(uint8_t length);
+
+// Packs preamble, sync word and body MSB-first into bits; returns 0 on success.
+int modem_frame_build(uint8_t dst, uint8_t src, const uint8_t *payload, size_t len,
+                      uint8_t *bits, size_t max_bytes, size_t *num_bits);
+
+// Validates a received body (header + payload + crc) and unpacks it.
+int modem_frame_parse(const uint8_t *body, size_t body_len, modem_frame_t *frame);
+
+#endif // MODEM_FRAME_H
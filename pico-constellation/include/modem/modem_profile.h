@@ -0,0 +1,82 @@
+#ifndef MODEM_PROFILE_H
+#define MODEM_PROFILE_H
+
+#include <stdint.h>
+
+#define MODEM_ADC_MIDPOINT 2048     // 12-bit ADC mid-scale
+#define MODEM_MAX_OVERSAMPLE 16     // maximum demodulator outputs (chips) per symbol
+#define MODEM_MAX_CARRIERS 8        // maximum parallel tone pairs
+#define MODEM_MAX_TONES 8           // maximum M-ary FSK tone set
+#define MODEM_MAX_SYMBOL_BITS 8     // maximum body bits per symbol
+
+typedef enum
+{
+    MODEM_MOD_FSK = 0, // binary FSK on one or more tone pairs
+    MODEM_MOD_MFSK,    // one of M tones per symbol, Gray coded
+    MODEM_MOD_BPSK,    // differential BPSK on one carrier, coherent receiver
+    MODEM_MOD_QPSK,    // differential QPSK on one carrier, coherent receiver
+} modem_modulation_t;
+
+typedef enum
+{
+    MODEM_PROFILE_FSK_32 = 0, // 1200/2200 Hz binary FSK, 32 baud
+    MODEM_PROFILE_MC4_32,     // 4 tone pairs, 32 baud each, 128 bit/s
+    MODEM_PROFILE_MC8_32,     // 8 tone pairs, 32 baud each, 256 bit/s
+    MODEM_PROFILE_MFSK4_32,   // 4-FSK, 32 baud, 64 bit/s
+    MODEM_PROFILE_MFSK8_32,   // 8-FSK, 32 baud, 96 bit/s
+    MODEM_PROFILE_BPSK_32,    // BPSK at 1500 Hz, 32 baud, 32 bit/s
+    MODEM_PROFILE_QPSK_250,   // QPSK at 1500 Hz, 250 baud, 500 bit/s
+    MODEM_PROFILE_AFSK_1200,  // Bell 202 at 1200 baud, AX.25/HDLC framing (ax25_rx, ax25_tx)
+    MODEM_PROFILE_COUNT
+} modem_profile_id_t;
+
+/*
+ * Multi-carrier profiles send one bit per carrier per symbol. Preamble and
+ * sync word are sent on every carrier at once so the receiver can average
+ * them; the frame body is spread across carriers, bit n on carrier n % K.
+ * Tones sit on multiples of the baud rate so the one-symbol integrators of
+ * neighbouring tones are orthogonal.
+ *
+ * M-ary FSK profiles send log2(M) bits per symbol on a single tone; the
+ * preamble and sync word use the lowest and highest tone.
+ *
+ * PSK profiles key the phase of a single carrier. Bits select a phase
+ * change relative to the previous symbol (BPSK: 1 = none, 0 = 180 degrees;
+ * QPSK dibits: 11 = 0, 01 = 90, 00 = 180, 10 = 270 degrees); the preamble
+ * and sync word use the BPSK changes on both.
+ *
+ * The AFSK 1200 profile is the packet radio / APRS standard: mark (1200 Hz)
+ * and space (2200 Hz) carry NRZI line levels, not data bits, and frames are
+ * HDLC rather than the preamble / sync word format above.
+ */
+typedef struct modem_profile
+{
+    const char *name;
+    modem_modulation_t modulation;
+    uint32_t sample_rate;                 // ADC/DAC sample rate in Hz
+    uint16_t baud;                        // symbols per second
+    uint8_t oversample;                   // demodulator outputs (chips) per symbol
+    uint8_t carriers;                     // parallel tone pairs, 1 for plain FSK
+    float tone_hz[MODEM_MAX_CARRIERS][2]; // per carrier: tone for bit 0, tone for bit 1
+    uint8_t tones;                        // MFSK: tone count, a power of two
+    float mfsk_hz[MODEM_MAX_TONES];       // MFSK: tone i carries the Gray code of i
+    float carrier_hz;                     // PSK: carrier frequency
+} modem_profile_t;
+
+const modem_profile_t *modem_profile_get(modem_profile_id_t id);
+
+// Body bits carried by one symbol.
+uint8_t modem_profile_bits_per_symbol(const modem_profile_t *profile);
+
+// Aggregate bit rate of the frame body.
+uint32_t modem_profile_bit_rate(const modem_profile_t *profile);
+
+// Tone for a symbol value on single-tone profiles (plain FSK or MFSK), e.g.
+// for dac_bsp_set_tone(); the carrier for PSK, 0 for multi-carrier profiles.
+float modem_profile_tone_hz(const modem_profile_t *profile, unsigned symbol);
+
+// Symbol that sends one preamble / sync word bit: every carrier's bit-1
+// tone, the top MFSK tone, or no PSK phase change for a 1; symbol 0 for a 0.
+unsigned modem_profile_shared_symbol(const modem_profile_t *profile, unsigned bit);
+
+#endif // MODEM_PROFILE_H
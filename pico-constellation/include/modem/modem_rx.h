@@ -0,0 +1,197 @@
+#ifndef MODEM_RX_H
+#define MODEM_RX_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#include "modem/fsk_demod.h"
+#include "modem/tone_bank.h"
+#include "modem/psk_demod.h"
+#include "modem/preamble_correlator.h"
+#include "modem/modem_frame.h"
+#include "modem/modem_profile.h"
+#include "modem/squelch.h"
+#include "modem/chase.h"
+
+#define MODEM_RX_CHIP_BATCH 16
+#define MODEM_RX_SYNC_THRESHOLD 0.6f
+#define MODEM_RX_SQUELCH_TIMEOUT_SYMBOLS 64 // open without a sync word this long re-learns the noise floor
+
+typedef void (*modem_rx_callback_t)(void *ctx, const uint8_t *data, size_t len, uint8_t src_addr);
+typedef void (*modem_rx_bit_callback_t)(void *ctx, unsigned bit, uint32_t index);
+
+typedef enum
+{
+    MODEM_RX_HUNT = 0, // correlating for the sync word
+    MODEM_RX_BODY,     // slicing header, payload and crc (or stream bits)
+} modem_rx_state_t;
+
+typedef struct modem_rx_stats
+{
+    uint32_t sync_detects;
+    uint32_t frames_ok;
+    uint32_t frames_bad_crc;
+    uint32_t frames_combined;   // bad copies recovered by chase combining
+    uint32_t frames_bad_header;
+    uint32_t frames_lost_carrier;
+    uint32_t squelch_timeouts;
+    uint32_t streams;           // stream mode: sync words followed by stream bits
+    uint64_t samples_demodulated;
+    uint64_t samples_gated;
+} modem_rx_stats_t;
+
+/**
+ * @brief Time spent per stage, kept only with a timer (modem_rx_set_timer).
+ */
+typedef struct modem_rx_timing
+{
+    uint64_t squelch_ns; // squelch_update on every block
+    uint64_t front_ns;   // demodulator front end, raw chips to modem_chip_t
+    uint64_t chips_ns;   // correlator, slicer, frame check and callbacks
+    uint64_t blocks;     // calls to modem_rx_process
+} modem_rx_timing_t;
+
+/**
+ * @brief What the demodulator front end reports for every chip.
+ */
+typedef struct modem_chip
+{
+    float sync;                        // soft value correlated against the sync word, -1..+1
+    float strength;                    // how well the window lines up with one symbol, 0..1
+    float soft[MODEM_MAX_SYMBOL_BITS]; // body bits of the symbol ending here, positive = 1
+    float level[MODEM_MAX_SYMBOL_BITS]; // envelope of the tone (or symbol) behind each bit, ADC counts
+    float noise;                        // noise power in one tone's detector, ADC counts^2
+} modem_chip_t;
+
+/**
+ * @brief Link quality of the frame being delivered, valid inside the callback.
+ *
+ * Sample numbers count every sample given to modem_rx_process since init.
+ * The wall-clock fields need a clock (modem_rx_set_clock) and assume each
+ * block is handed over as soon as its last sample has been captured.
+ */
+typedef struct modem_rx_frame_info
+{
+    float snr_db;             // SNR of one tone in a 3 kHz bandwidth, from the detector levels
+    float mark_level;         // mean envelope behind the 1 bits (binary FSK: mark tone)
+    float space_level;        // mean envelope behind the 0 bits (binary FSK: space tone)
+    float offset_hz;          // carrier offset seen by the PSK loop, 0 for FSK front ends
+    uint16_t corrected_bits;  // repaired by FEC or chase combining, 0 otherwise
+    uint16_t body_bits;
+    uint64_t first_sample;    // start of the sync word, to within a chip
+    uint64_t last_sample;     // end of the CRC
+    uint64_t timestamp_us;    // capture time of first_sample
+    uint32_t latency_us;      // from the capture of last_sample to the callback
+} modem_rx_frame_info_t;
+
+/**
+ * @brief Frame receiver: demodulator -> sync correlator -> slicer -> frame check.
+ *
+ * The front end depends on the profile: a bank of binary FSK detectors (one
+ * per carrier, run over the same sample block), a Goertzel bin bank for
+ * M-ary FSK, or the Costas-loop PSK demodulator. Either way it reduces each
+ * chip to a modem_chip_t.
+ *
+ * Symbol timing comes from the correlator peak and is then tracked with an
+ * early/late gate on the chips either side of each decision. When the
+ * squelch is enabled it runs first on every block and the demodulator is
+ * skipped while the channel is idle.
+ */
+typedef struct modem_rx
+{
+    squelch_t squelch;
+    bool squelch_enabled;
+    uint32_t hunt_open_samples;
+    uint32_t squelch_timeout_samples;
+
+    modem_modulation_t modulation;
+    union
+    {
+        fsk_demod_t fsk[MODEM_MAX_CARRIERS];
+        tone_bank_t mfsk;
+        psk_demod_t psk;
+    } demod;
+    union
+    {
+        fsk_chip_t fsk[MODEM_MAX_CARRIERS][MODEM_RX_CHIP_BATCH];
+        tone_bank_chip_t mfsk[MODEM_RX_CHIP_BATCH];
+        psk_chip_t psk[MODEM_RX_CHIP_BATCH];
+    } raw;
+    modem_chip_t chips[MODEM_RX_CHIP_BATCH];
+    preamble_correlator_t corr;
+
+    modem_rx_state_t state;
+    uint8_t oversample;
+    uint8_t carriers;
+    uint8_t tones;
+    uint8_t bits_per_symbol;
+    uint16_t countdown;   // chips until the chip after the next decision
+    modem_chip_t early;   // two chips before the newest
+    modem_chip_t prompt;  // one chip before the newest
+    float timing_error;
+
+    uint8_t body[MODEM_FRAME_MAX_BODY];
+    size_t body_bits;
+    size_t body_expected;
+    int8_t soft[MODEM_FRAME_MAX_BODY * 8]; // body soft values, kept only with a combiner
+    chase_t *chase;
+
+    // Link quality of the frame in progress
+    uint32_t sample_rate;
+    uint16_t baud;
+    float samples_per_chip;
+    float level_scale;      // M-ary FSK bin magnitude to ADC counts
+    uint64_t sample_count;  // samples consumed so far
+    uint64_t chip_sample;   // sample at which the current chip ends
+    float signal_sum;       // squared envelopes behind the body bits
+    float noise_sum;        // detector noise power, once per symbol
+    uint32_t symbols;
+    float level_sum[2];     // space, mark
+    uint32_t level_count[2];
+    uint64_t (*clock_us)(void);
+    uint64_t block_end_us;
+    uint64_t block_end_sample;
+    modem_rx_frame_info_t info;
+
+    modem_rx_callback_t callback;
+    void *callback_ctx;
+    modem_rx_bit_callback_t stream_callback;
+    void *stream_ctx;
+    uint32_t stream_bits;
+    uint64_t (*timer_ns)(void);
+    modem_rx_timing_t timing;
+    modem_rx_stats_t stats;
+} modem_rx_t;
+
+int modem_rx_init(modem_rx_t *rx, const modem_profile_t *profile, modem_rx_callback_t callback, void *ctx);
+void modem_rx_reset(modem_rx_t *rx);
+
+int modem_rx_set_squelch(modem_rx_t *rx, bool enabled, const squelch_config_t *config);
+
+int modem_rx_process(modem_rx_t *rx, const uint16_t *samples, size_t count);
+
+// Optional monotonic clock used to timestamp frames.
+void modem_rx_set_clock(modem_rx_t *rx, uint64_t (*clock_us)(void));
+
+// Optional nanosecond clock for per-stage timing (rx->timing); NULL turns it off.
+void modem_rx_set_timer(modem_rx_t *rx, uint64_t (*clock_ns)(void));
+
+// Link quality of the frame just delivered; call from the receive callback.
+const modem_rx_frame_info_t *modem_rx_frame_info(const modem_rx_t *rx);
+
+// Stream mode, for link tests: after each sync word the next stream_bits
+// sliced bits go to callback, numbered from 0, instead of being framed
+// (0: until modem_rx_resync). A NULL callback goes back to frames.
+void modem_rx_set_stream(modem_rx_t *rx, modem_rx_bit_callback_t callback, void *ctx, uint32_t stream_bits);
+
+// Drops symbol timing and hunts for the next sync word.
+void modem_rx_resync(modem_rx_t *rx);
+
+// Optional chase combiner for frames that fail the CRC; NULL turns it off.
+void modem_rx_set_chase(modem_rx_t *rx, chase_t *chase);
+
+// Data carrier detect: a carrier is present or a frame is being received.
+bool modem_rx_dcd(const modem_rx_t *rx);
+
+#endif // MODEM_RX_H
@@ -0,0 +1,46 @@
+#ifndef NCO_H
+#define NCO_H
+
+#include <stdint.h>
+
+#define NCO_TABLE_BITS 10
+#define NCO_TABLE_SIZE (1 << NCO_TABLE_BITS)
+
+/**
+ * @brief Numerically controlled oscillator.
+ *
+ * 32-bit phase accumulator indexing a shared Q15 sine table. Changing the
+ * step keeps the phase, so tone switches are phase-continuous.
+ */
+typedef struct nco
+{
+    uint32_t phase;
+    uint32_t step;
+} nco_t;
+
+extern int16_t nco_sine_table[NCO_TABLE_SIZE];
+
+void nco_init(nco_t *nco, float frequency, uint32_t sample_rate);
+uint32_t nco_step(float frequency, uint32_t sample_rate);
+
+static inline void nco_set_step(nco_t *nco, uint32_t step)
+{
+    nco->step = step;
+}
+
+static inline int16_t nco_sin(const nco_t *nco)
+{
+    return nco_sine_table[nco->phase >> (32 - NCO_TABLE_BITS)];
+}
+
+static inline int16_t nco_cos(const nco_t *nco)
+{
+    return nco_sine_table[(nco->phase + 0x40000000u) >> (32 - NCO_TABLE_BITS)];
+}
+
+static inline void nco_advance(nco_t *nco)
+{
+    nco->phase += nco->step;
+}
+
+#endif // NCO_H
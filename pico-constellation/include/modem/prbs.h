@@ -0,0 +1,104 @@
+#ifndef PRBS_H
+#define PRBS_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+/*
+ * Pseudo-random bit sequences for link testing (ITU-T O.150 polynomials,
+ * not inverted):
+ *
+ *   PRBS-9   x^9 + x^5 + 1     period 511
+ *   PRBS-15  x^15 + x^14 + 1   period 32767
+ *
+ * Every bit is the XOR of the bits order and tap places before it, so a
+ * receiver can lock onto the sequence from the received bits alone.
+ */
+#define PRBS_SYNC_BITS 32       // predictable bits in a row before the checker locks
+#define PRBS_LOSS_WINDOW 128    // bits per out-of-sync check while locked
+#define PRBS_LOSS_ERRORS 32     // errors in one window that count as lost sync (25%)
+
+typedef enum
+{
+    PRBS_9 = 0,
+    PRBS_15,
+} prbs_type_t;
+
+typedef struct prbs
+{
+    uint16_t state; // last order bits, newest in bit 0
+    uint16_t mask;
+    uint8_t order;
+    uint8_t tap;
+} prbs_t;
+
+int prbs_init(prbs_t *prbs, prbs_type_t type);
+
+// Next bit of the sequence.
+unsigned prbs_next(prbs_t *prbs);
+
+// Packs the next num_bits MSB first, as modem_frame and fsk_mod expect.
+void prbs_fill(prbs_t *prbs, uint8_t *bits, size_t num_bits);
+
+const char *prbs_name(prbs_type_t type);
+
+typedef struct prbs_stats
+{
+    uint64_t bits;              // compared while locked
+    uint64_t errors;
+    uint32_t syncs;
+    uint32_t sync_losses;
+    uint32_t seconds;           // closed with prbs_checker_second
+    uint32_t error_free_seconds; // locked throughout, no errors
+    uint32_t errored_seconds;   // locked, at least one error
+    uint32_t unsynced_seconds;  // out of lock at some point
+    uint32_t last_bits;         // the last closed second
+    uint32_t last_errors;
+} prbs_stats_t;
+
+/**
+ * @brief Self-synchronising PRBS receiver with BER and second counters.
+ *
+ * Out of lock, each received bit is checked against the XOR of the bits
+ * order and tap places before it; PRBS_SYNC_BITS correct predictions in a
+ * row seed a local generator from the received history. Locked, bits are
+ * compared with the local generator, so an error counts once instead of
+ * three times. Too many errors in a window (a bit slip, or the signal
+ * gone) drop the lock and the hunt starts again.
+ *
+ * The owner closes each wall-clock second with prbs_checker_second to get
+ * G.821-style error-free and errored seconds.
+ */
+typedef struct prbs_checker
+{
+    prbs_t ref;
+    uint16_t history;
+    uint8_t history_bits;
+    uint8_t run;
+    bool locked;
+    uint16_t window_bits;
+    uint16_t window_errors;
+
+    uint32_t second_bits;
+    uint32_t second_errors;
+    bool second_unsynced;
+
+    prbs_stats_t stats;
+} prbs_checker_t;
+
+int prbs_checker_init(prbs_checker_t *checker, prbs_type_t type);
+
+// Clears the lock and all counters.
+void prbs_checker_reset(prbs_checker_t *checker);
+
+// Checks one received bit; returns true while locked.
+bool prbs_checker_push(prbs_checker_t *checker, unsigned bit);
+
+// Closes the current second.
+void prbs_checker_second(prbs_checker_t *checker);
+
+// Errors over compared bits, 0 before any bits were compared.
+double prbs_checker_ber(const prbs_checker_t *checker);
+
+#endif // PRBS_H
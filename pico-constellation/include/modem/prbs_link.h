@@ -0,0 +1,71 @@
+#ifndef PRBS_LINK_H
+#define PRBS_LINK_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "modem/prbs.h"
+#include "modem/modem_rx.h"
+#include "modem/modem_profile.h"
+
+/*
+ * Link test stream, in bursts:
+ *
+ *   preamble + sync word   as for a frame, so the receiver gets symbol timing
+ *   marker                 the sync word again, sent as body bits
+ *   burst_bits             PRBS, bits_per_symbol per symbol as a frame body
+ *
+ * The PRBS runs on across bursts, so a locked checker stays locked as long
+ * as the receiver takes every burst. A receiver that starts late picks the
+ * stream up at the next sync word. The marker tells a real burst start from
+ * a sync-like stretch of PRBS, which would leave the receiver counting
+ * bursts from the wrong place.
+ */
+#define PRBS_LINK_BURST_SECONDS 10
+#define PRBS_LINK_MARKER_BITS MODEM_FRAME_SYNC_BITS
+#define PRBS_LINK_MARKER_ERRORS 3  // marker bits that may be wrong on a real burst
+#define PRBS_LINK_RESYNC_SECONDS 3 // out of lock this long drops symbol timing
+
+// PRBS bits per burst for a profile; the marker and PRBS fill whole symbols.
+uint32_t prbs_link_burst_bits(const modem_profile_t *profile);
+
+typedef struct prbs_link_tx
+{
+    const modem_profile_t *profile;
+    prbs_t prbs;
+    uint32_t sync;       // preamble and sync word, MSB first
+    uint8_t sync_bits;
+    uint8_t bits_per_symbol;
+    uint32_t burst_bits;
+    uint32_t pos;        // bits sent in this burst, preamble and sync word included
+} prbs_link_tx_t;
+
+int prbs_link_tx_init(prbs_link_tx_t *tx, const modem_profile_t *profile, prbs_type_t type, uint32_t burst_bits);
+
+// Next symbol, for fsk_mod_symbol() or modem_profile_tone_hz().
+unsigned prbs_link_tx_symbol(prbs_link_tx_t *tx);
+
+/**
+ * @brief Link test receiver: modem_rx in stream mode feeding a PRBS checker.
+ */
+typedef struct prbs_link_rx
+{
+    modem_rx_t rx;
+    prbs_checker_t checker;
+    uint16_t marker;
+    uint8_t unlocked_seconds;
+    uint32_t bursts;      // bursts with a good marker
+    uint32_t false_syncs; // sync words without one
+} prbs_link_rx_t;
+
+int prbs_link_rx_init(prbs_link_rx_t *link, const modem_profile_t *profile, prbs_type_t type, uint32_t burst_bits);
+
+int prbs_link_rx_process(prbs_link_rx_t *link, const uint16_t *samples, size_t count);
+
+// Closes one second of counters; call once per wall-clock second.
+void prbs_link_rx_second(prbs_link_rx_t *link);
+
+// Correct bits per second since init, preamble and time out of lock included.
+double prbs_link_rx_throughput(const prbs_link_rx_t *link);
+
+#endif // PRBS_LINK_H
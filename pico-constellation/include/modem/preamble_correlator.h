@@ -0,0 +1,59 @@
+#ifndef PREAMBLE_CORRELATOR_H
+#define PREAMBLE_CORRELATOR_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "modem/modem_profile.h"
+
+#define PREAMBLE_CORRELATOR_MAX_BITS 32
+
+/**
+ * @brief Matched-filter sync word detector running on the demodulator chip stream.
+ *
+ * The last sync_bits symbols of soft metric (one tap every oversample chips)
+ * are correlated against the known pattern on every chip. The correlation
+ * peak gives both the symbol phase and the chip on which the frame body
+ * starts, so no bit-clock training preamble is needed.
+ */
+typedef struct preamble_correlator_config
+{
+    uint32_t pattern;  // sync word, MSB sent first
+    uint8_t bits;      // pattern length, <= PREAMBLE_CORRELATOR_MAX_BITS
+    uint8_t oversample;
+    float threshold;   // normalized correlation (0..1) that arms the peak search
+} preamble_correlator_config_t;
+
+typedef struct preamble_detection
+{
+    uint32_t peak_chip;  // chip on which the last sync symbol is centred
+    uint32_t start_chip; // decision chip of the first symbol after the sync word
+    uint8_t phase;       // symbol phase, peak_chip % oversample
+    float score;         // normalized correlation at the peak
+} preamble_detection_t;
+
+typedef struct preamble_correlator
+{
+    int8_t taps[PREAMBLE_CORRELATOR_MAX_BITS];
+    float history[PREAMBLE_CORRELATOR_MAX_BITS * MODEM_MAX_OVERSAMPLE];
+    uint16_t history_len;
+    uint16_t history_pos;
+    uint8_t bits;
+    uint8_t oversample;
+    float threshold;
+    uint32_t chip_count;
+
+    bool searching;
+    uint8_t search_left;
+    uint8_t blank_left; // chips ignored after a detection so one peak reports once
+    float best_score;
+    uint32_t best_chip;
+} preamble_correlator_t;
+
+int preamble_correlator_init(preamble_correlator_t *corr, const preamble_correlator_config_t *config);
+void preamble_correlator_reset(preamble_correlator_t *corr);
+
+// Feeds one chip; returns true and fills detection once a correlation peak is confirmed.
+bool preamble_correlator_push(preamble_correlator_t *corr, float metric, preamble_detection_t *detection);
+
+#endif // PREAMBLE_CORRELATOR_H
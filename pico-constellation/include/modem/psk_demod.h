@@ -0,0 +1,105 @@
+#ifndef PSK_DEMOD_H
+#define PSK_DEMOD_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#include "modem/nco.h"
+#include "modem/modem_profile.h"
+
+#define PSK_ACQUIRE_BANDWIDTH 0.1f // Costas loop noise bandwidth while hunting, fraction of the baud rate
+#define PSK_TRACK_BANDWIDTH 0.05f  // ... and once a frame is being received
+
+/**
+ * @brief Coherent BPSK/QPSK demodulator with a Costas loop.
+ *
+ * The carrier NCO mixes each sample to baseband and integrates over one chip
+ * (1/oversample symbol), which decimates the ADC stream to the chip rate.
+ * A sliding one-symbol sum of the chips is the matched filter for the
+ * rectangular symbols the modulator sends. Its output drives a second-order
+ * Costas loop that corrects the NCO phase and frequency once per chip.
+ * While acquiring, the loop is wide and helped by a frequency-locked loop on
+ * the symbol-to-symbol rotation, so offsets well outside the Costas pull-in
+ * range are acquired within the preamble. Once the receiver has found the
+ * sync word it switches to tracking: narrow loop, no frequency assist.
+ *
+ * Symbols are differentially encoded, so the 180 (BPSK) or 90 (QPSK) degree
+ * ambiguity of the loop does not matter: soft bits compare each matched
+ * filter output with the hard decision one symbol earlier. The sync metric
+ * is the plain differential product, which does not need the loop locked.
+ */
+typedef struct psk_demod_config
+{
+    uint32_t sample_rate;    // Hz
+    uint16_t baud;           // symbols per second
+    uint8_t oversample;      // chips per symbol, <= MODEM_MAX_OVERSAMPLE
+    uint8_t bits_per_symbol; // 1 = BPSK, 2 = QPSK
+    float carrier_hz;
+    float acquire_bandwidth; // Costas loop noise bandwidth in Hz, acquiring
+    float track_bandwidth;   // Costas loop noise bandwidth in Hz, tracking
+} psk_demod_config_t;
+
+typedef struct psk_chip
+{
+    float sync;     // differential product, -1 (phase reversal) .. +1 (no change)
+    float strength; // matched filter energy / window energy, 0..1
+    float soft[2];  // body bits of the symbol ending here, MSB first, positive = 1
+    float level;    // symbol amplitude, ADC counts
+    float noise;    // error power against the nearest constellation point
+} psk_chip_t;
+
+typedef struct psk_demod
+{
+    nco_t nco;
+    uint32_t carrier_step;     // nominal NCO step
+    int32_t dc;                // DC estimate, Q10
+    int32_t acc_i, acc_q;      // partial sums of the current chip
+    float ring_i[MODEM_MAX_OVERSAMPLE];
+    float ring_q[MODEM_MAX_OVERSAMPLE];
+    float ring_power[MODEM_MAX_OVERSAMPLE];
+    float mf_i[MODEM_MAX_OVERSAMPLE]; // matched filter outputs of the last symbol
+    float mf_q[MODEM_MAX_OVERSAMPLE];
+    float sum_i, sum_q;        // matched filter, one-symbol window sums
+    float sum_power;           // chip energy over the same window
+    float power;               // average matched filter power, for normalisation
+    float lock;                // Costas lock indicator, 1 = locked, <= 0 = not
+    uint8_t ring_pos;
+    uint8_t oversample;
+    uint8_t bits_per_symbol;
+    uint32_t chip_len;         // samples per chip, Q16
+    uint32_t chip_pos;         // samples into the current chip, Q16
+    float chip_scale;          // mixer sum -> carrier amplitude units
+    float loop_k[2];           // proportional and integral gains in use
+    float acquire_k[2];
+    float track_k[2];
+    bool tracking;
+    float loop_freq;           // integrator, radians per chip
+    float fll_gain;            // frequency assist, per radian of rotation per symbol
+    float fll_re, fll_im;      // average symbol rotation with the modulation removed
+    float loop_freq_limit;
+    float chip_rate;           // chips per second
+    float rad_per_chip_to_step;
+} psk_demod_t;
+
+int psk_demod_config_from_profile(psk_demod_config_t *config, const modem_profile_t *profile);
+
+int psk_demod_init(psk_demod_t *demod, const psk_demod_config_t *config);
+void psk_demod_reset(psk_demod_t *demod);
+
+// Acquiring (wide loop with frequency assist) or tracking (narrow loop).
+// Reset returns to acquiring.
+void psk_demod_set_tracking(psk_demod_t *demod, bool tracking);
+
+// Skips count samples without mixing (e.g. while squelched); keeps the NCO
+// and DC estimate, empties the matched filter.
+void psk_demod_skip(psk_demod_t *demod, size_t count, float dc);
+
+// Returns the number of samples consumed; stops early when chips[] is full.
+size_t psk_demod_process(psk_demod_t *demod, const uint16_t *samples, size_t count,
+                         psk_chip_t *chips, size_t max_chips, size_t *num_chips);
+
+// Carrier frequency offset the Costas loop is currently correcting, in Hz.
+float psk_demod_offset_hz(const psk_demod_t *demod);
+
+#endif // PSK_DEMOD_H
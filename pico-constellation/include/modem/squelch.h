@@ -0,0 +1,61 @@
+#ifndef SQUELCH_H
+#define SQUELCH_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#define SQUELCH_BLOCK_SIZE 256 // samples per energy measurement, <= 512 keeps sums in 32 bits
+
+/**
+ * @brief Block-energy carrier detector with hysteresis.
+ *
+ * Measures the variance of each block of SQUELCH_BLOCK_SIZE samples against
+ * a tracked noise floor. The floor follows the energy down quickly and up
+ * slowly, and is frozen while open so a long frame cannot teach it the
+ * signal level.
+ */
+typedef struct squelch_config
+{
+    float open_db;      // energy above floor that opens the squelch
+    float close_db;     // energy above floor below which it starts closing
+    uint16_t attack;    // consecutive loud blocks needed to open
+    uint16_t hang;      // consecutive quiet blocks needed to close
+    float min_floor;    // floor lower bound, ADC counts^2
+} squelch_config_t;
+
+typedef struct squelch
+{
+    float open_ratio;
+    float close_ratio;
+    uint16_t attack;
+    uint16_t hang;
+    float min_floor;
+
+    float floor;        // noise floor, ADC counts^2
+    float energy;       // variance of the last block
+    float mean;         // mean of the last block, ADC counts
+    uint16_t count;     // consecutive blocks voting to change state
+    bool open;
+
+    uint32_t blocks;
+    uint32_t open_blocks;
+} squelch_t;
+
+void squelch_default_config(squelch_config_t *config);
+
+int squelch_init(squelch_t *squelch, const squelch_config_t *config);
+
+// Measures one block (count <= SQUELCH_BLOCK_SIZE); returns true while a carrier is present.
+bool squelch_update(squelch_t *squelch, const uint16_t *samples, size_t count);
+
+// Re-learns the floor from the current block and closes, e.g. when an open
+// squelch has not produced a sync word for a long time.
+void squelch_relearn(squelch_t *squelch);
+
+static inline bool squelch_is_open(const squelch_t *squelch)
+{
+    return squelch->open;
+}
+
+#endif // SQUELCH_H
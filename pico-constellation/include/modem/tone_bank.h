@@ -0,0 +1,66 @@
+#ifndef TONE_BANK_H
+#define TONE_BANK_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "modem/nco.h"
+#include "modem/modem_profile.h"
+
+#define TONE_BANK_MAX_TONES 8
+
+/**
+ * @brief Goertzel bin bank with a sliding one-symbol window.
+ *
+ * Each chip runs one Goertzel recursion per tone (one multiply per sample
+ * per bin). The chip results are rotated onto a common phase reference and
+ * summed over the last oversample chips, giving a full-symbol DFT bin for
+ * every tone on every chip.
+ */
+typedef struct tone_bank_config
+{
+    uint32_t sample_rate;
+    uint16_t baud;
+    uint8_t oversample;
+    uint8_t tones;
+    const float *tone_hz;
+} tone_bank_config_t;
+
+typedef struct tone_bank_chip
+{
+    float energy[TONE_BANK_MAX_TONES]; // |bin|^2 over the last symbol
+    float total;                        // sum of energy[]
+} tone_bank_chip_t;
+
+typedef struct tone_bank
+{
+    uint8_t tones;
+    uint8_t oversample;
+    float coeff[TONE_BANK_MAX_TONES];      // 2 cos(w)
+    float s1[TONE_BANK_MAX_TONES];
+    float s2[TONE_BANK_MAX_TONES];
+    float cos_w[TONE_BANK_MAX_TONES];
+    float sin_w[TONE_BANK_MAX_TONES];
+    nco_t reference[TONE_BANK_MAX_TONES];  // phase of the last sample of the chip
+    float ring_re[TONE_BANK_MAX_TONES][MODEM_MAX_OVERSAMPLE];
+    float ring_im[TONE_BANK_MAX_TONES][MODEM_MAX_OVERSAMPLE];
+    float sum_re[TONE_BANK_MAX_TONES];
+    float sum_im[TONE_BANK_MAX_TONES];
+    uint8_t ring_pos;
+    float dc;
+    uint32_t chip_len; // Q16
+    uint32_t chip_pos; // Q16
+    uint32_t chip_samples;
+} tone_bank_t;
+
+int tone_bank_init(tone_bank_t *bank, const tone_bank_config_t *config);
+void tone_bank_reset(tone_bank_t *bank);
+
+// Skips samples while squelched, keeping the phase reference and DC estimate.
+void tone_bank_skip(tone_bank_t *bank, size_t count, float dc);
+
+// Returns the number of samples consumed; stops early when chips[] is full.
+size_t tone_bank_process(tone_bank_t *bank, const uint16_t *samples, size_t count,
+                         tone_bank_chip_t *chips, size_t max_chips, size_t *num_chips);
+
+#endif // TONE_BANK_H
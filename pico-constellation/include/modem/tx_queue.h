@@ -0,0 +1,94 @@
+#ifndef TX_QUEUE_H
+#define TX_QUEUE_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#include "modem/fsk_mod.h"
+#include "modem/modem_profile.h"
+
+#define TX_QUEUE_SLOTS 8
+#define TX_QUEUE_MAX_BITS 4096 // symbol bits per frame: a full AX.25 frame with lead flags, or any modem_frame
+
+typedef enum
+{
+    TX_PRIORITY_HIGH = 0, // acknowledgements, beacons that must go out on time
+    TX_PRIORITY_NORMAL,   // messages
+    TX_PRIORITY_LOW,      // bulk, telemetry
+    TX_PRIORITY_COUNT
+} tx_priority_t;
+
+/**
+ * @brief Frames encoded ahead of air time, in a bounded priority queue.
+ *
+ * A frame is framed (modem_frame, or AX.25 HDLC with its FCS and bit
+ * stuffing) and mapped to the profile's symbols when it is queued, so the
+ * transmitter only copies symbols out. Symbols are packed at their width
+ * (1 bit for plain FSK, AFSK and BPSK, 2 for QPSK, 3 for MFSK-8, one per
+ * carrier for multi-carrier), LSB first.
+ *
+ * The next frame is always the oldest of the highest priority. A full
+ * queue makes room for a frame by dropping the newest of a lower priority,
+ * or drops the new frame if there is none. One frame at a time is on air,
+ * from tx_queue_next to tx_queue_done, and its slot is not reused until
+ * then. Nothing here knows about time beyond the timestamps it is given.
+ */
+typedef struct tx_frame
+{
+    uint8_t symbols[TX_QUEUE_MAX_BITS / 8];
+    uint16_t count;          // symbols
+    uint8_t priority;
+    bool used;
+    uint32_t seq;            // queue order, oldest first within a priority
+    uint32_t id;             // returned by the push, for the caller's bookkeeping
+    uint64_t queued_us;
+} tx_frame_t;
+
+typedef struct tx_queue_stats
+{
+    uint32_t queued[TX_PRIORITY_COUNT];
+    uint32_t sent[TX_PRIORITY_COUNT];
+    uint32_t dropped[TX_PRIORITY_COUNT]; // queue full: rejected or evicted
+    uint32_t rejected;                   // could not be encoded
+    uint32_t max_depth;
+    uint64_t wait_total_us[TX_PRIORITY_COUNT]; // queued to on air, over sent frames
+    uint32_t wait_max_us[TX_PRIORITY_COUNT];
+} tx_queue_stats_t;
+
+typedef struct tx_queue
+{
+    const modem_profile_t *profile;
+    fsk_mod_t mod;           // symbol mapping only
+    unsigned width;          // bits per symbol
+    tx_frame_t frames[TX_QUEUE_SLOTS];
+    int on_air;              // slot between next and done, or -1
+    uint32_t next_seq;
+    uint32_t next_id;
+    tx_queue_stats_t stats;
+} tx_queue_t;
+
+int tx_queue_init(tx_queue_t *queue, const modem_profile_t *profile);
+
+// A modem_frame for any profile but AFSK 1200; returns the frame id, or -1 if dropped.
+int32_t tx_queue_push_frame(tx_queue_t *queue, tx_priority_t priority, uint8_t dst, uint8_t src,
+                            const uint8_t *payload, size_t len, uint64_t now_us);
+
+// An AX.25 frame (no FCS) on a single-carrier FSK profile, as ax25_tx sends it; the frame id or -1.
+int32_t tx_queue_push_ax25(tx_queue_t *queue, tx_priority_t priority, const uint8_t *frame, size_t len,
+                           uint16_t lead_flags, uint16_t tail_flags, uint64_t now_us);
+
+// Takes the next frame on air, or NULL if none is waiting or one is on air already.
+const tx_frame_t *tx_queue_next(tx_queue_t *queue, uint64_t now_us);
+
+// The frame from tx_queue_next is out; its slot is free again.
+void tx_queue_done(tx_queue_t *queue);
+
+// Frames waiting, not counting the one on air.
+size_t tx_queue_depth(const tx_queue_t *queue);
+
+// Unpacks count symbols from first onwards; returns how many there were.
+size_t tx_queue_symbols(const tx_queue_t *queue, const tx_frame_t *frame, size_t first, uint8_t *out,
+                        size_t count);
+
+#endif // TX_QUEUE_H
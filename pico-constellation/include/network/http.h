@@ -0,0 +1,22 @@
+#ifndef HTTP_H
+#define HTTP_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include "network/network.h"
+
+/*
+ * Request parsing for the web UI server. No lwIP here, so the host tools
+ * can build and benchmark it.
+ */
+
+// Decodes %XX escapes and '+' from a form body or query; dst may be src.
+void url_decode(char *dst, const char *src);
+
+// Splits request in place and fills req; returns 0 or -1 if malformed or too long.
+int parse_http_request(char *request, http_request_t *req);
+
+// True once the headers and any Content-Length body are all in request.
+bool http_request_complete(const char *request, size_t request_len);
+
+#endif // HTTP_H
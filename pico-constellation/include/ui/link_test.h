@@ -0,0 +1,36 @@
+#ifndef LINK_TEST_H
+#define LINK_TEST_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "modem/prbs.h"
+#include "modem/modem_profile.h"
+
+typedef enum
+{
+    LINK_TEST_OFF = 0,
+    LINK_TEST_TRANSMIT, // key the radio and send the PRBS stream (prbs_link) forever
+    LINK_TEST_RECEIVE,  // lock onto the stream and count errors
+} link_test_role_t;
+
+/**
+ * @brief PRBS link test between two nodes, replacing the send-and-eyeball check.
+ *
+ * The transmitter keys PTT and steps the AD9833 through the prbs_link
+ * symbols from the main loop, so only single-tone profiles (plain FSK and
+ * MFSK) can be sent. With LINK_TEST_PIO, two-tone FSK goes to ad9833_fsk
+ * instead and the JSON carries its symbol timing. The receiver gets every ADC block from adc_bsp, runs
+ * the link test receiver on it, and once a second closes the counters and
+ * logs a line over USB. The UI polls the counters as JSON.
+ */
+int link_test_init(link_test_role_t role, modem_profile_id_t profile, prbs_type_t type);
+
+void link_test_feed(const uint16_t *samples, size_t count);
+
+int link_test_task(void);
+
+// {"role":...,"profile":...,"prbs":...} plus the counters of the role.
+size_t link_test_to_json(char *buffer, size_t buffer_size);
+
+#endif // LINK_TEST_H
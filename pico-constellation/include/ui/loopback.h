@@ -0,0 +1,83 @@
+#ifndef LOOPBACK_H
+#define LOOPBACK_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "modem/modem_profile.h"
+
+#define LOOPBACK_MAX_FRAMES 256
+#define LOOPBACK_NO_NOISE 100.0f // snr_db at or above this adds none
+#define LOOPBACK_MIN_SUCCESS 100 // percent of frames loopback_max_baud asks for by default
+
+/**
+ * @brief TX to RX loopback in memory, no radios needed.
+ *
+ * Frames are built and modulated a buffer at a time as the transmitter
+ * would, optionally with white noise, and written into the ADC ring with
+ * adc_hal_inject instead of going to the DAC. What the ring holds is read
+ * back the way adc_bsp does and handed to modem_rx with the squelch on.
+ * The same code runs on the device (sampling stopped) and on the host
+ * (hal-stub).
+ *
+ * Times are either capture time, counted in samples, or wall time from
+ * clock_ns. Latency is capture time from a frame's first sample entering
+ * the ring to its callback; delay is the part after its last sample. The
+ * receiver's wall time against the capture time gives the real-time
+ * factor. A profile can be run at another symbol rate, with its tones
+ * where they are, to find how fast it still decodes.
+ */
+typedef struct loopback_config
+{
+    modem_profile_id_t profile;
+    unsigned frames;
+    size_t payload;             // bytes; the first two carry the frame number
+    int16_t amplitude;          // peak, ADC counts
+    float gap_s;                // idle before each frame and after the last
+    float snr_db;               // one tone in a 3 kHz bandwidth
+    uint32_t seed;              // payload and noise
+    uint16_t baud;              // 0 keeps the profile's symbol rate
+    uint64_t (*clock_ns)(void); // wall clock; NULL leaves the wall-time fields 0
+} loopback_config_t;
+
+typedef struct loopback_report
+{
+    modem_profile_id_t profile;
+    uint16_t baud;              // the symbol rate that was run
+    uint32_t sent;
+    uint32_t ok;                // decoded with the payload that was sent
+    uint32_t bad_crc;
+    uint32_t wrong;             // passed the CRC with another payload
+    uint64_t dropped;           // overwritten in the ring, should be 0
+    double air_s;               // capture time pushed through
+    double latency_mean_ms;
+    double latency_max_ms;
+    double delay_mean_ms;
+    double tx_s;                // wall time building, modulating and injecting
+    double rx_s;                // wall time reading the ring and in modem_rx
+    double x_realtime;          // air_s / rx_s
+} loopback_report_t;
+
+void loopback_default_config(loopback_config_t *config, modem_profile_id_t profile, uint64_t (*clock_ns)(void));
+
+// Takes the ADC HAL over (init to deinit); sampling must be stopped.
+int loopback_run(const loopback_config_t *config, loopback_report_t *report);
+
+/*
+ * Highest symbol rate config's profile still decodes at: the baud is
+ * doubled from the profile's own until a run falls short, then narrowed
+ * down to a multiple of the profile's baud. A run falls short when fewer
+ * than min_success percent of the frames decode or, with a clock, the
+ * receiver falls behind real time. 0 if the profile's own baud does.
+ */
+uint16_t loopback_max_baud(const loopback_config_t *config, unsigned min_success);
+
+/*
+ * Boot-time self-test: frames on every frame-format profile (not AFSK
+ * 1200, which is HDLC framed), one log line each with the highest baud its
+ * tones still decode at, then the fastest profile that decoded everything
+ * in real time. -1 if any frame was lost.
+ */
+int loopback_self_test(unsigned frames, uint64_t (*clock_ns)(void));
+
+#endif // LOOPBACK_H
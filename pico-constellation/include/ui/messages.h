@@ -0,0 +1,18 @@
+#ifndef MESSAGES_H
+#define MESSAGES_H
+
+#include <stddef.h>
+
+#define MESSAGES_MAX 32
+
+typedef struct
+{
+    char name[32];
+    char time[32];
+    char message[100];
+} message_t;
+
+// [{"name":..,"text":..,"time":..},...] for the first count messages; stops at whole entries when out of room.
+size_t messages_to_json(const message_t *messages, int count, char *buffer, size_t buffer_size);
+
+#endif // MESSAGES_H
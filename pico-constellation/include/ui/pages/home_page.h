@@ -2,6 +2,6 @@
 #define HOME_COMPRESSED_H
 
 static const char home_compressed[] =
-    "<!doctype html><html><head><meta charset=utf-8><meta name=viewport content=\"width=device-width,initial-scale=1.0\"><style>body { margin: 0; background: #090b0f; color: #eef; height: 100vh; display: flex; flex-direction: column; gap: 10px; padding: 10px; font: 18px sans-serif; } #m { flex: 1; overflow: auto; padding: 4px; } input, button { font: 18px sans-serif; } input { width: 100%; padding: 12px; border: 1px solid #334155; border-radius: 10px; background: #0b1220; color: #eef; } button { width: 100%; padding: 12px; border: none; border-radius: 10px; background: #3b82f6; color: #fff; cursor: pointer; } article { margin: 0 0 8px; background: #111; padding: 8px; border-radius: 8px; overflow-wrap: anywhere; word-break: break-word; line-height: 1.35; } .head { display: flex; align-items: baseline; gap: 8px; margin-bottom: 4px; flex-wrap: wrap; } strong { display: inline; font-weight: 600; } time { font-size: 0.75em; opacity: 0.55; white-space: nowrap; }</style></head><body><div id=n>Node ID: %s</div><div id=m><article><strong>Loading...</strong></article></div><input id=i maxlength=100 autocomplete=off placeholder=\"Type a message...\"><button id=b>Send</button><small><span id=d>0</span>/100</small><script>const m=document.getElementById('m'); const i=document.getElementById('i'); const d=document.getElementById('d'); const b=document.getElementById('b'); i.oninput=()=>{ d.textContent=i.value.length; }; async function u() { try { const r=await fetch(\"/update\", { cache: 'no-store' }); if (!r.ok) throw 0; const j=await r.json(); m.textContent=''; if (!j || !j.length) { const a=document.createElement('article'); a.textContent='No messages yet.'; m.append(a); return; } j.slice().reverse().forEach(x=>{ const a=document.createElement('article'); const h=document.createElement('div'); h.className='head'; const s=document.createElement('strong'); s.textContent=x.name || 'Unknown'; h.append(s); if (x.time) { const t=document.createElement('time'); t.textContent=x.time; h.append(t); } a.append(h, document.createTextNode(x.text || '')); m.append(a); }); m.scrollTop=m.scrollHeight; } catch { } } b.onclick=async ()=>{ const t=i.value.trim(); if (!t) return; await fetch(\"/send\", { method: 'POST', headers: { 'Content-Type': 'application/json' }, body: JSON.stringify({ message: t }) }); i.value=''; d.textContent=0; u(); }; u(); setInterval(u, 10000);</script></body></html>";
+    "<!doctype html><html><head><meta charset=utf-8><meta name=viewport content=\"width=device-width,initial-scale=1.0\"><style>body { margin: 0; background: #090b0f; color: #eef; height: 100vh; display: flex; flex-direction: column; gap: 10px; padding: 10px; font: 18px sans-serif; } #m { flex: 1; overflow: auto; padding: 4px; } input, button { font: 18px sans-serif; } input { width: 100%; padding: 12px; border: 1px solid #334155; border-radius: 10px; background: #0b1220; color: #eef; } button { width: 100%; padding: 12px; border: none; border-radius: 10px; background: #3b82f6; color: #fff; cursor: pointer; } article { margin: 0 0 8px; background: #111; padding: 8px; border-radius: 8px; overflow-wrap: anywhere; word-break: break-word; line-height: 1.35; } .head { display: flex; align-items: baseline; gap: 8px; margin-bottom: 4px; flex-wrap: wrap; } strong { display: inline; font-weight: 600; } time { font-size: 0.75em; opacity: 0.55; white-space: nowrap; } canvas { width: calc(100vw - 20px); height: 96px; background: #000; image-rendering: pixelated; }</style></head><body><div id=n>Node ID: %s</div><canvas id=w width=128 height=96></canvas><small id=p></small><div id=m><article><strong>Loading...</strong></article></div><input id=i maxlength=100 autocomplete=off placeholder=\"Type a message...\"><button id=b>Send</button><small><span id=d>0</span>/100</small><script>const m=document.getElementById('m'); const i=document.getElementById('i'); const d=document.getElementById('d'); const b=document.getElementById('b'); i.oninput=()=>{ d.textContent=i.value.length; }; async function u() { try { const r=await fetch(\"/update\", { cache: 'no-store' }); if (!r.ok) throw 0; const j=await r.json(); m.textContent=''; if (!j || !j.length) { const a=document.createElement('article'); a.textContent='No messages yet.'; m.append(a); return; } j.slice().reverse().forEach(x=>{ const a=document.createElement('article'); const h=document.createElement('div'); h.className='head'; const s=document.createElement('strong'); s.textContent=x.name || 'Unknown'; h.append(s); if (x.time) { const t=document.createElement('time'); t.textContent=x.time; h.append(t); } a.append(h, document.createTextNode(x.text || '')); m.append(a); }); m.scrollTop=m.scrollHeight; } catch { } } b.onclick=async ()=>{ const t=i.value.trim(); if (!t) return; await fetch(\"/send\", { method: 'POST', headers: { 'Content-Type': 'application/json' }, body: JSON.stringify({ message: t }) }); i.value=''; d.textContent=0; u(); }; u(); setInterval(u, 10000); const w=document.getElementById('w'); const g=w.getContext('2d'); let q=0; async function f() { try { const r=await fetch('/spectrum?since=' + q, { cache: 'no-store' }); if (!r.ok) throw 0; const j=await r.json(); q=j.seq; j.lines.forEach(l=>{ const n=l.length/2; if (w.width !=n) w.width=n; g.drawImage(w, 0, 1); const p=g.createImageData(n, 1); for (let k=0; k<n; k++) { const v=parseInt(l.substr(2 * k, 2), 16); p.data.set([v, v * v>>8, 255 - v, 255], 4 * k); } g.putImageData(p, 0, 0); }); } catch { } } setInterval(f, 1000); const pe=document.getElementById('p'); async function h() { try { const r=await fetch('/peers', { cache: 'no-store' }); if (!r.ok) throw 0; const j=await r.json(); pe.textContent=j.map(x=>x.addr + ': ' + (x.snr===null ? 'n/a' : x.snr + ' dB') + ', ' + x.frames + ' frames, ' + x.age + ' s ago').join(' | '); } catch { } } h(); setInterval(h, 10000);</script></body></html>";
 
 #endif /* HOME_COMPRESSED_H */
@@ -0,0 +1,44 @@
+#ifndef TX_SERVICE_H
+#define TX_SERVICE_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#include "modem/modem_profile.h"
+#include "modem/tx_queue.h"
+
+/**
+ * @brief Queued transmit path: tx_queue, CSMA and PTT, fed to a hardware symbol clock.
+ *
+ * Messages are framed and mapped to symbols as they are queued, so the main
+ * loop only copies symbols to the sink: the PWM DAC (any profile, with
+ * TX_SERVICE_PWM) or ad9833_fsk (single-carrier FSK). CSMA keys PTT; once
+ * the key-up delay is over, frames are handed over back to back, highest
+ * priority first, and PTT drops when the queue is empty and the sink has
+ * sent its last symbol. The AD9833's SPI pins belong to the PIO only while
+ * PTT is up. The channel counts as busy while an energy squelch on the
+ * received audio (tx_service_feed) is open.
+ *
+ * Every key-up is timed from queue entry, PTT assert, the first symbol and
+ * PTT release, with symbol edges from ad9833_fsk (PWM DAC edges fall on
+ * exact samples and are not timed). Histograms of queue latency, PTT lead,
+ * PTT tail and symbol period error go out as a log line per key-up and in
+ * the JSON.
+ */
+int tx_service_init(modem_profile_id_t profile);
+bool tx_service_running(void);
+
+// Returns the frame id, or -1 if the frame was dropped.
+int32_t tx_service_send(tx_priority_t priority, uint8_t dst, const uint8_t *payload, size_t len);
+
+// Received audio for carrier sense, e.g. from the ADC tap; ignored while keyed.
+void tx_service_feed(const uint16_t *samples, size_t count);
+
+int tx_service_task(void);
+
+// {"profile":...,"depth":...} plus queue and CSMA counters, per priority where they
+// apply, and "timing" with the histograms in microseconds.
+size_t tx_service_to_json(char *buffer, size_t buffer_size);
+
+#endif // TX_SERVICE_H
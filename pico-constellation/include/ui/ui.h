@@ -2,10 +2,14 @@
 #define UI_H
 
 #include "network/network.h"
+#include "modem/modem_rx.h"
 
 int ui_init(void);
 int ui_deinit(void);
 
 int ui_handle_event(http_contents_t *contents, http_request_t *request);
 
+// Adds a received frame to the peer table; info may be NULL.
+int ui_frame_received(uint8_t src_addr, const modem_rx_frame_info_t *info);
+
 #endif // UI_H
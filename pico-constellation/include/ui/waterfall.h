@@ -0,0 +1,25 @@
+#ifndef WATERFALL_H
+#define WATERFALL_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+/**
+ * @brief Receive spectrum for the web UI.
+ *
+ * Wraps the spectrum engine around the ADC path: adc_bsp hands it every
+ * block it fetches, the main loop gives it spare time, and the UI polls the
+ * newest lines as JSON. Lines are only computed while the ADC has no backlog
+ * to work through, so the modem always has priority.
+ */
+int waterfall_init(uint32_t sample_rate);
+
+void waterfall_feed(const uint16_t *samples, size_t count);
+
+int waterfall_task(void);
+
+// {"seq":N,"rate":Hz,"bin":Hz,"bins":B,"lines":["hex",...]} with lines newer than since,
+// as many as fit; N is the last line sent, the next since.
+size_t waterfall_to_json(char *buffer, size_t buffer_size, uint32_t since);
+
+#endif // WATERFALL_H
@@ -0,0 +1,87 @@
+#ifndef CAPTURE_FILE_H
+#define CAPTURE_FILE_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+/*
+ * Self-describing capture stream (.pcc), written by the recorder and read
+ * by the host tools. Everything is little-endian. The stream is a sequence
+ * of chunks, each starting with a 24-byte chunk header:
+ *
+ *   u32 tag      CAPTURE_TAG_INFO, _DATA or _GAP; doubles as a sync word
+ *   u32 length   payload bytes after this header
+ *   u64 time_us  device time: when the stream started (INFO), when the
+ *                chunk's last frame had been taken (DATA) or when a loss
+ *                was seen (GAP)
+ *   u64 index    frame number of the first frame, dropped frames included
+ *
+ * INFO (first chunk, repeated now and then so a reader joining a live
+ * stream can start):
+ *   u16 version, u16 channels, u32 sample_rate, u8 bits, u8 profile
+ *   (modem_profile_id_t, CAPTURE_PROFILE_NONE if unknown), u16 dc_offset,
+ *   u8 trace_bits, u8[3] reserved
+ * DATA: whole frames of `channels` values, as many as the writer buffered.
+ *   Channel 0 is the ADC sample, a u16 with `bits` significant bits;
+ *   further channels are firmware traces scaled so full scale covers
+ *   0.0..1.0, one byte each if trace_bits is 8 and a u16 if it is 16 (or
+ *   0, as streams written before the field had it).
+ * GAP: u32 frames lost before `index`, e.g. overwritten in the ADC ring.
+ *
+ * Every tag is 'PCC' and a letter. Readers skip tags they do not know by
+ * length, so later versions can add chunks.
+ */
+#define CAPTURE_FILE_VERSION 1
+#define CAPTURE_CHUNK_HEADER_SIZE 24
+#define CAPTURE_INFO_SIZE 16
+#define CAPTURE_GAP_SIZE 4
+#define CAPTURE_PROFILE_NONE 0xFF
+#define CAPTURE_MAX_CHANNELS 8
+
+#define CAPTURE_TAG(a, b, c, d) ((uint32_t)(a) | (uint32_t)(b) << 8 | (uint32_t)(c) << 16 | (uint32_t)(d) << 24)
+#define CAPTURE_TAG_INFO CAPTURE_TAG('P', 'C', 'C', 'I')
+#define CAPTURE_TAG_DATA CAPTURE_TAG('P', 'C', 'C', 'D')
+#define CAPTURE_TAG_GAP CAPTURE_TAG('P', 'C', 'C', 'G')
+
+typedef struct capture_info
+{
+    uint16_t version;
+    uint16_t channels;
+    uint32_t sample_rate;
+    uint8_t bits;
+    uint8_t profile;
+    uint16_t dc_offset;
+    uint8_t trace_bits; // 8 or 16
+} capture_info_t;
+
+typedef struct capture_chunk
+{
+    uint32_t tag;
+    uint32_t length;
+    uint64_t time_us;
+    uint64_t index;
+    const uint8_t *payload;
+} capture_chunk_t;
+
+// Writers fill out and return the bytes used (header plus payload for INFO and GAP).
+size_t capture_file_chunk_header(uint8_t *out, uint32_t tag, uint32_t length, uint64_t time_us, uint64_t index);
+size_t capture_file_info(uint8_t *out, const capture_info_t *info, uint64_t time_us, uint64_t index);
+size_t capture_file_gap(uint8_t *out, uint32_t lost, uint64_t time_us, uint64_t index);
+
+/*
+ * Reads the chunk at data. Returns 0, or -1 if fewer than size bytes hold
+ * a whole chunk or the tag is not a 'PCC?' tag. Tags other than INFO,
+ * DATA and GAP parse too; callers skip them.
+ */
+int capture_file_parse_chunk(const uint8_t *data, size_t size, capture_chunk_t *chunk);
+
+// Decodes an INFO payload; -1 on a bad version, channel count or trace width.
+int capture_file_parse_info(const capture_chunk_t *chunk, capture_info_t *info);
+
+// Bytes per DATA frame.
+size_t capture_file_frame_size(const capture_info_t *info);
+
+// Offset of the next 'PCC?' tag at or after from, or size if there is none.
+size_t capture_file_resync(const uint8_t *data, size_t size, size_t from);
+
+#endif // CAPTURE_FILE_H
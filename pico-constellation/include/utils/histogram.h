@@ -0,0 +1,50 @@
+#ifndef HISTOGRAM_H
+#define HISTOGRAM_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#define HISTOGRAM_BINS 20 // log2 from a 1 ms unit reaches 8 minutes
+
+typedef enum
+{
+    HISTOGRAM_LOG2 = 0, // bin 0 below unit, bin k from unit << (k - 1) up to unit << k
+    HISTOGRAM_LINEAR,   // bin k from origin + k * unit, unit wide
+} histogram_scale_t;
+
+/*
+ * Fixed-size histogram of integer samples (microseconds, usually), small
+ * and cheap enough to fill from an interrupt: no floating point, no
+ * allocation. Values outside the range land in the first or last bin;
+ * min and max are kept exactly, and percentiles are read as the upper
+ * edge of the bin they fall in, never beyond max.
+ */
+typedef struct histogram
+{
+    uint32_t bins[HISTOGRAM_BINS];
+    uint32_t count;
+    int32_t min;
+    int32_t max;
+    int64_t sum;
+    uint8_t scale;
+    int32_t origin; // linear only
+    uint32_t unit;
+} histogram_t;
+
+void histogram_init_log2(histogram_t *hist, uint32_t unit);
+void histogram_init_linear(histogram_t *hist, int32_t origin, uint32_t width);
+void histogram_reset(histogram_t *hist); // empties it, keeping the bins
+
+void histogram_add(histogram_t *hist, int32_t value);
+
+// Adds src's samples to dst; -1 if their bins differ.
+int histogram_merge(histogram_t *dst, const histogram_t *src);
+
+// Upper bound of the value below which percent (0..100) of the samples fall; 0 if empty.
+int32_t histogram_percentile(const histogram_t *hist, unsigned percent);
+int32_t histogram_mean(const histogram_t *hist);
+
+// {"count":...,"min":...,"max":...,"mean":...,"p50":...,"p90":...,"p99":...,"scale":...,"bins":[...]}
+size_t histogram_to_json(const histogram_t *hist, char *buffer, size_t buffer_size);
+
+#endif // HISTOGRAM_H
@@ -1,5 +1,6 @@
 #include "adc_bsp.h"
 
+#include "adc_bsp_tap.h"
 #include "adc_hal.h"
 #include "c-logger.h"
 
@@ -8,6 +9,7 @@
 static bool data_available = false;
 static bool data_overflow = false;
 static uint16_t tmp_buffer[BUFFER_COUNT];
+static adc_bsp_tap_t tap = NULL;
 
 static void sample_callback(size_t size)
 {
@@ -28,6 +30,12 @@ int adc_bsp_init(int sample_rate)
     return 0;
 }
 
+int adc_bsp_set_tap(adc_bsp_tap_t cb)
+{
+    tap = cb;
+    return 0;
+}
+
 int adc_bsp_task()
 {
     if (data_overflow)
@@ -43,22 +51,35 @@ bool adc_bsp_data_available()
     return true;
 }
 
-int adc_bsp_get_data(circular_buffer_t *buffer)
+size_t adc_bsp_read(const uint16_t **samples)
 {
+    *samples = tmp_buffer;
     if (!data_available)
     {
         return 0;
     }
     data_available = false;
 
-    size_t samples_fetched = 0;
+    int samples_fetched = 0;
     adc_hal_get_samples(tmp_buffer, BUFFER_COUNT, &samples_fetched);
+    if (tap)
+    {
+        tap(tmp_buffer, samples_fetched);
+    }
+
+    return (size_t)samples_fetched;
+}
+
+int adc_bsp_get_data(circular_buffer_t *buffer)
+{
+    const uint16_t *samples;
+    size_t samples_fetched = adc_bsp_read(&samples);
 
     for (size_t i = 0; i < samples_fetched; i++)
     {
         if(circular_buffer_push(buffer, &tmp_buffer[i]))
         {
-            LOG_ERROR("Failed to push %d to buffer", samples_fetched);
+            LOG_ERROR("Failed to push %u to buffer", (unsigned)samples_fetched);
             return -1;
         }
     }
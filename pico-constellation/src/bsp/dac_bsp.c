@@ -1,10 +1,22 @@
 #include "dac_bsp.h"
 #include "ad9833.h"
+#include "pwm_dac.h"
+
+// 1 on boards without an AD9833: tones come from the PWM DAC instead.
+#ifndef DAC_BSP_PWM
+#define DAC_BSP_PWM 0
+#endif
+#define DAC_BSP_PWM_AMPLITUDE 1800 // peak, of the 2048 either side of the midpoint
 
 int dac_bsp_init()
 {
+#if DAC_BSP_PWM
+    if (pwm_dac_init() || pwm_dac_start(modem_profile_get(MODEM_PROFILE_FSK_32), DAC_BSP_PWM_AMPLITUDE))
+        return -1;
+#else
     ad9833_init();
     ad9833_set_mode(AD9833_MODE_SINE);
+#endif
     return 0;
 }
 
@@ -15,6 +27,10 @@ int dac_bsp_task()
 
 int dac_bsp_set_tone(float frequency)
 {
+#if DAC_BSP_PWM
+    return pwm_dac_set_tone(frequency);
+#else
     ad9833_set_frequency_hz(frequency);
     return 0;
-}
\ No newline at end of file
+#endif
+}
@@ -3,10 +3,65 @@
 #include <stdio.h>
 #include "fhdm-ad9833-pico.h"
 #include "pico/stdlib.h"
+#include "hardware/spi.h"
 #include "c-logger.h"
 
+#ifndef AD9833_MCLK_HZ
+#define AD9833_MCLK_HZ 25000000.0f
+#endif
+#define AD9833_SPI_HZ 10000000 // 1.6 us per word; the part takes up to 40 MHz
+
+// Control register bits (AD9833 datasheet, table 6)
+#define CTRL_B28 (1u << 13)
+#define CTRL_FSELECT (1u << 11)
+#define CTRL_RESET (1u << 8)
+#define CTRL_SLEEP1 (1u << 7)
+#define CTRL_SLEEP12 (1u << 6)
+#define CTRL_OPBITEN (1u << 5)
+#define CTRL_DIV2 (1u << 3)
+#define CTRL_MODE (1u << 1)
+#define CTRL_MODE_MASK (CTRL_SLEEP1 | CTRL_SLEEP12 | CTRL_OPBITEN | CTRL_DIV2 | CTRL_MODE)
+
+#define FREQ_ADDRESS(reg) ((reg) ? 0x8000u : 0x4000u)
+#define FREQ_NONE 0xFFFFFFFFu // above any 28-bit tuning word
+
 static bool initialized = false;
 static struct fhdm_ad9833 ad9833;
+static uint16_t control = CTRL_B28;            // last control word written
+static uint32_t loaded[2] = {FREQ_NONE, FREQ_NONE}; // tuning word in FREQ0 and FREQ1
+static float loaded_hz[2] = {-1.0f, -1.0f};         // the frequency each was asked for
+
+static void write_word(uint16_t word)
+{
+    gpio_put(AD9833_FSYNC_PIN, 0);
+    spi_write16_blocking(AD9833_SPI, &word, 1);
+    gpio_put(AD9833_FSYNC_PIN, 1);
+}
+
+static void write_control(uint16_t word)
+{
+    control = word;
+    write_word(word);
+}
+
+static uint32_t tuning_word(float frequency)
+{
+    float word = frequency * (float)(1u << 28) / AD9833_MCLK_HZ;
+    if (word < 0.0f)
+        return 0;
+    if (word > (float)0x0FFFFFFF)
+        return 0x0FFFFFFF;
+    return (uint32_t)(word + 0.5f);
+}
+
+// B28 is always set, so a register takes its 28 bits as two 14-bit writes, LSBs first.
+static void load_register(unsigned reg, float frequency, uint32_t word)
+{
+    write_word((uint16_t)(FREQ_ADDRESS(reg) | (word & 0x3FFF)));
+    write_word((uint16_t)(FREQ_ADDRESS(reg) | (word >> 14)));
+    loaded[reg] = word;
+    loaded_hz[reg] = frequency;
+}
 
 int ad9833_init(void)
 {
@@ -23,6 +78,33 @@ int ad9833_init(void)
 
     ad9833.start(&ad9833);
 
+    // The fhdm driver only brings the part up; from here on the registers are
+    // written directly and it is not called again. Its handle does not say
+    // which SPI and pins it used, so check they are the ones configured here.
+    unsigned index = spi_get_index(AD9833_SPI);
+    if (!(spi_get_hw(AD9833_SPI)->cr1 & SPI_SSPCR1_SSE_BITS) ||
+        gpio_get_function(AD9833_SCLK_PIN) != GPIO_FUNC_SPI || gpio_get_function(AD9833_SDATA_PIN) != GPIO_FUNC_SPI ||
+        ((AD9833_SCLK_PIN >> 3) & 1) != index || ((AD9833_SDATA_PIN >> 3) & 1) != index)
+    {
+        LOG_ERROR("AD9833 is not on spi%u with SCLK %u and SDATA %u; set AD9833_SPI and the pins to match the board",
+                  index, AD9833_SCLK_PIN, AD9833_SDATA_PIN);
+        ret = -1;
+        goto failed;
+    }
+
+    // FSYNC is a plain output toggled per word, whatever fhdm set it up as.
+    gpio_init(AD9833_FSYNC_PIN);
+    gpio_put(AD9833_FSYNC_PIN, 1);
+    gpio_set_dir(AD9833_FSYNC_PIN, GPIO_OUT);
+
+    // 16-bit words in SPI mode 2.
+    spi_set_baudrate(AD9833_SPI, AD9833_SPI_HZ);
+    spi_set_format(AD9833_SPI, 16, SPI_CPOL_1, SPI_CPHA_0, SPI_MSB_FIRST);
+    write_control(CTRL_B28 | CTRL_RESET);
+    load_register(0, 0.0f, 0);
+    load_register(1, 0.0f, 0);
+    write_control(CTRL_B28);
+
     initialized = true;
 
 failed:
@@ -41,6 +123,7 @@ failed:
 int ad9833_set_mode(ad9833_mode_t mode)
 {
     int ret = 0;
+    uint16_t bits = 0;
     //LOG_DEBUG("Setting AD9833 mode to %d", mode);
 
     if (!initialized)
@@ -56,34 +139,86 @@ int ad9833_set_mode(ad9833_mode_t mode)
     {
     case AD9833_MODE_SINE:
         LOG_INFO("Setting AD9833 mode to SINE");
-        ad9833.set_mode(&ad9833, FHDM_AD9833_MODE_SINE);
         break;
     case AD9833_MODE_TRIANGLE:
         LOG_INFO("Setting AD9833 mode to TRIANGLE");
-        ad9833.set_mode(&ad9833, FHDM_AD9833_MODE_TRIANGLE);
+        bits = CTRL_MODE;
         break;
     case AD9833_MODE_SQUARE:
         LOG_INFO("Setting AD9833 mode to SQUARE");
-        ad9833.set_mode(&ad9833, FHDM_AD9833_MODE_SQUARE);
+        bits = CTRL_OPBITEN | CTRL_DIV2;
         break;
     case AD9833_MODE_SLEEP:
         LOG_INFO("Setting AD9833 mode to SLEEP");
-        ad9833.set_mode(&ad9833, FHDM_AD9833_MODE_SLEEP);
+        bits = CTRL_SLEEP1 | CTRL_SLEEP12;
         break;
     default:
         ret = -1;
         goto failed;
     }
 
+    write_control((uint16_t)((control & ~CTRL_MODE_MASK) | bits));
+
 failed:
     return ret;
 }
 
-int ad9833_set_frequency_hz(float frequency)
+int ad9833_select(unsigned reg)
+{
+    if (!initialized || reg > 1)
+    {
+        return -1;
+    }
+
+    uint16_t word = ad9833_select_word(reg);
+    if (word != control)
+    {
+        write_control(word);
+    }
+    return 0;
+}
+
+uint16_t ad9833_select_word(unsigned reg)
+{
+    return reg ? (control | CTRL_FSELECT) : (control & ~CTRL_FSELECT);
+}
+
+int ad9833_resync(void)
+{
+    if (!initialized)
+    {
+        return -1;
+    }
+
+    write_word(control);
+    return 0;
+}
+
+int ad9833_load_tones(float tone0, float tone1)
 {
     int ret = 0;
 
-    LOG_DEBUG("Setting AD9833 frequency to %.2f Hz", frequency);
+    if (!initialized)
+    {
+        if (ad9833_init())
+        {
+            ret = -1;
+            goto failed;
+        }
+    }
+
+    // Before keying up: whichever register is in use is rewritten too.
+    load_register(0, tone0, tuning_word(tone0));
+    ad9833_select(0);
+    load_register(1, tone1, tuning_word(tone1));
+
+failed:
+    return ret;
+}
+
+int ad9833_set_frequency_hz(float frequency)
+{
+    int ret = 0;
 
     if (!initialized)
     {
@@ -95,8 +230,37 @@ int ad9833_set_frequency_hz(float frequency)
         }
     }
 
-    ad9833.set_frequency(&ad9833, frequency);
+    unsigned current = (control & CTRL_FSELECT) ? 1 : 0;
+
+    // A tone asked for before is found by its input, without the float conversion.
+    if (frequency == loaded_hz[current])
+    {
+        goto failed;
+    }
+    if (frequency == loaded_hz[!current])
+    {
+        ad9833_select(!current);
+        goto failed;
+    }
+
+    uint32_t word = tuning_word(frequency);
+    if (loaded[current] == word)
+    {
+        loaded_hz[current] = frequency;
+    }
+    else
+    {
+        if (loaded[!current] == word)
+        {
+            loaded_hz[!current] = frequency;
+        }
+        else
+        {
+            load_register(!current, frequency, word);
+        }
+        ad9833_select(!current);
+    }
 
 failed:
     return ret;
-}
\ No newline at end of file
+}
@@ -0,0 +1,260 @@
+#include "ad9833_fsk.h"
+
+#include "ad9833.h"
+#include "hardware/clocks.h"
+#include "hardware/dma.h"
+#include "hardware/irq.h"
+#include "hardware/pio.h"
+#include "hardware/sync.h"
+#include "pico/stdlib.h"
+#include "c-logger.h"
+#include "ad9833_fsk.pio.h"
+
+#define WORD_CYCLES 37 // state machine cycles of a control word, see ad9833_fsk.pio
+
+static PIO pio = pio0;
+static int sm = -1;
+static int offset = -1;
+static int dma_chan = -1;
+static bool is_running = false;
+
+// Control words, left-justified: the one DMA is reading and one waiting behind it.
+static uint32_t words[2][AD9833_FSK_MAX_SYMBOLS];
+static size_t word_count[2];
+static int active = 0;
+static volatile bool pending = false;
+
+static uint32_t select_word[2];
+static volatile uint32_t symbols_queued = 0;
+static volatile uint32_t gap_edge = 0; // first edge of the last burst sent with nothing feeding
+static volatile uint32_t last_edge_us = 0;
+static ad9833_fsk_stats_t stats;
+
+static void start_slot(int slot)
+{
+    active = slot;
+    dma_channel_transfer_from_buffer_now(dma_chan, words[slot], word_count[slot]);
+}
+
+static void __isr edge_handler(void)
+{
+    uint32_t now = time_us_32();
+    uint32_t stall = 1u << (PIO_FDEBUG_TXSTALL_LSB + sm);
+    bool stalled = pio->fdebug & stall;
+
+    pio_interrupt_clear(pio, 0);
+    pio->fdebug = stall;
+
+    // The next burst follows while the FIFO still holds the end of this one.
+    bool feeding = dma_channel_is_busy(dma_chan);
+    if (!feeding && pending)
+    {
+        pending = false;
+        start_slot(!active);
+        feeding = true;
+    }
+
+    if (stalled)
+    {
+        // A wait for words is the gap before a burst, or a burst not fed in time.
+        if (stats.edges != gap_edge)
+            stats.underruns++;
+    }
+    else if (stats.edges > 0)
+    {
+        uint32_t period = now - last_edge_us;
+        uint32_t error = period > stats.period_us ? period - stats.period_us : stats.period_us - period;
+        if (period < stats.min_us)
+            stats.min_us = period;
+        if (period > stats.max_us)
+            stats.max_us = period;
+        if (error > stats.max_error_us)
+            stats.max_error_us = error;
+        histogram_add(&stats.error, (int32_t)(period - stats.period_us));
+    }
+
+    if (stats.edges == 0)
+        stats.first_us = now;
+    stats.last_us = now;
+    last_edge_us = now;
+    stats.edges++;
+}
+
+int ad9833_fsk_init(void)
+{
+    if (sm >= 0)
+        return 0;
+
+    if (AD9833_SCLK_PIN != AD9833_FSYNC_PIN + 1)
+    {
+        LOG_ERROR("AD9833 FSK needs SCLK on the GPIO after FSYNC");
+        return -1;
+    }
+
+    if (!pio_can_add_program(pio, &ad9833_fsk_program) || (sm = pio_claim_unused_sm(pio, false)) < 0)
+    {
+        LOG_ERROR("No PIO state machine available for AD9833 FSK");
+        return -1;
+    }
+    offset = pio_add_program(pio, &ad9833_fsk_program);
+
+    dma_chan = dma_claim_unused_channel(false);
+    if (dma_chan < 0)
+    {
+        LOG_ERROR("No DMA channel available for AD9833 FSK");
+        ad9833_fsk_deinit();
+        return -1;
+    }
+
+    dma_channel_config c = dma_channel_get_default_config(dma_chan);
+    channel_config_set_transfer_data_size(&c, DMA_SIZE_32);
+    channel_config_set_read_increment(&c, true);
+    channel_config_set_write_increment(&c, false);
+    channel_config_set_dreq(&c, pio_get_dreq(pio, sm, true));
+    dma_channel_configure(dma_chan, &c, &pio->txf[sm], NULL, 0, false);
+
+    LOG_INFO("AD9833 FSK initialized (PIO0 SM %d)", sm);
+    return 0;
+}
+
+int ad9833_fsk_deinit(void)
+{
+    if (is_running)
+        ad9833_fsk_stop();
+
+    if (dma_chan >= 0)
+    {
+        dma_channel_unclaim(dma_chan);
+        dma_chan = -1;
+    }
+    if (sm >= 0)
+    {
+        pio_remove_program(pio, &ad9833_fsk_program, offset);
+        pio_sm_unclaim(pio, sm);
+        sm = -1;
+    }
+    return 0;
+}
+
+int ad9833_fsk_start(float tone0, float tone1, float baud)
+{
+    if (sm < 0 || is_running || baud <= 0.0f)
+        return -1;
+
+    uint32_t cycles = (uint32_t)(AD9833_FSK_SM_HZ / baud + 0.5f);
+    if (cycles <= WORD_CYCLES)
+    {
+        LOG_ERROR("AD9833 FSK: %.0f baud is too fast", baud);
+        return -1;
+    }
+
+    // Both tones over the SPI, then the control words that pick them.
+    if (ad9833_load_tones(tone0, tone1))
+        return -1;
+    select_word[0] = (uint32_t)ad9833_select_word(0) << 16;
+    select_word[1] = (uint32_t)ad9833_select_word(1) << 16;
+
+    stats = (ad9833_fsk_stats_t){.period_us = (uint32_t)(1e6f / baud + 0.5f), .min_us = UINT32_MAX};
+    histogram_init_linear(&stats.error, -(HISTOGRAM_BINS / 2) * AD9833_FSK_ERROR_BIN_US, AD9833_FSK_ERROR_BIN_US);
+    symbols_queued = 0;
+    gap_edge = 0;
+    pending = false;
+
+    ad9833_fsk_program_init(pio, sm, offset, AD9833_FSYNC_PIN, AD9833_SDATA_PIN,
+                            (float)clock_get_hz(clk_sys) / AD9833_FSK_SM_HZ);
+    pio->fdebug = 1u << (PIO_FDEBUG_TXSTALL_LSB + sm);
+    pio_sm_put(pio, sm, cycles - WORD_CYCLES);
+
+    pio_interrupt_clear(pio, 0);
+    pio_set_irq0_source_enabled(pio, pis_interrupt0, true);
+    irq_set_exclusive_handler(PIO0_IRQ_0, edge_handler);
+    irq_set_enabled(PIO0_IRQ_0, true);
+
+    pio_sm_set_enabled(pio, sm, true);
+    is_running = true;
+    LOG_INFO("AD9833 FSK started (%.1f/%.1f Hz, %.2f baud, %lu cycles per symbol)", tone0, tone1, baud,
+             (unsigned long)cycles);
+    return 0;
+}
+
+int ad9833_fsk_stop(void)
+{
+    if (!is_running)
+        return 0;
+
+    irq_set_enabled(PIO0_IRQ_0, false);
+    pio_set_irq0_source_enabled(pio, pis_interrupt0, false);
+    dma_channel_abort(dma_chan);
+    pio_sm_set_enabled(pio, sm, false);
+    pio_sm_clear_fifos(pio, sm);
+    pio_sm_restart(pio, sm);
+    pending = false;
+
+    // Back to the SPI; FSYNC is a plain output the driver toggles.
+    gpio_set_function(AD9833_SCLK_PIN, GPIO_FUNC_SPI);
+    gpio_set_function(AD9833_SDATA_PIN, GPIO_FUNC_SPI);
+    gpio_init(AD9833_FSYNC_PIN);
+    gpio_put(AD9833_FSYNC_PIN, 1);
+    gpio_set_dir(AD9833_FSYNC_PIN, GPIO_OUT);
+    ad9833_resync();
+
+    is_running = false;
+    LOG_INFO("AD9833 FSK stopped");
+    return 0;
+}
+
+int ad9833_fsk_send(const uint8_t *symbols, size_t count)
+{
+    if (!is_running || !symbols || count == 0 || count > AD9833_FSK_MAX_SYMBOLS)
+        return -1;
+
+    uint32_t status = save_and_disable_interrupts();
+    bool feeding = dma_channel_is_busy(dma_chan);
+    if (!feeding && pending)
+    {
+        // Done feeding since the last edge; the waiting burst goes first.
+        pending = false;
+        start_slot(!active);
+        feeding = true;
+    }
+    else if (feeding && pending)
+    {
+        restore_interrupts(status);
+        return -1;
+    }
+
+    int slot = feeding ? !active : active;
+    if (!feeding)
+        gap_edge = symbols_queued;
+    for (size_t i = 0; i < count; i++)
+        words[slot][i] = select_word[symbols[i] & 1];
+    word_count[slot] = count;
+    symbols_queued += count;
+
+    if (feeding)
+        pending = true;
+    else
+        start_slot(slot);
+
+    restore_interrupts(status);
+    return 0;
+}
+
+bool ad9833_fsk_busy(void)
+{
+    if (!is_running)
+        return false;
+
+    // The last edge starts the last symbol; it is on air for one more period.
+    uint32_t status = save_and_disable_interrupts();
+    bool busy = stats.edges < symbols_queued || time_us_32() - last_edge_us < stats.period_us;
+    restore_interrupts(status);
+    return busy;
+}
+
+void ad9833_fsk_get_stats(ad9833_fsk_stats_t *out)
+{
+    uint32_t status = save_and_disable_interrupts();
+    *out = stats;
+    restore_interrupts(status);
+}
@@ -5,6 +5,7 @@
 #include "hardware/adc.h"
 #include "hardware/dma.h"
 #include "hardware/irq.h"
+#include "hardware/sync.h"
 #include "pico/stdlib.h"
 #include "c-logger.h"
 
@@ -20,10 +21,18 @@ static uint16_t *circular_buffer = NULL;
 static size_t buffer_capacity = 0;
 static size_t write_index = 0;
 static size_t read_index = 0;
+static volatile uint64_t dropped_samples = 0;
 
 static int dma_chan = -1;
 static bool is_running = false;
 
+static const uint16_t *replay_samples = NULL;
+static size_t replay_length = 0;
+static size_t replay_count = 0; // whole chunks of replay_length, set on start
+static size_t replay_pos = 0;
+static volatile bool replay_waiting = false; // next chunk armed but not started, the ring is full
+static size_t inject_fill = 0;                 // samples of the chunk adc_hal_inject is filling
+
 int adc_hal_init(void)
 {
     adc_init();
@@ -102,6 +111,7 @@ int adc_hal_set_sample_size(int sample_size)
     buffer_chunk_size = sample_size;
     write_index = 0;
     read_index = 0;
+    inject_fill = 0;
     return 0;
 }
 
@@ -111,18 +121,36 @@ int adc_hal_set_callback(adc_buffer_ready_callback_t cb)
     return 0;
 }
 
-static void __isr dma_handler(void)
+int adc_hal_set_replay(const uint16_t *samples, size_t count)
 {
-    dma_hw->ints0 = 1u << dma_chan;
+    if (is_running)
+    {
+        LOG_WARN("Cannot change the replay source while running");
+        return -1;
+    }
 
+    replay_samples = count ? samples : NULL;
+    replay_length = count;
+    return 0;
+}
+
+static size_t ring_free_space(void)
+{
+    return (read_index + buffer_capacity - write_index - 1) % buffer_capacity;
+}
+
+// A chunk has landed at write_index: make room if the reader is behind, publish it, notify.
+static void ring_commit_chunk(void)
+{
     // Calculate free space in buffer (one slot less than full)
-    size_t free_space = (read_index + buffer_capacity - write_index - 1) % buffer_capacity;
+    size_t free_space = ring_free_space();
 
     if (free_space < buffer_chunk_size)
     {
         // Not enough space: overwrite old data by advancing read_index
         size_t samples_to_free = buffer_chunk_size - free_space;
         read_index = (read_index + samples_to_free) % buffer_capacity;
+        dropped_samples += samples_to_free;
     }
 
     // Now advance write_index by chunk size as DMA just wrote this many samples
@@ -133,6 +161,27 @@ static void __isr dma_handler(void)
         size_t available = (write_index + buffer_capacity - read_index) % buffer_capacity;
         user_callback(available);
     }
+}
+
+static void __isr dma_handler(void)
+{
+    dma_hw->ints0 = 1u << dma_chan;
+
+    ring_commit_chunk();
+
+    if (replay_samples)
+    {
+        // Memory is never late, so wait for room instead of overwriting; adc_hal_get_samples restarts it.
+        replay_pos = (replay_pos + buffer_chunk_size) % replay_count;
+        dma_channel_set_read_addr(dma_chan, &replay_samples[replay_pos], false);
+        dma_channel_set_write_addr(dma_chan, &circular_buffer[write_index], false);
+        dma_channel_set_trans_count(dma_chan, buffer_chunk_size, false);
+        if (ring_free_space() >= (size_t)buffer_chunk_size)
+            dma_channel_start(dma_chan);
+        else
+            replay_waiting = true;
+        return;
+    }
 
     dma_channel_set_read_addr(dma_chan, &adc_hw->fifo, false);
     dma_channel_set_write_addr(dma_chan, &circular_buffer[write_index], false);
@@ -144,6 +193,16 @@ int adc_hal_start(void)
     if (is_running)
         return 0;
 
+    if (replay_samples)
+    {
+        replay_count = replay_length - replay_length % buffer_chunk_size;
+        if (replay_count == 0)
+        {
+            LOG_ERROR("Replay needs at least one chunk of samples");
+            return -1;
+        }
+    }
+
     float clkdiv = 48000000.0f / sample_rate;
     adc_set_clkdiv(clkdiv);
 
@@ -151,14 +210,16 @@ int adc_hal_start(void)
 
     dma_channel_config c = dma_channel_get_default_config(dma_chan);
     channel_config_set_transfer_data_size(&c, DMA_SIZE_16);
-    channel_config_set_read_increment(&c, false);
+    channel_config_set_read_increment(&c, replay_samples != NULL);
     channel_config_set_write_increment(&c, true);
-    channel_config_set_dreq(&c, DREQ_ADC);
+    channel_config_set_dreq(&c, replay_samples ? DREQ_FORCE : DREQ_ADC);
 
+    replay_pos = 0;
+    replay_waiting = false;
     dma_channel_configure(
         dma_chan, &c,
         &circular_buffer[write_index],
-        &adc_hw->fifo,
+        replay_samples ? (const volatile void *)replay_samples : &adc_hw->fifo,
         buffer_chunk_size,
         false);
 
@@ -167,10 +228,12 @@ int adc_hal_start(void)
     irq_set_enabled(DMA_IRQ_0, true);
 
     dma_channel_start(dma_chan);
-    adc_run(true);
+    if (!replay_samples)
+        adc_run(true);
 
     is_running = true;
-    LOG_INFO("ADC sampling started (%d Hz, %d samples)", sample_rate, buffer_chunk_size);
+    LOG_INFO("ADC sampling started (%d Hz, %d samples%s)", sample_rate, buffer_chunk_size,
+             replay_samples ? ", replay" : "");
     return 0;
 }
 
@@ -228,5 +291,63 @@ int adc_hal_get_samples(uint16_t *buffer, size_t max_size, int *num_samples)
 
     read_index = (read_index + to_copy) % buffer_capacity;
     *num_samples = to_copy;
+
+    if (replay_waiting && ring_free_space() >= (size_t)buffer_chunk_size)
+    {
+        replay_waiting = false;
+        dma_channel_start(dma_chan);
+    }
+    return 0;
+}
+
+int adc_hal_inject(const uint16_t *samples, size_t count)
+{
+    if (!circular_buffer)
+    {
+        LOG_ERROR("Cannot inject samples before the buffer is set up");
+        return -1;
+    }
+    if (!samples)
+    {
+        LOG_ERROR("No samples to inject");
+        return -1;
+    }
+    if (is_running)
+    {
+        LOG_WARN("Cannot inject samples while sampling");
+        return -1;
+    }
+
+    while (count)
+    {
+        // As the DMA would: fill the chunk at write_index, then commit it whole.
+        size_t n = buffer_chunk_size - inject_fill;
+        if (n > count)
+            n = count;
+
+        memcpy(&circular_buffer[write_index + inject_fill], samples, n * sizeof(uint16_t));
+        inject_fill += n;
+        samples += n;
+        count -= n;
+
+        if (inject_fill == (size_t)buffer_chunk_size)
+        {
+            inject_fill = 0;
+            ring_commit_chunk();
+        }
+    }
+
+    return 0;
+}
+
+int adc_hal_get_dropped(uint64_t *dropped)
+{
+    if (!dropped)
+        return -1;
+
+    // 64-bit reads are not atomic; keep the ISR out while copying.
+    uint32_t status = save_and_disable_interrupts();
+    *dropped = dropped_samples;
+    restore_interrupts(status);
     return 0;
 }
@@ -0,0 +1,154 @@
+#include "crc_dma.h"
+
+#include <stdbool.h>
+#include <string.h>
+#include "hardware/dma.h"
+#include "pico/stdlib.h"
+#include "c-logger.h"
+
+#define SELF_TEST_MAX_LEN 330 // largest HDLC frame
+#define BENCHMARK_MAX_LEN 512
+
+static int dma_chan = -1;
+static uint8_t sink; // the transfer writes every byte here
+
+int crc_dma_compute(crc_type_t type, const uint8_t *data, size_t len, uint16_t *crc)
+{
+    if (dma_chan < 0 || type >= CRC_TYPE_COUNT)
+        return -1;
+
+    if (len == 0)
+    {
+        *crc = crc_software(type, data, 0);
+        return 0;
+    }
+
+    dma_channel_config config = dma_channel_get_default_config(dma_chan);
+    channel_config_set_transfer_data_size(&config, DMA_SIZE_8);
+    channel_config_set_read_increment(&config, true);
+    channel_config_set_write_increment(&config, false);
+    channel_config_set_sniff_enable(&config, true);
+
+    // CRC16R feeds each byte LSB first, which is what X.25 needs.
+    dma_sniffer_enable(dma_chan,
+                       crc_sniffer_reflected(type) ? DMA_SNIFF_CTRL_CALC_VALUE_CRC16R
+                                                   : DMA_SNIFF_CTRL_CALC_VALUE_CRC16,
+                       true);
+    dma_sniffer_set_data_accumulator(crc_sniffer_seed(type));
+
+    dma_channel_configure(dma_chan, &config, &sink, data, len, true);
+    dma_channel_wait_for_finish_blocking(dma_chan);
+
+    *crc = crc_from_sniffer(type, dma_sniffer_get_data_accumulator());
+    dma_sniffer_disable();
+    return 0;
+}
+
+int crc_dma_self_test(void)
+{
+    static const uint8_t check[] = "123456789";
+    static uint8_t buffer[SELF_TEST_MAX_LEN];
+    uint32_t state = 0x2545F491;
+    int failures = 0;
+
+    for (size_t i = 0; i < sizeof(buffer); i++)
+    {
+        state = state * 1664525u + 1013904223u;
+        buffer[i] = (uint8_t)(state >> 24);
+    }
+
+    for (int type = 0; type < CRC_TYPE_COUNT; type++)
+    {
+        uint16_t crc;
+        if (crc_dma_compute(type, check, sizeof(check) - 1, &crc) ||
+            crc != crc_software(type, check, sizeof(check) - 1))
+        {
+            LOG_ERROR("CRC DMA: check value mismatch for type %d", type);
+            failures++;
+        }
+
+        // Every length and an odd start, so alignment is covered too.
+        for (size_t len = 1; len < sizeof(buffer); len++)
+        {
+            if (crc_dma_compute(type, buffer + 1, len, &crc) || crc != crc_software(type, buffer + 1, len))
+            {
+                LOG_ERROR("CRC DMA: mismatch for type %d at %u bytes", type, (unsigned)len);
+                failures++;
+                break;
+            }
+        }
+    }
+
+    return failures ? -1 : 0;
+}
+
+void crc_dma_benchmark(size_t len, int rounds)
+{
+    static uint8_t buffer[BENCHMARK_MAX_LEN];
+    volatile uint16_t result = 0;
+
+    if (dma_chan < 0 || len > sizeof(buffer) || rounds <= 0)
+        return;
+
+    for (size_t i = 0; i < len; i++)
+        buffer[i] = (uint8_t)(i * 37 + 11);
+
+    for (int type = 0; type < CRC_TYPE_COUNT; type++)
+    {
+        uint64_t start = time_us_64();
+        for (int r = 0; r < rounds; r++)
+            result = crc_software(type, buffer, len);
+        uint64_t software_us = time_us_64() - start;
+
+        uint16_t crc = 0;
+        start = time_us_64();
+        for (int r = 0; r < rounds; r++)
+        {
+            crc_dma_compute(type, buffer, len, &crc);
+            result = crc;
+        }
+        uint64_t dma_us = time_us_64() - start;
+
+        LOG_INFO("CRC DMA: type %d, %u bytes: software %.2f us, DMA %.2f us", type, (unsigned)len,
+                 (double)software_us / rounds, (double)dma_us / rounds);
+    }
+
+    (void)result;
+}
+
+int crc_dma_init(void)
+{
+    if (dma_chan >= 0)
+        return 0;
+
+    dma_chan = dma_claim_unused_channel(false);
+    if (dma_chan < 0)
+    {
+        LOG_WARN("CRC DMA: no DMA channel available, using software CRC");
+        return -1;
+    }
+
+    if (crc_dma_self_test())
+    {
+        LOG_WARN("CRC DMA: self test failed, using software CRC");
+        crc_dma_deinit();
+        return -1;
+    }
+
+    crc_set_engine(crc_dma_compute, CRC_DMA_MIN_BYTES);
+    LOG_INFO("CRC DMA initialized on channel %d", dma_chan);
+    return 0;
+}
+
+int crc_dma_deinit(void)
+{
+    crc_set_engine(NULL, 0);
+
+    if (dma_chan >= 0)
+    {
+        dma_channel_unclaim(dma_chan);
+        dma_chan = -1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,329 @@
+#include "pwm_dac.h"
+
+#include "hardware/clocks.h"
+#include "hardware/dma.h"
+#include "hardware/irq.h"
+#include "hardware/pwm.h"
+#include "hardware/sync.h"
+#include "pico/stdlib.h"
+#include "c-logger.h"
+#include "modem/fsk_mod.h"
+
+#ifndef PWM_DAC_PIN
+#define PWM_DAC_PIN 14
+#endif
+#define PWM_DAC_BLOCK 256 // samples per DMA block, 3.2 ms at 79.2 kHz
+
+static int dma_chan[2] = {-1, -1};
+static uint slice = 0;
+static bool is_running = false;
+
+static uint16_t blocks[2][PWM_DAC_BLOCK];
+static uint32_t level_scale = 0; // wrap + 1: a 12-bit sample times this, >> 12, is the compare level
+static uint32_t sample_rate = 0;
+
+static modem_profile_t tx_profile; // the caller's, at the PWM sample rate
+static fsk_mod_t mod;
+static volatile size_t symbol_left = 0; // samples of the current symbol still to render (DMA interrupt)
+static nco_t tone;
+static volatile int16_t tone_amplitude = 0;
+static volatile int16_t amplitude = 0;
+static volatile bool amplitude_changed = false;
+
+// Single producer (pwm_dac_queue_symbols), single consumer (the DMA interrupt).
+static uint8_t queue[PWM_DAC_QUEUE];
+static volatile size_t queue_head = 0;
+static volatile size_t queue_tail = 0;
+static volatile uint64_t symbols_sent = 0;
+static volatile int tail_blocks = 0;     // filled blocks still to play that hold symbol samples
+static volatile uint32_t bursts = 0;     // runs of symbols without an idle block between them
+static volatile uint32_t burst_first_us = 0;
+static volatile uint32_t burst_end_us = 0;
+
+// Renders a block; [*first, *end) is the part of it that is symbols, empty if none.
+static void render(uint16_t *out, size_t count, size_t *first, size_t *end)
+{
+    size_t pos = 0;
+
+    *first = *end = 0;
+    if (amplitude_changed)
+    {
+        amplitude_changed = false;
+        mod.amplitude = amplitude / mod.carriers;
+    }
+
+    while (pos < count)
+    {
+        if (symbol_left == 0 && queue_tail != queue_head)
+        {
+            symbol_left = fsk_mod_begin_symbol(&mod, queue[queue_tail]);
+            queue_tail = (queue_tail + 1) % PWM_DAC_QUEUE;
+            symbols_sent++;
+        }
+
+        if (symbol_left)
+        {
+            size_t n = symbol_left < count - pos ? symbol_left : count - pos;
+            if (*end == 0)
+                *first = pos;
+            fsk_mod_render(&mod, out + pos, n);
+            symbol_left -= n;
+            pos += n;
+            *end = pos;
+            continue;
+        }
+
+        // Nothing queued: the idle tone until the end of the block.
+        for (; pos < count; pos++)
+        {
+            out[pos] = (uint16_t)(MODEM_ADC_MIDPOINT + ((tone_amplitude * nco_sin(&tone)) >> 15));
+            nco_advance(&tone);
+        }
+    }
+}
+
+static uint32_t samples_us(size_t samples)
+{
+    return (uint32_t)((uint64_t)samples * 1000000 / sample_rate);
+}
+
+static void fill(int index)
+{
+    uint16_t *block = blocks[index];
+    size_t first, end;
+
+    render(block, PWM_DAC_BLOCK, &first, &end);
+    if (end > first)
+    {
+        // This block plays once the one playing now is out, a block from now, and is done two fills later.
+        uint32_t start_us = time_us_32() + samples_us(PWM_DAC_BLOCK);
+        if (tail_blocks == 0)
+        {
+            burst_first_us = start_us + samples_us(first);
+            bursts++;
+        }
+        burst_end_us = start_us + samples_us(end);
+        tail_blocks = 2;
+    }
+    else if (tail_blocks > 0)
+    {
+        tail_blocks--;
+    }
+
+    for (size_t i = 0; i < PWM_DAC_BLOCK; i++)
+        block[i] = (uint16_t)((block[i] * level_scale) >> 12);
+}
+
+static void __isr dma_handler(void)
+{
+    for (int i = 0; i < 2; i++)
+    {
+        if (dma_hw->ints1 & (1u << dma_chan[i]))
+        {
+            dma_hw->ints1 = 1u << dma_chan[i];
+
+            // The other channel is playing its block now; this one restarts from the top when chained to.
+            fill(i);
+            dma_channel_set_read_addr(dma_chan[i], blocks[i], false);
+        }
+    }
+}
+
+int pwm_dac_init(void)
+{
+    if (dma_chan[0] >= 0)
+        return 0;
+
+    dma_chan[0] = dma_claim_unused_channel(false);
+    dma_chan[1] = dma_claim_unused_channel(false);
+    if (dma_chan[0] < 0 || dma_chan[1] < 0)
+    {
+        LOG_ERROR("No DMA channels available for the PWM DAC");
+        pwm_dac_deinit();
+        return -1;
+    }
+
+    gpio_set_function(PWM_DAC_PIN, GPIO_FUNC_PWM);
+    slice = pwm_gpio_to_slice_num(PWM_DAC_PIN);
+
+    LOG_INFO("PWM DAC initialized on GPIO %d", PWM_DAC_PIN);
+    return 0;
+}
+
+int pwm_dac_deinit(void)
+{
+    if (is_running)
+        pwm_dac_stop();
+
+    for (int i = 0; i < 2; i++)
+    {
+        if (dma_chan[i] >= 0)
+        {
+            dma_channel_unclaim(dma_chan[i]);
+            dma_chan[i] = -1;
+        }
+    }
+    return 0;
+}
+
+int pwm_dac_start(const modem_profile_t *profile, int16_t new_amplitude)
+{
+    if (dma_chan[0] < 0 || !profile || is_running)
+        return -1;
+
+    // One sample per PWM period, at the integer divider that keeps the wrap in 16 bits.
+    uint32_t sys_hz = clock_get_hz(clk_sys);
+    uint32_t divider = sys_hz / profile->sample_rate / 65536 + 1;
+    uint32_t wrap = sys_hz / divider / profile->sample_rate - 1;
+
+    level_scale = wrap + 1;
+    sample_rate = sys_hz / divider / (wrap + 1);
+
+    tx_profile = *profile;
+    tx_profile.sample_rate = sample_rate;
+    if (fsk_mod_init(&mod, &tx_profile, new_amplitude))
+    {
+        LOG_ERROR("PWM DAC: cannot modulate %s", profile->name);
+        return -1;
+    }
+
+    amplitude = new_amplitude;
+    tone_amplitude = new_amplitude;
+    amplitude_changed = false;
+    nco_init(&tone, 0.0f, sample_rate);
+    symbol_left = 0;
+    queue_head = 0;
+    queue_tail = 0;
+    symbols_sent = 0;
+    tail_blocks = 0;
+    bursts = 0;
+
+    pwm_config config = pwm_get_default_config();
+    pwm_config_set_clkdiv_int(&config, divider);
+    pwm_config_set_wrap(&config, (uint16_t)wrap);
+    pwm_init(slice, &config, false);
+    pwm_set_gpio_level(PWM_DAC_PIN, (uint16_t)(MODEM_ADC_MIDPOINT * level_scale >> 12));
+
+    fill(0);
+    fill(1);
+
+    for (int i = 0; i < 2; i++)
+    {
+        // A 16-bit write to CC lands in both halves; only this pin's half is connected.
+        dma_channel_config c = dma_channel_get_default_config(dma_chan[i]);
+        channel_config_set_transfer_data_size(&c, DMA_SIZE_16);
+        channel_config_set_read_increment(&c, true);
+        channel_config_set_write_increment(&c, false);
+        channel_config_set_dreq(&c, pwm_get_dreq(slice));
+        channel_config_set_chain_to(&c, dma_chan[!i]);
+        dma_channel_configure(dma_chan[i], &c, &pwm_hw->slice[slice].cc, blocks[i], PWM_DAC_BLOCK, false);
+        dma_channel_set_irq1_enabled(dma_chan[i], true);
+    }
+
+    irq_set_exclusive_handler(DMA_IRQ_1, dma_handler);
+    irq_set_enabled(DMA_IRQ_1, true);
+
+    dma_channel_start(dma_chan[0]);
+    pwm_set_enabled(slice, true);
+
+    is_running = true;
+    LOG_INFO("PWM DAC started (%lu Hz, wrap %lu, %s)", (unsigned long)sample_rate, (unsigned long)wrap,
+             profile->name);
+    return 0;
+}
+
+int pwm_dac_stop(void)
+{
+    if (!is_running)
+        return 0;
+
+    irq_set_enabled(DMA_IRQ_1, false);
+    for (int i = 0; i < 2; i++)
+    {
+        // Unchain first, or aborting one channel can start the other.
+        hw_clear_bits(&dma_hw->ch[dma_chan[i]].al1_ctrl, DMA_CH0_CTRL_TRIG_EN_BITS);
+        dma_channel_set_irq1_enabled(dma_chan[i], false);
+    }
+    dma_channel_abort(dma_chan[0]);
+    dma_channel_abort(dma_chan[1]);
+    dma_hw->ints1 = (1u << dma_chan[0]) | (1u << dma_chan[1]);
+
+    pwm_set_gpio_level(PWM_DAC_PIN, (uint16_t)(MODEM_ADC_MIDPOINT * level_scale >> 12));
+    pwm_set_enabled(slice, false);
+
+    is_running = false;
+    LOG_INFO("PWM DAC stopped");
+    return 0;
+}
+
+int pwm_dac_set_amplitude(int16_t new_amplitude)
+{
+    amplitude = new_amplitude;
+    tone_amplitude = new_amplitude;
+    amplitude_changed = true;
+    return 0;
+}
+
+int pwm_dac_set_tone(float frequency)
+{
+    if (!is_running || frequency < 0.0f || frequency >= sample_rate / 2.0f)
+        return -1;
+
+    // The step is one word, so the interrupt sees the old tone or the new one, phase unbroken.
+    nco_set_step(&tone, nco_step(frequency, sample_rate));
+    if (frequency == 0.0f)
+        tone.phase = 0; // back to the midpoint, not a held level
+    return 0;
+}
+
+size_t pwm_dac_queue_symbols(const uint8_t *symbols, size_t count)
+{
+    size_t queued = 0;
+
+    while (queued < count)
+    {
+        size_t next = (queue_head + 1) % PWM_DAC_QUEUE;
+        if (next == queue_tail)
+            break;
+        queue[queue_head] = symbols[queued++];
+        queue_head = next;
+    }
+    return queued;
+}
+
+size_t pwm_dac_queued(void)
+{
+    return (queue_head + PWM_DAC_QUEUE - queue_tail) % PWM_DAC_QUEUE;
+}
+
+bool pwm_dac_busy(void)
+{
+    // One snapshot: the interrupt moves samples from the queue to symbol_left to tail_blocks.
+    uint32_t status = save_and_disable_interrupts();
+    bool busy = is_running && (queue_head != queue_tail || symbol_left || tail_blocks);
+    restore_interrupts(status);
+    return busy;
+}
+
+bool pwm_dac_last_burst(uint32_t *first_us, uint32_t *end_us)
+{
+    uint32_t status = save_and_disable_interrupts();
+    bool any = bursts > 0;
+    *first_us = burst_first_us;
+    *end_us = burst_end_us;
+    restore_interrupts(status);
+    return any;
+}
+
+uint64_t pwm_dac_symbols_sent(void)
+{
+    uint32_t status = save_and_disable_interrupts();
+    uint64_t sent = symbols_sent;
+    restore_interrupts(status);
+    return sent;
+}
+
+uint32_t pwm_dac_sample_rate(void)
+{
+    return sample_rate;
+}
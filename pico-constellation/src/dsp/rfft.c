@@ -0,0 +1,124 @@
+#include "dsp/rfft.h"
+
+#include <math.h>
+#include <string.h>
+
+int rfft_init(rfft_t *fft, uint16_t size)
+{
+    if (!fft || size < 4 || size > RFFT_MAX_SIZE || (size & (size - 1)))
+        return -1;
+
+    memset(fft, 0, sizeof(*fft));
+    fft->size = size;
+
+    while ((2u << fft->stages) < size)
+        fft->stages++;
+
+    for (int i = 0; i < size; i++)
+    {
+        fft->sine[i] = (int16_t)lrintf(sinf(2.0f * (float)M_PI * i / size) * 32767.0f);
+    }
+
+    return 0;
+}
+
+// e^{-j 2 pi i / N} = cos - j sin
+static inline int16_t rfft_cos(const rfft_t *fft, unsigned i)
+{
+    return fft->sine[(i + fft->size / 4) & (fft->size - 1)];
+}
+
+static inline int16_t rfft_sin(const rfft_t *fft, unsigned i)
+{
+    return fft->sine[i & (fft->size - 1)];
+}
+
+static void rfft_bit_reverse(int16_t *z, unsigned half)
+{
+    for (unsigned i = 1, j = 0; i < half; i++)
+    {
+        unsigned bit = half >> 1;
+        for (; j & bit; bit >>= 1)
+            j ^= bit;
+        j |= bit;
+
+        if (i < j)
+        {
+            int16_t re = z[2 * i];
+            int16_t im = z[2 * i + 1];
+            z[2 * i] = z[2 * j];
+            z[2 * i + 1] = z[2 * j + 1];
+            z[2 * j] = re;
+            z[2 * j + 1] = im;
+        }
+    }
+}
+
+// Radix-2 decimation in time on N/2 interleaved complex values, 1/2 per stage.
+static void rfft_complex(const rfft_t *fft, int16_t *z)
+{
+    unsigned half = fft->size / 2;
+
+    rfft_bit_reverse(z, half);
+
+    for (unsigned span = 1; span < half; span <<= 1)
+    {
+        // Twiddle for the N/2-point transform: e^{-j 2 pi k / (2 span)} = W_N^{k N / (2 span)}
+        unsigned stride = fft->size / (2 * span);
+
+        for (unsigned k = 0; k < span; k++)
+        {
+            int32_t wr = rfft_cos(fft, k * stride);
+            int32_t wi = -rfft_sin(fft, k * stride);
+
+            for (unsigned a = k; a < half; a += 2 * span)
+            {
+                unsigned b = a + span;
+                int32_t br = z[2 * b];
+                int32_t bi = z[2 * b + 1];
+                int32_t tr = (br * wr - bi * wi) >> 15;
+                int32_t ti = (br * wi + bi * wr) >> 15;
+                int32_t ar = z[2 * a];
+                int32_t ai = z[2 * a + 1];
+
+                z[2 * a] = (int16_t)((ar + tr) >> 1);
+                z[2 * a + 1] = (int16_t)((ai + ti) >> 1);
+                z[2 * b] = (int16_t)((ar - tr) >> 1);
+                z[2 * b + 1] = (int16_t)((ai - ti) >> 1);
+            }
+        }
+    }
+}
+
+void rfft_power(const rfft_t *fft, int16_t *data, uint32_t *power)
+{
+    unsigned half = fft->size / 2;
+
+    rfft_complex(fft, data);
+
+    // X[k] = E[k] - j W_N^k O[k], E = (Z[k] + conj Z[M-k]) / 2, O = (Z[k] - conj Z[M-k]) / 2
+    for (unsigned k = 0; k < half; k++)
+    {
+        unsigned m = (half - k) & (half - 1);
+        int32_t zr = data[2 * k];
+        int32_t zi = data[2 * k + 1];
+        int32_t cr = data[2 * m];
+        int32_t ci = -data[2 * m + 1];
+
+        int32_t er = (zr + cr) >> 1;
+        int32_t ei = (zi + ci) >> 1;
+        int32_t odd_r = (zr - cr) >> 1;
+        int32_t odd_i = (zi - ci) >> 1;
+
+        int32_t wr = rfft_cos(fft, k);
+        int32_t wi = -rfft_sin(fft, k);
+
+        // t = W * O, then X = E - j t = (er + ti) + j (ei - tr)
+        int32_t tr = (odd_r * wr - odd_i * wi) >> 15;
+        int32_t ti = (odd_r * wi + odd_i * wr) >> 15;
+        int64_t xr = er + ti;
+        int64_t xi = ei - tr;
+
+        power[k] = (uint32_t)((xr * xr + xi * xi) >> 1);
+    }
+}
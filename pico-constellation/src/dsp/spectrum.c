@@ -0,0 +1,184 @@
+#include "dsp/spectrum.h"
+
+#include <math.h>
+#include <string.h>
+
+#define INPUT_SHIFT 3              // 12-bit ADC swing to half of Q15
+#define FULL_SCALE_LOG2 25         // log2 of the bin power of a full-swing sine
+#define DEFAULT_FFT_SIZE 256
+#define DEFAULT_DECIMATION 8
+#define DEFAULT_INTERVAL_US 250000
+#define DEFAULT_BUDGET_PERCENT 5
+
+void spectrum_default_config(spectrum_config_t *config, uint32_t sample_rate, uint64_t (*clock_us)(void))
+{
+    config->sample_rate = sample_rate;
+    config->fft_size = DEFAULT_FFT_SIZE;
+    config->decimation = DEFAULT_DECIMATION;
+    config->bins = DEFAULT_FFT_SIZE / 2;
+    config->interval_us = DEFAULT_INTERVAL_US;
+    config->budget_percent = DEFAULT_BUDGET_PERCENT;
+    config->schedule = SPECTRUM_SCHEDULE_ALWAYS;
+    config->clock_us = clock_us;
+}
+
+int spectrum_init(spectrum_t *spectrum, const spectrum_config_t *config)
+{
+    if (!spectrum || !config || !config->clock_us || !config->decimation)
+        return -1;
+
+    if (!config->bins || config->bins > SPECTRUM_MAX_BINS || (config->fft_size / 2) % config->bins)
+        return -1;
+
+    if (!config->budget_percent || config->budget_percent > 100)
+        return -1;
+
+    memset(spectrum, 0, sizeof(*spectrum));
+    spectrum->config = *config;
+
+    if (rfft_init(&spectrum->fft, config->fft_size) != 0)
+        return -1;
+
+    for (int i = 0; i < config->fft_size; i++)
+    {
+        float w = 0.5f - 0.5f * cosf(2.0f * (float)M_PI * i / config->fft_size);
+        spectrum->window[i] = (int16_t)lrintf(w * 32767.0f);
+    }
+
+    spectrum->next_capture_us = config->clock_us();
+    return 0;
+}
+
+void spectrum_feed(spectrum_t *spectrum, const uint16_t *samples, size_t count)
+{
+    if (spectrum->ready)
+        return;
+
+    if (!spectrum->capturing)
+    {
+        if (spectrum->config.clock_us() < spectrum->next_capture_us)
+            return;
+
+        spectrum->capturing = true;
+        spectrum->fill = 0;
+        spectrum->decimate_sum = 0;
+        spectrum->decimate_count = 0;
+    }
+
+    for (size_t i = 0; i < count; i++)
+    {
+        spectrum->decimate_sum += samples[i];
+        if (++spectrum->decimate_count < spectrum->config.decimation)
+            continue;
+
+        spectrum->frame[spectrum->fill++] = (uint16_t)(spectrum->decimate_sum / spectrum->config.decimation);
+        spectrum->decimate_sum = 0;
+        spectrum->decimate_count = 0;
+
+        if (spectrum->fill == spectrum->config.fft_size)
+        {
+            spectrum->capturing = false;
+            spectrum->ready = true;
+            spectrum->deferred = false;
+            return;
+        }
+    }
+}
+
+// log2(x) in Q8, linear between powers of two; 0 for x = 0.
+static uint16_t spectrum_log2_q8(uint32_t x)
+{
+    if (!x)
+        return 0;
+
+    int e = 31 - __builtin_clz(x);
+    uint32_t mantissa = e >= 8 ? x >> (e - 8) : x << (8 - e);
+    return (uint16_t)((e << 8) | (mantissa & 0xff));
+}
+
+static void spectrum_compute(spectrum_t *spectrum, uint8_t *line)
+{
+    uint16_t n = spectrum->config.fft_size;
+    uint32_t sum = 0;
+
+    for (uint16_t i = 0; i < n; i++)
+        sum += spectrum->frame[i];
+    int32_t mean = (int32_t)(sum / n);
+
+    for (uint16_t i = 0; i < n; i++)
+    {
+        int32_t x = ((int32_t)spectrum->frame[i] - mean) << INPUT_SHIFT;
+        if (x > INT16_MAX)
+            x = INT16_MAX;
+        else if (x < INT16_MIN)
+            x = INT16_MIN;
+        spectrum->work[i] = (int16_t)((x * spectrum->window[i]) >> 15);
+    }
+
+    rfft_power(&spectrum->fft, spectrum->work, spectrum->power);
+
+    // Peak of each group of bins, so narrow tones survive the narrower line.
+    uint16_t group = (n / 2) / spectrum->config.bins;
+    for (uint16_t b = 0; b < spectrum->config.bins; b++)
+    {
+        uint32_t peak = 0;
+        for (uint16_t k = b * group; k < (b + 1) * group; k++)
+        {
+            if (spectrum->power[k] > peak)
+                peak = spectrum->power[k];
+        }
+
+        uint32_t v = ((uint32_t)spectrum_log2_q8(peak) * 255) / (FULL_SCALE_LOG2 << 8);
+        line[b] = v > 255 ? 255 : (uint8_t)v;
+    }
+}
+
+int spectrum_task(spectrum_t *spectrum, bool idle)
+{
+    if (!spectrum->ready)
+        return 0;
+
+    if (spectrum->config.schedule == SPECTRUM_SCHEDULE_IDLE && !idle)
+    {
+        if (!spectrum->deferred)
+        {
+            spectrum->deferred = true;
+            spectrum->stats.deferred++;
+        }
+        return 0;
+    }
+
+    uint64_t start = spectrum->config.clock_us();
+    uint32_t seq = spectrum->seq + 1;
+    spectrum_compute(spectrum, spectrum->lines[seq % SPECTRUM_MAX_LINES]);
+    spectrum->seq = seq;
+    uint64_t end = spectrum->config.clock_us();
+
+    uint32_t cost = (uint32_t)(end - start);
+    spectrum->stats.lines++;
+    spectrum->stats.last_us = cost;
+    if (cost > spectrum->stats.max_us)
+        spectrum->stats.max_us = cost;
+
+    // Hold the next capture off until this line's cost averages out to the budget.
+    uint64_t hold = (uint64_t)cost * 100 / spectrum->config.budget_percent;
+    if (hold < spectrum->config.interval_us)
+        hold = spectrum->config.interval_us;
+    spectrum->next_capture_us = end + hold;
+    spectrum->ready = false;
+    return 1;
+}
+
+const uint8_t *spectrum_line(const spectrum_t *spectrum, uint32_t seq)
+{
+    if (!seq || seq > spectrum->seq || spectrum->seq - seq >= SPECTRUM_MAX_LINES)
+        return NULL;
+
+    return spectrum->lines[seq % SPECTRUM_MAX_LINES];
+}
+
+float spectrum_bin_hz(const spectrum_t *spectrum)
+{
+    float rate = (float)spectrum->config.sample_rate / spectrum->config.decimation;
+    return rate / spectrum->config.fft_size * ((spectrum->config.fft_size / 2) / spectrum->config.bins);
+}
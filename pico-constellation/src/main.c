@@ -1,13 +1,36 @@
 #include "pico/stdlib.h"
 #include "peregrine-constellation.h"
 #include "network/network.h"
+#include "ui/ui.h"
+#include "ui/waterfall.h"
+#include "ui/link_test.h"
+#include "ui/loopback.h"
+#include "ui/tx_service.h"
+#include "drivers/crc_dma.h"
+#include "adc_bsp_tap.h"
 #include "c-logger.h"
 
+// LINK_TEST_TRANSMIT or LINK_TEST_RECEIVE makes this node one end of a PRBS link test.
+#ifndef LINK_TEST_ROLE
+#define LINK_TEST_ROLE LINK_TEST_OFF
+#endif
+
+// Frames per profile in the boot-time loopback self-test; 0 skips it.
+#ifndef LOOPBACK_SELF_TEST_FRAMES
+#define LOOPBACK_SELF_TEST_FRAMES 1
+#endif
+
+// A profile id sends messages through the queued transmit path (ui/tx_service.h) rather than the library.
+#ifndef TX_SERVICE_PROFILE
+#define TX_SERVICE_PROFILE -1
+#endif
+
 static int count = 0;
 pc_handle_t *pc_handle;
 void data_callback(const uint8_t *data, size_t len, uint8_t src_addr)
 {
     LOG_INFO("%d Decoded Data from %d: ", count++, src_addr);
+    ui_frame_received(src_addr, NULL); // the library callback carries no link quality
     for (size_t i = 0; i < len; i++)
     {
         printf("%02X ", data[i]);
@@ -20,12 +43,34 @@ void data_callback(const uint8_t *data, size_t len, uint8_t src_addr)
     printf("\n");
 }
 
+// Everything the ADC delivers, before the library takes it.
+static void sample_tap(const uint16_t *samples, size_t count)
+{
+    waterfall_feed(samples, count);
+    link_test_feed(samples, count);
+    tx_service_feed(samples, count);
+}
+
+static uint64_t clock_ns(void)
+{
+    return time_us_64() * 1000;
+}
+
 int main(void)
 {
     stdio_init_all();
 
     log_init(LOG_LEVEL_INFO);
 
+    // Falls back to software CRCs on failure.
+    crc_dma_init();
+
+    // Before the library owns the ADC: the self-test borrows the ring, with sampling stopped.
+    if (LOOPBACK_SELF_TEST_FRAMES && loopback_self_test(LOOPBACK_SELF_TEST_FRAMES, clock_ns))
+    {
+        LOG_ERROR("Loopback self-test lost frames");
+    }
+
     if (network_init())
     {
         LOG_ERROR("Failed to initialize network interface");
@@ -37,10 +82,26 @@ int main(void)
         LOG_ERROR("Failed to initialize Peregrine Constellation");
         return -1;
     }
+    if (waterfall_init(modem_profile_get(MODEM_PROFILE_FSK_32)->sample_rate))
+    {
+        LOG_ERROR("Failed to start waterfall");
+    }
+    adc_bsp_set_tap(sample_tap);
+    if (link_test_init(LINK_TEST_ROLE, MODEM_PROFILE_FSK_32, PRBS_15))
+    {
+        LOG_ERROR("Failed to start link test");
+    }
+    if (TX_SERVICE_PROFILE >= 0 && tx_service_init(TX_SERVICE_PROFILE))
+    {
+        LOG_ERROR("Failed to start TX service, sending through the library");
+    }
 
     while (1)
     {
         pc_task(pc_handle);
+        waterfall_task();
+        link_test_task();
+        tx_service_task();
     }
     return 0;
 }
\ No newline at end of file
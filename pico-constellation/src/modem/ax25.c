@@ -0,0 +1,280 @@
+#include "modem/ax25.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#define SSID_RESERVED 0x60 // the two reserved bits, sent as 1
+#define ADDRESS_LAST 0x01  // extension bit on the final address
+#define ADDRESS_FLAG 0x80
+
+int ax25_address_parse(const char *text, size_t len, ax25_address_t *addr)
+{
+    if (!text || !addr)
+        return -1;
+
+    memset(addr, 0, sizeof(*addr));
+
+    if (len && text[len - 1] == '*')
+    {
+        addr->flag = true;
+        len--;
+    }
+
+    size_t call = 0;
+    while (call < len && text[call] != '-')
+    {
+        char c = text[call];
+        if (call >= AX25_CALLSIGN_LEN)
+            return -1;
+        if (c >= 'a' && c <= 'z')
+            c = (char)(c - 'a' + 'A');
+        if (!((c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9')))
+            return -1;
+        addr->callsign[call++] = c;
+    }
+
+    if (!call)
+        return -1;
+
+    if (call < len)
+    {
+        unsigned ssid = 0;
+        size_t digits = 0;
+        for (size_t i = call + 1; i < len; i++, digits++)
+        {
+            if (text[i] < '0' || text[i] > '9')
+                return -1;
+            ssid = ssid * 10 + (unsigned)(text[i] - '0');
+        }
+        if (!digits || ssid > 15)
+            return -1;
+        addr->ssid = (uint8_t)ssid;
+    }
+
+    return 0;
+}
+
+int ax25_frame_from_text(const char *text, ax25_frame_t *frame)
+{
+    if (!text || !frame)
+        return -1;
+
+    memset(frame, 0, sizeof(*frame));
+
+    const char *gt = strchr(text, '>');
+    const char *colon = gt ? strchr(gt, ':') : NULL;
+    if (!gt || !colon)
+        return -1;
+
+    if (ax25_address_parse(text, (size_t)(gt - text), &frame->src))
+        return -1;
+
+    // Destination, then comma separated digipeaters.
+    const char *field = gt + 1;
+    int index = -1;
+    while (field < colon)
+    {
+        const char *end = memchr(field, ',', (size_t)(colon - field));
+        if (!end)
+            end = colon;
+
+        if (index < 0)
+        {
+            if (ax25_address_parse(field, (size_t)(end - field), &frame->dst))
+                return -1;
+        }
+        else
+        {
+            if (index >= AX25_MAX_DIGIS)
+                return -1;
+            if (ax25_address_parse(field, (size_t)(end - field), &frame->digis[index]))
+                return -1;
+
+            // A '*' marks the last digipeater that has repeated the frame.
+            if (frame->digis[index].flag)
+            {
+                for (int i = 0; i < index; i++)
+                    frame->digis[i].flag = true;
+            }
+        }
+
+        index++;
+        field = end + 1;
+    }
+
+    if (index < 0 || frame->src.flag || frame->dst.flag)
+        return -1;
+
+    frame->num_digis = (uint8_t)index;
+    frame->dst.flag = true; // command
+    frame->control = AX25_CONTROL_UI;
+    frame->has_pid = true;
+    frame->pid = AX25_PID_NO_LAYER3;
+    frame->info = (const uint8_t *)(colon + 1);
+    frame->info_len = strlen(colon + 1);
+    return frame->info_len > AX25_MAX_INFO ? -1 : 0;
+}
+
+static int ax25_address_to_text(const ax25_address_t *addr, bool star, char *out, size_t max_len)
+{
+    int n;
+
+    if (addr->ssid)
+        n = snprintf(out, max_len, "%s-%u%s", addr->callsign, addr->ssid, star ? "*" : "");
+    else
+        n = snprintf(out, max_len, "%s%s", addr->callsign, star ? "*" : "");
+
+    return (n < 0 || (size_t)n >= max_len) ? -1 : n;
+}
+
+int ax25_frame_to_text(const ax25_frame_t *frame, char *out, size_t max_len)
+{
+    size_t len = 0;
+    int n;
+
+    if (!frame || !out)
+        return -1;
+
+    int last_repeated = -1;
+    for (int i = 0; i < frame->num_digis; i++)
+    {
+        if (frame->digis[i].flag)
+            last_repeated = i;
+    }
+
+    if ((n = ax25_address_to_text(&frame->src, false, out, max_len)) < 0)
+        return -1;
+    len += (size_t)n;
+
+    for (int i = -1; i < frame->num_digis; i++)
+    {
+        if (len + 1 >= max_len)
+            return -1;
+        out[len++] = i < 0 ? '>' : ',';
+
+        const ax25_address_t *addr = i < 0 ? &frame->dst : &frame->digis[i];
+        if ((n = ax25_address_to_text(addr, i >= 0 && i == last_repeated, out + len, max_len - len)) < 0)
+            return -1;
+        len += (size_t)n;
+    }
+
+    if (len + 1 + frame->info_len >= max_len)
+        return -1;
+
+    out[len++] = ':';
+    memcpy(out + len, frame->info, frame->info_len);
+    len += frame->info_len;
+    out[len] = '\0';
+    return (int)len;
+}
+
+static void ax25_address_encode(const ax25_address_t *addr, bool last, uint8_t *out)
+{
+    size_t call = strlen(addr->callsign);
+
+    for (size_t i = 0; i < AX25_CALLSIGN_LEN; i++)
+    {
+        out[i] = (uint8_t)((i < call ? addr->callsign[i] : ' ') << 1);
+    }
+
+    out[AX25_CALLSIGN_LEN] = (uint8_t)(SSID_RESERVED | (addr->ssid & 0x0F) << 1 |
+                                       (addr->flag ? ADDRESS_FLAG : 0) | (last ? ADDRESS_LAST : 0));
+}
+
+int ax25_encode(const ax25_frame_t *frame, uint8_t *out, size_t max_len, size_t *len)
+{
+    if (!frame || !out || !len || frame->num_digis > AX25_MAX_DIGIS || frame->info_len > AX25_MAX_INFO)
+        return -1;
+
+    size_t total = AX25_ADDRESS_SIZE * (2 + frame->num_digis) + 1 + (frame->has_pid ? 1 : 0) + frame->info_len;
+    if (total > max_len)
+        return -1;
+
+    size_t pos = 0;
+    ax25_address_encode(&frame->dst, false, out + pos);
+    pos += AX25_ADDRESS_SIZE;
+    ax25_address_encode(&frame->src, frame->num_digis == 0, out + pos);
+    pos += AX25_ADDRESS_SIZE;
+
+    for (int i = 0; i < frame->num_digis; i++)
+    {
+        ax25_address_encode(&frame->digis[i], i == frame->num_digis - 1, out + pos);
+        pos += AX25_ADDRESS_SIZE;
+    }
+
+    out[pos++] = frame->control;
+    if (frame->has_pid)
+        out[pos++] = frame->pid;
+
+    if (frame->info_len)
+        memcpy(out + pos, frame->info, frame->info_len);
+    pos += frame->info_len;
+
+    *len = pos;
+    return 0;
+}
+
+static int ax25_address_decode(const uint8_t *in, ax25_address_t *addr)
+{
+    memset(addr, 0, sizeof(*addr));
+
+    for (int i = 0; i < AX25_CALLSIGN_LEN; i++)
+    {
+        if (in[i] & 1)
+            return -1; // extension bit inside a callsign
+
+        char c = (char)(in[i] >> 1);
+        if (c == ' ')
+            break;
+        addr->callsign[i] = c;
+    }
+
+    addr->ssid = (in[AX25_CALLSIGN_LEN] >> 1) & 0x0F;
+    addr->flag = (in[AX25_CALLSIGN_LEN] & ADDRESS_FLAG) != 0;
+    return addr->callsign[0] ? 0 : -1;
+}
+
+int ax25_decode(const uint8_t *data, size_t len, ax25_frame_t *frame)
+{
+    if (!data || !frame || len < AX25_MIN_FRAME)
+        return -1;
+
+    memset(frame, 0, sizeof(*frame));
+
+    size_t pos = 0;
+    int count = 0;
+    bool last = false;
+
+    while (!last)
+    {
+        if (pos + AX25_ADDRESS_SIZE > len || count >= 2 + AX25_MAX_DIGIS)
+            return -1;
+
+        ax25_address_t *addr = count == 0 ? &frame->dst : count == 1 ? &frame->src : &frame->digis[count - 2];
+        if (ax25_address_decode(data + pos, addr))
+            return -1;
+
+        last = data[pos + AX25_CALLSIGN_LEN] & ADDRESS_LAST;
+        pos += AX25_ADDRESS_SIZE;
+        count++;
+    }
+
+    if (count < 2 || pos >= len)
+        return -1;
+
+    frame->num_digis = (uint8_t)(count - 2);
+    frame->control = data[pos++];
+
+    // I frames (bit 0 clear) and UI frames carry a PID.
+    if (!(frame->control & 0x01) || (frame->control & 0xEF) == AX25_CONTROL_UI)
+    {
+        if (pos >= len)
+            return -1;
+        frame->has_pid = true;
+        frame->pid = data[pos++];
+    }
+
+    frame->info = data + pos;
+    frame->info_len = len - pos;
+    return frame->info_len > AX25_MAX_INFO ? -1 : 0;
+}
@@ -0,0 +1,72 @@
+#include "modem/ax25_rx.h"
+
+#include <string.h>
+
+int ax25_rx_init(ax25_rx_t *rx, const modem_profile_t *profile, hdlc_frame_callback_t callback, void *ctx)
+{
+    if (!rx || !profile || profile->modulation != MODEM_MOD_FSK || profile->carriers != 1)
+        return -1;
+
+    memset(rx, 0, sizeof(*rx));
+
+    fsk_demod_config_t config;
+    if (fsk_demod_config_from_profile(&config, profile, 0) || fsk_demod_init(&rx->demod, &config))
+        return -1;
+
+    rx->bit_len = (int32_t)profile->oversample << 8;
+    hdlc_decoder_init(&rx->hdlc, callback, ctx);
+    return 0;
+}
+
+void ax25_rx_reset(ax25_rx_t *rx)
+{
+    fsk_demod_reset(&rx->demod);
+    hdlc_decoder_reset(&rx->hdlc);
+    rx->clock = 0;
+    rx->last_metric = 0.0f;
+}
+
+static void ax25_rx_chip(ax25_rx_t *rx, float metric)
+{
+    rx->clock += 1 << 8;
+
+    if ((metric > 0.0f) != (rx->last_metric > 0.0f))
+    {
+        // The one-bit window is centred on a tone change when the metric
+        // crosses zero, so the bit ends half a window later.
+        float fraction = rx->last_metric / (rx->last_metric - metric);
+        int32_t crossing = rx->clock - (int32_t)((1.0f - fraction) * 256.0f);
+        int32_t error = crossing - rx->bit_len / 2;
+        rx->clock -= (int32_t)(error * AX25_RX_PLL_GAIN);
+        rx->transitions++;
+    }
+    rx->last_metric = metric;
+
+    if (rx->clock >= rx->bit_len)
+    {
+        rx->clock -= rx->bit_len;
+        rx->bits++;
+        hdlc_decoder_push(&rx->hdlc, metric > 0.0f);
+    }
+}
+
+int ax25_rx_process(ax25_rx_t *rx, const uint16_t *samples, size_t count)
+{
+    if (!rx || (!samples && count))
+        return -1;
+
+    while (count)
+    {
+        size_t num_chips = 0;
+        size_t used = fsk_demod_process(&rx->demod, samples, count, rx->chips, AX25_RX_CHIP_BATCH, &num_chips);
+        samples += used;
+        count -= used;
+
+        for (size_t i = 0; i < num_chips; i++)
+        {
+            ax25_rx_chip(rx, rx->chips[i].metric);
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,123 @@
+#include "modem/ax25_tx.h"
+
+#include <stdbool.h>
+
+#include "modem/fsk_mod.h"
+#include "modem/hdlc.h"
+
+size_t ax25_tx_max_samples(const modem_profile_t *profile, size_t len, uint16_t lead_flags, uint16_t tail_flags)
+{
+    // One stuffed bit per five data bits at most.
+    size_t data_bits = (len + HDLC_FCS_SIZE) * 8;
+    size_t line_bits = (size_t)(lead_flags + tail_flags) * 8 + data_bits + data_bits / 5;
+    return (size_t)(((uint64_t)line_bits * profile->sample_rate + profile->baud - 1) / profile->baud) + 1;
+}
+
+static bool ax25_tx_bits(fsk_mod_t *mod, uint16_t bits, uint8_t count, uint16_t *out, size_t max_samples, size_t *written)
+{
+    for (uint8_t i = 0; i < count; i++)
+    {
+        size_t n = fsk_mod_symbol(mod, (bits >> i) & 1, out + *written, max_samples - *written);
+        if (!n)
+            return false;
+        *written += n;
+    }
+
+    return true;
+}
+
+size_t ax25_tx_modulate(const modem_profile_t *profile, int16_t amplitude, const uint8_t *frame, size_t len,
+                        uint16_t lead_flags, uint16_t tail_flags, uint16_t *out, size_t max_samples)
+{
+    fsk_mod_t mod;
+    hdlc_encoder_t enc;
+    size_t written = 0;
+    uint8_t count;
+    uint16_t bits;
+    bool ok = true;
+
+    if (!profile || !frame || !out || len + HDLC_FCS_SIZE > HDLC_MAX_FRAME)
+        return 0;
+
+    if (profile->modulation != MODEM_MOD_FSK || profile->carriers != 1 || fsk_mod_init(&mod, profile, amplitude))
+        return 0;
+
+    hdlc_encoder_init(&enc);
+
+    uint16_t fcs = hdlc_fcs(frame, len);
+    uint8_t trailer[HDLC_FCS_SIZE] = {(uint8_t)fcs, (uint8_t)(fcs >> 8)};
+
+    for (uint16_t i = 0; i < lead_flags && ok; i++)
+    {
+        bits = hdlc_encoder_flag(&enc, &count);
+        ok = ax25_tx_bits(&mod, bits, count, out, max_samples, &written);
+    }
+
+    for (size_t i = 0; i < len + HDLC_FCS_SIZE && ok; i++)
+    {
+        bits = hdlc_encoder_byte(&enc, i < len ? frame[i] : trailer[i - len], &count);
+        ok = ax25_tx_bits(&mod, bits, count, out, max_samples, &written);
+    }
+
+    for (uint16_t i = 0; i < tail_flags && ok; i++)
+    {
+        bits = hdlc_encoder_flag(&enc, &count);
+        ok = ax25_tx_bits(&mod, bits, count, out, max_samples, &written);
+    }
+
+    return ok ? written : 0;
+}
+
+static bool ax25_tx_pack(uint16_t bits, uint8_t count, uint8_t *out, size_t max_bits, size_t *written)
+{
+    if (*written + count > max_bits)
+        return false;
+
+    for (uint8_t i = 0; i < count; i++, (*written)++)
+    {
+        if ((bits >> i) & 1)
+            out[*written >> 3] |= (uint8_t)(1u << (*written & 7));
+        else
+            out[*written >> 3] &= (uint8_t)~(1u << (*written & 7));
+    }
+
+    return true;
+}
+
+size_t ax25_tx_line_bits(const uint8_t *frame, size_t len, uint16_t lead_flags, uint16_t tail_flags, uint8_t *bits,
+                         size_t max_bits)
+{
+    hdlc_encoder_t enc;
+    size_t written = 0;
+    uint8_t count;
+    uint16_t line;
+    bool ok = true;
+
+    if (!frame || !bits || len + HDLC_FCS_SIZE > HDLC_MAX_FRAME)
+        return 0;
+
+    hdlc_encoder_init(&enc);
+
+    uint16_t fcs = hdlc_fcs(frame, len);
+    uint8_t trailer[HDLC_FCS_SIZE] = {(uint8_t)fcs, (uint8_t)(fcs >> 8)};
+
+    for (uint16_t i = 0; i < lead_flags && ok; i++)
+    {
+        line = hdlc_encoder_flag(&enc, &count);
+        ok = ax25_tx_pack(line, count, bits, max_bits, &written);
+    }
+
+    for (size_t i = 0; i < len + HDLC_FCS_SIZE && ok; i++)
+    {
+        line = hdlc_encoder_byte(&enc, i < len ? frame[i] : trailer[i - len], &count);
+        ok = ax25_tx_pack(line, count, bits, max_bits, &written);
+    }
+
+    for (uint16_t i = 0; i < tail_flags && ok; i++)
+    {
+        line = hdlc_encoder_flag(&enc, &count);
+        ok = ax25_tx_pack(line, count, bits, max_bits, &written);
+    }
+
+    return ok ? written : 0;
+}
@@ -0,0 +1,209 @@
+#include "modem/chase.h"
+
+#include <string.h>
+
+#define DEFAULT_SLOTS CHASE_MAX_SLOTS
+#define DEFAULT_MAX_COPIES 4
+#define DEFAULT_MAX_AGE_US 30000000 // repeats come within a few retry intervals
+#define DEFAULT_KEY_TOLERANCE 2
+
+void chase_default_config(chase_config_t *config)
+{
+    config->slots = DEFAULT_SLOTS;
+    config->max_copies = DEFAULT_MAX_COPIES;
+    config->max_age_us = DEFAULT_MAX_AGE_US;
+    config->key_tolerance = DEFAULT_KEY_TOLERANCE;
+}
+
+int chase_init(chase_t *chase, const chase_config_t *config)
+{
+    if (!chase || !config)
+        return -1;
+
+    if (!config->slots || config->slots > CHASE_MAX_SLOTS || config->max_copies < 2 ||
+        config->max_copies > CHASE_MAX_COPIES)
+        return -1;
+
+    memset(chase, 0, sizeof(*chase));
+    chase->config = *config;
+    return 0;
+}
+
+void chase_reset(chase_t *chase)
+{
+    for (uint8_t i = 0; i < chase->config.slots; i++)
+    {
+        chase->slots[i].used = false;
+    }
+}
+
+int8_t chase_quantize(float soft)
+{
+    float q = soft * CHASE_SOFT_SCALE;
+    if (q > 127.0f)
+        return 127;
+    if (q < -127.0f)
+        return -127;
+    return (int8_t)(q < 0.0f ? q - 0.5f : q + 0.5f);
+}
+
+// Slices bits MSB first, as the receiver packs the body.
+static void chase_slice_soft(const int8_t *soft, size_t bits, uint8_t *out)
+{
+    memset(out, 0, (bits + 7) / 8);
+    for (size_t p = 0; p < bits; p++)
+    {
+        if (soft[p] > 0)
+            out[p >> 3] |= (uint8_t)(0x80 >> (p & 7));
+    }
+}
+
+static void chase_slice_sum(const int16_t *sum, size_t bits, uint8_t *out)
+{
+    memset(out, 0, (bits + 7) / 8);
+    for (size_t p = 0; p < bits; p++)
+    {
+        if (sum[p] > 0)
+            out[p >> 3] |= (uint8_t)(0x80 >> (p & 7));
+    }
+}
+
+static void chase_expire(chase_t *chase, uint64_t now_us)
+{
+    for (uint8_t i = 0; i < chase->config.slots; i++)
+    {
+        chase_slot_t *slot = &chase->slots[i];
+        if (slot->used && now_us - slot->last_us > chase->config.max_age_us)
+        {
+            slot->used = false;
+            chase->stats.expired++;
+        }
+    }
+}
+
+static int chase_key_distance(const uint8_t *a, const uint8_t *b)
+{
+    int distance = 0;
+    for (size_t i = 0; i < MODEM_FRAME_HEADER_SIZE; i++)
+    {
+        for (uint8_t diff = a[i] ^ b[i]; diff; diff &= diff - 1)
+        {
+            distance++;
+        }
+    }
+
+    return distance;
+}
+
+// Same length and the closest header within tolerance; a weak copy may have a header bit wrong.
+static chase_slot_t *chase_find(chase_t *chase, const uint8_t *key, size_t bits, int tolerance)
+{
+    chase_slot_t *best = NULL;
+    int best_distance = tolerance + 1;
+
+    for (uint8_t i = 0; i < chase->config.slots; i++)
+    {
+        chase_slot_t *slot = &chase->slots[i];
+        if (!slot->used || slot->bits != bits)
+            continue;
+
+        int distance = chase_key_distance(slot->key, key);
+        if (distance < best_distance)
+        {
+            best = slot;
+            best_distance = distance;
+        }
+    }
+
+    return best;
+}
+
+static chase_slot_t *chase_open(chase_t *chase, const uint8_t *key, const int8_t *soft, size_t bits, uint64_t now_us)
+{
+    chase_slot_t *oldest = &chase->slots[0];
+
+    // Prefer a free slot, then the one touched least recently.
+    for (uint8_t i = 0; i < chase->config.slots; i++)
+    {
+        chase_slot_t *slot = &chase->slots[i];
+        if (!slot->used)
+        {
+            oldest = slot;
+            break;
+        }
+        if (slot->last_us < oldest->last_us)
+            oldest = slot;
+    }
+
+    if (oldest->used)
+        chase->stats.evicted++;
+
+    oldest->used = true;
+    oldest->copies = 1;
+    oldest->bits = (uint16_t)bits;
+    oldest->last_us = now_us;
+    memcpy(oldest->key, key, sizeof(oldest->key));
+    for (size_t p = 0; p < bits; p++)
+    {
+        oldest->sum[p] = soft[p];
+    }
+
+    chase->stats.stored++;
+    return oldest;
+}
+
+size_t chase_combine(chase_t *chase, const int8_t *soft, size_t bits, uint64_t now_us, uint8_t *body)
+{
+    if (!chase || !soft || !body || bits < CHASE_KEY_BITS || bits % 8)
+        return 0;
+
+    if (bits > CHASE_MAX_BITS)
+    {
+        chase->stats.too_long++;
+        return 0;
+    }
+
+    chase_expire(chase, now_us);
+
+    uint8_t key[MODEM_FRAME_HEADER_SIZE];
+    chase_slice_soft(soft, CHASE_KEY_BITS, key);
+
+    chase_slot_t *slot = chase_find(chase, key, bits, chase->config.key_tolerance);
+    if (!slot || slot->copies >= chase->config.max_copies)
+    {
+        // Nothing to add to yet, or a slot that never came good; start over from this copy.
+        if (slot)
+            slot->used = false;
+        chase_open(chase, key, soft, bits, now_us);
+        return 0;
+    }
+
+    for (size_t p = 0; p < bits; p++)
+    {
+        slot->sum[p] += soft[p];
+    }
+    slot->copies++;
+    slot->last_us = now_us;
+    chase->stats.combined++;
+
+    modem_frame_t frame;
+    chase_slice_sum(slot->sum, bits, body);
+    memcpy(slot->key, body, sizeof(slot->key));
+    if (modem_frame_parse(body, bits / 8, &frame))
+        return 0;
+
+    slot->used = false;
+    chase->stats.recovered++;
+    return bits / 8;
+}
+
+void chase_forget(chase_t *chase, const uint8_t *body)
+{
+    if (!chase || !body)
+        return;
+
+    size_t bits = modem_frame_body_size(body[0]) * 8;
+    chase_slot_t *slot = chase_find(chase, body, bits, 0);
+    if (slot)
+        slot->used = false;
+}
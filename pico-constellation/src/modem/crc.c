@@ -0,0 +1,110 @@
+#include "modem/crc.h"
+
+#include <stdbool.h>
+
+#define CCITT_POLY 0x1021
+#define CCITT_POLY_REFLECTED 0x8408
+
+static uint16_t ccitt_table[256];
+static uint16_t x25_table[256];
+static bool tables_ready = false;
+
+static crc_engine_t engine = NULL;
+static size_t engine_min_len = 0;
+
+static void crc_build_tables(void)
+{
+    for (int i = 0; i < 256; i++)
+    {
+        uint16_t msb = (uint16_t)(i << 8);
+        uint16_t lsb = (uint16_t)i;
+        for (int b = 0; b < 8; b++)
+        {
+            msb = (msb & 0x8000) ? (uint16_t)((msb << 1) ^ CCITT_POLY) : (uint16_t)(msb << 1);
+            lsb = (lsb & 1) ? (uint16_t)((lsb >> 1) ^ CCITT_POLY_REFLECTED) : (uint16_t)(lsb >> 1);
+        }
+        ccitt_table[i] = msb;
+        x25_table[i] = lsb;
+    }
+
+    tables_ready = true;
+}
+
+uint16_t crc16_ccitt_update(uint16_t crc, const uint8_t *data, size_t len)
+{
+    if (!tables_ready)
+        crc_build_tables();
+
+    for (size_t i = 0; i < len; i++)
+    {
+        crc = (uint16_t)((crc << 8) ^ ccitt_table[(crc >> 8) ^ data[i]]);
+    }
+
+    return crc;
+}
+
+uint16_t crc16_x25_update(uint16_t crc, const uint8_t *data, size_t len)
+{
+    if (!tables_ready)
+        crc_build_tables();
+
+    for (size_t i = 0; i < len; i++)
+    {
+        crc = (uint16_t)((crc >> 8) ^ x25_table[(crc ^ data[i]) & 0xFF]);
+    }
+
+    return crc;
+}
+
+uint16_t crc_software(crc_type_t type, const uint8_t *data, size_t len)
+{
+    if (type == CRC_16_X25)
+        return (uint16_t)~crc16_x25_update(0xFFFF, data, len);
+
+    return crc16_ccitt_update(0xFFFF, data, len);
+}
+
+void crc_set_engine(crc_engine_t new_engine, size_t min_len)
+{
+    engine = new_engine;
+    engine_min_len = min_len;
+}
+
+uint16_t crc_compute(crc_type_t type, const uint8_t *data, size_t len)
+{
+    uint16_t crc;
+
+    if (engine && len >= engine_min_len && !engine(type, data, len, &crc))
+        return crc;
+
+    return crc_software(type, data, len);
+}
+
+static uint16_t reflect16(uint16_t value)
+{
+    value = (uint16_t)(((value & 0x5555) << 1) | ((value >> 1) & 0x5555));
+    value = (uint16_t)(((value & 0x3333) << 2) | ((value >> 2) & 0x3333));
+    value = (uint16_t)(((value & 0x0F0F) << 4) | ((value >> 4) & 0x0F0F));
+    return (uint16_t)((value << 8) | (value >> 8));
+}
+
+uint32_t crc_sniffer_seed(crc_type_t type)
+{
+    // 0xFFFF reflects to itself, so both types start the same.
+    (void)type;
+    return 0xFFFF;
+}
+
+int crc_sniffer_reflected(crc_type_t type)
+{
+    return type == CRC_16_X25;
+}
+
+uint16_t crc_from_sniffer(crc_type_t type, uint32_t accumulator)
+{
+    // An MSB-first CRC over bit-reversed bytes is the reflected CRC, reflected.
+    if (type == CRC_16_X25)
+        return (uint16_t)~reflect16((uint16_t)accumulator);
+
+    return (uint16_t)accumulator;
+}
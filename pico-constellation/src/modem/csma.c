@@ -0,0 +1,69 @@
+#include "modem/csma.h"
+
+#include <string.h>
+
+void csma_default_config(csma_config_t *config)
+{
+    config->txdelay_us = CSMA_DEFAULT_TXDELAY_US;
+    config->slot_us = CSMA_DEFAULT_SLOT_US;
+    config->persist = CSMA_DEFAULT_PERSIST;
+}
+
+int csma_init(csma_t *csma, const csma_config_t *config)
+{
+    if (!csma || !config || !config->slot_us)
+        return -1;
+
+    memset(csma, 0, sizeof(*csma));
+    csma->config = *config;
+    csma->state = CSMA_IDLE;
+    return 0;
+}
+
+void csma_request(csma_t *csma, uint64_t now_us)
+{
+    if (csma->state != CSMA_IDLE)
+        return;
+
+    csma->state = CSMA_DEFER;
+    csma->next_us = now_us;
+}
+
+csma_state_t csma_update(csma_t *csma, uint64_t now_us, bool busy, uint8_t random)
+{
+    if (now_us < csma->next_us)
+        return csma->state;
+
+    if (csma->state == CSMA_DEFER)
+    {
+        if (busy)
+        {
+            csma->stats.busy_slots++;
+            csma->next_us = now_us + csma->config.slot_us;
+        }
+        else if (random <= csma->config.persist)
+        {
+            csma->stats.keyups++;
+            csma->state = CSMA_KEYUP;
+            csma->next_us = now_us + csma->config.txdelay_us;
+        }
+        else
+        {
+            csma->stats.lost_draws++;
+            csma->next_us = now_us + csma->config.slot_us;
+        }
+    }
+    else if (csma->state == CSMA_KEYUP)
+    {
+        csma->state = CSMA_TRANSMIT;
+    }
+
+    return csma->state;
+}
+
+void csma_done(csma_t *csma, uint64_t now_us, bool more)
+{
+    csma->state = more ? CSMA_DEFER : CSMA_IDLE;
+    // The next frame waits a slot so others get a chance at the channel.
+    csma->next_us = now_us + csma->config.slot_us;
+}
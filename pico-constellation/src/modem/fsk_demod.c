@@ -0,0 +1,131 @@
+#include "modem/fsk_demod.h"
+
+#include <math.h>
+#include <string.h>
+
+#define DC_SHIFT 10      // DC tracker time constant, 2^DC_SHIFT samples
+#define MIX_SHIFT 12     // keeps a full symbol of products inside int32
+#define ENERGY_FLOOR 1.0f
+
+int fsk_demod_config_from_profile(fsk_demod_config_t *config, const modem_profile_t *profile, uint8_t carrier)
+{
+    if (!config || !profile || carrier >= profile->carriers)
+        return -1;
+
+    config->sample_rate = profile->sample_rate;
+    config->baud = profile->baud;
+    config->oversample = profile->oversample;
+    config->tone_hz[0] = profile->tone_hz[carrier][0];
+    config->tone_hz[1] = profile->tone_hz[carrier][1];
+    return 0;
+}
+
+int fsk_demod_init(fsk_demod_t *demod, const fsk_demod_config_t *config)
+{
+    if (!demod || !config)
+        return -1;
+
+    if (!config->baud || !config->oversample || config->oversample > MODEM_MAX_OVERSAMPLE)
+        return -1;
+
+    memset(demod, 0, sizeof(*demod));
+
+    for (int k = 0; k < 2; k++)
+    {
+        nco_init(&demod->nco[k], config->tone_hz[k], config->sample_rate);
+    }
+
+    demod->oversample = config->oversample;
+    demod->chip_len = (uint32_t)(((uint64_t)config->sample_rate << 16) /
+                                 ((uint32_t)config->baud * config->oversample));
+
+    // A tone of amplitude A sums to A * N / 2 * 32767 / 2^MIX_SHIFT over N samples.
+    float samples_per_symbol = (float)config->sample_rate / config->baud;
+    demod->level_scale = 2.0f * (1 << MIX_SHIFT) / (32767.0f * samples_per_symbol);
+
+    demod->dc = MODEM_ADC_MIDPOINT << DC_SHIFT;
+    return 0;
+}
+
+void fsk_demod_reset(fsk_demod_t *demod)
+{
+    memset(demod->acc_i, 0, sizeof(demod->acc_i));
+    memset(demod->acc_q, 0, sizeof(demod->acc_q));
+    memset(demod->ring_i, 0, sizeof(demod->ring_i));
+    memset(demod->ring_q, 0, sizeof(demod->ring_q));
+    memset(demod->sum_i, 0, sizeof(demod->sum_i));
+    memset(demod->sum_q, 0, sizeof(demod->sum_q));
+    demod->ring_pos = 0;
+    demod->chip_pos = 0;
+}
+
+void fsk_demod_skip(fsk_demod_t *demod, size_t count, float dc)
+{
+    fsk_demod_reset(demod);
+
+    for (int k = 0; k < 2; k++)
+    {
+        demod->nco[k].phase += demod->nco[k].step * (uint32_t)count;
+    }
+
+    demod->dc = (int32_t)(dc * (1 << DC_SHIFT));
+}
+
+static void fsk_demod_emit(fsk_demod_t *demod, fsk_chip_t *chip)
+{
+    float energy[2];
+    uint8_t pos = demod->ring_pos;
+
+    for (int k = 0; k < 2; k++)
+    {
+        demod->sum_i[k] += demod->acc_i[k] - demod->ring_i[k][pos];
+        demod->sum_q[k] += demod->acc_q[k] - demod->ring_q[k][pos];
+        demod->ring_i[k][pos] = demod->acc_i[k];
+        demod->ring_q[k][pos] = demod->acc_q[k];
+        demod->acc_i[k] = 0;
+        demod->acc_q[k] = 0;
+
+        float i = (float)demod->sum_i[k];
+        float q = (float)demod->sum_q[k];
+        energy[k] = i * i + q * q;
+        chip->level[k] = sqrtf(energy[k]) * demod->level_scale;
+    }
+
+    chip->metric = (energy[1] - energy[0]) / (energy[1] + energy[0] + ENERGY_FLOOR);
+
+    demod->ring_pos = (pos + 1 == demod->oversample) ? 0 : pos + 1;
+    demod->chip_count++;
+}
+
+size_t fsk_demod_process(fsk_demod_t *demod, const uint16_t *samples, size_t count,
+                         fsk_chip_t *chips, size_t max_chips, size_t *num_chips)
+{
+    size_t produced = 0;
+    size_t i = 0;
+
+    while (i < count && produced < max_chips)
+    {
+        int32_t x = ((int32_t)samples[i++] << DC_SHIFT) - demod->dc;
+        demod->dc += x >> DC_SHIFT;
+        x >>= DC_SHIFT;
+
+        for (int k = 0; k < 2; k++)
+        {
+            nco_t *nco = &demod->nco[k];
+            demod->acc_i[k] += (x * nco_cos(nco)) >> MIX_SHIFT;
+            demod->acc_q[k] += (x * nco_sin(nco)) >> MIX_SHIFT;
+            nco_advance(nco);
+        }
+
+        demod->chip_pos += 1u << 16;
+        if (demod->chip_pos >= demod->chip_len)
+        {
+            demod->chip_pos -= demod->chip_len;
+            fsk_demod_emit(demod, &chips[produced++]);
+        }
+    }
+
+    if (num_chips)
+        *num_chips = produced;
+    return i;
+}
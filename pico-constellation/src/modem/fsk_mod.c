@@ -0,0 +1,189 @@
+#include "modem/fsk_mod.h"
+#include "modem/mfsk.h"
+
+#include <stdbool.h>
+#include <string.h>
+
+// PSK phase change per symbol value, in quarter turns (see modem_profile.h).
+static const uint8_t psk_quarter_turns[2][4] = {
+    {2, 0},       // BPSK: 0 -> 180, 1 -> 0 degrees
+    {2, 1, 3, 0}, // QPSK: 00 -> 180, 01 -> 90, 10 -> 270, 11 -> 0 degrees
+};
+
+static bool is_psk(modem_modulation_t modulation)
+{
+    return modulation == MODEM_MOD_BPSK || modulation == MODEM_MOD_QPSK;
+}
+
+int fsk_mod_init(fsk_mod_t *mod, const modem_profile_t *profile, int16_t amplitude)
+{
+    if (!mod || !profile || !profile->baud)
+        return -1;
+
+    if (!profile->carriers || profile->carriers > MODEM_MAX_CARRIERS)
+        return -1;
+
+    memset(mod, 0, sizeof(*mod));
+    mod->modulation = profile->modulation;
+    mod->carriers = profile->carriers;
+    mod->tones = profile->tones;
+    mod->bits_per_symbol = modem_profile_bits_per_symbol(profile);
+    mod->shared_one = modem_profile_shared_symbol(profile, 1);
+
+    if (is_psk(mod->modulation))
+    {
+        if (mod->carriers != 1)
+            return -1;
+
+        nco_init(&mod->nco[0], profile->carrier_hz, profile->sample_rate);
+    }
+    else if (mod->modulation == MODEM_MOD_MFSK)
+    {
+        if (mod->carriers != 1 || mod->tones < 2 || mod->tones > MODEM_MAX_TONES)
+            return -1;
+
+        nco_init(&mod->nco[0], profile->mfsk_hz[0], profile->sample_rate);
+        for (int i = 0; i < mod->tones; i++)
+        {
+            mod->mfsk_step[i] = nco_step(profile->mfsk_hz[i], profile->sample_rate);
+        }
+    }
+    else
+    {
+        for (int k = 0; k < mod->carriers; k++)
+        {
+            nco_init(&mod->nco[k], profile->tone_hz[k][0], profile->sample_rate);
+            mod->tone_step[k][0] = nco_step(profile->tone_hz[k][0], profile->sample_rate);
+            mod->tone_step[k][1] = nco_step(profile->tone_hz[k][1], profile->sample_rate);
+        }
+    }
+
+    mod->symbol_len = (uint32_t)(((uint64_t)profile->sample_rate << 16) / profile->baud);
+    mod->amplitude = amplitude / mod->carriers;
+    return 0;
+}
+
+size_t fsk_mod_symbol_samples(const fsk_mod_t *mod)
+{
+    return (mod->symbol_pos + mod->symbol_len) >> 16;
+}
+
+size_t fsk_mod_begin_symbol(fsk_mod_t *mod, unsigned symbol)
+{
+    size_t n = fsk_mod_symbol_samples(mod);
+
+    if (is_psk(mod->modulation))
+    {
+        mod->nco[0].phase += (uint32_t)psk_quarter_turns[mod->bits_per_symbol - 1][symbol & 3] << 30;
+    }
+    else if (mod->modulation == MODEM_MOD_MFSK)
+    {
+        nco_set_step(&mod->nco[0], mod->mfsk_step[mfsk_tone_for_bits(symbol) & (mod->tones - 1)]);
+    }
+    else
+    {
+        for (int k = 0; k < mod->carriers; k++)
+        {
+            nco_set_step(&mod->nco[k], mod->tone_step[k][(symbol >> k) & 1]);
+        }
+    }
+
+    mod->symbol_pos = (mod->symbol_pos + mod->symbol_len) & 0xFFFF;
+    return n;
+}
+
+void fsk_mod_render(fsk_mod_t *mod, uint16_t *out, size_t count)
+{
+    for (size_t i = 0; i < count; i++)
+    {
+        int32_t sum = 0;
+        for (int k = 0; k < mod->carriers; k++)
+        {
+            sum += nco_sin(&mod->nco[k]);
+            nco_advance(&mod->nco[k]);
+        }
+        out[i] = (uint16_t)(MODEM_ADC_MIDPOINT + ((mod->amplitude * sum) >> 15));
+    }
+}
+
+size_t fsk_mod_symbol(fsk_mod_t *mod, unsigned symbol, uint16_t *out, size_t max_samples)
+{
+    if (fsk_mod_symbol_samples(mod) > max_samples)
+        return 0;
+
+    size_t n = fsk_mod_begin_symbol(mod, symbol);
+    fsk_mod_render(mod, out, n);
+    return n;
+}
+
+static unsigned get_bit(const uint8_t *bits, size_t pos)
+{
+    return (bits[pos >> 3] >> (7 - (pos & 7))) & 1;
+}
+
+unsigned fsk_mod_next_symbol(const fsk_mod_t *mod, const uint8_t *bits, size_t num_bits, size_t shared_bits,
+                             size_t *pos)
+{
+    unsigned symbol = 0;
+    size_t next = *pos;
+
+    if (next < shared_bits)
+    {
+        symbol = get_bit(bits, next++) ? mod->shared_one : 0;
+    }
+    else if (mod->modulation != MODEM_MOD_FSK)
+    {
+        // MSB first, padded with zeros past the end.
+        for (int b = 0; b < mod->bits_per_symbol; b++)
+        {
+            symbol = (symbol << 1) | (next < num_bits ? get_bit(bits, next++) : 0);
+        }
+    }
+    else
+    {
+        for (int k = 0; k < mod->carriers && next < num_bits; k++)
+        {
+            symbol |= get_bit(bits, next++) << k;
+        }
+    }
+
+    *pos = next;
+    return symbol;
+}
+
+unsigned fsk_mod_symbol_width(const fsk_mod_t *mod)
+{
+    return mod->modulation == MODEM_MOD_FSK ? mod->carriers : mod->bits_per_symbol;
+}
+
+size_t fsk_mod_frame_part(fsk_mod_t *mod, const uint8_t *bits, size_t num_bits, size_t shared_bits, size_t *pos,
+                          uint16_t *out, size_t max_samples)
+{
+    size_t written = 0;
+
+    while (*pos < num_bits)
+    {
+        size_t next = *pos;
+        unsigned symbol = fsk_mod_next_symbol(mod, bits, num_bits, shared_bits, &next);
+
+        size_t n = fsk_mod_symbol(mod, symbol, out + written, max_samples - written);
+        if (!n)
+            break;
+        written += n;
+        *pos = next;
+    }
+
+    return written;
+}
+
+size_t fsk_mod_frame(fsk_mod_t *mod, const uint8_t *bits, size_t num_bits, size_t shared_bits,
+                     uint16_t *out, size_t max_samples)
+{
+    size_t pos = 0;
+    return fsk_mod_frame_part(mod, bits, num_bits, shared_bits, &pos, out, max_samples);
+}
+
+size_t fsk_mod_bits(fsk_mod_t *mod, const uint8_t *bits, size_t num_bits, uint16_t *out, size_t max_samples)
+{
+    return fsk_mod_frame(mod, bits, num_bits, 0, out, max_samples);
+}
@@ -0,0 +1,307 @@
+#include "modem/hdlc.h"
+
+#include <string.h>
+#include "modem/crc.h"
+
+typedef struct stuff_entry
+{
+    uint16_t bits;  // data bits with stuffed 0s, LSB first
+    uint8_t count;  // 8 to 10
+    uint8_t ones;   // run of 1s left over for the next byte
+} stuff_entry_t;
+
+static stuff_entry_t stuff_table[5][256]; // by run of 1s carried in (0..4) and byte
+static uint8_t nrzi_table[256];           // line levels for 8 bits starting from level 0
+static bool tables_ready = false;
+
+static void hdlc_build_tables(void)
+{
+    for (int i = 0; i < 256; i++)
+    {
+        uint8_t level = 0;
+        uint8_t out = 0;
+        for (int b = 0; b < 8; b++)
+        {
+            if (!((i >> b) & 1))
+                level ^= 1;
+            out |= (uint8_t)(level << b);
+        }
+        nrzi_table[i] = out;
+    }
+
+    for (int run = 0; run < 5; run++)
+    {
+        for (int i = 0; i < 256; i++)
+        {
+            stuff_entry_t *entry = &stuff_table[run][i];
+            uint8_t ones = (uint8_t)run;
+            uint16_t bits = 0;
+            uint8_t count = 0;
+
+            for (int b = 0; b < 8; b++)
+            {
+                unsigned bit = (i >> b) & 1;
+                bits |= (uint16_t)(bit << count++);
+                ones = bit ? ones + 1 : 0;
+                if (ones == 5)
+                {
+                    count++; // stuffed 0
+                    ones = 0;
+                }
+            }
+
+            entry->bits = bits;
+            entry->count = count;
+            entry->ones = ones;
+        }
+    }
+
+    tables_ready = true;
+}
+
+uint16_t hdlc_fcs_update(uint16_t crc, const uint8_t *data, size_t len)
+{
+    return crc16_x25_update(crc, data, len);
+}
+
+uint16_t hdlc_fcs(const uint8_t *data, size_t len)
+{
+    return crc_compute(CRC_16_X25, data, len);
+}
+
+void hdlc_encoder_init(hdlc_encoder_t *enc)
+{
+    if (!tables_ready)
+        hdlc_build_tables();
+
+    enc->ones = 0;
+    enc->level = 0;
+}
+
+// NRZI-encodes count (<= 16) data bits, LSB first, from the current level.
+static uint16_t hdlc_nrzi(hdlc_encoder_t *enc, uint16_t bits, uint8_t count)
+{
+    uint16_t out = 0;
+
+    for (uint8_t done = 0; done < count; done += 8)
+    {
+        uint8_t chunk = nrzi_table[(bits >> done) & 0xFF];
+        if (enc->level)
+            chunk = (uint8_t)~chunk;
+
+        uint8_t n = count - done < 8 ? count - done : 8;
+        out |= (uint16_t)(chunk & ((1u << n) - 1)) << done;
+        enc->level = (chunk >> (n - 1)) & 1;
+    }
+
+    return out;
+}
+
+uint16_t hdlc_encoder_flag(hdlc_encoder_t *enc, uint8_t *num_bits)
+{
+    enc->ones = 0;
+    *num_bits = 8;
+    return hdlc_nrzi(enc, HDLC_FLAG, 8);
+}
+
+uint16_t hdlc_encoder_byte(hdlc_encoder_t *enc, uint8_t byte, uint8_t *num_bits)
+{
+    const stuff_entry_t *entry = &stuff_table[enc->ones][byte];
+    enc->ones = entry->ones;
+    *num_bits = entry->count;
+    return hdlc_nrzi(enc, entry->bits, entry->count);
+}
+
+typedef struct line_writer
+{
+    uint8_t *line;
+    size_t max_bits;
+    size_t bits;
+} line_writer_t;
+
+static bool line_put(line_writer_t *writer, uint16_t bits, uint8_t count)
+{
+    if (writer->bits + count > writer->max_bits)
+        return false;
+
+    for (uint8_t i = 0; i < count; i++)
+    {
+        size_t p = writer->bits++;
+        if ((bits >> i) & 1)
+            writer->line[p >> 3] |= (uint8_t)(1u << (p & 7));
+        else
+            writer->line[p >> 3] &= (uint8_t)~(1u << (p & 7));
+    }
+
+    return true;
+}
+
+size_t hdlc_encode(const uint8_t *frame, size_t len, uint16_t lead_flags, uint16_t tail_flags,
+                   uint8_t *line, size_t max_bytes)
+{
+    if (!frame || !line || len + HDLC_FCS_SIZE > HDLC_MAX_FRAME)
+        return 0;
+
+    hdlc_encoder_t enc;
+    line_writer_t writer = {line, max_bytes * 8, 0};
+    uint8_t count;
+    uint16_t bits;
+    bool ok = true;
+
+    hdlc_encoder_init(&enc);
+
+    uint16_t fcs = hdlc_fcs(frame, len);
+    uint8_t trailer[HDLC_FCS_SIZE] = {(uint8_t)fcs, (uint8_t)(fcs >> 8)};
+
+    for (uint16_t i = 0; i < lead_flags && ok; i++)
+    {
+        bits = hdlc_encoder_flag(&enc, &count);
+        ok = line_put(&writer, bits, count);
+    }
+
+    for (size_t i = 0; i < len + HDLC_FCS_SIZE && ok; i++)
+    {
+        bits = hdlc_encoder_byte(&enc, i < len ? frame[i] : trailer[i - len], &count);
+        ok = line_put(&writer, bits, count);
+    }
+
+    for (uint16_t i = 0; i < tail_flags && ok; i++)
+    {
+        bits = hdlc_encoder_flag(&enc, &count);
+        ok = line_put(&writer, bits, count);
+    }
+
+    return ok ? writer.bits : 0;
+}
+
+/*
+ * Receive transitions. The state is the run of 1s: 0-4 plain data, 5 means
+ * the next 0 is stuffed, 6 means the next 0 closes a flag, 7 is an abort
+ * (seven or more 1s) that lasts until the next 0.
+ */
+typedef enum
+{
+    RX_NONE = 0,
+    RX_DATA0,
+    RX_DATA1,
+    RX_FLAG,
+    RX_ABORT,
+} rx_action_t;
+
+typedef struct rx_entry
+{
+    uint8_t next;
+    uint8_t action;
+} rx_entry_t;
+
+static const rx_entry_t rx_table[8][2] = {
+    //  bit 0               bit 1
+    {{0, RX_DATA0}, {1, RX_DATA1}},
+    {{0, RX_DATA0}, {2, RX_DATA1}},
+    {{0, RX_DATA0}, {3, RX_DATA1}},
+    {{0, RX_DATA0}, {4, RX_DATA1}},
+    {{0, RX_DATA0}, {5, RX_DATA1}},
+    {{0, RX_NONE}, {6, RX_NONE}},   // stuffed 0 dropped
+    {{0, RX_FLAG}, {7, RX_ABORT}},
+    {{0, RX_NONE}, {7, RX_NONE}},
+};
+
+// The flag's leading 0 and five 1s went in as data before it was recognised.
+#define FLAG_DATA_BITS 6
+
+void hdlc_decoder_init(hdlc_decoder_t *dec, hdlc_frame_callback_t callback, void *ctx)
+{
+    if (!tables_ready)
+        hdlc_build_tables();
+
+    memset(dec, 0, sizeof(*dec));
+    dec->callback = callback;
+    dec->callback_ctx = ctx;
+}
+
+void hdlc_decoder_reset(hdlc_decoder_t *dec)
+{
+    dec->state = 0;
+    dec->in_frame = false;
+    dec->bits = 0;
+}
+
+static void hdlc_decoder_flag(hdlc_decoder_t *dec)
+{
+    if (dec->in_frame && dec->bits > FLAG_DATA_BITS)
+    {
+        size_t bits = dec->bits - FLAG_DATA_BITS;
+        size_t len = bits / 8;
+
+        if ((bits & 7) || len < HDLC_MIN_FRAME || len > HDLC_MAX_FRAME)
+        {
+            dec->stats.frames_bad_length++;
+        }
+        else if (hdlc_fcs(dec->frame, len) != (uint16_t)~HDLC_FCS_GOOD)
+        {
+            dec->stats.frames_bad_fcs++;
+        }
+        else
+        {
+            dec->stats.frames_ok++;
+            if (dec->callback)
+                dec->callback(dec->callback_ctx, dec->frame, len - HDLC_FCS_SIZE);
+        }
+    }
+
+    dec->in_frame = true;
+    dec->bits = 0;
+}
+
+static void hdlc_decoder_data(hdlc_decoder_t *dec, unsigned bit)
+{
+    uint16_t p = dec->bits;
+
+    if (p >= sizeof(dec->frame) * 8)
+    {
+        dec->stats.frames_bad_length++;
+        dec->in_frame = false;
+        return;
+    }
+
+    if (!(p & 7))
+        dec->frame[p >> 3] = 0;
+    dec->frame[p >> 3] |= (uint8_t)(bit << (p & 7));
+    dec->bits = p + 1;
+}
+
+void hdlc_decoder_push(hdlc_decoder_t *dec, unsigned level)
+{
+    unsigned bit = (level & 1) == dec->level;
+    dec->level = level & 1;
+
+    const rx_entry_t *entry = &rx_table[dec->state][bit];
+    dec->state = entry->next;
+
+    switch (entry->action)
+    {
+    case RX_DATA0:
+    case RX_DATA1:
+        if (dec->in_frame)
+            hdlc_decoder_data(dec, entry->action == RX_DATA1);
+        break;
+    case RX_FLAG:
+        hdlc_decoder_flag(dec);
+        break;
+    case RX_ABORT:
+        if (dec->in_frame && dec->bits > FLAG_DATA_BITS)
+            dec->stats.aborts++;
+        dec->in_frame = false;
+        break;
+    default:
+        break;
+    }
+}
+
+void hdlc_decoder_push_bits(hdlc_decoder_t *dec, const uint8_t *line, size_t num_bits)
+{
+    for (size_t i = 0; i < num_bits; i++)
+    {
+        hdlc_decoder_push(dec, (line[i >> 3] >> (i & 7)) & 1);
+    }
+}
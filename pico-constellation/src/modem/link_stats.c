@@ -0,0 +1,81 @@
+#include "modem/link_stats.h"
+
+#include <string.h>
+
+void link_stats_init(link_stats_t *stats)
+{
+    memset(stats, 0, sizeof(*stats));
+}
+
+const link_peer_t *link_stats_find(const link_stats_t *stats, uint8_t addr)
+{
+    for (int i = 0; i < LINK_STATS_MAX_PEERS; i++)
+    {
+        if (stats->peers[i].used && stats->peers[i].addr == addr)
+            return &stats->peers[i];
+    }
+
+    return NULL;
+}
+
+static link_peer_t *link_stats_slot(link_stats_t *stats, uint8_t addr, uint64_t now_us)
+{
+    link_peer_t *oldest = &stats->peers[0];
+
+    for (int i = 0; i < LINK_STATS_MAX_PEERS; i++)
+    {
+        link_peer_t *peer = &stats->peers[i];
+        if (peer->used && peer->addr == addr)
+            return peer;
+
+        // Prefer a free slot, then the peer heard from least recently.
+        if (!peer->used)
+        {
+            if (oldest->used)
+                oldest = peer;
+        }
+        else if (oldest->used && peer->last_seen_us < oldest->last_seen_us)
+        {
+            oldest = peer;
+        }
+    }
+
+    memset(oldest, 0, sizeof(*oldest));
+    oldest->used = true;
+    oldest->addr = addr;
+    oldest->first_seen_us = now_us;
+    return oldest;
+}
+
+static float link_stats_average(float average, float value, uint32_t count)
+{
+    // Plain mean until the window fills, then exponential.
+    uint32_t n = count < LINK_STATS_AVERAGE_FRAMES ? count : LINK_STATS_AVERAGE_FRAMES;
+    return average + (value - average) / n;
+}
+
+link_peer_t *link_stats_update(link_stats_t *stats, uint8_t addr, const modem_rx_frame_info_t *info, uint64_t now_us)
+{
+    if (!stats)
+        return NULL;
+
+    link_peer_t *peer = link_stats_slot(stats, addr, now_us);
+    peer->frames++;
+    peer->last_seen_us = now_us;
+
+    if (!info)
+        return peer;
+
+    uint32_t n = ++peer->frames_with_info;
+    peer->snr_db = link_stats_average(peer->snr_db, info->snr_db, n);
+    peer->mark_level = link_stats_average(peer->mark_level, info->mark_level, n);
+    peer->space_level = link_stats_average(peer->space_level, info->space_level, n);
+    peer->offset_hz = link_stats_average(peer->offset_hz, info->offset_hz, n);
+    peer->latency_us = link_stats_average(peer->latency_us, (float)info->latency_us, n);
+    peer->corrected_bits += info->corrected_bits;
+
+    if (n == 1 || info->snr_db < peer->snr_min_db)
+        peer->snr_min_db = info->snr_db;
+
+    return peer;
+}
@@ -0,0 +1,42 @@
+#include "modem/mfsk.h"
+
+#define ENERGY_FLOOR 1.0f
+
+unsigned mfsk_soft_bits(const float *energy, uint8_t tones, float total, float *soft)
+{
+    uint8_t bits = 0;
+    unsigned best = 0;
+
+    while ((1u << bits) < tones)
+        bits++;
+
+    for (unsigned i = 1; i < tones; i++)
+    {
+        if (energy[i] > energy[best])
+            best = i;
+    }
+
+    for (uint8_t b = 0; b < bits; b++)
+    {
+        unsigned mask = 1u << (bits - 1 - b);
+        float max1 = 0.0f;
+        float max0 = 0.0f;
+
+        for (unsigned i = 0; i < tones; i++)
+        {
+            if (mfsk_gray(i) & mask)
+            {
+                if (energy[i] > max1)
+                    max1 = energy[i];
+            }
+            else if (energy[i] > max0)
+            {
+                max0 = energy[i];
+            }
+        }
+
+        soft[b] = (max1 - max0) / (total + ENERGY_FLOOR);
+    }
+
+    return mfsk_gray(best);
+}
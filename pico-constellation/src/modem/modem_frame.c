@@ -0,0 +1,82 @@
+#include "modem/modem_frame.h"
+
+#include <string.h>
+#include "modem/crc.h"
+
+uint16_t modem_frame_crc16(const uint8_t *data, size_t len)
+{
+    return crc_compute(CRC_16_CCITT_FALSE, data, len);
+}
+
+size_t modem_frame_body_size(uint8_t length)
+{
+    return MODEM_FRAME_HEADER_SIZE + length + MODEM_FRAME_CRC_SIZE;
+}
+
+static void put_bits(uint8_t *bits, size_t *pos, uint32_t value, int count)
+{
+    for (int i = count - 1; i >= 0; i--)
+    {
+        size_t p = (*pos)++;
+        if ((value >> i) & 1)
+            bits[p >> 3] |= (uint8_t)(0x80 >> (p & 7));
+        else
+            bits[p >> 3] &= (uint8_t)~(0x80 >> (p & 7));
+    }
+}
+
+int modem_frame_build(uint8_t dst, uint8_t src, const uint8_t *payload, size_t len,
+                      uint8_t *bits, size_t max_bytes, size_t *num_bits)
+{
+    if (!bits || !num_bits || (len && !payload) || len > MODEM_FRAME_MAX_PAYLOAD)
+        return -1;
+
+    size_t total = MODEM_FRAME_PREAMBLE_BITS + MODEM_FRAME_SYNC_BITS + modem_frame_body_size((uint8_t)len) * 8;
+    if ((total + 7) / 8 > max_bytes)
+        return -1;
+
+    uint8_t body[MODEM_FRAME_MAX_BODY];
+    body[0] = (uint8_t)len;
+    body[1] = dst;
+    body[2] = src;
+    memcpy(&body[MODEM_FRAME_HEADER_SIZE], payload, len);
+
+    uint16_t crc = modem_frame_crc16(body, MODEM_FRAME_HEADER_SIZE + len);
+    body[MODEM_FRAME_HEADER_SIZE + len] = (uint8_t)(crc >> 8);
+    body[MODEM_FRAME_HEADER_SIZE + len + 1] = (uint8_t)crc;
+
+    size_t pos = 0;
+    for (int i = 0; i < MODEM_FRAME_PREAMBLE_BITS; i++)
+    {
+        put_bits(bits, &pos, (i & 1) ? 0 : 1, 1);
+    }
+    put_bits(bits, &pos, MODEM_FRAME_SYNC_WORD, MODEM_FRAME_SYNC_BITS);
+    for (size_t i = 0; i < modem_frame_body_size((uint8_t)len); i++)
+    {
+        put_bits(bits, &pos, body[i], 8);
+    }
+
+    *num_bits = pos;
+    return 0;
+}
+
+int modem_frame_parse(const uint8_t *body, size_t body_len, modem_frame_t *frame)
+{
+    if (!body || !frame || body_len < MODEM_FRAME_HEADER_SIZE + MODEM_FRAME_CRC_SIZE)
+        return -1;
+
+    uint8_t length = body[0];
+    if (length > MODEM_FRAME_MAX_PAYLOAD || modem_frame_body_size(length) != body_len)
+        return -1;
+
+    uint16_t crc = modem_frame_crc16(body, MODEM_FRAME_HEADER_SIZE + length);
+    uint16_t rx_crc = (uint16_t)(body[body_len - 2] << 8) | body[body_len - 1];
+    if (crc != rx_crc)
+        return -1;
+
+    frame->length = length;
+    frame->dst = body[1];
+    frame->src = body[2];
+    memcpy(frame->payload, &body[MODEM_FRAME_HEADER_SIZE], length);
+    return 0;
+}
@@ -0,0 +1,150 @@
+#include "modem/modem_profile.h"
+#include "modem/mfsk.h"
+
+#include <stddef.h>
+
+static const modem_profile_t profiles[MODEM_PROFILE_COUNT] = {
+    [MODEM_PROFILE_FSK_32] = {
+        .name = "fsk-32",
+        .sample_rate = 79200,
+        .baud = 32,
+        .oversample = 8,
+        .carriers = 1,
+        .tone_hz = {{1200.0f, 2200.0f}},
+    },
+    [MODEM_PROFILE_MC4_32] = {
+        .name = "mc4-32",
+        .sample_rate = 79200,
+        .baud = 32,
+        .oversample = 8,
+        .carriers = 4,
+        .tone_hz = {
+            {640.0f, 832.0f},
+            {1216.0f, 1408.0f},
+            {1792.0f, 1984.0f},
+            {2368.0f, 2560.0f},
+        },
+    },
+    [MODEM_PROFILE_MC8_32] = {
+        .name = "mc8-32",
+        .sample_rate = 79200,
+        .baud = 32,
+        .oversample = 8,
+        .carriers = 8,
+        .tone_hz = {
+            {480.0f, 640.0f},
+            {800.0f, 960.0f},
+            {1120.0f, 1280.0f},
+            {1440.0f, 1600.0f},
+            {1760.0f, 1920.0f},
+            {2080.0f, 2240.0f},
+            {2400.0f, 2560.0f},
+            {2720.0f, 2880.0f},
+        },
+    },
+    [MODEM_PROFILE_MFSK4_32] = {
+        .name = "mfsk4-32",
+        .modulation = MODEM_MOD_MFSK,
+        .sample_rate = 79200,
+        .baud = 32,
+        .oversample = 8,
+        .carriers = 1,
+        .tones = 4,
+        .mfsk_hz = {1024.0f, 1408.0f, 1792.0f, 2176.0f},
+    },
+    [MODEM_PROFILE_MFSK8_32] = {
+        .name = "mfsk8-32",
+        .modulation = MODEM_MOD_MFSK,
+        .sample_rate = 79200,
+        .baud = 32,
+        .oversample = 8,
+        .carriers = 1,
+        .tones = 8,
+        .mfsk_hz = {768.0f, 1056.0f, 1344.0f, 1632.0f, 1920.0f, 2208.0f, 2496.0f, 2784.0f},
+    },
+    [MODEM_PROFILE_BPSK_32] = {
+        .name = "bpsk-32",
+        .modulation = MODEM_MOD_BPSK,
+        .sample_rate = 79200,
+        .baud = 32,
+        .oversample = 8,
+        .carriers = 1,
+        .carrier_hz = 1500.0f,
+    },
+    [MODEM_PROFILE_QPSK_250] = {
+        .name = "qpsk-250",
+        .modulation = MODEM_MOD_QPSK,
+        .sample_rate = 79200,
+        .baud = 250,
+        .oversample = 8,
+        .carriers = 1,
+        .carrier_hz = 1500.0f,
+    },
+    [MODEM_PROFILE_AFSK_1200] = {
+        .name = "afsk-1200",
+        .sample_rate = 79200,
+        .baud = 1200,
+        .oversample = 8,
+        .carriers = 1,
+        .tone_hz = {{2200.0f, 1200.0f}}, // space = line 0, mark = line 1
+    },
+};
+
+const modem_profile_t *modem_profile_get(modem_profile_id_t id)
+{
+    if (id >= MODEM_PROFILE_COUNT)
+        return NULL;
+    return &profiles[id];
+}
+
+uint8_t modem_profile_bits_per_symbol(const modem_profile_t *profile)
+{
+    if (profile->modulation == MODEM_MOD_BPSK)
+        return 1;
+
+    if (profile->modulation == MODEM_MOD_QPSK)
+        return 2;
+
+    if (profile->modulation == MODEM_MOD_MFSK)
+    {
+        uint8_t bits = 0;
+        while ((1u << bits) < profile->tones)
+            bits++;
+        return bits;
+    }
+
+    return profile->carriers;
+}
+
+uint32_t modem_profile_bit_rate(const modem_profile_t *profile)
+{
+    return (uint32_t)profile->baud * modem_profile_bits_per_symbol(profile);
+}
+
+unsigned modem_profile_shared_symbol(const modem_profile_t *profile, unsigned bit)
+{
+    if (!bit)
+        return 0;
+
+    if (profile->modulation == MODEM_MOD_MFSK)
+        return mfsk_gray(profile->tones - 1u);
+
+    if (profile->modulation == MODEM_MOD_BPSK || profile->modulation == MODEM_MOD_QPSK)
+        return (1u << modem_profile_bits_per_symbol(profile)) - 1;
+
+    return (1u << profile->carriers) - 1;
+}
+
+float modem_profile_tone_hz(const modem_profile_t *profile, unsigned symbol)
+{
+    if (profile->modulation == MODEM_MOD_MFSK)
+        return profile->mfsk_hz[mfsk_tone_for_bits(symbol) & (profile->tones - 1)];
+
+    if (profile->modulation == MODEM_MOD_BPSK || profile->modulation == MODEM_MOD_QPSK)
+        return profile->carrier_hz;
+
+    if (profile->carriers != 1)
+        return 0.0f;
+
+    return profile->tone_hz[0][symbol & 1];
+}
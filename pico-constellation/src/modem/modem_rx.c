@@ -0,0 +1,622 @@
+#include "modem/modem_rx.h"
+
+#include <math.h>
+#include <string.h>
+
+#include "modem/mfsk.h"
+
+#define TIMING_ERROR_LIMIT 1.5f // accumulated early/late error that slips one chip
+#define ENERGY_FLOOR 1.0f
+#define SNR_MAX_DB 60.0f
+#define SNR_BANDWIDTH_HZ 3000.0f
+
+static bool is_psk(modem_modulation_t modulation)
+{
+    return modulation == MODEM_MOD_BPSK || modulation == MODEM_MOD_QPSK;
+}
+
+static int modem_rx_front_init(modem_rx_t *rx, const modem_profile_t *profile)
+{
+    if (is_psk(profile->modulation))
+    {
+        psk_demod_config_t config;
+        if (psk_demod_config_from_profile(&config, profile))
+            return -1;
+        return psk_demod_init(&rx->demod.psk, &config);
+    }
+
+    if (profile->modulation == MODEM_MOD_MFSK)
+    {
+        tone_bank_config_t config = {
+            .sample_rate = profile->sample_rate,
+            .baud = profile->baud,
+            .oversample = profile->oversample,
+            .tones = profile->tones,
+            .tone_hz = profile->mfsk_hz,
+        };
+        return tone_bank_init(&rx->demod.mfsk, &config);
+    }
+
+    if (!profile->carriers || profile->carriers > MODEM_MAX_CARRIERS)
+        return -1;
+
+    for (uint8_t k = 0; k < profile->carriers; k++)
+    {
+        fsk_demod_config_t config;
+        fsk_demod_config_from_profile(&config, profile, k);
+        if (fsk_demod_init(&rx->demod.fsk[k], &config))
+            return -1;
+    }
+
+    return 0;
+}
+
+static void modem_rx_front_reset(modem_rx_t *rx)
+{
+    if (is_psk(rx->modulation))
+    {
+        psk_demod_reset(&rx->demod.psk);
+        return;
+    }
+
+    if (rx->modulation == MODEM_MOD_MFSK)
+    {
+        tone_bank_reset(&rx->demod.mfsk);
+        return;
+    }
+
+    for (uint8_t k = 0; k < rx->carriers; k++)
+    {
+        fsk_demod_reset(&rx->demod.fsk[k]);
+    }
+}
+
+static void modem_rx_front_skip(modem_rx_t *rx, size_t count, float dc)
+{
+    if (is_psk(rx->modulation))
+    {
+        psk_demod_skip(&rx->demod.psk, count, dc);
+        return;
+    }
+
+    if (rx->modulation == MODEM_MOD_MFSK)
+    {
+        tone_bank_skip(&rx->demod.mfsk, count, dc);
+        return;
+    }
+
+    for (uint8_t k = 0; k < rx->carriers; k++)
+    {
+        fsk_demod_skip(&rx->demod.fsk[k], count, dc);
+    }
+}
+
+// Coherent front ends narrow their loops while a frame is being received.
+static void modem_rx_front_track(modem_rx_t *rx, bool tracking)
+{
+    if (is_psk(rx->modulation))
+        psk_demod_set_tracking(&rx->demod.psk, tracking);
+}
+
+static size_t modem_rx_front_fsk(modem_rx_t *rx, const uint16_t *samples, size_t count, size_t *num_chips)
+{
+    size_t used = 0;
+
+    // Every carrier consumes the same samples and yields the same number of chips.
+    for (uint8_t k = 0; k < rx->carriers; k++)
+    {
+        used = fsk_demod_process(&rx->demod.fsk[k], samples, count, rx->raw.fsk[k], MODEM_RX_CHIP_BATCH, num_chips);
+    }
+
+    for (size_t i = 0; i < *num_chips; i++)
+    {
+        modem_chip_t *chip = &rx->chips[i];
+        chip->sync = 0.0f;
+        chip->strength = 0.0f;
+        chip->noise = 0.0f;
+
+        for (uint8_t k = 0; k < rx->carriers; k++)
+        {
+            float metric = rx->raw.fsk[k][i].metric;
+            chip->sync += metric;
+            chip->strength += fabsf(metric);
+            chip->soft[k] = metric;
+            chip->level[k] = rx->raw.fsk[k][i].level[metric > 0.0f];
+            float other = rx->raw.fsk[k][i].level[metric <= 0.0f];
+            chip->noise += other * other;
+        }
+
+        chip->sync /= rx->carriers;
+        chip->strength /= rx->carriers;
+        chip->noise /= rx->carriers;
+    }
+
+    return used;
+}
+
+static size_t modem_rx_front_mfsk(modem_rx_t *rx, const uint16_t *samples, size_t count, size_t *num_chips)
+{
+    size_t used = tone_bank_process(&rx->demod.mfsk, samples, count, rx->raw.mfsk, MODEM_RX_CHIP_BATCH, num_chips);
+
+    for (size_t i = 0; i < *num_chips; i++)
+    {
+        const tone_bank_chip_t *raw = &rx->raw.mfsk[i];
+        modem_chip_t *chip = &rx->chips[i];
+        float top = raw->energy[rx->tones - 1];
+        float bottom = raw->energy[0];
+        float peak = 0.0f;
+
+        for (uint8_t t = 0; t < rx->tones; t++)
+        {
+            if (raw->energy[t] > peak)
+                peak = raw->energy[t];
+        }
+
+        // Preamble and sync word use the outer tones.
+        chip->sync = (top - bottom) / (raw->total + ENERGY_FLOOR);
+        chip->strength = peak / (raw->total + ENERGY_FLOOR);
+        mfsk_soft_bits(raw->energy, rx->tones, raw->total, chip->soft);
+
+        float level = sqrtf(peak) * rx->level_scale;
+        for (uint8_t b = 0; b < rx->bits_per_symbol; b++)
+        {
+            chip->level[b] = level;
+        }
+        chip->noise = (raw->total - peak) / (rx->tones - 1) * rx->level_scale * rx->level_scale;
+    }
+
+    return used;
+}
+
+static size_t modem_rx_front_psk(modem_rx_t *rx, const uint16_t *samples, size_t count, size_t *num_chips)
+{
+    size_t used = psk_demod_process(&rx->demod.psk, samples, count, rx->raw.psk, MODEM_RX_CHIP_BATCH, num_chips);
+
+    for (size_t i = 0; i < *num_chips; i++)
+    {
+        const psk_chip_t *raw = &rx->raw.psk[i];
+        modem_chip_t *chip = &rx->chips[i];
+
+        chip->sync = raw->sync;
+        chip->strength = raw->strength;
+        chip->soft[0] = raw->soft[0];
+        chip->soft[1] = raw->soft[1];
+        chip->level[0] = raw->level;
+        chip->level[1] = raw->level;
+        chip->noise = raw->noise;
+    }
+
+    return used;
+}
+
+int modem_rx_init(modem_rx_t *rx, const modem_profile_t *profile, modem_rx_callback_t callback, void *ctx)
+{
+    if (!rx || !profile)
+        return -1;
+
+    memset(rx, 0, sizeof(*rx));
+
+    rx->modulation = profile->modulation;
+    rx->carriers = profile->carriers;
+    rx->tones = profile->tones;
+    rx->bits_per_symbol = modem_profile_bits_per_symbol(profile);
+    if (!rx->bits_per_symbol || rx->bits_per_symbol > MODEM_MAX_SYMBOL_BITS)
+        return -1;
+
+    if (modem_rx_front_init(rx, profile))
+        return -1;
+
+    preamble_correlator_config_t corr_config = {
+        .pattern = MODEM_FRAME_SYNC_WORD,
+        .bits = MODEM_FRAME_SYNC_BITS,
+        .oversample = profile->oversample,
+        .threshold = MODEM_RX_SYNC_THRESHOLD,
+    };
+    if (preamble_correlator_init(&rx->corr, &corr_config))
+        return -1;
+
+    squelch_config_t squelch_config;
+    squelch_default_config(&squelch_config);
+    squelch_init(&rx->squelch, &squelch_config);
+    rx->squelch_timeout_samples = (uint32_t)((uint64_t)profile->sample_rate * MODEM_RX_SQUELCH_TIMEOUT_SYMBOLS / profile->baud);
+
+    rx->oversample = profile->oversample;
+    rx->sample_rate = profile->sample_rate;
+    rx->baud = profile->baud;
+    rx->samples_per_chip = (float)profile->sample_rate / ((float)profile->baud * profile->oversample);
+    // A tone of amplitude A sums to A * N / 2 over the N samples of a symbol.
+    rx->level_scale = 2.0f * profile->baud / profile->sample_rate;
+    rx->callback = callback;
+    rx->callback_ctx = ctx;
+    rx->state = MODEM_RX_HUNT;
+    return 0;
+}
+
+void modem_rx_reset(modem_rx_t *rx)
+{
+    modem_rx_front_reset(rx);
+    preamble_correlator_reset(&rx->corr);
+    rx->state = MODEM_RX_HUNT;
+}
+
+int modem_rx_set_squelch(modem_rx_t *rx, bool enabled, const squelch_config_t *config)
+{
+    if (!rx)
+        return -1;
+
+    if (config && squelch_init(&rx->squelch, config))
+        return -1;
+
+    rx->squelch_enabled = enabled;
+    rx->hunt_open_samples = 0;
+    return 0;
+}
+
+void modem_rx_set_clock(modem_rx_t *rx, uint64_t (*clock_us)(void))
+{
+    rx->clock_us = clock_us;
+}
+
+void modem_rx_set_timer(modem_rx_t *rx, uint64_t (*clock_ns)(void))
+{
+    rx->timer_ns = clock_ns;
+    memset(&rx->timing, 0, sizeof(rx->timing));
+}
+
+void modem_rx_set_stream(modem_rx_t *rx, modem_rx_bit_callback_t callback, void *ctx, uint32_t stream_bits)
+{
+    rx->stream_callback = callback;
+    rx->stream_ctx = ctx;
+    rx->stream_bits = stream_bits;
+}
+
+void modem_rx_set_chase(modem_rx_t *rx, chase_t *chase)
+{
+    rx->chase = chase;
+}
+
+const modem_rx_frame_info_t *modem_rx_frame_info(const modem_rx_t *rx)
+{
+    return &rx->info;
+}
+
+bool modem_rx_dcd(const modem_rx_t *rx)
+{
+    return rx->state == MODEM_RX_BODY || (rx->squelch_enabled && squelch_is_open(&rx->squelch));
+}
+
+static void modem_rx_hunt(modem_rx_t *rx)
+{
+    preamble_correlator_reset(&rx->corr);
+    modem_rx_front_track(rx, false);
+    rx->state = MODEM_RX_HUNT;
+}
+
+void modem_rx_resync(modem_rx_t *rx)
+{
+    modem_rx_hunt(rx);
+}
+
+// Capture time of a sample, from the time its block was handed over.
+static uint64_t modem_rx_sample_us(const modem_rx_t *rx, uint64_t sample)
+{
+    uint64_t behind = (rx->block_end_sample - sample) * 1000000 / rx->sample_rate;
+    return behind < rx->block_end_us ? rx->block_end_us - behind : 0;
+}
+
+static void modem_rx_frame_info_done(modem_rx_t *rx)
+{
+    modem_rx_frame_info_t *info = &rx->info;
+    float noise = rx->noise_sum / rx->symbols;
+    float signal = rx->signal_sum / rx->body_bits - noise;
+
+    // A tone of amplitude A against detector noise N over one symbol is
+    // A^2 / N; the same noise spread over 3 kHz instead of the baud rate.
+    float ratio = signal / (noise + ENERGY_FLOOR) * rx->baud / SNR_BANDWIDTH_HZ;
+    info->snr_db = ratio > 0.0f ? fminf(10.0f * log10f(ratio), SNR_MAX_DB) : -SNR_MAX_DB;
+
+    info->space_level = rx->level_count[0] ? rx->level_sum[0] / rx->level_count[0] : 0.0f;
+    info->mark_level = rx->level_count[1] ? rx->level_sum[1] / rx->level_count[1] : 0.0f;
+    info->offset_hz = is_psk(rx->modulation) ? psk_demod_offset_hz(&rx->demod.psk) : 0.0f;
+    info->corrected_bits = 0;
+    info->body_bits = (uint16_t)rx->body_bits;
+
+    // The decision chip is the one before the newest.
+    info->last_sample = rx->chip_sample - (uint64_t)rx->samples_per_chip;
+
+    if (rx->clock_us)
+    {
+        uint64_t now = rx->clock_us();
+        uint64_t last_us = modem_rx_sample_us(rx, info->last_sample);
+        info->timestamp_us = modem_rx_sample_us(rx, info->first_sample);
+        info->latency_us = now > last_us ? (uint32_t)(now - last_us) : 0;
+    }
+}
+
+// Hands a failed copy to the combiner; returns the number of bits the sum changed, or -1.
+static int modem_rx_combine(modem_rx_t *rx, modem_frame_t *frame)
+{
+    uint8_t body[MODEM_FRAME_MAX_BODY];
+    uint64_t now_us = rx->chip_sample * 1000000 / rx->sample_rate;
+
+    size_t len = chase_combine(rx->chase, rx->soft, rx->body_expected, now_us, body);
+    if (!len || modem_frame_parse(body, len, frame))
+        return -1;
+
+    int changed = 0;
+    for (size_t i = 0; i < len; i++)
+    {
+        for (uint8_t diff = body[i] ^ rx->body[i]; diff; diff &= diff - 1)
+        {
+            changed++;
+        }
+    }
+
+    return changed;
+}
+
+static void modem_rx_frame_done(modem_rx_t *rx)
+{
+    modem_frame_t frame;
+    int corrected = 0;
+
+    if (modem_frame_parse(rx->body, rx->body_expected / 8, &frame))
+    {
+        rx->stats.frames_bad_crc++;
+        corrected = rx->chase ? modem_rx_combine(rx, &frame) : -1;
+        if (corrected < 0)
+        {
+            modem_rx_hunt(rx);
+            return;
+        }
+        rx->stats.frames_combined++;
+    }
+    else
+    {
+        rx->stats.frames_ok++;
+        if (rx->chase)
+            chase_forget(rx->chase, rx->body);
+    }
+
+    modem_rx_frame_info_done(rx);
+    rx->info.corrected_bits = (uint16_t)corrected;
+    if (rx->callback)
+        rx->callback(rx->callback_ctx, frame.payload, frame.length, frame.src);
+
+    modem_rx_hunt(rx);
+}
+
+static void modem_rx_stream_bit(modem_rx_t *rx, float soft)
+{
+    uint32_t index = (uint32_t)rx->body_bits++;
+    rx->stream_callback(rx->stream_ctx, soft > 0.0f, index);
+
+    if (rx->body_bits == rx->stream_bits && rx->state == MODEM_RX_BODY)
+        modem_rx_hunt(rx);
+}
+
+static void modem_rx_bit(modem_rx_t *rx, float soft, float level)
+{
+    if (rx->stream_callback)
+    {
+        modem_rx_stream_bit(rx, soft);
+        return;
+    }
+
+    size_t p = rx->body_bits++;
+    bool one = soft > 0.0f;
+    if (one)
+        rx->body[p >> 3] |= (uint8_t)(0x80 >> (p & 7));
+    if (rx->chase)
+        rx->soft[p] = chase_quantize(soft);
+
+    rx->signal_sum += level * level;
+    rx->level_sum[one] += level;
+    rx->level_count[one]++;
+
+    if (rx->body_bits == 8)
+    {
+        uint8_t length = rx->body[0];
+        if (length > MODEM_FRAME_MAX_PAYLOAD)
+        {
+            rx->stats.frames_bad_header++;
+            modem_rx_hunt(rx);
+            return;
+        }
+        rx->body_expected = modem_frame_body_size(length) * 8;
+    }
+
+    if (rx->body_bits == rx->body_expected)
+        modem_rx_frame_done(rx);
+}
+
+static void modem_rx_frame_start(modem_rx_t *rx, const preamble_detection_t *detection)
+{
+    rx->signal_sum = 0.0f;
+    rx->noise_sum = 0.0f;
+    rx->symbols = 0;
+    memset(rx->level_sum, 0, sizeof(rx->level_sum));
+    memset(rx->level_count, 0, sizeof(rx->level_count));
+    memset(&rx->info, 0, sizeof(rx->info));
+
+    // The peak chip closes the last sync symbol; the word began bits symbols earlier.
+    uint32_t chips_back = (rx->corr.chip_count - 1 - detection->peak_chip) + (uint32_t)MODEM_FRAME_SYNC_BITS * rx->oversample;
+    uint64_t samples_back = (uint64_t)(chips_back * rx->samples_per_chip);
+    rx->info.first_sample = rx->chip_sample > samples_back ? rx->chip_sample - samples_back : 0;
+}
+
+static void modem_rx_chip(modem_rx_t *rx, const modem_chip_t *chip)
+{
+    if (rx->state == MODEM_RX_HUNT)
+    {
+        preamble_detection_t detection;
+        if (!preamble_correlator_push(&rx->corr, chip->sync, &detection))
+            return;
+
+        rx->stats.sync_detects++;
+        if (rx->stream_callback)
+            rx->stats.streams++;
+        rx->hunt_open_samples = 0;
+        rx->state = MODEM_RX_BODY;
+        modem_rx_front_track(rx, true);
+        rx->countdown = (uint16_t)(detection.start_chip + 1 - (rx->corr.chip_count - 1));
+        rx->timing_error = 0.0f;
+        memset(&rx->early, 0, sizeof(rx->early));
+        memset(&rx->prompt, 0, sizeof(rx->prompt));
+        rx->body_bits = 0;
+        rx->body_expected = MODEM_FRAME_MAX_BODY * 8;
+        memset(rx->body, 0, sizeof(rx->body));
+        modem_rx_frame_start(rx, &detection);
+        return;
+    }
+
+    // Correlator chip counter keeps running so chip numbering stays global.
+    rx->corr.chip_count++;
+
+    bool decide = --rx->countdown == 0;
+    if (decide)
+    {
+        rx->timing_error += chip->strength - rx->early.strength;
+        rx->countdown = rx->oversample;
+        if (rx->timing_error > TIMING_ERROR_LIMIT)
+        {
+            rx->countdown++;
+            rx->timing_error = 0.0f;
+        }
+        else if (rx->timing_error < -TIMING_ERROR_LIMIT)
+        {
+            rx->countdown--;
+            rx->timing_error = 0.0f;
+        }
+    }
+
+    rx->early = rx->prompt;
+    rx->prompt = *chip;
+
+    if (!decide)
+        return;
+
+    rx->noise_sum += rx->early.noise;
+    rx->symbols++;
+
+    // Decide on the centre chip, now held in early; stop if the frame completes mid-symbol.
+    for (uint8_t b = 0; b < rx->bits_per_symbol && rx->state == MODEM_RX_BODY; b++)
+    {
+        modem_rx_bit(rx, rx->early.soft[b], rx->early.level[b]);
+    }
+}
+
+static uint64_t modem_rx_now_ns(const modem_rx_t *rx)
+{
+    return rx->timer_ns ? rx->timer_ns() : 0;
+}
+
+static void modem_rx_demodulate(modem_rx_t *rx, const uint16_t *samples, size_t count)
+{
+    rx->stats.samples_demodulated += count;
+
+    while (count)
+    {
+        size_t num_chips = 0;
+        size_t used;
+        uint64_t start_ns = modem_rx_now_ns(rx);
+
+        if (is_psk(rx->modulation))
+            used = modem_rx_front_psk(rx, samples, count, &num_chips);
+        else if (rx->modulation == MODEM_MOD_MFSK)
+            used = modem_rx_front_mfsk(rx, samples, count, &num_chips);
+        else
+            used = modem_rx_front_fsk(rx, samples, count, &num_chips);
+
+        samples += used;
+        count -= used;
+        rx->sample_count += used;
+        uint64_t front_ns = modem_rx_now_ns(rx);
+
+        for (size_t i = 0; i < num_chips; i++)
+        {
+            // The batch stops on its last chip or runs out of samples within one chip of it.
+            rx->chip_sample = rx->sample_count - (uint64_t)((num_chips - 1 - i) * rx->samples_per_chip);
+            modem_rx_chip(rx, &rx->chips[i]);
+        }
+
+        if (rx->timer_ns)
+        {
+            rx->timing.front_ns += front_ns - start_ns;
+            rx->timing.chips_ns += modem_rx_now_ns(rx) - front_ns;
+        }
+    }
+}
+
+static void modem_rx_squelched_block(modem_rx_t *rx, const uint16_t *samples, size_t count)
+{
+    bool was_open = squelch_is_open(&rx->squelch);
+    uint64_t start_ns = modem_rx_now_ns(rx);
+    bool open = squelch_update(&rx->squelch, samples, count);
+
+    if (rx->timer_ns)
+        rx->timing.squelch_ns += modem_rx_now_ns(rx) - start_ns;
+
+    if (!open)
+    {
+        if (rx->state == MODEM_RX_BODY)
+        {
+            rx->stats.frames_lost_carrier++;
+            modem_rx_hunt(rx);
+        }
+
+        rx->stats.samples_gated += count;
+        rx->sample_count += count;
+        modem_rx_front_skip(rx, count, rx->squelch.mean);
+        return;
+    }
+
+    if (!was_open)
+    {
+        // Correlator history is from before the carrier; start clean.
+        preamble_correlator_reset(&rx->corr);
+        rx->hunt_open_samples = 0;
+    }
+
+    modem_rx_demodulate(rx, samples, count);
+
+    if (rx->state == MODEM_RX_HUNT)
+    {
+        rx->hunt_open_samples += count;
+        if (rx->hunt_open_samples >= rx->squelch_timeout_samples)
+        {
+            rx->stats.squelch_timeouts++;
+            rx->hunt_open_samples = 0;
+            squelch_relearn(&rx->squelch);
+        }
+    }
+}
+
+int modem_rx_process(modem_rx_t *rx, const uint16_t *samples, size_t count)
+{
+    if (!rx || (!samples && count))
+        return -1;
+
+    if (rx->clock_us)
+    {
+        rx->block_end_us = rx->clock_us();
+        rx->block_end_sample = rx->sample_count + count;
+    }
+    rx->timing.blocks++;
+
+    if (!rx->squelch_enabled)
+    {
+        modem_rx_demodulate(rx, samples, count);
+        return 0;
+    }
+
+    while (count)
+    {
+        size_t n = count < SQUELCH_BLOCK_SIZE ? count : SQUELCH_BLOCK_SIZE;
+        modem_rx_squelched_block(rx, samples, n);
+        samples += n;
+        count -= n;
+    }
+
+    return 0;
+}
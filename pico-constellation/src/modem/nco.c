@@ -0,0 +1,31 @@
+#include "modem/nco.h"
+
+#include <math.h>
+#include <stdbool.h>
+
+int16_t nco_sine_table[NCO_TABLE_SIZE];
+static bool table_ready = false;
+
+static void nco_build_table(void)
+{
+    for (int i = 0; i < NCO_TABLE_SIZE; i++)
+    {
+        float angle = (2.0f * (float)M_PI * i) / NCO_TABLE_SIZE;
+        nco_sine_table[i] = (int16_t)lrintf(sinf(angle) * 32767.0f);
+    }
+    table_ready = true;
+}
+
+uint32_t nco_step(float frequency, uint32_t sample_rate)
+{
+    return (uint32_t)((double)frequency / sample_rate * 4294967296.0);
+}
+
+void nco_init(nco_t *nco, float frequency, uint32_t sample_rate)
+{
+    if (!table_ready)
+        nco_build_table();
+
+    nco->phase = 0;
+    nco->step = nco_step(frequency, sample_rate);
+}
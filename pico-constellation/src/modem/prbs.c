@@ -0,0 +1,170 @@
+#include "modem/prbs.h"
+
+#include <string.h>
+
+static int prbs_polynomial(prbs_type_t type, uint8_t *order, uint8_t *tap)
+{
+    switch (type)
+    {
+    case PRBS_9:
+        *order = 9;
+        *tap = 5;
+        return 0;
+    case PRBS_15:
+        *order = 15;
+        *tap = 14;
+        return 0;
+    default:
+        return -1;
+    }
+}
+
+static unsigned prbs_feedback(uint16_t state, uint8_t order, uint8_t tap)
+{
+    return ((state >> (order - 1)) ^ (state >> (tap - 1))) & 1;
+}
+
+int prbs_init(prbs_t *prbs, prbs_type_t type)
+{
+    if (!prbs || prbs_polynomial(type, &prbs->order, &prbs->tap))
+        return -1;
+
+    prbs->mask = (uint16_t)((1u << prbs->order) - 1);
+    prbs->state = prbs->mask; // any non-zero seed
+    return 0;
+}
+
+unsigned prbs_next(prbs_t *prbs)
+{
+    unsigned bit = prbs_feedback(prbs->state, prbs->order, prbs->tap);
+    prbs->state = (uint16_t)(((prbs->state << 1) | bit) & prbs->mask);
+    return bit;
+}
+
+void prbs_fill(prbs_t *prbs, uint8_t *bits, size_t num_bits)
+{
+    memset(bits, 0, (num_bits + 7) / 8);
+    for (size_t p = 0; p < num_bits; p++)
+    {
+        if (prbs_next(prbs))
+            bits[p >> 3] |= (uint8_t)(0x80 >> (p & 7));
+    }
+}
+
+const char *prbs_name(prbs_type_t type)
+{
+    return type == PRBS_15 ? "prbs-15" : "prbs-9";
+}
+
+int prbs_checker_init(prbs_checker_t *checker, prbs_type_t type)
+{
+    if (!checker)
+        return -1;
+
+    memset(checker, 0, sizeof(*checker));
+    return prbs_init(&checker->ref, type);
+}
+
+void prbs_checker_reset(prbs_checker_t *checker)
+{
+    prbs_t ref = checker->ref;
+    memset(checker, 0, sizeof(*checker));
+    checker->ref = ref;
+}
+
+static void prbs_checker_unlock(prbs_checker_t *checker)
+{
+    checker->locked = false;
+    checker->history_bits = 0;
+    checker->run = 0;
+    checker->second_unsynced = true;
+    checker->stats.sync_losses++;
+}
+
+static void prbs_checker_hunt(prbs_checker_t *checker, unsigned bit)
+{
+    prbs_t *ref = &checker->ref;
+
+    if (checker->history_bits < ref->order)
+    {
+        checker->history_bits++;
+        checker->run = 0;
+    }
+    else if (bit == prbs_feedback(checker->history, ref->order, ref->tap))
+    {
+        checker->run++;
+    }
+    else
+    {
+        checker->run = 0;
+    }
+
+    checker->history = (uint16_t)(((checker->history << 1) | bit) & ref->mask);
+
+    if (checker->run >= PRBS_SYNC_BITS)
+    {
+        // The history is the generator state that produced it.
+        ref->state = checker->history;
+        checker->locked = true;
+        checker->window_bits = 0;
+        checker->window_errors = 0;
+        checker->stats.syncs++;
+    }
+}
+
+bool prbs_checker_push(prbs_checker_t *checker, unsigned bit)
+{
+    if (!checker->locked)
+    {
+        checker->second_unsynced = true;
+        prbs_checker_hunt(checker, bit & 1);
+        return checker->locked;
+    }
+
+    unsigned error = (bit & 1) ^ prbs_next(&checker->ref);
+    checker->stats.bits++;
+    checker->stats.errors += error;
+    checker->second_bits++;
+    checker->second_errors += error;
+    checker->window_errors += error;
+
+    if (++checker->window_bits == PRBS_LOSS_WINDOW)
+    {
+        if (checker->window_errors >= PRBS_LOSS_ERRORS)
+        {
+            // Those bits were never really compared.
+            checker->stats.bits -= checker->window_bits;
+            checker->stats.errors -= checker->window_errors;
+            prbs_checker_unlock(checker);
+            return false;
+        }
+        checker->window_bits = 0;
+        checker->window_errors = 0;
+    }
+
+    return true;
+}
+
+void prbs_checker_second(prbs_checker_t *checker)
+{
+    prbs_stats_t *stats = &checker->stats;
+
+    stats->seconds++;
+    if (checker->second_unsynced || !checker->locked)
+        stats->unsynced_seconds++;
+    else if (checker->second_errors)
+        stats->errored_seconds++;
+    else
+        stats->error_free_seconds++;
+
+    stats->last_bits = checker->second_bits;
+    stats->last_errors = checker->second_errors;
+    checker->second_bits = 0;
+    checker->second_errors = 0;
+    checker->second_unsynced = !checker->locked;
+}
+
+double prbs_checker_ber(const prbs_checker_t *checker)
+{
+    return checker->stats.bits ? (double)checker->stats.errors / (double)checker->stats.bits : 0.0;
+}
@@ -0,0 +1,140 @@
+#include "modem/prbs_link.h"
+
+#include <string.h>
+
+#define SYNC_BITS (MODEM_FRAME_PREAMBLE_BITS + MODEM_FRAME_SYNC_BITS)
+
+uint32_t prbs_link_burst_bits(const modem_profile_t *profile)
+{
+    uint32_t bits_per_symbol = modem_profile_bits_per_symbol(profile);
+    uint32_t bits = PRBS_LINK_MARKER_BITS + modem_profile_bit_rate(profile) * PRBS_LINK_BURST_SECONDS;
+    return bits - bits % bits_per_symbol - PRBS_LINK_MARKER_BITS;
+}
+
+int prbs_link_tx_init(prbs_link_tx_t *tx, const modem_profile_t *profile, prbs_type_t type, uint32_t burst_bits)
+{
+    if (!tx || !profile || !burst_bits)
+        return -1;
+
+    memset(tx, 0, sizeof(*tx));
+    if (prbs_init(&tx->prbs, type))
+        return -1;
+
+    // 1010... preamble, then the sync word, as modem_frame_build sends them.
+    uint32_t preamble = 0;
+    for (int i = 0; i < MODEM_FRAME_PREAMBLE_BITS; i++)
+    {
+        preamble = (preamble << 1) | ((i & 1) ? 0 : 1);
+    }
+
+    tx->profile = profile;
+    tx->sync = (preamble << MODEM_FRAME_SYNC_BITS) | MODEM_FRAME_SYNC_WORD;
+    tx->sync_bits = SYNC_BITS;
+    tx->bits_per_symbol = modem_profile_bits_per_symbol(profile);
+    tx->burst_bits = burst_bits;
+    return 0;
+}
+
+unsigned prbs_link_tx_symbol(prbs_link_tx_t *tx)
+{
+    if (tx->pos < tx->sync_bits)
+    {
+        unsigned bit = (tx->sync >> (tx->sync_bits - 1 - tx->pos)) & 1;
+        tx->pos++;
+        return modem_profile_shared_symbol(tx->profile, bit);
+    }
+
+    // Body bits: carrier k for multi-carrier FSK, otherwise MSB first (as fsk_mod_frame).
+    unsigned symbol = 0;
+    for (uint8_t b = 0; b < tx->bits_per_symbol; b++)
+    {
+        uint32_t marker_pos = tx->pos++ - tx->sync_bits;
+        unsigned bit = marker_pos < PRBS_LINK_MARKER_BITS
+                           ? (MODEM_FRAME_SYNC_WORD >> (PRBS_LINK_MARKER_BITS - 1 - marker_pos)) & 1
+                           : prbs_next(&tx->prbs);
+
+        if (tx->profile->modulation == MODEM_MOD_FSK)
+            symbol |= bit << b;
+        else
+            symbol = (symbol << 1) | bit;
+    }
+
+    if (tx->pos >= tx->sync_bits + PRBS_LINK_MARKER_BITS + tx->burst_bits)
+        tx->pos = 0;
+
+    return symbol;
+}
+
+static void prbs_link_rx_bit(void *ctx, unsigned bit, uint32_t index)
+{
+    prbs_link_rx_t *link = ctx;
+
+    if (index >= PRBS_LINK_MARKER_BITS)
+    {
+        prbs_checker_push(&link->checker, bit);
+        return;
+    }
+
+    link->marker = (uint16_t)((link->marker << 1) | bit);
+    if (index < PRBS_LINK_MARKER_BITS - 1)
+        return;
+
+    int errors = 0;
+    for (uint16_t diff = link->marker ^ MODEM_FRAME_SYNC_WORD; diff; diff &= diff - 1)
+    {
+        errors++;
+    }
+
+    if (errors > PRBS_LINK_MARKER_ERRORS)
+    {
+        link->false_syncs++;
+        modem_rx_resync(&link->rx);
+        return;
+    }
+
+    link->bursts++;
+    link->unlocked_seconds = 0;
+}
+
+int prbs_link_rx_init(prbs_link_rx_t *link, const modem_profile_t *profile, prbs_type_t type, uint32_t burst_bits)
+{
+    if (!link || !profile)
+        return -1;
+
+    memset(link, 0, sizeof(*link));
+    if (modem_rx_init(&link->rx, profile, NULL, NULL) || prbs_checker_init(&link->checker, type))
+        return -1;
+
+    modem_rx_set_stream(&link->rx, prbs_link_rx_bit, link, PRBS_LINK_MARKER_BITS + burst_bits);
+    return 0;
+}
+
+int prbs_link_rx_process(prbs_link_rx_t *link, const uint16_t *samples, size_t count)
+{
+    return modem_rx_process(&link->rx, samples, count);
+}
+
+void prbs_link_rx_second(prbs_link_rx_t *link)
+{
+    prbs_checker_second(&link->checker);
+
+    if (link->checker.locked || link->rx.state == MODEM_RX_HUNT)
+    {
+        link->unlocked_seconds = 0;
+        return;
+    }
+
+    // Streaming without a lock: symbol timing is probably wrong too, so wait
+    // for the next sync word.
+    if (++link->unlocked_seconds >= PRBS_LINK_RESYNC_SECONDS)
+    {
+        link->unlocked_seconds = 0;
+        modem_rx_resync(&link->rx);
+    }
+}
+
+double prbs_link_rx_throughput(const prbs_link_rx_t *link)
+{
+    const prbs_stats_t *stats = &link->checker.stats;
+    return stats->seconds ? (double)(stats->bits - stats->errors) / stats->seconds : 0.0;
+}
@@ -0,0 +1,105 @@
+#include "modem/preamble_correlator.h"
+
+#include <string.h>
+
+int preamble_correlator_init(preamble_correlator_t *corr, const preamble_correlator_config_t *config)
+{
+    if (!corr || !config)
+        return -1;
+
+    if (!config->bits || config->bits > PREAMBLE_CORRELATOR_MAX_BITS)
+        return -1;
+
+    if (!config->oversample || config->oversample > MODEM_MAX_OVERSAMPLE)
+        return -1;
+
+    memset(corr, 0, sizeof(*corr));
+
+    for (int i = 0; i < config->bits; i++)
+    {
+        corr->taps[i] = ((config->pattern >> (config->bits - 1 - i)) & 1) ? 1 : -1;
+    }
+
+    corr->bits = config->bits;
+    corr->oversample = config->oversample;
+    corr->threshold = config->threshold;
+    corr->history_len = (uint16_t)((config->bits - 1) * config->oversample + 1);
+    return 0;
+}
+
+void preamble_correlator_reset(preamble_correlator_t *corr)
+{
+    memset(corr->history, 0, sizeof(corr->history));
+    corr->history_pos = 0;
+    corr->searching = false;
+    corr->blank_left = 0;
+}
+
+static float preamble_correlator_score(const preamble_correlator_t *corr)
+{
+    // history_pos is the oldest entry, which lines up with the first tap.
+    float sum = 0.0f;
+    uint16_t pos = corr->history_pos;
+
+    for (int i = 0; i < corr->bits; i++)
+    {
+        sum += corr->taps[i] > 0 ? corr->history[pos] : -corr->history[pos];
+        pos += corr->oversample;
+        if (pos >= corr->history_len)
+            pos -= corr->history_len;
+    }
+
+    return sum / corr->bits;
+}
+
+bool preamble_correlator_push(preamble_correlator_t *corr, float metric, preamble_detection_t *detection)
+{
+    uint32_t chip = corr->chip_count++;
+
+    corr->history[corr->history_pos] = metric;
+    if (++corr->history_pos == corr->history_len)
+        corr->history_pos = 0;
+
+    float score = preamble_correlator_score(corr);
+
+    if (corr->blank_left)
+    {
+        corr->blank_left--;
+        return false;
+    }
+
+    if (!corr->searching)
+    {
+        if (score < corr->threshold)
+            return false;
+
+        // Armed: keep looking for the maximum over half a symbol.
+        corr->searching = true;
+        corr->search_left = corr->oversample / 2;
+        corr->best_score = score;
+        corr->best_chip = chip;
+        return false;
+    }
+
+    if (score > corr->best_score)
+    {
+        corr->best_score = score;
+        corr->best_chip = chip;
+    }
+
+    if (corr->search_left && --corr->search_left)
+        return false;
+
+    corr->searching = false;
+    corr->blank_left = corr->oversample;
+
+    if (detection)
+    {
+        detection->peak_chip = corr->best_chip;
+        detection->start_chip = corr->best_chip + corr->oversample;
+        detection->phase = (uint8_t)(corr->best_chip % corr->oversample);
+        detection->score = corr->best_score;
+    }
+
+    return true;
+}
@@ -0,0 +1,282 @@
+#include "modem/psk_demod.h"
+
+#include <math.h>
+#include <string.h>
+
+#define DC_SHIFT 10      // DC tracker time constant, 2^DC_SHIFT samples
+#define MIX_SHIFT 12     // keeps a chip of products inside int32
+#define ENERGY_FLOOR 1.0f
+#define LOOP_DAMPING 0.707f
+#define FLL_SYMBOLS 4    // frequency-assist time constant in symbols
+#define RAD_TO_PHASE (4294967296.0f / (2.0f * (float)M_PI))
+
+int psk_demod_config_from_profile(psk_demod_config_t *config, const modem_profile_t *profile)
+{
+    if (!config || !profile)
+        return -1;
+
+    if (profile->modulation != MODEM_MOD_BPSK && profile->modulation != MODEM_MOD_QPSK)
+        return -1;
+
+    config->sample_rate = profile->sample_rate;
+    config->baud = profile->baud;
+    config->oversample = profile->oversample;
+    config->bits_per_symbol = modem_profile_bits_per_symbol(profile);
+    config->carrier_hz = profile->carrier_hz;
+    config->acquire_bandwidth = profile->baud * PSK_ACQUIRE_BANDWIDTH;
+    config->track_bandwidth = profile->baud * PSK_TRACK_BANDWIDTH;
+    return 0;
+}
+
+// Second-order loop, unity detector and NCO gain, updated once per chip.
+static void psk_demod_loop_gains(float chip_rate, float bandwidth, float *k)
+{
+    float bt = bandwidth / chip_rate;
+    float theta = bt / (LOOP_DAMPING + 1.0f / (4.0f * LOOP_DAMPING));
+    float d = 1.0f + 2.0f * LOOP_DAMPING * theta + theta * theta;
+    k[0] = 4.0f * LOOP_DAMPING * theta / d;
+    k[1] = 4.0f * theta * theta / d;
+}
+
+int psk_demod_init(psk_demod_t *demod, const psk_demod_config_t *config)
+{
+    if (!demod || !config)
+        return -1;
+
+    if (!config->baud || !config->oversample || config->oversample > MODEM_MAX_OVERSAMPLE)
+        return -1;
+
+    if (config->bits_per_symbol != 1 && config->bits_per_symbol != 2)
+        return -1;
+
+    memset(demod, 0, sizeof(*demod));
+
+    nco_init(&demod->nco, config->carrier_hz, config->sample_rate);
+    demod->carrier_step = demod->nco.step;
+    demod->oversample = config->oversample;
+    demod->bits_per_symbol = config->bits_per_symbol;
+    demod->chip_len = (uint32_t)(((uint64_t)config->sample_rate << 16) /
+                                 ((uint32_t)config->baud * config->oversample));
+
+    // A carrier of amplitude A sums to A * N / 2 * 32767 / 2^MIX_SHIFT over N
+    // samples; scale so the one-symbol matched filter reads A.
+    float samples_per_symbol = (float)config->sample_rate / config->baud;
+    demod->chip_scale = 2.0f * (1 << MIX_SHIFT) / (32767.0f * samples_per_symbol);
+
+    demod->chip_rate = (float)config->baud * config->oversample;
+    psk_demod_loop_gains(demod->chip_rate, config->acquire_bandwidth, demod->acquire_k);
+    psk_demod_loop_gains(demod->chip_rate, config->track_bandwidth, demod->track_k);
+
+    // The frequency assist is unambiguous up to a quarter (BPSK) or an eighth
+    // (QPSK) of the baud rate.
+    demod->fll_gain = 1.0f / (FLL_SYMBOLS * config->oversample * config->oversample);
+    demod->loop_freq_limit = 2.0f * (float)M_PI * (config->baud / (4.0f * config->bits_per_symbol)) / demod->chip_rate;
+    demod->rad_per_chip_to_step = RAD_TO_PHASE * demod->chip_rate / config->sample_rate;
+
+    demod->dc = MODEM_ADC_MIDPOINT << DC_SHIFT;
+    psk_demod_set_tracking(demod, false);
+    return 0;
+}
+
+void psk_demod_set_tracking(psk_demod_t *demod, bool tracking)
+{
+    demod->tracking = tracking;
+    memcpy(demod->loop_k, tracking ? demod->track_k : demod->acquire_k, sizeof(demod->loop_k));
+}
+
+void psk_demod_reset(psk_demod_t *demod)
+{
+    demod->acc_i = 0;
+    demod->acc_q = 0;
+    memset(demod->ring_i, 0, sizeof(demod->ring_i));
+    memset(demod->ring_q, 0, sizeof(demod->ring_q));
+    memset(demod->ring_power, 0, sizeof(demod->ring_power));
+    memset(demod->mf_i, 0, sizeof(demod->mf_i));
+    memset(demod->mf_q, 0, sizeof(demod->mf_q));
+    demod->sum_i = 0.0f;
+    demod->sum_q = 0.0f;
+    demod->sum_power = 0.0f;
+    demod->power = 0.0f;
+    demod->lock = 0.0f;
+    demod->fll_re = 0.0f;
+    demod->fll_im = 0.0f;
+    demod->ring_pos = 0;
+    demod->chip_pos = 0;
+    demod->loop_freq = 0.0f;
+    demod->nco.step = demod->carrier_step;
+    psk_demod_set_tracking(demod, false);
+}
+
+void psk_demod_skip(psk_demod_t *demod, size_t count, float dc)
+{
+    psk_demod_reset(demod);
+    demod->nco.phase += demod->nco.step * (uint32_t)count;
+    demod->dc = (int32_t)(dc * (1 << DC_SHIFT));
+}
+
+static float sign(float x)
+{
+    return x < 0.0f ? -1.0f : 1.0f;
+}
+
+static void psk_demod_loop(psk_demod_t *demod, float i, float q, float ref_i, float ref_q, float norm)
+{
+    float error;
+
+    // Lock indicator: cos(2 phi) for BPSK, -cos(4 phi) for QPSK, which sit at
+    // +1 when the constellation is on the loop's stable points.
+    float p = i * i + q * q + ENERGY_FLOOR;
+    float c2 = (i * i - q * q) / p;
+    float lock = c2;
+    if (demod->bits_per_symbol == 2)
+        lock = 1.0f - 2.0f * c2 * c2;
+    demod->lock += (lock - demod->lock) / (4.0f * demod->oversample);
+
+    // Frequency assist while acquiring: the differential product rotates by
+    // the residual offset each symbol whether or not the phase loop is
+    // locked. Raising it to the 2nd (BPSK) or 4th (QPSK) power strips the
+    // modulation; the average of that unit vector gives the rotation and, by
+    // its length, how coherent the estimate is, so noise barely moves the
+    // loop. It fades out as the phase loop locks so the two do not fight.
+    if (!demod->tracking)
+    {
+        float d_re = i * ref_i + q * ref_q;
+        float d_im = q * ref_i - i * ref_q;
+        float mag = sqrtf(d_re * d_re + d_im * d_im) + ENERGY_FLOOR;
+        float u_re = d_re / mag;
+        float u_im = d_im / mag;
+        for (uint8_t k = 0; k < demod->bits_per_symbol; k++)
+        {
+            float t = u_re * u_re - u_im * u_im;
+            u_im = 2.0f * u_re * u_im;
+            u_re = t;
+        }
+
+        float alpha = 1.0f / (2.0f * demod->oversample);
+        demod->fll_re += (u_re - demod->fll_re) * alpha;
+        demod->fll_im += (u_im - demod->fll_im) * alpha;
+
+        float coherence = demod->fll_re * demod->fll_re + demod->fll_im * demod->fll_im;
+        float rotation = atan2f(demod->fll_im, demod->fll_re) / (2 << (demod->bits_per_symbol - 1));
+        if (demod->lock > 0.0f)
+            coherence *= 1.0f - demod->lock;
+        demod->loop_freq += demod->fll_gain * coherence * rotation;
+    }
+
+    if (demod->bits_per_symbol == 1)
+        error = q * sign(i);
+    else
+        error = (q * sign(i) - i * sign(q)) * (float)M_SQRT1_2;
+
+    error *= norm;
+    if (error > 1.0f)
+        error = 1.0f;
+    else if (error < -1.0f)
+        error = -1.0f;
+
+    demod->loop_freq += demod->loop_k[1] * error;
+    if (demod->loop_freq > demod->loop_freq_limit)
+        demod->loop_freq = demod->loop_freq_limit;
+    else if (demod->loop_freq < -demod->loop_freq_limit)
+        demod->loop_freq = -demod->loop_freq_limit;
+
+    // Received phase ahead of the NCO gives a positive error: advance the NCO.
+    demod->nco.phase += (uint32_t)(int32_t)(demod->loop_k[0] * error * RAD_TO_PHASE);
+    demod->nco.step = demod->carrier_step + (uint32_t)(int32_t)(demod->loop_freq * demod->rad_per_chip_to_step);
+}
+
+static void psk_demod_emit(psk_demod_t *demod, psk_chip_t *chip)
+{
+    uint8_t pos = demod->ring_pos;
+
+    // x * e^{-j wt}: the chip is the carrier phasor relative to the NCO.
+    float ci = demod->acc_i * demod->chip_scale;
+    float cq = -demod->acc_q * demod->chip_scale;
+    float cp = ci * ci + cq * cq;
+    demod->acc_i = 0;
+    demod->acc_q = 0;
+
+    demod->sum_i += ci - demod->ring_i[pos];
+    demod->sum_q += cq - demod->ring_q[pos];
+    demod->sum_power += cp - demod->ring_power[pos];
+    demod->ring_i[pos] = ci;
+    demod->ring_q[pos] = cq;
+    demod->ring_power[pos] = cp;
+
+    float i = demod->sum_i;
+    float q = demod->sum_q;
+    float p = i * i + q * q;
+    float ref_i = demod->mf_i[pos];
+    float ref_q = demod->mf_q[pos];
+    demod->mf_i[pos] = i;
+    demod->mf_q[pos] = q;
+
+    demod->power += (p - demod->power) / (4.0f * demod->oversample);
+    float norm = 1.0f / (sqrtf(demod->power) + ENERGY_FLOOR);
+
+    chip->sync = (i * ref_i + q * ref_q) / (0.5f * (p + ref_i * ref_i + ref_q * ref_q) + ENERGY_FLOOR);
+    chip->strength = p / (demod->oversample * demod->sum_power + ENERGY_FLOOR);
+    chip->level = sqrtf(p);
+
+    // Once locked, BPSK sits on the I axis and QPSK on the diagonals; what is
+    // left off them is noise (counted for both dimensions).
+    if (demod->bits_per_symbol == 1)
+        chip->noise = 2.0f * q * q;
+    else
+        chip->noise = (fabsf(i) - fabsf(q)) * (fabsf(i) - fabsf(q));
+
+    // Coherent decision against the previous symbol's hard decision.
+    if (demod->bits_per_symbol == 1)
+    {
+        chip->soft[0] = i * sign(ref_i) * norm;
+        chip->soft[1] = 0.0f;
+    }
+    else
+    {
+        // d = z * conj(s) rotated by +45 degrees: 0 -> 11, 90 -> 01, 180 -> 00, 270 -> 10.
+        float si = sign(ref_i);
+        float sq = sign(ref_q);
+        float d_re = i * si + q * sq;
+        float d_im = q * si - i * sq;
+        chip->soft[0] = (d_re - d_im) * 0.5f * norm;
+        chip->soft[1] = (d_re + d_im) * 0.5f * norm;
+    }
+
+    psk_demod_loop(demod, i, q, ref_i, ref_q, norm);
+
+    demod->ring_pos = (pos + 1 == demod->oversample) ? 0 : pos + 1;
+}
+
+size_t psk_demod_process(psk_demod_t *demod, const uint16_t *samples, size_t count,
+                         psk_chip_t *chips, size_t max_chips, size_t *num_chips)
+{
+    size_t produced = 0;
+    size_t i = 0;
+
+    while (i < count && produced < max_chips)
+    {
+        int32_t x = ((int32_t)samples[i++] << DC_SHIFT) - demod->dc;
+        demod->dc += x >> DC_SHIFT;
+        x >>= DC_SHIFT;
+
+        demod->acc_i += (x * nco_cos(&demod->nco)) >> MIX_SHIFT;
+        demod->acc_q += (x * nco_sin(&demod->nco)) >> MIX_SHIFT;
+        nco_advance(&demod->nco);
+
+        demod->chip_pos += 1u << 16;
+        if (demod->chip_pos >= demod->chip_len)
+        {
+            demod->chip_pos -= demod->chip_len;
+            psk_demod_emit(demod, &chips[produced++]);
+        }
+    }
+
+    if (num_chips)
+        *num_chips = produced;
+    return i;
+}
+
+float psk_demod_offset_hz(const psk_demod_t *demod)
+{
+    return demod->loop_freq * demod->chip_rate / (2.0f * (float)M_PI);
+}
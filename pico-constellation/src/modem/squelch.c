@@ -0,0 +1,109 @@
+#include "modem/squelch.h"
+
+#include <math.h>
+#include <string.h>
+
+#include "modem/modem_profile.h"
+
+#define FLOOR_FALL_SHIFT 2 // floor tracks quieter blocks within a few blocks
+#define FLOOR_RISE_SHIFT 8 // and louder ones over a few hundred (~0.8 s)
+
+void squelch_default_config(squelch_config_t *config)
+{
+    config->open_db = 9.0f;
+    config->close_db = 5.0f;
+    config->attack = 2;
+    config->hang = 16;
+    config->min_floor = 4.0f;
+}
+
+int squelch_init(squelch_t *squelch, const squelch_config_t *config)
+{
+    if (!squelch || !config || config->open_db < config->close_db)
+        return -1;
+
+    memset(squelch, 0, sizeof(*squelch));
+    squelch->open_ratio = powf(10.0f, config->open_db / 10.0f);
+    squelch->close_ratio = powf(10.0f, config->close_db / 10.0f);
+    squelch->attack = config->attack ? config->attack : 1;
+    squelch->hang = config->hang ? config->hang : 1;
+    squelch->min_floor = config->min_floor;
+    squelch->floor = config->min_floor;
+    squelch->mean = MODEM_ADC_MIDPOINT;
+    return 0;
+}
+
+static float squelch_block_energy(squelch_t *squelch, const uint16_t *samples, size_t count)
+{
+    int32_t sum = 0;
+    uint32_t sum_sq = 0;
+
+    for (size_t i = 0; i < count; i++)
+    {
+        int32_t x = (int32_t)samples[i] - MODEM_ADC_MIDPOINT;
+        sum += x;
+        sum_sq += (uint32_t)(x * x);
+    }
+
+    float mean = (float)sum / count;
+    squelch->mean = MODEM_ADC_MIDPOINT + mean;
+    return (float)sum_sq / count - mean * mean;
+}
+
+bool squelch_update(squelch_t *squelch, const uint16_t *samples, size_t count)
+{
+    if (!count)
+        return squelch->open;
+
+    if (count > SQUELCH_BLOCK_SIZE)
+        count = SQUELCH_BLOCK_SIZE;
+
+    float energy = squelch_block_energy(squelch, samples, count);
+    squelch->energy = energy;
+    squelch->blocks++;
+
+    if (!squelch->open)
+    {
+        if (energy > squelch->floor * squelch->open_ratio)
+        {
+            if (++squelch->count >= squelch->attack)
+            {
+                squelch->open = true;
+                squelch->count = 0;
+            }
+        }
+        else
+        {
+            squelch->count = 0;
+            float delta = energy - squelch->floor;
+            squelch->floor += delta < 0.0f ? delta / (1 << FLOOR_FALL_SHIFT) : delta / (1 << FLOOR_RISE_SHIFT);
+            if (squelch->floor < squelch->min_floor)
+                squelch->floor = squelch->min_floor;
+        }
+    }
+    else
+    {
+        squelch->open_blocks++;
+        if (energy < squelch->floor * squelch->close_ratio)
+        {
+            if (++squelch->count >= squelch->hang)
+            {
+                squelch->open = false;
+                squelch->count = 0;
+            }
+        }
+        else
+        {
+            squelch->count = 0;
+        }
+    }
+
+    return squelch->open;
+}
+
+void squelch_relearn(squelch_t *squelch)
+{
+    squelch->floor = squelch->energy > squelch->min_floor ? squelch->energy : squelch->min_floor;
+    squelch->open = false;
+    squelch->count = 0;
+}
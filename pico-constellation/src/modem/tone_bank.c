@@ -0,0 +1,128 @@
+#include "modem/tone_bank.h"
+
+#include <math.h>
+#include <string.h>
+
+#define DC_ALPHA (1.0f / 1024.0f)
+
+int tone_bank_init(tone_bank_t *bank, const tone_bank_config_t *config)
+{
+    if (!bank || !config || !config->tone_hz)
+        return -1;
+
+    if (!config->tones || config->tones > TONE_BANK_MAX_TONES)
+        return -1;
+
+    if (!config->baud || !config->oversample || config->oversample > MODEM_MAX_OVERSAMPLE)
+        return -1;
+
+    memset(bank, 0, sizeof(*bank));
+    bank->tones = config->tones;
+    bank->oversample = config->oversample;
+
+    for (int k = 0; k < bank->tones; k++)
+    {
+        float w = 2.0f * (float)M_PI * config->tone_hz[k] / config->sample_rate;
+        bank->coeff[k] = 2.0f * cosf(w);
+        bank->cos_w[k] = cosf(w);
+        bank->sin_w[k] = sinf(w);
+        nco_init(&bank->reference[k], config->tone_hz[k], config->sample_rate);
+    }
+
+    bank->chip_len = (uint32_t)(((uint64_t)config->sample_rate << 16) /
+                                ((uint32_t)config->baud * config->oversample));
+    bank->dc = MODEM_ADC_MIDPOINT;
+    return 0;
+}
+
+void tone_bank_reset(tone_bank_t *bank)
+{
+    memset(bank->s1, 0, sizeof(bank->s1));
+    memset(bank->s2, 0, sizeof(bank->s2));
+    memset(bank->ring_re, 0, sizeof(bank->ring_re));
+    memset(bank->ring_im, 0, sizeof(bank->ring_im));
+    memset(bank->sum_re, 0, sizeof(bank->sum_re));
+    memset(bank->sum_im, 0, sizeof(bank->sum_im));
+    bank->ring_pos = 0;
+    bank->chip_pos = 0;
+    bank->chip_samples = 0;
+}
+
+void tone_bank_skip(tone_bank_t *bank, size_t count, float dc)
+{
+    tone_bank_reset(bank);
+
+    for (int k = 0; k < bank->tones; k++)
+    {
+        bank->reference[k].phase += bank->reference[k].step * (uint32_t)count;
+    }
+
+    bank->dc = dc;
+}
+
+static void tone_bank_emit(tone_bank_t *bank, tone_bank_chip_t *chip)
+{
+    uint8_t pos = bank->ring_pos;
+    chip->total = 0.0f;
+
+    for (int k = 0; k < bank->tones; k++)
+    {
+        // y = s1 - s2 e^{-jw} is the chip DFT referenced to its last sample;
+        // rotate by e^{-j phase} to the common reference.
+        float y_re = bank->s1[k] - bank->s2[k] * bank->cos_w[k];
+        float y_im = bank->s2[k] * bank->sin_w[k];
+
+        // The NCO has already stepped past the last sample.
+        nco_t last = {bank->reference[k].phase - bank->reference[k].step, 0};
+        float c = nco_cos(&last) * (1.0f / 32767.0f);
+        float s = nco_sin(&last) * (1.0f / 32767.0f);
+        float re = y_re * c + y_im * s;
+        float im = y_im * c - y_re * s;
+
+        bank->sum_re[k] += re - bank->ring_re[k][pos];
+        bank->sum_im[k] += im - bank->ring_im[k][pos];
+        bank->ring_re[k][pos] = re;
+        bank->ring_im[k][pos] = im;
+        bank->s1[k] = 0.0f;
+        bank->s2[k] = 0.0f;
+
+        chip->energy[k] = bank->sum_re[k] * bank->sum_re[k] + bank->sum_im[k] * bank->sum_im[k];
+        chip->total += chip->energy[k];
+    }
+
+    bank->ring_pos = (pos + 1 == bank->oversample) ? 0 : pos + 1;
+    bank->chip_samples = 0;
+}
+
+size_t tone_bank_process(tone_bank_t *bank, const uint16_t *samples, size_t count,
+                         tone_bank_chip_t *chips, size_t max_chips, size_t *num_chips)
+{
+    size_t produced = 0;
+    size_t i = 0;
+
+    while (i < count && produced < max_chips)
+    {
+        float x = (float)samples[i++] - bank->dc;
+        bank->dc += x * DC_ALPHA;
+
+        for (int k = 0; k < bank->tones; k++)
+        {
+            float s = x + bank->coeff[k] * bank->s1[k] - bank->s2[k];
+            bank->s2[k] = bank->s1[k];
+            bank->s1[k] = s;
+            nco_advance(&bank->reference[k]);
+        }
+        bank->chip_samples++;
+
+        bank->chip_pos += 1u << 16;
+        if (bank->chip_pos >= bank->chip_len)
+        {
+            bank->chip_pos -= bank->chip_len;
+            tone_bank_emit(bank, &chips[produced++]);
+        }
+    }
+
+    if (num_chips)
+        *num_chips = produced;
+    return i;
+}
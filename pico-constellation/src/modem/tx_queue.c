@@ -0,0 +1,193 @@
+#include "modem/tx_queue.h"
+
+#include <string.h>
+
+#include "modem/ax25_tx.h"
+#include "modem/modem_frame.h"
+
+int tx_queue_init(tx_queue_t *queue, const modem_profile_t *profile)
+{
+    if (!queue || !profile)
+        return -1;
+
+    memset(queue, 0, sizeof(*queue));
+    if (fsk_mod_init(&queue->mod, profile, 0))
+        return -1;
+
+    queue->profile = profile;
+    queue->width = fsk_mod_symbol_width(&queue->mod);
+    queue->on_air = -1;
+    return 0;
+}
+
+size_t tx_queue_depth(const tx_queue_t *queue)
+{
+    size_t depth = 0;
+    for (int i = 0; i < TX_QUEUE_SLOTS; i++)
+        depth += queue->frames[i].used && i != queue->on_air;
+    return depth;
+}
+
+// A free slot, or one taken from a frame of lower priority than the new one; -1 if the new one is dropped.
+static int claim_slot(tx_queue_t *queue, tx_priority_t priority)
+{
+    int victim = -1;
+
+    for (int i = 0; i < TX_QUEUE_SLOTS; i++)
+    {
+        const tx_frame_t *frame = &queue->frames[i];
+        if (!frame->used)
+            return i;
+        if (i == queue->on_air || frame->priority <= priority)
+            continue;
+
+        // The lowest priority, and the newest of those.
+        const tx_frame_t *worst = victim < 0 ? NULL : &queue->frames[victim];
+        if (!worst || frame->priority > worst->priority ||
+            (frame->priority == worst->priority && frame->seq > worst->seq))
+            victim = i;
+    }
+
+    if (victim < 0)
+    {
+        queue->stats.dropped[priority]++;
+        return -1;
+    }
+
+    queue->stats.dropped[queue->frames[victim].priority]++;
+    queue->frames[victim].used = false;
+    return victim;
+}
+
+static int32_t commit(tx_queue_t *queue, int slot, tx_priority_t priority, size_t count, uint64_t now_us)
+{
+    tx_frame_t *frame = &queue->frames[slot];
+
+    frame->count = (uint16_t)count;
+    frame->priority = (uint8_t)priority;
+    frame->used = true;
+    frame->seq = queue->next_seq++;
+    frame->id = queue->next_id++;
+    frame->queued_us = now_us;
+
+    queue->stats.queued[priority]++;
+    size_t depth = tx_queue_depth(queue);
+    if (depth > queue->stats.max_depth)
+        queue->stats.max_depth = (uint32_t)depth;
+    return (int32_t)frame->id;
+}
+
+int32_t tx_queue_push_frame(tx_queue_t *queue, tx_priority_t priority, uint8_t dst, uint8_t src,
+                            const uint8_t *payload, size_t len, uint64_t now_us)
+{
+    uint8_t bits[(MODEM_FRAME_MAX_BITS + 7) / 8];
+    size_t num_bits = 0;
+
+    if (priority >= TX_PRIORITY_COUNT ||
+        modem_frame_build(dst, src, payload, len, bits, sizeof(bits), &num_bits))
+    {
+        queue->stats.rejected++;
+        return -1;
+    }
+
+    int slot = claim_slot(queue, priority);
+    if (slot < 0)
+        return -1;
+
+    // Symbols go in LSB first, each value's own bits LSB first.
+    uint8_t *out = queue->frames[slot].symbols;
+    size_t shared_bits = MODEM_FRAME_PREAMBLE_BITS + MODEM_FRAME_SYNC_BITS;
+    size_t pos = 0;
+    size_t count = 0;
+
+    memset(out, 0, sizeof(queue->frames[slot].symbols));
+    while (pos < num_bits)
+    {
+        unsigned symbol = fsk_mod_next_symbol(&queue->mod, bits, num_bits, shared_bits, &pos);
+        size_t at = count++ * queue->width;
+        for (unsigned b = 0; b < queue->width; b++, at++)
+            out[at >> 3] |= (uint8_t)(((symbol >> b) & 1) << (at & 7));
+    }
+
+    return commit(queue, slot, priority, count, now_us);
+}
+
+int32_t tx_queue_push_ax25(tx_queue_t *queue, tx_priority_t priority, const uint8_t *frame, size_t len,
+                           uint16_t lead_flags, uint16_t tail_flags, uint64_t now_us)
+{
+    static uint8_t line[TX_QUEUE_MAX_BITS / 8];
+
+    size_t count = 0;
+    if (queue->profile->modulation == MODEM_MOD_FSK && queue->profile->carriers == 1)
+        count = ax25_tx_line_bits(frame, len, lead_flags, tail_flags, line, TX_QUEUE_MAX_BITS);
+    if (priority >= TX_PRIORITY_COUNT || count == 0)
+    {
+        queue->stats.rejected++;
+        return -1;
+    }
+
+    int slot = claim_slot(queue, priority);
+    if (slot < 0)
+        return -1;
+
+    memcpy(queue->frames[slot].symbols, line, (count + 7) / 8);
+    return commit(queue, slot, priority, count, now_us);
+}
+
+const tx_frame_t *tx_queue_next(tx_queue_t *queue, uint64_t now_us)
+{
+    int best = -1;
+
+    if (queue->on_air >= 0)
+        return NULL;
+
+    for (int i = 0; i < TX_QUEUE_SLOTS; i++)
+    {
+        const tx_frame_t *frame = &queue->frames[i];
+        if (!frame->used)
+            continue;
+        if (best < 0 || frame->priority < queue->frames[best].priority ||
+            (frame->priority == queue->frames[best].priority && frame->seq < queue->frames[best].seq))
+            best = i;
+    }
+
+    if (best < 0)
+        return NULL;
+
+    tx_frame_t *frame = &queue->frames[best];
+    uint64_t wait = now_us > frame->queued_us ? now_us - frame->queued_us : 0;
+    queue->stats.wait_total_us[frame->priority] += wait;
+    if (wait > queue->stats.wait_max_us[frame->priority])
+        queue->stats.wait_max_us[frame->priority] = wait > UINT32_MAX ? UINT32_MAX : (uint32_t)wait;
+
+    queue->on_air = best;
+    return frame;
+}
+
+void tx_queue_done(tx_queue_t *queue)
+{
+    if (queue->on_air < 0)
+        return;
+
+    tx_frame_t *frame = &queue->frames[queue->on_air];
+    queue->stats.sent[frame->priority]++;
+    frame->used = false;
+    queue->on_air = -1;
+}
+
+size_t tx_queue_symbols(const tx_queue_t *queue, const tx_frame_t *frame, size_t first, uint8_t *out,
+                        size_t count)
+{
+    size_t n = 0;
+
+    for (size_t i = first; i < frame->count && n < count; i++)
+    {
+        size_t at = i * queue->width;
+        unsigned symbol = 0;
+        for (unsigned b = 0; b < queue->width; b++, at++)
+            symbol |= (unsigned)((frame->symbols[at >> 3] >> (at & 7)) & 1) << b;
+        out[n++] = (uint8_t)symbol;
+    }
+
+    return n;
+}
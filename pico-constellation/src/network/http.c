@@ -0,0 +1,160 @@
+#include "network/http.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include "c-logger.h"
+
+static http_method_t parse_http_method(const char *s)
+{
+    if (strcmp(s, "GET") == 0)
+        return HTTP_METHOD_GET;
+    if (strcmp(s, "POST") == 0)
+        return HTTP_METHOD_POST;
+    if (strcmp(s, "PUT") == 0)
+        return HTTP_METHOD_PUT;
+    if (strcmp(s, "DELETE") == 0)
+        return HTTP_METHOD_DELETE;
+    return HTTP_METHOD_UNKNOWN;
+}
+
+static int hex(char c)
+{
+    if (c >= '0' && c <= '9')
+        return c - '0';
+    if (c >= 'a' && c <= 'f')
+        return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F')
+        return c - 'A' + 10;
+    return 0;
+}
+
+void url_decode(char *dst, const char *src)
+{
+    while (*src)
+    {
+        if (*src == '%')
+        {
+            if (src[1] && src[2])
+            {
+                *dst++ = (hex(src[1]) << 4) | hex(src[2]);
+                src += 3;
+            }
+            else
+                break;
+        }
+        else if (*src == '+')
+        {
+            *dst++ = ' ';
+            src++;
+        }
+        else
+        {
+            *dst++ = *src++;
+        }
+    }
+    *dst = '\0';
+}
+
+int parse_http_request(char *request, http_request_t *req)
+{
+    if (!request || !req)
+    {
+        LOG_ERROR("request or req is NULL");
+        return -1;
+    }
+
+    memset(req, 0, sizeof(*req));
+
+    // Find the start of the body.
+    char *body = strstr(request, "\r\n\r\n");
+    if (body)
+    {
+        *body = '\0';
+        body += 4;
+
+        size_t body_len = strlen(body);
+        if (body_len >= HTML_MAX_QUERY_LEN)
+        {
+            LOG_ERROR("Body too large");
+            return -1;
+        }
+        url_decode(req->body, body);
+        //memcpy(req->body, body, body_len + 1);
+    }
+
+    // Parse request line.
+    char *method = request;
+    char *space = strchr(method, ' ');
+    if (!space)
+    {
+        LOG_ERROR("Malformed request");
+        return -1;
+    }
+
+    *space++ = '\0';
+    while (*space == ' ')
+        space++;
+
+    char *path = space;
+
+    space = strchr(path, ' ');
+    if (!space)
+    {
+        LOG_ERROR("Malformed request");
+        return -1;
+    }
+
+    *space = '\0';
+
+    // Split query string from path.
+    char *query = strchr(path, '?');
+    if (query)
+    {
+        *query++ = '\0';
+    }
+
+    req->method = parse_http_method(method);
+    if (req->method == HTTP_METHOD_UNKNOWN)
+    {
+        LOG_ERROR("Unknown HTTP method");
+        return -1;
+    }
+
+    if (strlen(path) >= HTML_MAX_PATH_LEN)
+    {
+        LOG_ERROR("Path too long");
+        return -1;
+    }
+
+    strcpy(req->path, path);
+
+    if (query)
+    {
+        if (strlen(query) >= HTML_MAX_QUERY_LEN)
+        {
+            LOG_ERROR("Query too long");
+            return -1;
+        }
+
+        strcpy(req->query, query);
+    }
+
+    return 0;
+}
+
+bool http_request_complete(const char *request, size_t request_len)
+{
+    const char *end = strstr(request, "\r\n\r\n");
+    if (!end)
+        return false;
+
+    size_t header_len = end - request + 4;
+
+    const char *cl = strstr(request, "Content-Length:");
+    if (!cl)
+        return true; // GET, HEAD, etc.
+
+    size_t body_len = atoi(cl + 15);
+
+    return request_len >= header_len + body_len;
+}
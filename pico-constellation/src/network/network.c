@@ -1,4 +1,5 @@
 #include "network/network.h"
+#include "network/http.h"
 #include "pico/cyw43_arch.h"
 #include "pico/stdlib.h"
 
@@ -53,7 +54,6 @@ static err_t tcp_server_poll(void *arg, struct tcp_pcb *pcb);
 static void tcp_server_err(void *arg, err_t err);
 static err_t tcp_server_accept(void *arg, struct tcp_pcb *client_pcb, err_t err);
 static bool tcp_server_open(void *arg, const char *ap_name);
-static int parse_http_request(char *request_line, http_request_t *req);
 
 static TCP_SERVER_T *state;
 static dhcp_server_t dhcp_server;
@@ -167,161 +167,6 @@ static err_t tcp_server_sent(void *arg, struct tcp_pcb *pcb, u16_t len)
     return ERR_OK;
 }
 
-static http_method_t parse_http_method(const char *s)
-{
-    if (strcmp(s, "GET") == 0)
-        return HTTP_METHOD_GET;
-    if (strcmp(s, "POST") == 0)
-        return HTTP_METHOD_POST;
-    if (strcmp(s, "PUT") == 0)
-        return HTTP_METHOD_PUT;
-    if (strcmp(s, "DELETE") == 0)
-        return HTTP_METHOD_DELETE;
-    return HTTP_METHOD_UNKNOWN;
-}
-
-static int hex(char c)
-{
-    if (c >= '0' && c <= '9')
-        return c - '0';
-    if (c >= 'a' && c <= 'f')
-        return c - 'a' + 10;
-    if (c >= 'A' && c <= 'F')
-        return c - 'A' + 10;
-    return 0;
-}
-
-static void url_decode(char *dst, const char *src)
-{
-    while (*src)
-    {
-        if (*src == '%')
-        {
-            if (src[1] && src[2])
-            {
-                *dst++ = (hex(src[1]) << 4) | hex(src[2]);
-                src += 3;
-            }
-            else
-                break;
-        }
-        else if (*src == '+')
-        {
-            *dst++ = ' ';
-            src++;
-        }
-        else
-        {
-            *dst++ = *src++;
-        }
-    }
-    *dst = '\0';
-}
-
-static int parse_http_request(char *request, http_request_t *req)
-{
-    if (!request || !req)
-    {
-        LOG_ERROR("request or req is NULL");
-        return -1;
-    }
-
-    memset(req, 0, sizeof(*req));
-
-    // Find the start of the body.
-    char *body = strstr(request, "\r\n\r\n");
-    if (body)
-    {
-        *body = '\0';
-        body += 4;
-
-        size_t body_len = strlen(body);
-        if (body_len >= HTML_MAX_QUERY_LEN)
-        {
-            LOG_ERROR("Body too large");
-            return -1;
-        }
-        url_decode(req->body, body);
-        //memcpy(req->body, body, body_len + 1);
-    }
-
-    // Parse request line.
-    char *method = request;
-    char *space = strchr(method, ' ');
-    if (!space)
-    {
-        LOG_ERROR("Malformed request");
-        return -1;
-    }
-
-    *space++ = '\0';
-    while (*space == ' ')
-        space++;
-
-    char *path = space;
-
-    space = strchr(path, ' ');
-    if (!space)
-    {
-        LOG_ERROR("Malformed request");
-        return -1;
-    }
-
-    *space = '\0';
-
-    // Split query string from path.
-    char *query = strchr(path, '?');
-    if (query)
-    {
-        *query++ = '\0';
-    }
-
-    req->method = parse_http_method(method);
-    if (req->method == HTTP_METHOD_UNKNOWN)
-    {
-        LOG_ERROR("Unknown HTTP method");
-        return -1;
-    }
-
-    if (strlen(path) >= HTML_MAX_PATH_LEN)
-    {
-        LOG_ERROR("Path too long");
-        return -1;
-    }
-
-    strcpy(req->path, path);
-
-    if (query)
-    {
-        if (strlen(query) >= HTML_MAX_QUERY_LEN)
-        {
-            LOG_ERROR("Query too long");
-            return -1;
-        }
-
-        strcpy(req->query, query);
-    }
-
-    return 0;
-}
-
-static bool http_request_complete(TCP_CONNECT_STATE_T *con)
-{
-    char *end = strstr(con->request, "\r\n\r\n");
-    if (!end)
-        return false;
-
-    size_t header_len = end - con->request + 4;
-
-    char *cl = strstr(con->request, "Content-Length:");
-    if (!cl)
-        return true; // GET, HEAD, etc.
-
-    size_t body_len = atoi(cl + 15);
-
-    return con->request_len >= header_len + body_len;
-}
-
 err_t tcp_server_recv(void *arg, struct tcp_pcb *pcb, struct pbuf *p, err_t err)
 {
     TCP_CONNECT_STATE_T *con = (TCP_CONNECT_STATE_T *)arg;
@@ -357,7 +202,7 @@ err_t tcp_server_recv(void *arg, struct tcp_pcb *pcb, struct pbuf *p, err_t err)
     tcp_recved(pcb, p->tot_len);
 
     // Wait until the full HTTP request has arrived.
-    if (!http_request_complete(con))
+    if (!http_request_complete(con->request, con->request_len))
     {
         pbuf_free(p);
         return ERR_OK;
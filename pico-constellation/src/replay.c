@@ -0,0 +1,240 @@
+/**
+ * @file replay.c
+ *
+ * @brief Replays a capture built into flash through the receive path, as fast as it will go.
+ *
+ * The capture (scripts/convert_to_header.py output, generated at build
+ * time from REPLAY_CAPTURE) takes the ADC's place: adc_hal's DMA channel
+ * reads it from flash instead of the ADC FIFO, unpaced, and only waits
+ * when the ring is full. Everything after that is the firmware's own
+ * path: the DMA interrupt and ring, adc_bsp_read (ring copy, waterfall
+ * and link test feeds), then modem_rx on each block. The per-sample push
+ * into the constellation library's buffer is left out; its ring belongs
+ * to the library.
+ *
+ * Each pass over the capture prints a CSV row over USB with the cycles
+ * per sample of each stage, the frames decoded and the real-time factor,
+ * the most this board could keep up with. The squelch and frame timers
+ * see capture time, not wall time. The DMA interrupt is not timed on its
+ * own; it lands in whichever stage it interrupts.
+ *
+ * Build with `make pico-constellation-replay`; set REPLAY_CAPTURE and
+ * REPLAY_PROFILE when configuring.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include "pico/stdlib.h"
+#include "hardware/clocks.h"
+#include "c-logger.h"
+#include "adc_hal.h"
+#include "adc_bsp.h"
+#include "adc_bsp_tap.h"
+#include "modem/modem_rx.h"
+#include "ui/waterfall.h"
+#include "ui/link_test.h"
+#include "audio_data.h"
+
+#if PICO_RP2350
+#include "hardware/structs/m33.h"
+#endif
+
+#ifndef REPLAY_PROFILE
+#define REPLAY_PROFILE MODEM_PROFILE_FSK_32
+#endif
+
+#define REPLAY_PASSES 4
+#define REPLAY_SAMPLE_RATE 79200
+#define REPLAY_REPORT_MS 5000      // the summary repeats for a late terminal
+#define REPLAY_CHUNK 1024          // adc_bsp's DMA transfer; the capture replays in whole chunks
+#define BLOCK_SAMPLES 1024
+#define REPLAY_LEN (AUDIO_DATA_LEN - AUDIO_DATA_LEN % REPLAY_CHUNK)
+
+typedef struct replay_stats
+{
+    uint64_t samples;
+    uint64_t total_cycles;
+    uint64_t bsp_cycles;           // adc_bsp_read
+    modem_rx_timing_t timing;      // in cycles, see cycles()
+    uint32_t frames;
+    uint32_t bad_crc;
+} replay_stats_t;
+
+static uint16_t block[BLOCK_SAMPLES];
+static modem_rx_t rx;
+static uint64_t samples_fetched = 0;
+static uint32_t frames_decoded = 0;
+
+/**
+ * @brief Free-running cycle count, extended to 64 bits.
+ *
+ * The RP2350's Cortex-M33 has the DWT cycle counter; it wraps every half
+ * minute or so, which the main loop always notices. The RP2040 has none,
+ * so it falls back to the microsecond timer scaled by clk_sys.
+ */
+static void cycles_init(void)
+{
+#if PICO_RP2350
+    m33_hw->demcr |= M33_DEMCR_TRCENA_BITS;
+    m33_hw->dwt_cyccnt = 0;
+    m33_hw->dwt_ctrl |= M33_DWT_CTRL_CYCCNTENA_BITS;
+#endif
+}
+
+static uint64_t cycles(void)
+{
+#if PICO_RP2350
+    static uint32_t last = 0;
+    static uint64_t high = 0;
+    uint32_t now = m33_hw->dwt_cyccnt;
+    if (now < last)
+        high += 1ull << 32;
+    last = now;
+    return high | now;
+#else
+    return time_us_64() * (clock_get_hz(clk_sys) / 1000000);
+#endif
+}
+
+// The capture's own timeline, so squelch and frame timeouts behave as on air.
+static uint64_t replay_time_us(void)
+{
+    return samples_fetched * 1000000 / REPLAY_SAMPLE_RATE;
+}
+
+static void frame_callback(void *ctx, const uint8_t *data, size_t len, uint8_t src_addr)
+{
+    (void)ctx;
+    (void)data;
+    (void)len;
+    (void)src_addr;
+    frames_decoded++;
+}
+
+// The firmware's own consumers of each ADC block, as main registers them.
+static void sample_tap(const uint16_t *samples, size_t count)
+{
+    waterfall_feed(samples, count);
+    link_test_feed(samples, count);
+}
+
+static void run_pass(replay_stats_t *stats)
+{
+    uint64_t first = samples_fetched;
+    uint64_t target = samples_fetched + REPLAY_LEN;
+    uint64_t start = cycles();
+
+    frames_decoded = 0;
+
+    while (samples_fetched < target)
+    {
+        const uint16_t *samples;
+        uint64_t t0 = cycles();
+        size_t count = adc_bsp_read(&samples);
+        stats->bsp_cycles += cycles() - t0;
+
+        for (size_t i = 0; i < count; i += BLOCK_SAMPLES)
+        {
+            size_t n = count - i < BLOCK_SAMPLES ? count - i : BLOCK_SAMPLES;
+            samples_fetched += n;
+            modem_rx_process(&rx, samples + i, n);
+        }
+    }
+
+    stats->total_cycles += cycles() - start;
+    stats->samples += samples_fetched - first;
+    stats->frames += frames_decoded;
+}
+
+static void print_row(const char *name, const replay_stats_t *stats)
+{
+    double samples = (double)stats->samples;
+    double seconds = (double)stats->total_cycles / clock_get_hz(clk_sys);
+    uint64_t staged = stats->bsp_cycles + stats->timing.squelch_ns + stats->timing.front_ns +
+                      stats->timing.chips_ns;
+
+    printf("%s,%llu,%lu,%.1f,%.1f,%.1f,%.1f,%.1f,%.1f,%lu,%lu,%.2f\n", name,
+           (unsigned long long)stats->samples, (unsigned long)(clock_get_hz(clk_sys) / 1000000),
+           stats->total_cycles / samples, stats->bsp_cycles / samples,
+           stats->timing.squelch_ns / samples, stats->timing.front_ns / samples, stats->timing.chips_ns / samples,
+           (stats->total_cycles - staged) / samples, (unsigned long)stats->frames,
+           (unsigned long)stats->bad_crc, samples / REPLAY_SAMPLE_RATE / seconds);
+}
+
+int main(void)
+{
+    replay_stats_t total = {0};
+
+    stdio_init_all();
+    sleep_ms(2000); // Wait for USB to initialize
+    log_init(LOG_LEVEL_WARN);
+    cycles_init();
+
+    // adc_bsp sets the ring up and starts the ADC; restart it on the capture.
+    adc_bsp_init(REPLAY_SAMPLE_RATE);
+    waterfall_init(REPLAY_SAMPLE_RATE);
+    adc_bsp_set_tap(sample_tap);
+    adc_hal_stop();
+    int stale;
+    do
+    {
+        adc_hal_get_samples(block, BLOCK_SAMPLES, &stale);
+    } while (stale > 0);
+
+    if (adc_hal_set_replay(audio_data, AUDIO_DATA_LEN) || adc_hal_start())
+    {
+        LOG_FATAL("Failed to start the replay");
+        return -1;
+    }
+
+    const modem_profile_t *profile = modem_profile_get(REPLAY_PROFILE);
+    if (!profile || modem_rx_init(&rx, profile, frame_callback, NULL))
+    {
+        LOG_FATAL("Failed to initialize the receiver");
+        return -1;
+    }
+    modem_rx_set_squelch(&rx, true, NULL);
+    modem_rx_set_clock(&rx, replay_time_us);
+    modem_rx_set_timer(&rx, cycles);
+
+    printf("# replay of %u samples (%.2f s) at %u Hz, %s\n", (unsigned)REPLAY_LEN,
+           (double)REPLAY_LEN / REPLAY_SAMPLE_RATE, REPLAY_SAMPLE_RATE, profile->name);
+    printf("pass,samples,mhz,cycles_per_sample,bsp,squelch,front_end,sync_slice_frame,other,frames_ok,"
+           "bad_crc,x_realtime\n");
+
+    for (int pass = 0; pass < REPLAY_PASSES; pass++)
+    {
+        replay_stats_t stats = {0};
+        modem_rx_timing_t before = rx.timing;
+        uint32_t bad_crc = rx.stats.frames_bad_crc;
+
+        run_pass(&stats);
+        stats.timing.squelch_ns = rx.timing.squelch_ns - before.squelch_ns;
+        stats.timing.front_ns = rx.timing.front_ns - before.front_ns;
+        stats.timing.chips_ns = rx.timing.chips_ns - before.chips_ns;
+        stats.bad_crc = rx.stats.frames_bad_crc - bad_crc;
+
+        char name[8];
+        snprintf(name, sizeof(name), "%d", pass);
+        print_row(name, &stats);
+
+        total.samples += stats.samples;
+        total.total_cycles += stats.total_cycles;
+        total.bsp_cycles += stats.bsp_cycles;
+        total.timing.squelch_ns += stats.timing.squelch_ns;
+        total.timing.front_ns += stats.timing.front_ns;
+        total.timing.chips_ns += stats.timing.chips_ns;
+        total.frames += stats.frames;
+        total.bad_crc += stats.bad_crc;
+    }
+
+    adc_hal_stop();
+
+    while (true)
+    {
+        print_row("all", &total);
+        sleep_ms(REPLAY_REPORT_MS);
+    }
+
+    return 0;
+}
@@ -0,0 +1,240 @@
+#include "ui/link_test.h"
+
+#include <stdbool.h>
+#include <stdio.h>
+#include "c-logger.h"
+#include "modem/prbs_link.h"
+#include "dac_bsp.h"
+#include "ptt_bsp.h"
+#include "HAL_time.h"
+
+// 1: two-tone profiles are sent by ad9833_fsk, symbol edges timed by PIO
+// rather than the main loop.
+#ifndef LINK_TEST_PIO
+#define LINK_TEST_PIO 0
+#endif
+#define PIO_BURST 64 // symbols handed over at a time, two seconds at 32 baud
+
+#if LINK_TEST_PIO
+#include "ad9833_fsk.h"
+#endif
+
+static link_test_role_t role = LINK_TEST_OFF;
+static const modem_profile_t *profile;
+static prbs_type_t prbs_type;
+
+static prbs_link_tx_t tx;
+static uint64_t tx_start_us;
+static uint64_t tx_symbols;
+static bool tx_pio = false;
+
+static prbs_link_rx_t rx;
+static HAL_timer_t second_timer;
+
+int link_test_init(link_test_role_t new_role, modem_profile_id_t profile_id, prbs_type_t type)
+{
+    role = LINK_TEST_OFF;
+    if (new_role == LINK_TEST_OFF)
+    {
+        return 0;
+    }
+
+    profile = modem_profile_get(profile_id);
+    if (!profile)
+    {
+        LOG_ERROR("Link test: unknown profile %d", profile_id);
+        return -1;
+    }
+    prbs_type = type;
+
+    uint32_t burst_bits = prbs_link_burst_bits(profile);
+
+    if (new_role == LINK_TEST_TRANSMIT)
+    {
+        // The AD9833 makes one tone at a time.
+        if (modem_profile_tone_hz(profile, 0) == 0.0f || profile->modulation == MODEM_MOD_BPSK ||
+            profile->modulation == MODEM_MOD_QPSK)
+        {
+            LOG_ERROR("Link test: %s cannot be sent with the tone generator", profile->name);
+            return -1;
+        }
+
+        if (prbs_link_tx_init(&tx, profile, type, burst_bits))
+        {
+            LOG_ERROR("Link test: failed to initialize transmitter");
+            return -1;
+        }
+
+        tx_symbols = 0;
+        tx_pio = false;
+#if LINK_TEST_PIO
+        if (profile->modulation == MODEM_MOD_FSK && profile->carriers == 1)
+        {
+            if (ad9833_fsk_init() ||
+                ad9833_fsk_start(profile->tone_hz[0][0], profile->tone_hz[0][1], profile->baud))
+            {
+                LOG_ERROR("Link test: PIO symbol clock unavailable");
+                return -1;
+            }
+            tx_pio = true;
+        }
+#endif
+        tx_start_us = HAL_get_current_time_us();
+        ptt_bsp_set_ptt(true);
+    }
+    else
+    {
+        if (prbs_link_rx_init(&rx, profile, type, burst_bits))
+        {
+            LOG_ERROR("Link test: failed to initialize receiver");
+            return -1;
+        }
+    }
+
+    HAL_timer_start(&second_timer, ONE_SECOND);
+    role = new_role;
+    LOG_INFO("Link test: %s %s on %s", new_role == LINK_TEST_TRANSMIT ? "sending" : "receiving",
+             prbs_name(type), profile->name);
+    return 0;
+}
+
+void link_test_feed(const uint16_t *samples, size_t count)
+{
+    if (role == LINK_TEST_RECEIVE)
+    {
+        prbs_link_rx_process(&rx, samples, count);
+    }
+}
+
+static void link_test_transmit(void)
+{
+#if LINK_TEST_PIO
+    if (tx_pio)
+    {
+        // Keeps a burst waiting behind the one on air; the state machine does the timing.
+        static uint8_t burst[PIO_BURST];
+        static bool burst_ready = false;
+        if (!burst_ready)
+        {
+            for (int i = 0; i < PIO_BURST; i++)
+                burst[i] = (uint8_t)prbs_link_tx_symbol(&tx);
+            burst_ready = true;
+        }
+        if (ad9833_fsk_send(burst, PIO_BURST) == 0)
+        {
+            burst_ready = false;
+            tx_symbols += PIO_BURST;
+        }
+        return;
+    }
+#endif
+
+    // Symbol n starts at n / baud seconds, so rounding never accumulates.
+    uint64_t due_us = tx_start_us + tx_symbols * 1000000 / profile->baud;
+    if (HAL_get_current_time_us() < due_us)
+    {
+        return;
+    }
+
+    dac_bsp_set_tone(modem_profile_tone_hz(profile, prbs_link_tx_symbol(&tx)));
+    tx_symbols++;
+}
+
+static void link_test_report(void)
+{
+    const prbs_stats_t *stats = &rx.checker.stats;
+
+    prbs_link_rx_second(&rx);
+    LOG_INFO("Link test: %s, last %lu bits %lu errors, BER %.2e, EFS %lu ES %lu unsynced %lu, %.1f bit/s",
+             rx.checker.locked ? "locked" : "hunting",
+             (unsigned long)stats->last_bits,
+             (unsigned long)stats->last_errors,
+             prbs_checker_ber(&rx.checker),
+             (unsigned long)stats->error_free_seconds,
+             (unsigned long)stats->errored_seconds,
+             (unsigned long)stats->unsynced_seconds,
+             prbs_link_rx_throughput(&rx));
+}
+
+int link_test_task(void)
+{
+    if (role == LINK_TEST_OFF)
+    {
+        return 0;
+    }
+
+    if (role == LINK_TEST_TRANSMIT)
+    {
+        link_test_transmit();
+    }
+
+    if (HAL_timer_done(&second_timer))
+    {
+        HAL_timer_reset(&second_timer);
+        if (role == LINK_TEST_RECEIVE)
+        {
+            link_test_report();
+        }
+    }
+
+    return 0;
+}
+
+size_t link_test_to_json(char *buffer, size_t buffer_size)
+{
+    if (role == LINK_TEST_OFF)
+    {
+        return snprintf(buffer, buffer_size, "{\"role\":\"off\"}");
+    }
+
+    if (role == LINK_TEST_TRANSMIT)
+    {
+#if LINK_TEST_PIO
+        if (tx_pio)
+        {
+            ad9833_fsk_stats_t timing;
+            ad9833_fsk_get_stats(&timing);
+            return snprintf(buffer, buffer_size,
+                            "{\"role\":\"tx\",\"profile\":\"%s\",\"prbs\":\"%s\",\"symbols\":%llu,\"rate\":%lu,"
+                            "\"edges\":%lu,\"period_us\":%lu,\"max_error_us\":%lu,\"underruns\":%lu}",
+                            profile->name,
+                            prbs_name(prbs_type),
+                            (unsigned long long)tx_symbols,
+                            (unsigned long)modem_profile_bit_rate(profile),
+                            (unsigned long)timing.edges,
+                            (unsigned long)timing.period_us,
+                            (unsigned long)timing.max_error_us,
+                            (unsigned long)timing.underruns);
+        }
+#endif
+        return snprintf(buffer, buffer_size,
+                        "{\"role\":\"tx\",\"profile\":\"%s\",\"prbs\":\"%s\",\"symbols\":%llu,\"rate\":%lu}",
+                        profile->name,
+                        prbs_name(prbs_type),
+                        (unsigned long long)tx_symbols,
+                        (unsigned long)modem_profile_bit_rate(profile));
+    }
+
+    const prbs_stats_t *stats = &rx.checker.stats;
+    return snprintf(buffer, buffer_size,
+                    "{\"role\":\"rx\",\"profile\":\"%s\",\"prbs\":\"%s\",\"locked\":%d,\"bits\":%llu,\"errors\":%llu,"
+                    "\"ber\":%.3e,\"seconds\":%lu,\"efs\":%lu,\"es\":%lu,\"unsynced\":%lu,\"losses\":%lu,"
+                    "\"bursts\":%lu,\"false_syncs\":%lu,\"last_bits\":%lu,\"last_errors\":%lu,\"bps\":%.1f,\"rate\":%lu}",
+                    profile->name,
+                    prbs_name(prbs_type),
+                    rx.checker.locked,
+                    (unsigned long long)stats->bits,
+                    (unsigned long long)stats->errors,
+                    prbs_checker_ber(&rx.checker),
+                    (unsigned long)stats->seconds,
+                    (unsigned long)stats->error_free_seconds,
+                    (unsigned long)stats->errored_seconds,
+                    (unsigned long)stats->unsynced_seconds,
+                    (unsigned long)stats->sync_losses,
+                    (unsigned long)rx.bursts,
+                    (unsigned long)rx.false_syncs,
+                    (unsigned long)stats->last_bits,
+                    (unsigned long)stats->last_errors,
+                    prbs_link_rx_throughput(&rx),
+                    (unsigned long)modem_profile_bit_rate(profile));
+}
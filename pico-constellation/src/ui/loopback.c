@@ -0,0 +1,386 @@
+#include "ui/loopback.h"
+
+#include <math.h>
+#include <stdbool.h>
+#include <string.h>
+#include "c-logger.h"
+#include "adc_hal.h"
+#include "modem/fsk_mod.h"
+#include "modem/modem_frame.h"
+#include "modem/modem_rx.h"
+
+#define CHUNK 1024           // adc_bsp's DMA transfer
+#define READ_MAX (CHUNK * 3) // adc_bsp's read buffer
+#define TX_MAX 4096          // at least one symbol of the slowest profile
+#define REFERENCE_BANDWIDTH_HZ 3000.0f
+#define LOOPBACK_DST 0x02
+#define LOOPBACK_SRC 0x01
+#define SWEEP_GAP_S 0.1f     // loopback_max_baud's idle between frames in the self-test
+
+typedef struct loopback_state
+{
+    const loopback_config_t *config;
+    loopback_report_t *report;
+    uint64_t tx_start[LOOPBACK_MAX_FRAMES]; // sample number of each frame's first sample
+    uint64_t tx_end[LOOPBACK_MAX_FRAMES];
+    uint64_t block_end;                     // sample number just past the block in modem_rx
+    double latency_sum;
+    double delay_sum;
+    uint32_t rng;
+    float sigma;
+} loopback_state_t;
+
+static modem_rx_t rx;
+static uint16_t tx_buffer[TX_MAX];
+static uint16_t rx_buffer[READ_MAX];
+static uint64_t samples_injected = 0;
+static uint64_t samples_received = 0;
+static uint32_t sample_rate = 0;
+
+static uint32_t xorshift(uint32_t *state)
+{
+    uint32_t x = *state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    return *state = x;
+}
+
+// Sum of four uniforms: close enough to Gaussian for a self-test, and cheap on the device.
+static float noise(loopback_state_t *state)
+{
+    float sum = 0.0f;
+    for (int i = 0; i < 4; i++)
+        sum += (float)(xorshift(&state->rng) >> 8) * (1.0f / 16777216.0f);
+    return (sum - 2.0f) * 1.7320508f * state->sigma; // variance of the sum is 1/3
+}
+
+static void add_noise(loopback_state_t *state, uint16_t *samples, size_t count)
+{
+    if (state->sigma <= 0.0f)
+        return;
+
+    for (size_t i = 0; i < count; i++)
+    {
+        float value = samples[i] + noise(state);
+        samples[i] = value < 0.0f ? 0 : value > 4095.0f ? 4095 : (uint16_t)(value + 0.5f);
+    }
+}
+
+static uint64_t capture_time_us(void)
+{
+    return samples_received * 1000000 / sample_rate;
+}
+
+static uint64_t wall_ns(const loopback_state_t *state)
+{
+    return state->config->clock_ns ? state->config->clock_ns() : 0;
+}
+
+static void make_payload(const loopback_config_t *config, uint16_t number, uint8_t *payload)
+{
+    uint32_t rng = config->seed * 2654435761u + number + 1;
+
+    payload[0] = (uint8_t)(number >> 8);
+    payload[1] = (uint8_t)number;
+    for (size_t i = 2; i < config->payload; i++)
+        payload[i] = (uint8_t)xorshift(&rng);
+}
+
+static void frame_callback(void *ctx, const uint8_t *data, size_t len, uint8_t src_addr)
+{
+    loopback_state_t *state = ctx;
+    const loopback_config_t *config = state->config;
+    uint8_t expected[MODEM_FRAME_MAX_PAYLOAD];
+
+    if (len != config->payload || len < 2 || src_addr != LOOPBACK_SRC)
+    {
+        state->report->wrong++;
+        return;
+    }
+
+    uint16_t number = (uint16_t)(data[0] << 8 | data[1]);
+    make_payload(config, number, expected);
+    if (number >= config->frames || memcmp(data, expected, len) != 0)
+    {
+        state->report->wrong++;
+        return;
+    }
+
+    double latency_ms = (state->block_end - state->tx_start[number]) * 1000.0 / sample_rate;
+    double delay_ms = ((double)state->block_end - (double)state->tx_end[number]) * 1000.0 / sample_rate;
+
+    state->report->ok++;
+    state->latency_sum += latency_ms;
+    state->delay_sum += delay_ms;
+    if (latency_ms > state->report->latency_max_ms)
+        state->report->latency_max_ms = latency_ms;
+}
+
+// Reads everything the ring holds into the receiver, as adc_bsp and the main loop would.
+static void drain(loopback_state_t *state)
+{
+    int fetched;
+
+    while (adc_hal_get_samples(rx_buffer, READ_MAX, &fetched) == 0 && fetched > 0)
+    {
+        uint64_t start = wall_ns(state);
+        state->block_end = samples_received + (uint64_t)fetched;
+        modem_rx_process(&rx, rx_buffer, (size_t)fetched);
+        samples_received = state->block_end;
+        state->report->rx_s += (wall_ns(state) - start) / 1e9;
+    }
+}
+
+static int send_idle(loopback_state_t *state, size_t count)
+{
+    while (count)
+    {
+        size_t n = count < TX_MAX ? count : TX_MAX;
+        for (size_t i = 0; i < n; i++)
+            tx_buffer[i] = MODEM_ADC_MIDPOINT;
+
+        uint64_t start = wall_ns(state);
+        add_noise(state, tx_buffer, n);
+        int ret = adc_hal_inject(tx_buffer, n);
+        state->report->tx_s += (wall_ns(state) - start) / 1e9;
+        if (ret)
+            return -1;
+
+        samples_injected += n;
+        drain(state);
+        count -= n;
+    }
+    return 0;
+}
+
+static int send_frame(loopback_state_t *state, const modem_profile_t *profile, uint16_t number)
+{
+    uint8_t payload[MODEM_FRAME_MAX_PAYLOAD];
+    uint8_t bits[(MODEM_FRAME_MAX_BITS + 7) / 8];
+    size_t num_bits = 0;
+    size_t pos = 0;
+    fsk_mod_t mod;
+
+    uint64_t start = wall_ns(state);
+    make_payload(state->config, number, payload);
+    if (modem_frame_build(LOOPBACK_DST, LOOPBACK_SRC, payload, state->config->payload, bits, sizeof(bits),
+                          &num_bits) ||
+        fsk_mod_init(&mod, profile, state->config->amplitude))
+        return -1;
+    state->report->tx_s += (wall_ns(state) - start) / 1e9;
+
+    state->tx_start[number] = samples_injected;
+    while (pos < num_bits)
+    {
+        start = wall_ns(state);
+        size_t n = fsk_mod_frame_part(&mod, bits, num_bits, MODEM_FRAME_PREAMBLE_BITS + MODEM_FRAME_SYNC_BITS, &pos,
+                                      tx_buffer, TX_MAX);
+        add_noise(state, tx_buffer, n);
+        int ret = n ? adc_hal_inject(tx_buffer, n) : -1;
+        state->report->tx_s += (wall_ns(state) - start) / 1e9;
+        if (ret)
+            return -1;
+
+        samples_injected += n;
+        drain(state);
+    }
+    state->tx_end[number] = samples_injected;
+    return 0;
+}
+
+void loopback_default_config(loopback_config_t *config, modem_profile_id_t profile, uint64_t (*clock_ns)(void))
+{
+    memset(config, 0, sizeof(*config));
+    config->profile = profile;
+    config->frames = 4;
+    config->payload = 16;
+    config->amplitude = 600;
+    config->gap_s = 0.5f;
+    config->snr_db = LOOPBACK_NO_NOISE;
+    config->seed = 1;
+    config->clock_ns = clock_ns;
+}
+
+int loopback_run(const loopback_config_t *config, loopback_report_t *report)
+{
+    static loopback_state_t state;
+    static modem_profile_t stepped; // the profile at config->baud
+    const modem_profile_t *profile = modem_profile_get(config->profile);
+
+    memset(report, 0, sizeof(*report));
+    report->profile = config->profile;
+
+    // afsk-1200 is HDLC framed; every other profile sends modem_frame frames.
+    if (!profile || config->profile == MODEM_PROFILE_AFSK_1200 || config->frames == 0 ||
+        config->frames > LOOPBACK_MAX_FRAMES || config->payload < 2 || config->payload > MODEM_FRAME_MAX_PAYLOAD)
+        return -1;
+
+    if (config->baud && config->baud != profile->baud)
+    {
+        // At least one sample per chip.
+        if ((uint32_t)config->baud * profile->oversample > profile->sample_rate)
+            return -1;
+        stepped = *profile;
+        stepped.baud = config->baud;
+        profile = &stepped;
+    }
+    report->baud = profile->baud;
+
+    memset(&state, 0, sizeof(state));
+    state.config = config;
+    state.report = report;
+    state.rng = config->seed ? config->seed : 1;
+    if (config->snr_db < LOOPBACK_NO_NOISE)
+    {
+        // Tone power against the white noise that falls in the reference bandwidth.
+        float band_fraction = REFERENCE_BANDWIDTH_HZ / (profile->sample_rate / 2.0f);
+        float tone_power = (float)config->amplitude * config->amplitude / 2.0f;
+        state.sigma = sqrtf(tone_power / powf(10.0f, config->snr_db / 10.0f) / band_fraction);
+    }
+
+    sample_rate = profile->sample_rate;
+    samples_injected = 0;
+    samples_received = 0;
+
+    uint64_t dropped_before = 0;
+    if (adc_hal_init() || adc_hal_set_sample_rate((int)sample_rate) || adc_hal_set_sample_size(CHUNK) ||
+        adc_hal_set_callback(NULL) || adc_hal_get_dropped(&dropped_before))
+    {
+        LOG_ERROR("Loopback: cannot set the ADC ring up");
+        adc_hal_deinit();
+        return -1;
+    }
+
+    modem_rx_init(&rx, profile, frame_callback, &state);
+    modem_rx_set_squelch(&rx, true, NULL);
+    modem_rx_set_clock(&rx, capture_time_us);
+
+    size_t gap = (size_t)(config->gap_s * sample_rate);
+    int ret = 0;
+
+    for (unsigned f = 0; f < config->frames && ret == 0; f++)
+    {
+        ret = send_idle(&state, gap);
+        if (ret == 0)
+            ret = send_frame(&state, profile, (uint16_t)f);
+        if (ret == 0)
+            report->sent++;
+    }
+
+    // The gap after the last frame, and at least a chunk so its tail leaves the DMA-sized staging.
+    if (ret == 0)
+        ret = send_idle(&state, gap > CHUNK ? gap : CHUNK);
+
+    uint64_t dropped = 0;
+    adc_hal_get_dropped(&dropped);
+    adc_hal_deinit();
+
+    report->bad_crc = rx.stats.frames_bad_crc;
+    report->dropped = dropped - dropped_before;
+    report->air_s = (double)samples_received / sample_rate;
+    if (report->ok)
+    {
+        report->latency_mean_ms = state.latency_sum / report->ok;
+        report->delay_mean_ms = state.delay_sum / report->ok;
+    }
+    if (report->rx_s > 0.0)
+    {
+        report->x_realtime = report->air_s / report->rx_s;
+    }
+
+    if (ret)
+        LOG_ERROR("Loopback: cannot send on %s", profile->name);
+    return ret;
+}
+
+static bool baud_holds(const loopback_config_t *config, unsigned min_success, uint32_t baud)
+{
+    loopback_config_t stepped = *config;
+    loopback_report_t report;
+
+    stepped.baud = (uint16_t)baud;
+    if (loopback_run(&stepped, &report))
+        return false;
+    if (report.ok * 100 < config->frames * min_success)
+        return false;
+    return !config->clock_ns || report.x_realtime >= 1.0;
+}
+
+uint16_t loopback_max_baud(const loopback_config_t *config, unsigned min_success)
+{
+    const modem_profile_t *profile = modem_profile_get(config->profile);
+    if (!profile || !baud_holds(config, min_success, profile->baud))
+        return 0;
+
+    uint32_t limit = profile->sample_rate / profile->oversample;
+    if (limit > UINT16_MAX)
+        limit = UINT16_MAX;
+
+    // Multiples of the profile's baud: good holds, bad does not (or is past the limit).
+    uint32_t good = 1;
+    uint32_t bad = 2;
+    while (bad * profile->baud <= limit && baud_holds(config, min_success, bad * profile->baud))
+    {
+        good = bad;
+        bad *= 2;
+    }
+    if (bad * profile->baud > limit)
+        bad = limit / profile->baud + 1;
+
+    while (bad - good > 1)
+    {
+        uint32_t mid = good + (bad - good) / 2;
+        if (baud_holds(config, min_success, mid * profile->baud))
+            good = mid;
+        else
+            bad = mid;
+    }
+    return (uint16_t)(good * profile->baud);
+}
+
+int loopback_self_test(unsigned frames, uint64_t (*clock_ns)(void))
+{
+    const modem_profile_t *best = NULL;
+    int ret = 0;
+
+    for (int id = 0; id < MODEM_PROFILE_COUNT; id++)
+    {
+        loopback_config_t config;
+        loopback_report_t report;
+
+        if (id == MODEM_PROFILE_AFSK_1200)
+            continue;
+
+        loopback_default_config(&config, (modem_profile_id_t)id, clock_ns);
+        config.frames = frames;
+
+        const modem_profile_t *profile = modem_profile_get((modem_profile_id_t)id);
+        if (loopback_run(&config, &report) || report.ok != report.sent)
+        {
+            LOG_ERROR("Loopback %s: %lu/%lu frames, %lu bad CRC, %lu wrong", profile->name,
+                      (unsigned long)report.ok, (unsigned long)report.sent, (unsigned long)report.bad_crc,
+                      (unsigned long)report.wrong);
+            ret = -1;
+            continue;
+        }
+
+        config.gap_s = SWEEP_GAP_S;
+        uint16_t max_baud = loopback_max_baud(&config, LOOPBACK_MIN_SUCCESS);
+
+        LOG_INFO("Loopback %s: %lu/%lu frames, latency %.0f ms (%.0f after the frame), %.1fx real time, "
+                 "decodes up to %u baud",
+                 profile->name, (unsigned long)report.ok, (unsigned long)report.sent, report.latency_mean_ms,
+                 report.delay_mean_ms, report.x_realtime, (unsigned)max_baud);
+
+        if (report.x_realtime >= 1.0 && (!best || profile->baud > best->baud))
+            best = profile;
+    }
+
+    if (best)
+        LOG_INFO("Loopback: fastest profile in real time is %s at %u baud", best->name, best->baud);
+    else if (clock_ns)
+        LOG_WARN("Loopback: no profile decoded in real time");
+
+    return ret;
+}
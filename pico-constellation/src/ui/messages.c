@@ -0,0 +1,36 @@
+#include "ui/messages.h"
+
+#include <stdio.h>
+
+size_t messages_to_json(const message_t *messages, int count, char *buffer, size_t buffer_size)
+{
+    size_t len = 0;
+
+    if (buffer_size < 3)
+        return 0;
+
+    buffer[len++] = '[';
+
+    for (int i = 0; i < count; i++)
+    {
+        // Keep room for the closing bracket; a cut-off entry is dropped whole.
+        size_t room = buffer_size - len - 1;
+        int n = snprintf(
+            buffer + len,
+            room,
+            "%s{\"name\":\"%s\",\"text\":\"%s\",\"time\":\"%s\"}",
+            (i == 0) ? "" : ",",
+            messages[i].name,
+            messages[i].message,
+            messages[i].time);
+
+        if (n < 0 || (size_t)n >= room)
+            break;
+        len += n;
+    }
+
+    buffer[len++] = ']';
+    buffer[len] = '\0';
+
+    return len;
+}
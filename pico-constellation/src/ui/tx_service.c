@@ -0,0 +1,347 @@
+#include "ui/tx_service.h"
+
+#include <stdio.h>
+#include "c-logger.h"
+#include "modem/ax25_tx.h"
+#include "modem/csma.h"
+#include "modem/squelch.h"
+#include "ptt_bsp.h"
+#include "HAL_time.h"
+#include "utils/histogram.h"
+
+// 1: symbols go out of the PWM DAC; 0: two-tone FSK through ad9833_fsk.
+#ifndef TX_SERVICE_PWM
+#define TX_SERVICE_PWM 0
+#endif
+#ifndef TX_SERVICE_ADDRESS
+#define TX_SERVICE_ADDRESS 0x01
+#endif
+#define TX_SERVICE_AMPLITUDE 1800
+#define STAGE_SYMBOLS 64 // unpacked at a time, two seconds at 32 baud
+#define TIMING_MARKS 16  // frames per key-up whose queue latency is measured
+
+#include "ad9833_fsk.h"
+#if TX_SERVICE_PWM
+#include "pwm_dac.h"
+#endif
+
+static bool running = false;
+static const modem_profile_t *profile;
+static tx_queue_t queue;
+static csma_t csma;
+static squelch_t carrier; // carrier sense on the received audio
+static uint32_t random_state = 1;
+
+static const tx_frame_t *frame; // being handed to the sink
+static size_t frame_pos;
+static bool keyed = false;
+static uint64_t keyup_us;
+static uint32_t burst_frames;
+
+// Timestamps are HAL time; the sinks' are its low 32 bits (time_us_32).
+typedef struct frame_mark
+{
+    uint64_t queued_us;
+    uint32_t offset; // symbols into the key-up
+} frame_mark_t;
+
+static frame_mark_t marks[TIMING_MARKS];
+static size_t mark_count;
+static uint32_t burst_symbols;
+
+static histogram_t queue_latency; // queue entry to the frame's first symbol
+static histogram_t ptt_lead;      // PTT assert to the first symbol
+static histogram_t ptt_tail;      // end of the last symbol to PTT release
+static histogram_t symbol_error;  // edge spacing minus the period, ad9833_fsk only
+
+static uint8_t random_byte(void)
+{
+    random_state ^= random_state << 13;
+    random_state ^= random_state >> 17;
+    random_state ^= random_state << 5;
+    return (uint8_t)(random_state >> 24);
+}
+
+static int sink_start(void)
+{
+#if TX_SERVICE_PWM
+    return 0; // running since init, between frames on the idle tone
+#else
+    return ad9833_fsk_start(profile->tone_hz[0][0], profile->tone_hz[0][1], profile->baud);
+#endif
+}
+
+static void sink_stop(void)
+{
+#if !TX_SERVICE_PWM
+    ad9833_fsk_stats_t stats;
+    ad9833_fsk_get_stats(&stats);
+    histogram_merge(&symbol_error, &stats.error);
+    ad9833_fsk_stop();
+#endif
+}
+
+// When the key-up's first symbol started and its last ended; false if none went out.
+static bool sink_times(uint32_t *first_us, uint32_t *end_us)
+{
+#if TX_SERVICE_PWM
+    return pwm_dac_last_burst(first_us, end_us);
+#else
+    ad9833_fsk_stats_t stats;
+    ad9833_fsk_get_stats(&stats);
+    *first_us = stats.first_us;
+    *end_us = stats.last_us + stats.period_us;
+    return stats.edges > 0;
+#endif
+}
+
+static bool sink_busy(void)
+{
+#if TX_SERVICE_PWM
+    return pwm_dac_busy();
+#else
+    return ad9833_fsk_busy();
+#endif
+}
+
+// Hands over what the sink takes of the frame; returns whether all of it is gone.
+static bool sink_feed(void)
+{
+    uint8_t stage[STAGE_SYMBOLS];
+
+    while (frame_pos < frame->count)
+    {
+        size_t n = tx_queue_symbols(&queue, frame, frame_pos, stage, STAGE_SYMBOLS);
+#if TX_SERVICE_PWM
+        size_t taken = pwm_dac_queue_symbols(stage, n);
+        frame_pos += taken;
+        if (taken < n)
+            return false;
+#else
+        if (ad9833_fsk_send(stage, n))
+            return false;
+        frame_pos += n;
+#endif
+    }
+    return true;
+}
+
+int tx_service_init(modem_profile_id_t profile_id)
+{
+    running = false;
+
+    profile = modem_profile_get(profile_id);
+    if (!profile || tx_queue_init(&queue, profile))
+    {
+        LOG_ERROR("TX service: unknown profile %d", profile_id);
+        return -1;
+    }
+
+#if TX_SERVICE_PWM
+    // Restarted at this profile's rate; the idle tone still works for the library.
+    pwm_dac_stop();
+    if (pwm_dac_init() || pwm_dac_start(profile, TX_SERVICE_AMPLITUDE))
+    {
+        LOG_ERROR("TX service: PWM DAC unavailable");
+        return -1;
+    }
+#else
+    if (profile->modulation != MODEM_MOD_FSK || profile->carriers != 1)
+    {
+        LOG_ERROR("TX service: %s needs the PWM DAC", profile->name);
+        return -1;
+    }
+    if (ad9833_fsk_init())
+    {
+        LOG_ERROR("TX service: PIO symbol clock unavailable");
+        return -1;
+    }
+#endif
+
+    csma_config_t config;
+    csma_default_config(&config);
+    csma_init(&csma, &config);
+
+    squelch_config_t squelch_config;
+    squelch_default_config(&squelch_config);
+    squelch_init(&carrier, &squelch_config);
+    random_state = (uint32_t)HAL_get_current_time_us() | 1;
+
+    histogram_init_log2(&queue_latency, 1000);
+    histogram_init_log2(&ptt_lead, 1000);
+    histogram_init_log2(&ptt_tail, 100);
+    histogram_init_linear(&symbol_error, -(HISTOGRAM_BINS / 2) * AD9833_FSK_ERROR_BIN_US, AD9833_FSK_ERROR_BIN_US);
+
+    frame = NULL;
+    keyed = false;
+    running = true;
+    LOG_INFO("TX service: %s, %d slots", profile->name, TX_QUEUE_SLOTS);
+    return 0;
+}
+
+bool tx_service_running(void)
+{
+    return running;
+}
+
+int32_t tx_service_send(tx_priority_t priority, uint8_t dst, const uint8_t *payload, size_t len)
+{
+    if (!running)
+        return -1;
+
+    uint64_t now = HAL_get_current_time_us();
+    int32_t id;
+    if (profile == modem_profile_get(MODEM_PROFILE_AFSK_1200))
+        id = tx_queue_push_ax25(&queue, priority, payload, len, AX25_TX_LEAD_FLAGS, AX25_TX_TAIL_FLAGS, now);
+    else
+        id = tx_queue_push_frame(&queue, priority, dst, TX_SERVICE_ADDRESS, payload, len, now);
+
+    if (id < 0)
+        LOG_WARN("TX service: frame of %u bytes dropped (%u waiting)", (unsigned)len,
+                 (unsigned)tx_queue_depth(&queue));
+    else if (csma.state == CSMA_IDLE)
+        csma_request(&csma, now);
+    return id;
+}
+
+static void timing_burst(uint64_t release_us)
+{
+    uint32_t first_us, end_us;
+
+    if (burst_frames == 0 || !sink_times(&first_us, &end_us))
+        return;
+
+    int32_t lead = (int32_t)(first_us - (uint32_t)keyup_us);
+    int32_t tail = (int32_t)((uint32_t)release_us - end_us);
+    histogram_add(&ptt_lead, lead);
+    histogram_add(&ptt_tail, tail);
+
+    // Later frames follow the first on the nominal symbol clock.
+    uint64_t start_us = keyup_us + lead;
+    for (size_t i = 0; i < mark_count; i++)
+    {
+        uint64_t frame_us = start_us + (uint64_t)marks[i].offset * 1000000 / profile->baud;
+        int64_t latency = (int64_t)(frame_us - marks[i].queued_us);
+        histogram_add(&queue_latency, latency > INT32_MAX ? INT32_MAX : (int32_t)latency);
+    }
+
+    LOG_INFO("TX timing: PTT lead %ld ms, tail %ld us, %lu frames; lead p99 %ld ms, queue p50 %ld ms p99 %ld ms, "
+             "symbol error %ld..%ld us",
+             (long)(lead / 1000), (long)tail, (unsigned long)burst_frames,
+             (long)(histogram_percentile(&ptt_lead, 99) / 1000),
+             (long)(histogram_percentile(&queue_latency, 50) / 1000),
+             (long)(histogram_percentile(&queue_latency, 99) / 1000), (long)symbol_error.min,
+             (long)symbol_error.max);
+}
+
+void tx_service_feed(const uint16_t *samples, size_t count)
+{
+    // Half duplex: while keyed the receiver hears nothing but us.
+    if (!running || keyed)
+        return;
+
+    while (count)
+    {
+        size_t n = count < SQUELCH_BLOCK_SIZE ? count : SQUELCH_BLOCK_SIZE;
+        squelch_update(&carrier, samples, n);
+        samples += n;
+        count -= n;
+    }
+}
+
+int tx_service_task(void)
+{
+    if (!running)
+        return 0;
+
+    uint64_t now = HAL_get_current_time_us();
+    csma_state_t state = csma_update(&csma, now, squelch_is_open(&carrier), random_byte());
+
+    if (csma_ptt(&csma) && !keyed)
+    {
+        if (sink_start())
+        {
+            LOG_ERROR("TX service: symbol clock failed to start");
+            csma_done(&csma, now, tx_queue_depth(&queue) > 0);
+            return -1;
+        }
+        ptt_bsp_set_ptt(true);
+        keyed = true;
+        keyup_us = HAL_get_current_time_us();
+        burst_frames = 0;
+        burst_symbols = 0;
+        mark_count = 0;
+    }
+
+    if (state != CSMA_TRANSMIT)
+        return 0;
+
+    // Back to back while PTT is up: the next frame goes in behind the last.
+    while (true)
+    {
+        if (!frame)
+        {
+            frame = tx_queue_next(&queue, now);
+            frame_pos = 0;
+            if (!frame)
+                break;
+            burst_frames++;
+            if (mark_count < TIMING_MARKS)
+                marks[mark_count++] = (frame_mark_t){.queued_us = frame->queued_us, .offset = burst_symbols};
+            burst_symbols += frame->count;
+        }
+        if (!sink_feed())
+            return 0;
+        tx_queue_done(&queue);
+        frame = NULL;
+    }
+
+    if (sink_busy())
+        return 0;
+
+    ptt_bsp_set_ptt(false);
+    uint64_t release_us = HAL_get_current_time_us();
+    sink_stop();
+    keyed = false;
+    csma_done(&csma, now, tx_queue_depth(&queue) > 0);
+    LOG_INFO("TX service: %lu frames in %lu ms keyed", (unsigned long)burst_frames,
+             (unsigned long)((release_us - keyup_us) / 1000));
+    timing_burst(release_us);
+    return 0;
+}
+
+size_t tx_service_to_json(char *buffer, size_t buffer_size)
+{
+    if (!running)
+        return snprintf(buffer, buffer_size, "{\"profile\":null}");
+
+    const tx_queue_stats_t *s = &queue.stats;
+    double wait_ms[TX_PRIORITY_COUNT];
+    for (int p = 0; p < TX_PRIORITY_COUNT; p++)
+        wait_ms[p] = s->sent[p] ? s->wait_total_us[p] / 1000.0 / s->sent[p] : 0.0;
+
+    size_t len = (size_t)snprintf(buffer, buffer_size,
+                                  "{\"profile\":\"%s\",\"depth\":%u,\"max_depth\":%lu,\"keyups\":%lu,\"lost_draws\":%lu,"
+                                  "\"rejected\":%lu,\"queued\":[%lu,%lu,%lu],\"sent\":[%lu,%lu,%lu],\"dropped\":[%lu,%lu,%lu],"
+                                  "\"wait_mean_ms\":[%.1f,%.1f,%.1f],\"wait_max_ms\":[%lu,%lu,%lu],\"timing\":{",
+                                  profile->name, (unsigned)tx_queue_depth(&queue), (unsigned long)s->max_depth,
+                                  (unsigned long)csma.stats.keyups, (unsigned long)csma.stats.lost_draws,
+                                  (unsigned long)s->rejected, (unsigned long)s->queued[0], (unsigned long)s->queued[1],
+                                  (unsigned long)s->queued[2], (unsigned long)s->sent[0], (unsigned long)s->sent[1],
+                                  (unsigned long)s->sent[2], (unsigned long)s->dropped[0], (unsigned long)s->dropped[1],
+                                  (unsigned long)s->dropped[2], wait_ms[0], wait_ms[1], wait_ms[2],
+                                  (unsigned long)(s->wait_max_us[0] / 1000), (unsigned long)(s->wait_max_us[1] / 1000),
+                                  (unsigned long)(s->wait_max_us[2] / 1000));
+
+    const histogram_t *hists[] = {&queue_latency, &ptt_lead, &ptt_tail, &symbol_error};
+    const char *names[] = {"queue_latency_us", "ptt_lead_us", "ptt_tail_us", "symbol_error_us"};
+    for (int i = 0; i < 4 && len < buffer_size; i++)
+    {
+        len += (size_t)snprintf(buffer + len, buffer_size - len, "%s\"%s\":", i ? "," : "", names[i]);
+        if (len < buffer_size)
+            len += histogram_to_json(hists[i], buffer + len, buffer_size - len);
+    }
+    if (len < buffer_size)
+        len += (size_t)snprintf(buffer + len, buffer_size - len, "}}");
+    return len < buffer_size ? len : buffer_size - 1;
+}
@@ -1,29 +1,35 @@
 #include "ui/ui.h"
 
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 #include "c-logger.h"
 #include "pages/home_page.h"
+#include "ui/waterfall.h"
+#include "ui/link_test.h"
+#include "ui/messages.h"
+#include "ui/tx_service.h"
+#include "modem/link_stats.h"
+#include "HAL_time.h"
 #include "interface/pconfig.h"
 #include "peregrine-constellation.h"
 
-typedef struct
-{
-    char name[32];
-    char time[32];
-    char message[100];
-} message_t;
-
-static message_t messages[32];
+static message_t messages[MESSAGES_MAX];
 static int message_index = 0;
+static link_stats_t links;
 extern pc_handle_t *pc_handle;
 
 static int _update(http_contents_t *contents, http_request_t *request);
 static int _home_page(http_contents_t *contents, http_request_t *request);
 static int _send(http_contents_t *contents, http_request_t *request);
+static int _spectrum(http_contents_t *contents, http_request_t *request);
+static int _peers(http_contents_t *contents, http_request_t *request);
+static int _link_test(http_contents_t *contents, http_request_t *request);
+static int _tx(http_contents_t *contents, http_request_t *request);
 
 int ui_init(void)
 {
+    link_stats_init(&links);
     return 0;
 }
 
@@ -46,6 +52,22 @@ int ui_handle_event(http_contents_t *contents, http_request_t *request)
     {
         return _send(contents, request);
     }
+    else if (strcmp(request->path, "/spectrum") == 0)
+    {
+        return _spectrum(contents, request);
+    }
+    else if (strcmp(request->path, "/peers") == 0)
+    {
+        return _peers(contents, request);
+    }
+    else if (strcmp(request->path, "/tx") == 0)
+    {
+        return _tx(contents, request);
+    }
+    else if (strcmp(request->path, "/linktest") == 0)
+    {
+        return _link_test(contents, request);
+    }
     else
     {
         return _home_page(contents, request);
@@ -61,25 +83,75 @@ int _home_page(http_contents_t *contents, http_request_t *request)
     contents->update = true;
 }
 
-size_t messages_to_json(char *buffer, size_t buffer_size)
+int ui_frame_received(uint8_t src_addr, const modem_rx_frame_info_t *info)
+{
+    return link_stats_update(&links, src_addr, info, HAL_get_current_time_us()) ? 0 : -1;
+}
+
+size_t peers_to_json(char *buffer, size_t buffer_size)
 {
     size_t len = 0;
+    int count = 0;
+    uint64_t now = HAL_get_current_time_us();
+
+    if (buffer_size < 3)
+        return 0;
 
-    len += snprintf(buffer + len, buffer_size - len, "[");
+    buffer[len++] = '[';
 
-    for (int i = 0; i < message_index; i++)
+    for (int i = 0; i < LINK_STATS_MAX_PEERS; i++)
     {
-        len += snprintf(
-            buffer + len,
-            buffer_size - len,
-            "%s{\"name\":\"%s\",\"text\":\"%s\",\"time\":\"%s\"}",
-            (i == 0) ? "" : ",",
-            messages[i].name,
-            messages[i].message,
-            messages[i].time);
+        const link_peer_t *peer = &links.peers[i];
+        if (!peer->used)
+        {
+            continue;
+        }
+
+        // Keep room for the closing bracket; a cut-off entry is dropped whole.
+        size_t room = buffer_size - len - 1;
+        int n;
+        if (peer->frames_with_info)
+        {
+            n = snprintf(
+                buffer + len,
+                room,
+                "%s{\"addr\":%u,\"frames\":%lu,\"snr\":%.1f,\"min\":%.1f,\"mark\":%.0f,\"space\":%.0f,"
+                "\"offset\":%.1f,\"fixed\":%lu,\"latency\":%.1f,\"age\":%lu}",
+                (count == 0) ? "" : ",",
+                peer->addr,
+                (unsigned long)peer->frames,
+                peer->snr_db,
+                peer->snr_min_db,
+                peer->mark_level,
+                peer->space_level,
+                peer->offset_hz,
+                (unsigned long)peer->corrected_bits,
+                peer->latency_us / 1000.0f,
+                (unsigned long)((now - peer->last_seen_us) / 1000000));
+        }
+        else
+        {
+            // No frame came with link quality (the library's callback has none): null, not 0.
+            n = snprintf(
+                buffer + len,
+                room,
+                "%s{\"addr\":%u,\"frames\":%lu,\"snr\":null,\"min\":null,\"mark\":null,\"space\":null,"
+                "\"offset\":null,\"fixed\":%lu,\"latency\":null,\"age\":%lu}",
+                (count == 0) ? "" : ",",
+                peer->addr,
+                (unsigned long)peer->frames,
+                (unsigned long)peer->corrected_bits,
+                (unsigned long)((now - peer->last_seen_us) / 1000000));
+        }
+
+        if (n < 0 || (size_t)n >= room)
+            break;
+        len += n;
+        count++;
     }
 
-    len += snprintf(buffer + len, buffer_size - len, "]");
+    buffer[len++] = ']';
+    buffer[len] = '\0';
 
     return len;
 }
@@ -87,7 +159,7 @@ size_t messages_to_json(char *buffer, size_t buffer_size)
 int _update(http_contents_t *contents, http_request_t *request)
 {
     static int count = 0;
-    messages_to_json(contents->contents, HTML_MAX_CONTENTS);
+    messages_to_json(messages, message_index, contents->contents, HTML_MAX_CONTENTS);
     contents->length = strlen(contents->contents);
     contents->update = true;
 
@@ -96,7 +168,7 @@ int _update(http_contents_t *contents, http_request_t *request)
 
 int _send(http_contents_t *contents, http_request_t *request)
 {
-    if (message_index >= 32)
+    if (message_index >= MESSAGES_MAX)
     {
         message_index = 0;
     }
@@ -105,10 +177,57 @@ int _send(http_contents_t *contents, http_request_t *request)
     snprintf(messages[message_index].time, 32, "unknown");
     snprintf(messages[message_index].message, 100, request->body);
 
-    pc_send_message(pc_handle, 0x00, messages[message_index].message, strlen(messages[message_index].message));
+    if (tx_service_running())
+    {
+        tx_service_send(TX_PRIORITY_NORMAL, 0x00, (const uint8_t *)messages[message_index].message,
+                        strlen(messages[message_index].message));
+    }
+    else
+    {
+        pc_send_message(pc_handle, 0x00, messages[message_index].message, strlen(messages[message_index].message));
+    }
     message_index++;
     contents->update = false;
     contents->length = 0;
     
     return 0;
-}
\ No newline at end of file
+}
+
+int _spectrum(http_contents_t *contents, http_request_t *request)
+{
+    uint32_t since = 0;
+    const char *arg = strstr(request->query, "since=");
+    if (arg)
+    {
+        since = (uint32_t)strtoul(arg + strlen("since="), NULL, 10);
+    }
+
+    contents->length = waterfall_to_json(contents->contents, HTML_MAX_CONTENTS, since);
+    contents->update = true;
+
+    return 0;
+}
+
+int _peers(http_contents_t *contents, http_request_t *request)
+{
+    contents->length = peers_to_json(contents->contents, HTML_MAX_CONTENTS);
+    contents->update = true;
+
+    return 0;
+}
+
+int _link_test(http_contents_t *contents, http_request_t *request)
+{
+    contents->length = link_test_to_json(contents->contents, HTML_MAX_CONTENTS);
+    contents->update = true;
+
+    return 0;
+}
+
+int _tx(http_contents_t *contents, http_request_t *request)
+{
+    contents->length = tx_service_to_json(contents->contents, HTML_MAX_CONTENTS);
+    contents->update = true;
+
+    return 0;
+}
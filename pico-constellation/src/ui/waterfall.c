@@ -0,0 +1,136 @@
+#include "ui/waterfall.h"
+
+#include <stdbool.h>
+#include <stdio.h>
+#include "adc_hal.h"
+#include "c-logger.h"
+#include "dsp/spectrum.h"
+#include "HAL_time.h"
+
+#define IDLE_BACKLOG 1024   // ADC samples waiting before the CPU counts as busy
+#define MAX_JSON_LINES 8    // keeps a reply well inside HTML_MAX_CONTENTS
+
+static spectrum_t spectrum;
+static bool initialized = false;
+
+int waterfall_init(uint32_t sample_rate)
+{
+    spectrum_config_t config;
+    spectrum_default_config(&config, sample_rate, HAL_get_current_time_us);
+    config.schedule = SPECTRUM_SCHEDULE_IDLE;
+
+    if (spectrum_init(&spectrum, &config))
+    {
+        LOG_ERROR("Failed to initialize waterfall");
+        return -1;
+    }
+
+    initialized = true;
+    return 0;
+}
+
+void waterfall_feed(const uint16_t *samples, size_t count)
+{
+    if (initialized)
+    {
+        spectrum_feed(&spectrum, samples, count);
+    }
+}
+
+int waterfall_task(void)
+{
+    if (!initialized)
+    {
+        return 0;
+    }
+
+    int backlog = 0;
+    adc_samples_available(&backlog);
+    return spectrum_task(&spectrum, backlog < IDLE_BACKLOG);
+}
+
+size_t waterfall_to_json(char *buffer, size_t buffer_size, uint32_t since)
+{
+    static const char hex[] = "0123456789abcdef";
+    static const char header[] = "{\"seq\":%lu,\"rate\":%lu,\"bin\":%.1f,\"bins\":%u,\"lines\":[";
+    unsigned long rate = (unsigned long)(spectrum.config.sample_rate / spectrum.config.decimation);
+    size_t len = 0;
+    int emitted = 0;
+    int n;
+
+    if (!initialized)
+    {
+        n = snprintf(buffer, buffer_size, "{\"seq\":0,\"lines\":[]}");
+        return n < 0 || buffer_size == 0 ? 0 : (size_t)n < buffer_size ? (size_t)n : buffer_size - 1;
+    }
+
+    uint32_t first = since + 1;
+    if (spectrum.seq >= MAX_JSON_LINES && first <= spectrum.seq - MAX_JSON_LINES)
+    {
+        first = spectrum.seq - MAX_JSON_LINES + 1;
+    }
+
+    // Sized with the newest seq, which has the most digits; "]}" and the NUL always fit after it.
+    n = snprintf(NULL, 0, header, (unsigned long)spectrum.seq, rate, spectrum_bin_hz(&spectrum),
+                     spectrum.config.bins);
+    if (n < 0 || (size_t)n + 3 > buffer_size)
+    {
+        if (buffer_size)
+            buffer[0] = '\0';
+        return 0;
+    }
+
+    // The lines that fit, oldest first, stopping at the first that does not: seq is
+    // the last one sent, so the next request picks up the rest.
+    size_t line_len = 2 * (size_t)spectrum.config.bins + 3; // quotes and a comma
+    size_t room = buffer_size - (size_t)n - 3;
+    uint32_t last = first > spectrum.seq ? spectrum.seq : first - 1;
+    for (uint32_t seq = first; seq <= spectrum.seq; seq++)
+    {
+        if (spectrum_line(&spectrum, seq))
+        {
+            if (line_len > room)
+            {
+                break;
+            }
+            room -= line_len;
+        }
+        last = seq;
+    }
+
+    n = snprintf(buffer, buffer_size, header, (unsigned long)last, rate, spectrum_bin_hz(&spectrum),
+                 spectrum.config.bins);
+    if (n < 0)
+    {
+        buffer[0] = '\0';
+        return 0;
+    }
+    len = (size_t)n;
+
+    for (uint32_t seq = first; seq <= last; seq++)
+    {
+        const uint8_t *line = spectrum_line(&spectrum, seq);
+        if (!line)
+        {
+            continue; // no longer held; nothing to resend
+        }
+
+        if (emitted++)
+        {
+            buffer[len++] = ',';
+        }
+        buffer[len++] = '"';
+        for (uint16_t b = 0; b < spectrum.config.bins; b++)
+        {
+            buffer[len++] = hex[line[b] >> 4];
+            buffer[len++] = hex[line[b] & 0x0f];
+        }
+        buffer[len++] = '"';
+    }
+
+    buffer[len++] = ']';
+    buffer[len++] = '}';
+    buffer[len] = '\0';
+
+    return len;
+}
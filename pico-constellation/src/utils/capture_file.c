@@ -0,0 +1,126 @@
+#include "utils/capture_file.h"
+
+#include <stdbool.h>
+
+static void put_le16(uint8_t *p, uint16_t value)
+{
+    p[0] = (uint8_t)value;
+    p[1] = (uint8_t)(value >> 8);
+}
+
+static void put_le32(uint8_t *p, uint32_t value)
+{
+    put_le16(p, (uint16_t)value);
+    put_le16(p + 2, (uint16_t)(value >> 16));
+}
+
+static void put_le64(uint8_t *p, uint64_t value)
+{
+    put_le32(p, (uint32_t)value);
+    put_le32(p + 4, (uint32_t)(value >> 32));
+}
+
+static uint16_t get_le16(const uint8_t *p)
+{
+    return (uint16_t)(p[0] | p[1] << 8);
+}
+
+static uint32_t get_le32(const uint8_t *p)
+{
+    return (uint32_t)get_le16(p) | (uint32_t)get_le16(p + 2) << 16;
+}
+
+static uint64_t get_le64(const uint8_t *p)
+{
+    return (uint64_t)get_le32(p) | (uint64_t)get_le32(p + 4) << 32;
+}
+
+// Any 'PCC?' tag: chunk types a reader does not know are still chunks, to be skipped.
+static bool stream_tag(uint32_t tag)
+{
+    return (tag & 0x00FFFFFFu) == (CAPTURE_TAG_INFO & 0x00FFFFFFu);
+}
+
+size_t capture_file_chunk_header(uint8_t *out, uint32_t tag, uint32_t length, uint64_t time_us, uint64_t index)
+{
+    put_le32(out, tag);
+    put_le32(out + 4, length);
+    put_le64(out + 8, time_us);
+    put_le64(out + 16, index);
+    return CAPTURE_CHUNK_HEADER_SIZE;
+}
+
+size_t capture_file_info(uint8_t *out, const capture_info_t *info, uint64_t time_us, uint64_t index)
+{
+    uint8_t *p = out + capture_file_chunk_header(out, CAPTURE_TAG_INFO, CAPTURE_INFO_SIZE, time_us, index);
+
+    put_le16(p, CAPTURE_FILE_VERSION);
+    put_le16(p + 2, info->channels);
+    put_le32(p + 4, info->sample_rate);
+    p[8] = info->bits;
+    p[9] = info->profile;
+    put_le16(p + 10, info->dc_offset);
+    p[12] = info->trace_bits == 8 ? 8 : 16;
+    p[13] = p[14] = p[15] = 0;
+    return CAPTURE_CHUNK_HEADER_SIZE + CAPTURE_INFO_SIZE;
+}
+
+size_t capture_file_gap(uint8_t *out, uint32_t lost, uint64_t time_us, uint64_t index)
+{
+    put_le32(out + capture_file_chunk_header(out, CAPTURE_TAG_GAP, CAPTURE_GAP_SIZE, time_us, index), lost);
+    return CAPTURE_CHUNK_HEADER_SIZE + CAPTURE_GAP_SIZE;
+}
+
+int capture_file_parse_chunk(const uint8_t *data, size_t size, capture_chunk_t *chunk)
+{
+    if (size < CAPTURE_CHUNK_HEADER_SIZE)
+        return -1;
+
+    chunk->tag = get_le32(data);
+    chunk->length = get_le32(data + 4);
+    chunk->time_us = get_le64(data + 8);
+    chunk->index = get_le64(data + 16);
+    chunk->payload = data + CAPTURE_CHUNK_HEADER_SIZE;
+
+    if (!stream_tag(chunk->tag) || chunk->length > size - CAPTURE_CHUNK_HEADER_SIZE)
+        return -1;
+
+    return 0;
+}
+
+int capture_file_parse_info(const capture_chunk_t *chunk, capture_info_t *info)
+{
+    if (chunk->tag != CAPTURE_TAG_INFO || chunk->length < CAPTURE_INFO_SIZE)
+        return -1;
+
+    const uint8_t *p = chunk->payload;
+    info->version = get_le16(p);
+    info->channels = get_le16(p + 2);
+    info->sample_rate = get_le32(p + 4);
+    info->bits = p[8];
+    info->profile = p[9];
+    info->dc_offset = get_le16(p + 10);
+    info->trace_bits = p[12] ? p[12] : 16;
+
+    if (info->version != CAPTURE_FILE_VERSION || !info->channels || info->channels > CAPTURE_MAX_CHANNELS ||
+        (info->trace_bits != 8 && info->trace_bits != 16))
+        return -1;
+
+    return 0;
+}
+
+size_t capture_file_frame_size(const capture_info_t *info)
+{
+    return 2 + (size_t)(info->channels - 1) * (info->trace_bits == 8 ? 1 : 2);
+}
+
+size_t capture_file_resync(const uint8_t *data, size_t size, size_t from)
+{
+    for (size_t i = from; i + 4 <= size; i++)
+    {
+        if (data[i] == 'P' && stream_tag(get_le32(data + i)))
+            return i;
+    }
+
+    return size;
+}
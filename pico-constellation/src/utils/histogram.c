@@ -0,0 +1,130 @@
+#include "utils/histogram.h"
+
+#include <stdio.h>
+#include <string.h>
+
+static void histogram_init(histogram_t *hist, histogram_scale_t scale, int32_t origin, uint32_t unit)
+{
+    memset(hist, 0, sizeof(*hist));
+    hist->scale = (uint8_t)scale;
+    hist->origin = origin;
+    hist->unit = unit ? unit : 1;
+}
+
+void histogram_init_log2(histogram_t *hist, uint32_t unit)
+{
+    histogram_init(hist, HISTOGRAM_LOG2, 0, unit);
+}
+
+void histogram_init_linear(histogram_t *hist, int32_t origin, uint32_t width)
+{
+    histogram_init(hist, HISTOGRAM_LINEAR, origin, width);
+}
+
+void histogram_reset(histogram_t *hist)
+{
+    histogram_init(hist, (histogram_scale_t)hist->scale, hist->origin, hist->unit);
+}
+
+static unsigned histogram_bin(const histogram_t *hist, int32_t value)
+{
+    if (hist->scale == HISTOGRAM_LINEAR)
+    {
+        if (value < hist->origin)
+            return 0;
+        uint32_t bin = (uint32_t)((int64_t)value - hist->origin) / hist->unit;
+        return bin < HISTOGRAM_BINS ? bin : HISTOGRAM_BINS - 1;
+    }
+
+    if (value < (int64_t)hist->unit)
+        return 0;
+    // Bits in value / unit: 1 for [unit, 2 unit), and so on.
+    uint32_t scaled = (uint32_t)value / hist->unit;
+    unsigned bin = 32 - (unsigned)__builtin_clz(scaled);
+    return bin < HISTOGRAM_BINS ? bin : HISTOGRAM_BINS - 1;
+}
+
+// Exclusive upper edge of a bin; the last bin is open.
+static int64_t histogram_upper(const histogram_t *hist, unsigned bin)
+{
+    if (hist->scale == HISTOGRAM_LINEAR)
+        return (int64_t)hist->origin + (int64_t)(bin + 1) * hist->unit;
+    return (int64_t)hist->unit << bin;
+}
+
+void histogram_add(histogram_t *hist, int32_t value)
+{
+    hist->bins[histogram_bin(hist, value)]++;
+    if (hist->count == 0 || value < hist->min)
+        hist->min = value;
+    if (hist->count == 0 || value > hist->max)
+        hist->max = value;
+    hist->sum += value;
+    hist->count++;
+}
+
+int histogram_merge(histogram_t *dst, const histogram_t *src)
+{
+    if (dst->scale != src->scale || dst->origin != src->origin || dst->unit != src->unit)
+        return -1;
+    if (src->count == 0)
+        return 0;
+
+    for (int i = 0; i < HISTOGRAM_BINS; i++)
+        dst->bins[i] += src->bins[i];
+    if (dst->count == 0 || src->min < dst->min)
+        dst->min = src->min;
+    if (dst->count == 0 || src->max > dst->max)
+        dst->max = src->max;
+    dst->sum += src->sum;
+    dst->count += src->count;
+    return 0;
+}
+
+int32_t histogram_percentile(const histogram_t *hist, unsigned percent)
+{
+    if (hist->count == 0)
+        return 0;
+
+    // The sample at rank ceil(count * percent / 100), counting from 1.
+    uint64_t rank = ((uint64_t)hist->count * (percent > 100 ? 100 : percent) + 99) / 100;
+    uint64_t seen = 0;
+    if (rank == 0)
+        return hist->min;
+
+    for (unsigned bin = 0; bin < HISTOGRAM_BINS; bin++)
+    {
+        seen += hist->bins[bin];
+        if (seen >= rank)
+        {
+            int64_t upper = histogram_upper(hist, bin);
+            if (bin == HISTOGRAM_BINS - 1 || upper > hist->max)
+                return hist->max;
+            return upper < hist->min ? hist->min : (int32_t)upper;
+        }
+    }
+    return hist->max;
+}
+
+int32_t histogram_mean(const histogram_t *hist)
+{
+    return hist->count ? (int32_t)(hist->sum / (int64_t)hist->count) : 0;
+}
+
+size_t histogram_to_json(const histogram_t *hist, char *buffer, size_t buffer_size)
+{
+    size_t len = (size_t)snprintf(buffer, buffer_size,
+                                  "{\"count\":%lu,\"min\":%ld,\"max\":%ld,\"mean\":%ld,\"p50\":%ld,\"p90\":%ld,"
+                                  "\"p99\":%ld,\"scale\":\"%s\",\"origin\":%ld,\"unit\":%lu,\"bins\":[",
+                                  (unsigned long)hist->count, (long)hist->min, (long)hist->max,
+                                  (long)histogram_mean(hist), (long)histogram_percentile(hist, 50),
+                                  (long)histogram_percentile(hist, 90), (long)histogram_percentile(hist, 99),
+                                  hist->scale == HISTOGRAM_LINEAR ? "linear" : "log2", (long)hist->origin,
+                                  (unsigned long)hist->unit);
+
+    for (int i = 0; i < HISTOGRAM_BINS && len < buffer_size; i++)
+        len += (size_t)snprintf(buffer + len, buffer_size - len, i ? ",%lu" : "%lu", (unsigned long)hist->bins[i]);
+    if (len < buffer_size)
+        len += (size_t)snprintf(buffer + len, buffer_size - len, "]}");
+    return len < buffer_size ? len : buffer_size - 1;
+}
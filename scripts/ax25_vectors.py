@@ -0,0 +1,147 @@
+#!/usr/bin/env python3
+"""Generate the AX.25 / HDLC test vectors used by host/tools/ax25_vectors.
+
+A deliberately plain, bit-by-bit implementation of AX.25 v2.2 addressing,
+the CRC-16/X.25 FCS, HDLC bit stuffing and NRZI, written independently of
+the table-driven C code it checks.
+
+Each vector line has tab separated fields:
+    monitor   TNC2 monitor text, or '-' for a raw frame
+    frame     frame bytes without FCS, hex
+    fcs       FCS as sent (low byte first), hex
+    bits      number of line bits
+    line      line levels packed LSB first, hex
+
+The line is one flag, the stuffed frame and FCS, and one flag, NRZI encoded
+starting from level 0.
+"""
+import argparse
+from pathlib import Path
+
+FLAG = 0x7E
+
+
+def crc_x25(data: bytes) -> int:
+    crc = 0xFFFF
+    for byte in data:
+        for i in range(8):
+            bit = (byte >> i) & 1
+            if (crc ^ bit) & 1:
+                crc = (crc >> 1) ^ 0x8408
+            else:
+                crc >>= 1
+    return crc ^ 0xFFFF
+
+
+def parse_address(text: str):
+    repeated = text.endswith("*")
+    text = text.rstrip("*")
+    call, _, ssid = text.partition("-")
+    return call.upper(), int(ssid or 0), repeated
+
+
+def encode_address(call: str, ssid: int, flag: bool, last: bool) -> bytes:
+    out = bytes((ord(c) << 1) for c in call.ljust(6))
+    return out + bytes([0x60 | (ssid << 1) | (0x80 if flag else 0) | (1 if last else 0)])
+
+
+def encode_monitor(text: str) -> bytes:
+    head, _, info = text.partition(":")
+    src, _, path = head.partition(">")
+    fields = path.split(",")
+    dst, digis = fields[0], fields[1:]
+
+    # '*' marks the last digipeater that has repeated the frame.
+    starred = max((i for i, d in enumerate(digis) if d.endswith("*")), default=-1)
+
+    out = encode_address(*parse_address(dst)[:2], True, False)
+    out += encode_address(*parse_address(src)[:2], False, not digis)
+    for i, digi in enumerate(digis):
+        call, ssid, _ = parse_address(digi)
+        out += encode_address(call, ssid, i <= starred, i == len(digis) - 1)
+    return out + bytes([0x03, 0xF0]) + info.encode("latin-1")
+
+
+def line_bits(frame: bytes):
+    fcs = crc_x25(frame)
+    data_bits = []
+    for byte in frame + bytes([fcs & 0xFF, fcs >> 8]):
+        data_bits += [(byte >> i) & 1 for i in range(8)]
+
+    flag = [(FLAG >> i) & 1 for i in range(8)]
+    stuffed = list(flag)
+    ones = 0
+    for bit in data_bits:
+        stuffed.append(bit)
+        ones = ones + 1 if bit else 0
+        if ones == 5:
+            stuffed.append(0)
+            ones = 0
+    stuffed += flag
+
+    level = 0
+    line = []
+    for bit in stuffed:
+        if bit == 0:
+            level ^= 1
+        line.append(level)
+    return fcs, line
+
+
+def pack(bits) -> str:
+    out = bytearray((len(bits) + 7) // 8)
+    for i, bit in enumerate(bits):
+        out[i >> 3] |= bit << (i & 7)
+    return out.hex()
+
+
+MONITOR = [
+    "N0CALL>APRS:>test",
+    "N0CALL-1>APRS,WIDE1-1,WIDE2-1:!4903.50N/07201.75W-Test 001234",
+    "W1AW-15>APZ123,RELAY*,WIDE2-1:=4237.14N/07120.83W#PHG2250",
+    "KC2ABC-9>T2QP8V,DIGI1,DIGI2*,WIDE2-2:`c6Rl!&>/]\"4)}=",
+    "VK2XYZ-12>APDR15,TCPIP*:@092345z4903.50N/07201.75W_220/004g005t077",
+    "DL1ABC>APRS,WIDE1-1:=5030.50N/00745.00E-???~~~???",
+    "G4XYZ-2>CQ:" + "?" * 64,
+    "N0CALL>APRS,A,B,C,D,E,F,G,H:eight digipeaters",
+    "AB1CD-3>ID:AB1CD-3/R WIDE/D",
+    "N1ABC-7>APRS::N0CALL   :hello world{1",
+    "N0CALL>APRS:" + "".join(chr(0x20 + (i % 95)) for i in range(256)),
+    "ZZ9ZZZ-5>BEACON:",
+]
+
+RAW = [
+    encode_address("QST", 0, True, False) + encode_address("N0CALL", 0, False, True) + bytes([0x03, 0xF0]) + bytes([0x7E] * 8),
+    encode_address("QST", 0, True, False) + encode_address("N0CALL", 0, False, True) + bytes([0x03, 0xF0]) + bytes([0xFF] * 16),
+    encode_address("QST", 0, True, False) + encode_address("N0CALL", 0, False, True) + bytes([0x03, 0xF0]) + bytes(range(256)),
+    encode_address("N0CALL", 1, True, False) + encode_address("N1CALL", 2, False, True) + bytes([0x3F]),  # SABM-like control, no PID
+]
+
+
+def main() -> None:
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("-o", "--output", type=Path, default=Path(__file__).parent.parent / "host" / "vectors" / "ax25.txt")
+    args = parser.parse_args()
+
+    rows = []
+    for text in MONITOR:
+        rows.append((text, encode_monitor(text)))
+    for frame in RAW:
+        rows.append(("-", frame))
+
+    lines = [
+        "# AX.25 / HDLC vectors, generated by scripts/ax25_vectors.py",
+        "# CRC-16/X.25 check value: crc(\"123456789\") = %04x" % crc_x25(b"123456789"),
+        "# monitor\tframe\tfcs\tbits\tline",
+    ]
+    for text, frame in rows:
+        fcs, bits = line_bits(frame)
+        lines.append("\t".join([text, frame.hex(), bytes([fcs & 0xFF, fcs >> 8]).hex(), str(len(bits)), pack(bits)]))
+
+    args.output.parent.mkdir(parents=True, exist_ok=True)
+    args.output.write_text("\n".join(lines) + "\n", encoding="latin-1")
+    print(f"Wrote {len(rows)} vectors to {args.output}")
+
+
+if __name__ == "__main__":
+    main()
@@ -1,40 +1,69 @@
 import serial
 import struct
+import sys
+
+# Reads the recorder's capture stream (pico-constellation/include/utils/capture_file.h)
+# and saves it as a .pcc file for host/tools (capture_analyze, capture_convert).
 
 PORT = "/dev/ttyACM1"       # Change this to your Pico's COM port
 BAUD = 115200       # Ignored by USB CDC, but required by pyserial
-RECORD_SIZE = 5
+OUTPUT = sys.argv[1] if len(sys.argv) > 1 else "capture.pcc"
+
+CHUNK_HEADER = struct.Struct("<4sIQQ")
 
 ser = serial.Serial(PORT, BAUD, timeout=1)
 
 print("Waiting for data...")
 
 buffer = bytearray()
+have_info = False
+frames = 0
+lost = 0
+
+with open(OUTPUT, "wb") as out:
+    try:
+        while True:
+            data = ser.read(4096)
+
+            if data:
+                buffer.extend(data)
+
+            while len(buffer) >= CHUNK_HEADER.size:
+                tag, length, time_us, index = CHUNK_HEADER.unpack_from(buffer)
+
+                if tag[:3] != b"PCC":
+                    # Joined mid-chunk: drop bytes until the next tag.
+                    del buffer[:1]
+                    continue
+
+                if len(buffer) < CHUNK_HEADER.size + length:
+                    break
 
-try:
-    while True:
-        data = ser.read(4096)
+                chunk = bytes(buffer[:CHUNK_HEADER.size + length])
+                del buffer[:CHUNK_HEADER.size + length]
 
-        if data:
-            buffer.extend(data)
+                if tag == b"PCCI":
+                    version, channels, rate, bits, profile, dc_offset, trace_bits = struct.unpack_from("<HHIBBHB", chunk, CHUNK_HEADER.size)
+                    frame_size = 2 + (channels - 1) * (1 if trace_bits == 8 else 2)
+                    if not have_info:
+                        print(f"stream v{version}: {channels} channels, {rate} Hz, {bits} bit, dc {dc_offset}, {frame_size} bytes per frame")
+                    have_info = True
+                elif not have_info:
+                    continue  # the file must start with INFO
+                elif tag == b"PCCD":
+                    frames += length // frame_size
+                elif tag == b"PCCG":
+                    lost += struct.unpack_from("<I", chunk, CHUNK_HEADER.size)[0]
+                    print(f"gap: {lost} frames lost so far")
 
-        while len(buffer) >= RECORD_SIZE:
-            record = buffer[:RECORD_SIZE]
-            del buffer[:RECORD_SIZE]
+                out.write(chunk)
 
-            sample, filtered_1200, filtered_2200, metric = struct.unpack(
-                "<HBBB", record
-            )
+            print(f"\r{frames} frames, {frames / rate if have_info else 0:.1f} s", end="")
 
-            print(
-                f"sample={sample:5d} "
-                f"1200={filtered_1200:3d} "
-                f"2200={filtered_2200:3d} "
-                f"metric={metric:3d}"
-            )
+    except KeyboardInterrupt:
+        print("\nStopping...")
 
-except KeyboardInterrupt:
-    print("\nStopping...")
+    finally:
+        ser.close()
 
-finally:
-    ser.close()
\ No newline at end of file
+print(f"Wrote {frames} frames ({lost} lost) to {OUTPUT}")